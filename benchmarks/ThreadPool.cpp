@@ -0,0 +1,37 @@
+//
+// Created by daniel on 18.10.23.
+//
+
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "knowrob/ThreadPool.h"
+
+using namespace knowrob;
+
+namespace knowrob {
+	class EmptyRunner : public ThreadPool::Runner {
+	public:
+		void run() override {}
+	};
+}
+
+static void BM_ThreadPool(benchmark::State &state)
+{
+	// push a batch of goals with an empty run function and wait for all of them
+	auto numGoals = state.range(0);
+	ThreadPool pool(std::thread::hardware_concurrency());
+	std::vector<std::shared_ptr<EmptyRunner>> goals(numGoals);
+
+	for(auto _ : state) {
+		for(auto &goal : goals) {
+			goal = std::make_shared<EmptyRunner>();
+			pool.pushWork(goal, nullptr);
+		}
+		for(auto &goal : goals) goal->join();
+	}
+	state.SetItemsProcessed(state.iterations() * numGoals);
+}
+BENCHMARK(BM_ThreadPool)
+	->RangeMultiplier(10)->Range(10, 10000)
+	->Unit(benchmark::kMicrosecond)
+	->UseRealTime();
@@ -0,0 +1,29 @@
+#include <cstring>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <knowrob/knowrob.h>
+#include <knowrob/Logger.h>
+
+int main(int argc, char **argv)
+{
+	knowrob::InitKnowledgeBase(argc, argv);
+	// debug messages of the thread pool would dominate the measurements
+	knowrob::Logger::setSinkLevel(knowrob::Logger::Console, spdlog::level::warn);
+
+	// report in JSON format unless another format was requested,
+	// such that results of different runs can be compared by scripts.
+	std::vector<char*> args(argv, argv+argc);
+	static char jsonFormat[] = "--benchmark_format=json";
+	bool hasFormat = false;
+	for(int i=1; i<argc; ++i) {
+		if(std::strncmp(argv[i], "--benchmark_format", 18) == 0) hasFormat = true;
+	}
+	if(!hasFormat) args.push_back(jsonFormat);
+	int numArgs = static_cast<int>(args.size());
+
+	benchmark::Initialize(&numArgs, args.data());
+	if(benchmark::ReportUnrecognizedArguments(numArgs, args.data())) return 1;
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
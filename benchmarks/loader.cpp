@@ -0,0 +1,175 @@
+//
+// Created by daniel on 18.10.26.
+//
+
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "knowrob/semweb/rdf.h"
+#include "knowrob/semweb/rdfs.h"
+#include "knowrob/mongodb/TripleLoader.h"
+
+using namespace knowrob;
+
+// number of triples used in the benchmarks: 100, 1000, ..., 100000
+#define KNOWROB_BENCHMARK_TRIPLES RangeMultiplier(10)->Range(100, 100000)->Unit(benchmark::kMillisecond)
+// depth of the class and property hierarchies
+#define KNOWROB_BENCHMARK_HIERARCHY_DEPTH 8
+
+/**
+ * Exposes the encoding of triple documents such that it can be measured
+ * without writing the documents into a database.
+ */
+class EncodingTripleLoader : public mongo::TripleLoader {
+public:
+	explicit EncodingTripleLoader(const semweb::VocabularyPtr &vocabulary)
+	: TripleLoader("benchmark", nullptr, nullptr, vocabulary) {}
+
+	const bson_t* encode(const StatementData &tripleData, bool isTaxonomic) {
+		return encodeTriple(tripleData, graphName_, isTaxonomic);
+	}
+
+	const bson_t* load(const StatementData &tripleData) {
+		return encodeTriple(tripleData, graphName_, updateVocabulary(tripleData));
+	}
+};
+
+struct LoaderInput {
+	semweb::VocabularyPtr vocabulary;
+	std::vector<std::string> strings;
+	std::vector<StatementData> statements;
+};
+
+static std::shared_ptr<LoaderInput> createLoaderInput(int64_t numTriples)
+{
+	// an ABox of typed objects that are related by sub-properties of a
+	// property hierarchy, similar to the instance data of an ontology.
+	auto input = std::make_shared<LoaderInput>();
+	input->vocabulary = std::make_shared<semweb::Vocabulary>();
+	semweb::PropertyPtr property;
+	semweb::ClassPtr cls;
+	for(int i=0; i<KNOWROB_BENCHMARK_HIERARCHY_DEPTH; ++i) {
+		auto nextProperty = input->vocabulary->defineProperty("http://knowrob.org/bench#relation" + std::to_string(i));
+		auto nextClass = input->vocabulary->defineClass("http://knowrob.org/bench#Concept" + std::to_string(i));
+		if(property) nextProperty->addDirectParent(property);
+		if(cls) nextClass->addDirectParent(cls);
+		property = nextProperty;
+		cls = nextClass;
+	}
+
+	// strings must not be moved after statements point to them
+	input->strings.reserve(numTriples);
+	for(int64_t i=0; i<numTriples; ++i) {
+		input->strings.push_back("http://knowrob.org/bench#Object_" + std::to_string(i));
+	}
+	input->statements.reserve(numTriples);
+	for(int64_t i=0; i<numTriples; ++i) {
+		auto &subject = input->strings[i];
+		if(i%2 == 0) {
+			input->statements.emplace_back(subject.c_str(), semweb::rdf::type.data(), cls->iri().c_str());
+		}
+		else {
+			auto &object = input->strings[(i+1) % numTriples];
+			input->statements.emplace_back(subject.c_str(), property->iri().c_str(), object.c_str());
+		}
+	}
+	return input;
+}
+
+static void BM_TripleLoaderEncode(benchmark::State &state)
+{
+	auto input = createLoaderInput(state.range(0));
+	EncodingTripleLoader loader(input->vocabulary);
+
+	for(auto _ : state) {
+		for(auto &statement : input->statements) {
+			bool isTaxonomic = (statement.predicate == semweb::rdf::type.data());
+			benchmark::DoNotOptimize(loader.encode(statement, isTaxonomic));
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TripleLoaderEncode)->KNOWROB_BENCHMARK_TRIPLES;
+
+static void BM_TripleLoaderEncodeUncached(benchmark::State &state)
+{
+	// a new loader for each triple, i.e. neither the document buffer
+	// nor parents of properties and classes are re-used.
+	auto input = createLoaderInput(state.range(0));
+
+	for(auto _ : state) {
+		for(auto &statement : input->statements) {
+			EncodingTripleLoader loader(input->vocabulary);
+			bool isTaxonomic = (statement.predicate == semweb::rdf::type.data());
+			benchmark::DoNotOptimize(loader.encode(statement, isTaxonomic));
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TripleLoaderEncodeUncached)->KNOWROB_BENCHMARK_TRIPLES;
+
+static std::shared_ptr<LoaderInput> createOntologyInput(int64_t numTriples)
+{
+	// an ontology where the class and property hierarchies are asserted while
+	// instances of the classes and properties are loaded, such that cached
+	// parents of classes and properties are invalidated during loading.
+	auto input = std::make_shared<LoaderInput>();
+	int64_t numClasses = numTriples/8 + 1;
+	int64_t numProperties = numTriples/8 + 1;
+	// strings must not be moved after statements point to them
+	input->strings.reserve(numClasses + numProperties + numTriples);
+	for(int64_t i=0; i<numClasses; ++i) {
+		input->strings.push_back("http://knowrob.org/bench#Concept" + std::to_string(i));
+	}
+	for(int64_t i=0; i<numProperties; ++i) {
+		input->strings.push_back("http://knowrob.org/bench#relation" + std::to_string(i));
+	}
+	for(int64_t i=0; i<numTriples; ++i) {
+		input->strings.push_back("http://knowrob.org/bench#Object_" + std::to_string(i));
+	}
+	auto classIRI = [&input](int64_t i) { return input->strings[i].c_str(); };
+	auto propertyIRI = [&input, numClasses](int64_t i) { return input->strings[numClasses + i].c_str(); };
+	auto objectIRI = [&input, numClasses, numProperties](int64_t i) {
+		return input->strings[numClasses + numProperties + i].c_str(); };
+
+	input->statements.reserve(numTriples);
+	// the hierarchies are trees where each node has four children
+	int64_t numDefinedClasses = 1, numDefinedProperties = 1;
+	for(int64_t i=0; i<numTriples; ++i) {
+		if(i%8 == 0 && numDefinedClasses < numClasses) {
+			auto k = numDefinedClasses++;
+			input->statements.emplace_back(classIRI(k), semweb::rdfs::subClassOf.data(), classIRI((k-1)/4));
+		}
+		else if(i%8 == 4 && numDefinedProperties < numProperties) {
+			auto k = numDefinedProperties++;
+			input->statements.emplace_back(propertyIRI(k), semweb::rdfs::subPropertyOf.data(), propertyIRI((k-1)/4));
+		}
+		else if(i%2 == 1) {
+			input->statements.emplace_back(objectIRI(i), semweb::rdf::type.data(), classIRI(i % numDefinedClasses));
+		}
+		else {
+			input->statements.emplace_back(objectIRI(i), propertyIRI(i % numDefinedProperties), objectIRI((i+1) % numTriples));
+		}
+	}
+	return input;
+}
+
+static void BM_TripleLoaderOntology(benchmark::State &state)
+{
+	auto input = createOntologyInput(state.range(0));
+
+	for(auto _ : state) {
+		// the hierarchies are built while loading, so each iteration starts with an empty vocabulary
+		state.PauseTiming();
+		auto loader = std::make_unique<EncodingTripleLoader>(std::make_shared<semweb::Vocabulary>());
+		state.ResumeTiming();
+		for(auto &statement : input->statements) {
+			benchmark::DoNotOptimize(loader->load(statement));
+		}
+		state.PauseTiming();
+		loader = nullptr;
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TripleLoaderOntology)->KNOWROB_BENCHMARK_TRIPLES;
@@ -0,0 +1,540 @@
+/*
+ * Copyright (c) 2022, Daniel Beßler
+ * All rights reserved.
+ *
+ * This file is part of KnowRob, please consult
+ * https://github.com/knowrob/knowrob for license details.
+ */
+
+// STD
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+// POSIX
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+// BOOST
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/variables_map.hpp>
+#include <boost/program_options/parsers.hpp>
+#include <boost/property_tree/ptree.hpp>
+// KnowRob
+#include <knowrob/knowrob.h>
+#include <knowrob/Logger.h>
+#include <knowrob/KnowledgeBase.h>
+#include <knowrob/queries/QueryParser.h>
+#include <knowrob/mongodb/MongoKnowledgeGraph.h>
+#include <knowrob/semweb/owl.h>
+#include <knowrob/semweb/rdf.h>
+#include <knowrob/semweb/rdfs.h>
+
+using namespace knowrob;
+using namespace knowrob::semweb;
+namespace po = boost::program_options;
+
+// the namespace of the synthetic ontology
+#define BENCH_PREFIX "bench"
+#define BENCH_NS "http://knowrob.org/kb/bench"
+#define BENCH_IRI(name) (std::string(BENCH_NS "#") + (name))
+// the agent of statements that are only believed
+#define BENCH_AGENT "bench_agent"
+
+/**
+ * A mongod process that is started and stopped by the benchmark harness.
+ * The database is stored in a fresh directory such that runs are reproducible.
+ */
+class MongoServer {
+public:
+	MongoServer(const std::string &binary, const std::filesystem::path &dbPath, int port)
+	: dbPath_(dbPath), port_(port), pid_(-1)
+	{
+		std::filesystem::create_directories(dbPath_);
+		auto logPath = (dbPath_ / "mongod.log").string();
+		auto portString = std::to_string(port_);
+		auto dbPathString = dbPath_.string();
+
+		pid_ = fork();
+		if(pid_ < 0) {
+			throw std::runtime_error("failed to fork mongod process");
+		}
+		else if(pid_ == 0) {
+			int logFD = open(logPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+			if(logFD >= 0) {
+				dup2(logFD, STDOUT_FILENO);
+				dup2(logFD, STDERR_FILENO);
+			}
+			execlp(binary.c_str(), binary.c_str(),
+				   "--dbpath", dbPathString.c_str(),
+				   "--port", portString.c_str(),
+				   "--bind_ip", "127.0.0.1",
+				   "--quiet",
+				   (char*)nullptr);
+			_exit(127);
+		}
+	}
+
+	~MongoServer()
+	{
+		if(pid_ > 0) {
+			kill(pid_, SIGTERM);
+			waitpid(pid_, nullptr, 0);
+		}
+	}
+
+	/**
+	 * Block until mongod accepts connections.
+	 * @param timeout maximum time to wait.
+	 * @return true if mongod is ready.
+	 */
+	bool waitUntilReady(std::chrono::seconds timeout) const
+	{
+		auto deadline = std::chrono::steady_clock::now() + timeout;
+		while(std::chrono::steady_clock::now() < deadline) {
+			// mongod exited early, e.g. because the binary was not found
+			if(waitpid(pid_, nullptr, WNOHANG) == pid_) return false;
+
+			int fd = socket(AF_INET, SOCK_STREAM, 0);
+			sockaddr_in addr{};
+			addr.sin_family = AF_INET;
+			addr.sin_port = htons(port_);
+			addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+			bool isConnected = (connect(fd, (sockaddr*)&addr, sizeof(addr)) == 0);
+			close(fd);
+			if(isConnected) return true;
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		}
+		return false;
+	}
+
+	pid_t pid() const { return pid_; }
+
+protected:
+	const std::filesystem::path dbPath_;
+	const int port_;
+	pid_t pid_;
+};
+
+/**
+ * A directory that is removed with all its content when this object is destroyed,
+ * including when the benchmark fails.
+ */
+class TemporaryDirectory {
+public:
+	explicit TemporaryDirectory(std::filesystem::path path)
+	: path_(std::move(path))
+	{ std::filesystem::create_directories(path_); }
+
+	~TemporaryDirectory()
+	{
+		std::error_code err;
+		std::filesystem::remove_all(path_, err);
+	}
+
+	const std::filesystem::path& path() const { return path_; }
+
+protected:
+	const std::filesystem::path path_;
+};
+
+/**
+ * Reads the peak resident set size of a process from procfs.
+ * @param pid a process id, or "self".
+ * @return the peak resident set size in kB, or 0 if unknown.
+ */
+static long readMemoryHighWaterMark(const std::string &pid)
+{
+	std::ifstream status("/proc/" + pid + "/status");
+	std::string line;
+	while(std::getline(status, line)) {
+		if(line.rfind("VmHWM:", 0) == 0) {
+			return std::stol(line.substr(6));
+		}
+	}
+	return 0;
+}
+
+/**
+ * A synthetic ontology shaped like the data recorded in NEEMs:
+ * a class taxonomy, objects with a part-of structure, and events
+ * with participants that hold during a time interval. Some participation
+ * statements are only believed by an agent.
+ * The strings are owned by the ontology as statements only hold pointers.
+ */
+struct SyntheticOntology {
+	uint32_t numClasses;
+	uint32_t numObjects;
+	uint32_t numEvents;
+	uint32_t branching;
+	std::deque<std::string> strings;
+	std::vector<StatementData> statements;
+
+	const char* str(const std::string &s)
+	{
+		strings.push_back(s);
+		return strings.back().c_str();
+	}
+
+	static std::string className(uint32_t i)  { return "Class_" + std::to_string(i); }
+	static std::string objectName(uint32_t i) { return "Obj_" + std::to_string(i); }
+	static std::string eventName(uint32_t i)  { return "Event_" + std::to_string(i); }
+
+	uint32_t parentOf(uint32_t i) const { return (i - 1) / branching; }
+
+	void generate(std::mt19937 &rng)
+	{
+		auto *subClassOf = str(std::string(rdfs::subClassOf));
+		auto *type = str(std::string(rdf::type));
+		auto *owlClass = str(std::string(owl::Class));
+		auto *hasPart = str(BENCH_IRI("hasPart"));
+		auto *hasParticipant = str(BENCH_IRI("hasParticipant"));
+
+		std::vector<const char*> classes(numClasses), objects(numObjects);
+		for(uint32_t i=0; i<numClasses; ++i) {
+			classes[i] = str(BENCH_IRI(className(i)));
+			statements.emplace_back(classes[i], type, owlClass);
+			if(i > 0) statements.emplace_back(classes[i], subClassOf, classes[parentOf(i)]);
+		}
+		std::uniform_int_distribution<uint32_t> classDist(0, numClasses-1);
+		std::uniform_int_distribution<uint32_t> objectDist(0, numObjects-1);
+		for(uint32_t i=0; i<numObjects; ++i) {
+			objects[i] = str(BENCH_IRI(objectName(i)));
+			statements.emplace_back(objects[i], type, classes[classDist(rng)]);
+			if(i > 0) statements.emplace_back(objects[parentOf(i)], hasPart, objects[i]);
+		}
+		for(uint32_t i=0; i<numEvents; ++i) {
+			auto *event = str(BENCH_IRI(eventName(i)));
+			// events occur one after the other, each lasting ten seconds
+			auto &occurs = statements.emplace_back(event, hasParticipant, objects[objectDist(rng)]);
+			occurs.begin = 10.0 * i;
+			occurs.end = 10.0 * i + 10.0;
+			auto &believed = statements.emplace_back(event, hasParticipant, objects[objectDist(rng)]);
+			believed.agent = BENCH_AGENT;
+			believed.epistemicOperator = EpistemicOperator::BELIEF;
+			believed.confidence = 0.8;
+		}
+	}
+
+	/**
+	 * Write a Prolog module that computes the transitive closure of the
+	 * part-of structure, such that literals are computed by the Prolog reasoner.
+	 */
+	void writePrologModule(const std::filesystem::path &path) const
+	{
+		std::ofstream file(path);
+		file << ":- module(knowrob_bench, [ bench_link/2, bench_connected/2 ]).\n\n";
+		for(uint32_t i=1; i<numObjects; ++i) {
+			file << "bench_link('" << BENCH_IRI(objectName(parentOf(i))) << "', '"
+			     << BENCH_IRI(objectName(i)) << "').\n";
+		}
+		file << "\nbench_connected(X, Y) :- bench_link(X, Y).\n"
+		     << "bench_connected(X, Y) :- bench_link(X, Z), bench_connected(Z, Y).\n";
+	}
+};
+
+/**
+ * A class of queries that is replayed against the knowledge base.
+ */
+struct QueryClass {
+	std::string name;
+	// generates a random query string of this class
+	std::function<std::string(std::mt19937&)> generator;
+	// latencies in nanoseconds
+	std::vector<uint64_t> latencies;
+	std::atomic<uint64_t> numAnswers = 0;
+	double wallSeconds = 0.0;
+
+	double percentile(double q) const
+	{
+		if(latencies.empty()) return 0.0;
+		auto index = static_cast<size_t>(q * static_cast<double>(latencies.size() - 1));
+		return static_cast<double>(latencies[index]) / 1e9;
+	}
+};
+
+static uint64_t runQuery(KnowledgeBase &kb, const FormulaPtr &phi)
+{
+	auto resultStream = kb.submitQuery(phi, QUERY_FLAG_ALL_SOLUTIONS);
+	auto resultQueue = resultStream->createQueue();
+	uint64_t numAnswers = 0;
+	while(!AnswerStream::isEOS(resultQueue->pop_front())) {
+		numAnswers += 1;
+	}
+	return numAnswers;
+}
+
+static void runQueryClass(KnowledgeBase &kb, QueryClass &queryClass,
+						  uint32_t numQueries, uint32_t numClients, uint32_t seed)
+{
+	// queries are generated and parsed upfront such that only evaluation is measured
+	std::mt19937 rng(seed);
+	std::vector<FormulaPtr> queries(numQueries);
+	for(auto &phi : queries) phi = QueryParser::parse(queryClass.generator(rng));
+
+	// warm-up caches of the database and the reasoner
+	for(uint32_t i=0; i<std::min<uint32_t>(numQueries, 10); ++i) runQuery(kb, queries[i]);
+
+	queryClass.latencies.resize(numQueries);
+	std::atomic<uint32_t> nextQuery = 0;
+	auto begin = std::chrono::steady_clock::now();
+	std::vector<std::thread> clients;
+	for(uint32_t c=0; c<numClients; ++c) {
+		clients.emplace_back([&]() {
+			for(auto i=nextQuery++; i<numQueries; i=nextQuery++) {
+				auto t0 = std::chrono::steady_clock::now();
+				queryClass.numAnswers += runQuery(kb, queries[i]);
+				queryClass.latencies[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(
+						std::chrono::steady_clock::now() - t0).count();
+			}
+		});
+	}
+	for(auto &client : clients) client.join();
+	queryClass.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	std::sort(queryClass.latencies.begin(), queryClass.latencies.end());
+}
+
+static boost::property_tree::ptree createConfiguration(
+		const std::string &host, int port, const std::string &db,
+		const std::filesystem::path &prologModule)
+{
+	boost::property_tree::ptree config, prefix, prefixes, semweb;
+	prefix.put("alias", BENCH_PREFIX);
+	prefix.put("uri", BENCH_NS);
+	prefixes.push_back(std::make_pair("", prefix));
+	semweb.add_child("prefixes", prefixes);
+	config.add_child("semantic-web", semweb);
+
+	boost::property_tree::ptree backend, backends;
+	backend.put("type", "MongoDB");
+	backend.put("name", "mongodb");
+	backend.put("host", host);
+	backend.put("port", port);
+	backend.put("db", db);
+	backend.put("read-only", false);
+	backends.push_back(std::make_pair("", backend));
+	config.add_child("data-backends", backends);
+
+	if(!prologModule.empty()) {
+		boost::property_tree::ptree reasoner, reasoners, source, sources;
+		source.put("path", prologModule.string());
+		source.put("format", "prolog");
+		sources.push_back(std::make_pair("", source));
+		reasoner.put("type", "Prolog");
+		reasoner.put("name", "prolog");
+		reasoner.add_child("imports", sources);
+		reasoners.push_back(std::make_pair("", reasoner));
+		config.add_child("reasoner", reasoners);
+	}
+	return config;
+}
+
+static void writeReport(std::ostream &os,
+						const SyntheticOntology &ontology,
+						double loadSeconds,
+						const std::vector<std::unique_ptr<QueryClass>> &queryClasses,
+						long memoryHWM, long mongoMemoryHWM)
+{
+	os << std::fixed << std::setprecision(6);
+	os << "{\n"
+	   << "  \"ontology\": {\"classes\": " << ontology.numClasses
+	   << ", \"objects\": " << ontology.numObjects
+	   << ", \"events\": " << ontology.numEvents
+	   << ", \"statements\": " << ontology.statements.size() << "},\n"
+	   << "  \"load\": {\"seconds\": " << loadSeconds
+	   << ", \"statements_per_second\": " << static_cast<double>(ontology.statements.size()) / loadSeconds << "},\n"
+	   << "  \"memory_hwm_kb\": " << memoryHWM << ",\n"
+	   << "  \"mongod_memory_hwm_kb\": " << mongoMemoryHWM << ",\n"
+	   << "  \"queries\": [";
+	bool isFirst = true;
+	for(auto &qc : queryClasses) {
+		if(!isFirst) os << ',';
+		isFirst = false;
+		os << "\n    {\"class\": \"" << qc->name << "\""
+		   << ", \"queries\": " << qc->latencies.size()
+		   << ", \"answers\": " << qc->numAnswers.load()
+		   << ", \"queries_per_second\": " << static_cast<double>(qc->latencies.size()) / qc->wallSeconds
+		   << ", \"p50_seconds\": " << qc->percentile(0.5)
+		   << ", \"p99_seconds\": " << qc->percentile(0.99) << "}";
+	}
+	os << "\n  ]\n}\n";
+}
+
+static int run(int argc, char **argv)
+{
+	po::options_description general("Macro-benchmark options");
+	general.add_options()
+			("help", "produce a help message")
+			("classes", po::value<uint32_t>()->default_value(1000), "number of classes in the taxonomy")
+			("objects", po::value<uint32_t>()->default_value(10000), "number of objects")
+			("events", po::value<uint32_t>()->default_value(1000), "number of events")
+			("branching", po::value<uint32_t>()->default_value(4), "branching factor of taxonomy and part-of structure")
+			("queries", po::value<uint32_t>()->default_value(200), "number of queries per query class")
+			("clients", po::value<uint32_t>()->default_value(1), "number of concurrent clients submitting queries")
+			("seed", po::value<uint32_t>()->default_value(42), "seed of the random generator")
+			("mongod", po::value<std::string>()->default_value("mongod"), "the mongod binary started by the harness")
+			("port", po::value<int>()->default_value(27027), "port of the mongod started by the harness")
+			("dbpath", po::value<std::string>(), "database directory, a temporary directory is used by default")
+			("host", po::value<std::string>(), "use a running mongod on this host instead of starting one")
+			("db", po::value<std::string>(), "the database name, with --host a unique name is used by default")
+			("no-prolog", "do not load the Prolog reasoner and skip Prolog-computed literals")
+			("output", po::value<std::string>(), "write the report to a JSON file");
+	po::variables_map vm;
+	po::store(po::parse_command_line(argc, argv, general), vm);
+	if(vm.count("help")) {
+		std::cout << general;
+		return EXIT_SUCCESS;
+	}
+	po::notify(vm);
+
+	SyntheticOntology ontology;
+	ontology.numClasses = std::max(vm["classes"].as<uint32_t>(), 1u);
+	ontology.numObjects = std::max(vm["objects"].as<uint32_t>(), 1u);
+	ontology.numEvents = std::max(vm["events"].as<uint32_t>(), 1u);
+	ontology.branching = std::max(vm["branching"].as<uint32_t>(), 1u);
+	auto seed = vm["seed"].as<uint32_t>();
+	auto numQueries = vm["queries"].as<uint32_t>();
+	auto numClients = std::max(vm["clients"].as<uint32_t>(), 1u);
+	auto port = vm["port"].as<int>();
+	bool useProlog = (vm.count("no-prolog") == 0);
+
+	// note: declared before mongod such that mongod is stopped before the directory is removed
+	TemporaryDirectory tmpDir(std::filesystem::temp_directory_path() /
+			("knowrob-bench-" + std::to_string(getpid())));
+	auto &workDir = tmpDir.path();
+
+	// start a fresh mongod unless a host was given
+	std::string host = "localhost";
+	std::unique_ptr<MongoServer> mongod;
+	if(vm.count("host")) {
+		host = vm["host"].as<std::string>();
+	}
+	else {
+		auto dbPath = vm.count("dbpath") ?
+				std::filesystem::path(vm["dbpath"].as<std::string>()) : workDir / "db";
+		mongod = std::make_unique<MongoServer>(vm["mongod"].as<std::string>(), dbPath, port);
+		if(!mongod->waitUntilReady(std::chrono::seconds(30))) {
+			// the log is removed with the work directory, so it is printed here
+			std::ifstream log(dbPath / "mongod.log");
+			std::stringstream logContent;
+			logContent << log.rdbuf();
+			KB_ERROR("mongod did not start:\n{}", logContent.str());
+			return EXIT_FAILURE;
+		}
+	}
+
+	std::mt19937 rng(seed);
+	ontology.generate(rng);
+	std::filesystem::path prologModule;
+	if(useProlog) {
+		prologModule = workDir / "knowrob_bench.pl";
+		ontology.writePrologModule(prologModule);
+	}
+
+	// a running mongod may be shared, so each run uses its own database there,
+	// and drops its statements when done.
+	std::string dbName = "knowrob_bench";
+	if(vm.count("db")) {
+		dbName = vm["db"].as<std::string>();
+	}
+	else if(!mongod) {
+		dbName += "_" + std::to_string(getpid());
+	}
+	KnowledgeBase kb(createConfiguration(host, port, dbName, prologModule));
+
+	// load phase
+	KB_INFO("loading {} statements.", ontology.statements.size());
+	auto loadBegin = std::chrono::steady_clock::now();
+	if(!kb.insert(ontology.statements)) {
+		KB_ERROR("failed to load the synthetic ontology.");
+		return EXIT_FAILURE;
+	}
+	auto loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadBegin).count();
+
+	// the query mix
+	auto randomClass = [&ontology](std::mt19937 &g) {
+		return SyntheticOntology::className(std::uniform_int_distribution<uint32_t>(0, ontology.numClasses-1)(g));
+	};
+	auto randomObject = [&ontology](std::mt19937 &g) {
+		return SyntheticOntology::objectName(std::uniform_int_distribution<uint32_t>(0, ontology.numObjects-1)(g));
+	};
+	auto randomEvent = [&ontology](std::mt19937 &g) {
+		return std::uniform_int_distribution<uint32_t>(0, ontology.numEvents-1)(g);
+	};
+	std::vector<std::unique_ptr<QueryClass>> queryClasses;
+	auto addClass = [&queryClasses](const std::string &name, std::function<std::string(std::mt19937&)> generator) {
+		auto &qc = queryClasses.emplace_back(std::make_unique<QueryClass>());
+		qc->name = name;
+		qc->generator = std::move(generator);
+	};
+	addClass("edb", [&](std::mt19937 &g) {
+		return "bench:hasPart(bench:" + randomObject(g) + ", X)";
+	});
+	addClass("edb-path", [&](std::mt19937 &g) {
+		return "bench:hasPart(bench:" + randomObject(g) + ", X), bench:hasPart(X, Y), rdf:type(Y, Z)";
+	});
+	addClass("subclass-transitive", [&](std::mt19937 &g) {
+		return "rdfs:subClassOf(X, bench:" + randomClass(g) + ")";
+	});
+	if(useProlog) {
+		addClass("prolog", [&](std::mt19937 &g) {
+			return "bench_connected(bench:" + randomObject(g) + ", X)";
+		});
+	}
+	addClass("temporal", [&](std::mt19937 &g) {
+		auto begin = 10 * randomEvent(g);
+		std::stringstream ss;
+		ss << "P[begin=" << begin << ",end=" << begin + 5 << "] bench:hasParticipant(E, X)";
+		return ss.str();
+	});
+	addClass("belief", [&](std::mt19937 &g) {
+		return "B[" BENCH_AGENT "] bench:hasParticipant(bench:" +
+				SyntheticOntology::eventName(randomEvent(g)) + ", X)";
+	});
+
+	for(auto &qc : queryClasses) {
+		KB_INFO("running {} queries of class '{}'.", numQueries, qc->name);
+		runQueryClass(kb, *qc, numQueries, numClients, seed);
+	}
+
+	auto memoryHWM = readMemoryHighWaterMark("self");
+	auto mongoMemoryHWM = mongod ? readMemoryHighWaterMark(std::to_string(mongod->pid())) : 0;
+	writeReport(std::cout, ontology, loadSeconds, queryClasses, memoryHWM, mongoMemoryHWM);
+	if(vm.count("output")) {
+		std::ofstream file(vm["output"].as<std::string>());
+		writeReport(file, ontology, loadSeconds, queryClasses, memoryHWM, mongoMemoryHWM);
+	}
+	if(!mongod) {
+		auto mongoKG = std::dynamic_pointer_cast<MongoKnowledgeGraph>(kb.centralKG());
+		if(mongoKG) mongoKG->drop();
+	}
+
+	return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv)
+{
+	InitKnowledgeBase(argc, argv);
+	// debug messages of the thread pool would dominate the measurements
+	Logger::setSinkLevel(Logger::Console, spdlog::level::info);
+	try {
+		return run(argc, argv);
+	}
+	catch(std::exception& e) {
+		KB_ERROR("a '{}' exception occurred in main loop: {}.", typeid(e).name(), e.what());
+		return EXIT_FAILURE;
+	}
+}
@@ -0,0 +1,95 @@
+//
+// Created by daniel on 18.10.23.
+//
+
+#include <thread>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "knowrob/terms/Constant.h"
+#include "knowrob/queries/Answer.h"
+#include "knowrob/queries/AnswerQueue.h"
+#include "knowrob/queries/AnswerBroadcaster.h"
+#include "knowrob/queries/AnswerCombiner.h"
+
+using namespace knowrob;
+
+// number of answers used in the benchmarks: 10, 100, ..., 100000
+#define KNOWROB_BENCHMARK_ANSWERS RangeMultiplier(10)->Range(10, 100000)->Unit(benchmark::kMicrosecond)
+
+static std::vector<AnswerPtr> createAnswers(int64_t numAnswers, const std::string &varName)
+{
+	std::vector<AnswerPtr> answers(numAnswers);
+	Variable var(varName);
+	for(int64_t i=0; i<numAnswers; ++i) {
+		auto answer = std::make_shared<Answer>();
+		answer->substitute(var, std::make_shared<LongTerm>(i));
+		answers[i] = answer;
+	}
+	return answers;
+}
+
+static void BM_AnswerBroadcaster(benchmark::State &state)
+{
+	// one input channel broadcast to four subscribers
+	const int numSubscriber = 4;
+	auto answers = createAnswers(state.range(0), "X");
+
+	for(auto _ : state) {
+		state.PauseTiming();
+		auto broadcast = std::make_shared<AnswerBroadcaster>();
+		std::vector<std::shared_ptr<AnswerQueue>> outputs(numSubscriber);
+		for(auto &output : outputs) {
+			output = std::make_shared<AnswerQueue>();
+			broadcast->addSubscriber(AnswerStream::Channel::create(output));
+		}
+		auto input = AnswerStream::Channel::create(broadcast);
+		state.ResumeTiming();
+
+		for(auto &answer : answers) input->push(answer);
+		input->push(AnswerStream::eos());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AnswerBroadcaster)->KNOWROB_BENCHMARK_ANSWERS;
+
+static void BM_AnswerCombiner(benchmark::State &state)
+{
+	// a single answer from the first channel is combined with each answer
+	// from the second channel.
+	auto first = createAnswers(1, "X");
+	auto second = createAnswers(state.range(0), "Y");
+
+	for(auto _ : state) {
+		state.PauseTiming();
+		auto combiner = std::make_shared<AnswerCombiner>();
+		auto output = std::make_shared<AnswerQueue>();
+		combiner->addSubscriber(AnswerStream::Channel::create(output));
+		auto input1 = AnswerStream::Channel::create(combiner);
+		auto input2 = AnswerStream::Channel::create(combiner);
+		state.ResumeTiming();
+
+		input1->push(first[0]);
+		for(auto &answer : second) input2->push(answer);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AnswerCombiner)->KNOWROB_BENCHMARK_ANSWERS;
+
+static void BM_AnswerQueue(benchmark::State &state)
+{
+	// answers are pushed into a queue from one thread, and popped in another
+	auto answers = createAnswers(state.range(0), "X");
+
+	for(auto _ : state) {
+		auto queue = std::make_shared<AnswerQueue>();
+		auto input = AnswerStream::Channel::create(queue);
+		std::thread producer([&answers, &input]{
+			for(auto &answer : answers) input->push(answer);
+			input->push(AnswerStream::eos());
+		});
+		while(!AnswerStream::isEOS(queue->pop_front())) {}
+		producer.join();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AnswerQueue)->KNOWROB_BENCHMARK_ANSWERS->UseRealTime();
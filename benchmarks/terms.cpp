@@ -0,0 +1,121 @@
+//
+// Created by daniel on 18.10.23.
+//
+
+#include <sstream>
+#include <string>
+#include <benchmark/benchmark.h>
+#include "knowrob/terms/Unifier.h"
+#include "knowrob/terms/Constant.h"
+#include "knowrob/formulas/Predicate.h"
+#include "knowrob/queries/Answer.h"
+#include "knowrob/queries/QueryParser.h"
+
+using namespace knowrob;
+
+// number of variables used in the benchmarks: 1, 2, 4, 8, 16, 20
+#define KNOWROB_BENCHMARK_VARIABLES RangeMultiplier(2)->Range(1, 16)->Arg(20)
+
+static std::shared_ptr<Variable> createVariable(int index)
+{
+	return std::make_shared<Variable>("X" + std::to_string(index));
+}
+
+static void BM_Unifier(benchmark::State &state)
+{
+	// unify p(X0,...,Xn) with p(0,...,n)
+	auto numArgs = state.range(0);
+	std::vector<TermPtr> variables(numArgs), constants(numArgs);
+	for(int i=0; i<numArgs; ++i) {
+		variables[i] = createVariable(i);
+		constants[i] = std::make_shared<LongTerm>(i);
+	}
+	TermPtr t0 = std::make_shared<Predicate>("p", variables);
+	TermPtr t1 = std::make_shared<Predicate>("p", constants);
+
+	for(auto _ : state) {
+		Unifier unifier(t0, t1);
+		benchmark::DoNotOptimize(unifier.exists());
+	}
+	state.SetItemsProcessed(state.iterations() * numArgs);
+}
+BENCHMARK(BM_Unifier)->KNOWROB_BENCHMARK_VARIABLES;
+
+static void BM_Unifier_apply(benchmark::State &state)
+{
+	// unify p(X0,...,Xn) with p(f(Y0),...,f(Yn)) and instantiate the result
+	auto numArgs = state.range(0);
+	std::vector<TermPtr> variables(numArgs), nested(numArgs);
+	for(int i=0; i<numArgs; ++i) {
+		variables[i] = createVariable(i);
+		nested[i] = std::make_shared<Predicate>("f", std::vector<TermPtr>{
+			std::make_shared<Variable>("Y" + std::to_string(i))});
+	}
+	TermPtr t0 = std::make_shared<Predicate>("p", variables);
+	TermPtr t1 = std::make_shared<Predicate>("p", nested);
+
+	for(auto _ : state) {
+		Unifier unifier(t0, t1);
+		benchmark::DoNotOptimize(unifier.apply());
+	}
+	state.SetItemsProcessed(state.iterations() * numArgs);
+}
+BENCHMARK(BM_Unifier_apply)->KNOWROB_BENCHMARK_VARIABLES;
+
+static void BM_Substitution_unifyWith(benchmark::State &state)
+{
+	// two substitutions that agree on half of their variables
+	auto numVars = state.range(0);
+	Substitution s0, s1;
+	for(int i=0; i<numVars; ++i) {
+		s0.set(*createVariable(i), std::make_shared<LongTerm>(i));
+		s1.set(*createVariable(i + numVars/2), std::make_shared<LongTerm>(i + numVars/2));
+	}
+
+	for(auto _ : state) {
+		Reversible changes;
+		benchmark::DoNotOptimize(s0.unifyWith(s1, &changes));
+		changes.rollBack();
+	}
+	state.SetItemsProcessed(state.iterations() * numVars);
+}
+BENCHMARK(BM_Substitution_unifyWith)->KNOWROB_BENCHMARK_VARIABLES;
+
+static void BM_Answer_combine(benchmark::State &state)
+{
+	// two answers that agree on half of their variables
+	auto numVars = state.range(0);
+	auto a0 = std::make_shared<Answer>();
+	auto a1 = std::make_shared<Answer>();
+	for(int i=0; i<numVars; ++i) {
+		a0->substitute(*createVariable(i), std::make_shared<LongTerm>(i));
+		a1->substitute(*createVariable(i + numVars/2), std::make_shared<LongTerm>(i + numVars/2));
+	}
+	std::shared_ptr<const Answer> other = a1;
+
+	for(auto _ : state) {
+		Reversible changes;
+		benchmark::DoNotOptimize(a0->combine(other, &changes));
+		changes.rollBack();
+	}
+	state.SetItemsProcessed(state.iterations() * numVars);
+}
+BENCHMARK(BM_Answer_combine)->KNOWROB_BENCHMARK_VARIABLES;
+
+static void BM_QueryParser_parse(benchmark::State &state)
+{
+	// a chain of literals p0(X0,X1), p1(X1,X2), ... with one variable shared between neighbours
+	auto numLiterals = state.range(0);
+	std::stringstream ss;
+	for(int i=0; i<numLiterals; ++i) {
+		if(i>0) ss << ", ";
+		ss << "p" << i << "(X" << i << ", X" << (i+1) << ")";
+	}
+	auto queryString = ss.str();
+
+	for(auto _ : state) {
+		benchmark::DoNotOptimize(QueryParser::parse(queryString));
+	}
+	state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(queryString.size()));
+}
+BENCHMARK(BM_QueryParser_parse)->KNOWROB_BENCHMARK_VARIABLES;
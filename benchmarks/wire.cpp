@@ -0,0 +1,178 @@
+//
+// Created by daniel on 18.10.26.
+//
+
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <benchmark/benchmark.h>
+#include "knowrob/mongodb/Connection.h"
+#include "knowrob/mongodb/Collection.h"
+#include "knowrob/mongodb/Cursor.h"
+#include "knowrob/mongodb/Document.h"
+#include "knowrob/mongodb/MongoException.h"
+
+using namespace knowrob::mongo;
+
+#define KNOWROB_BENCHMARK_DB "knowrob_benchmark"
+#define KNOWROB_BENCHMARK_COLLECTION "wire"
+// number of distinct predicates of the generated documents
+#define KNOWROB_BENCHMARK_PREDICATES 10
+
+// compressors that are compared, the empty string disables compression
+static const char *benchmarkCompressors[] = { "", "zstd", "snappy", "zlib" };
+
+static std::string benchmarkURI(const char *compressors)
+{
+	// the server can be selected with an environment variable
+	auto uri = std::getenv("KNOWROB_BENCHMARK_MONGO_URI");
+	std::string uriString = (uri ? uri : "mongodb://localhost:27017/?serverSelectionTimeoutMS=2000");
+	if(compressors[0] == '\0') return uriString;
+	// the URI is parsed such that the option is added correctly, e.g. after a database path
+	bson_error_t err;
+	mongoc_uri_t *uriPtr = mongoc_uri_new_with_error(uriString.c_str(), &err);
+	if(!uriPtr) {
+		throw knowrob::MongoException("invalid_uri", err);
+	}
+	std::shared_ptr<mongoc_uri_t> parsedURI(uriPtr, mongoc_uri_destroy);
+	if(!mongoc_uri_set_compressors(parsedURI.get(), compressors)) {
+		throw std::runtime_error(std::string("invalid compressors: ") + compressors);
+	}
+	return mongoc_uri_get_string(parsedURI.get());
+}
+
+static std::shared_ptr<Connection> getConnection(const char *compressors)
+{
+	static std::map<std::string, std::shared_ptr<Connection>> connections;
+	auto &connection = connections[compressors];
+	if(!connection) connection = std::make_shared<Connection>(benchmarkURI(compressors));
+	return connection;
+}
+
+// reads the number of bytes the server has sent, with and without wire compression
+static bool readBytesOut(int64_t &physicalBytes, int64_t &logicalBytes)
+{
+	// an uncompressed connection that is not measured
+	ClientLease lease(getConnection("")->pool_, "admin", KNOWROB_BENCHMARK_COLLECTION);
+	bson_t *cmd = BCON_NEW("serverStatus", BCON_INT32(1));
+	bson_t reply;
+	bson_error_t err;
+	bool success = mongoc_client_command_simple(lease.client(), "admin", cmd, nullptr, &reply, &err);
+	bson_destroy(cmd);
+	if(success) {
+		bson_iter_t iter;
+		// physicalBytesOut is only reported by servers that support compression
+		if(bson_iter_init(&iter, &reply) && bson_iter_find_descendant(&iter, "network.bytesOut", &iter)) {
+			logicalBytes = bson_iter_as_int64(&iter);
+			physicalBytes = logicalBytes;
+		}
+		if(bson_iter_init(&iter, &reply) && bson_iter_find_descendant(&iter, "network.physicalBytesOut", &iter)) {
+			physicalBytes = bson_iter_as_int64(&iter);
+		}
+	}
+	bson_destroy(&reply);
+	return success;
+}
+
+static bool createDocuments(int64_t numDocuments)
+{
+	static int64_t numCreated = 0;
+	if(numCreated == numDocuments) return true;
+	try {
+		auto collection = std::make_shared<Collection>(
+			getConnection(""), KNOWROB_BENCHMARK_DB, KNOWROB_BENCHMARK_COLLECTION);
+		collection->removeAll(Document(bson_new()));
+		// documents that resemble triples of the triples collection
+		auto bulk = collection->createBulkOperation();
+		for(int64_t i=0; i<numDocuments; ++i) {
+			auto subject = "http://knowrob.org/bench#Object_" + std::to_string(i);
+			auto predicate = "http://knowrob.org/bench#relation" + std::to_string(i % KNOWROB_BENCHMARK_PREDICATES);
+			auto object = "http://knowrob.org/bench#Object_" + std::to_string((i+1) % numDocuments);
+			bson_t *doc = BCON_NEW(
+				"s", BCON_UTF8(subject.c_str()),
+				"p", BCON_UTF8(predicate.c_str()),
+				"o", BCON_UTF8(object.c_str()),
+				"graph", BCON_UTF8("user"),
+				"scope", "{", "time", "{", "since", BCON_DOUBLE(0.0), "until", BCON_DOUBLE(1e9), "}", "}");
+			bulk->pushInsert(doc);
+			bson_destroy(doc);
+		}
+		bulk->execute();
+		collection->createAscendingIndex({ "p" });
+	}
+	catch(const std::exception&) {
+		numCreated = 0;
+		return false;
+	}
+	numCreated = numDocuments;
+	return true;
+}
+
+static void runAggregation(benchmark::State &state, const bson_t *pipelineDoc)
+{
+	auto compressors = benchmarkCompressors[state.range(0)];
+	if(!createDocuments(state.range(1))) {
+		state.SkipWithError("MongoDB server is not available.");
+		return;
+	}
+	auto collection = std::make_shared<Collection>(
+		getConnection(compressors), KNOWROB_BENCHMARK_DB, KNOWROB_BENCHMARK_COLLECTION);
+	int64_t physicalBegin=0, logicalBegin=0, physicalEnd=0, logicalEnd=0;
+	readBytesOut(physicalBegin, logicalBegin);
+
+	int64_t numDocuments = 0;
+	for(auto _ : state) {
+		Cursor cursor(collection);
+		cursor.batchSize(1000);
+		cursor.aggregate(pipelineDoc);
+		const bson_t *doc;
+		while(cursor.next(&doc)) ++numDocuments;
+	}
+
+	readBytesOut(physicalEnd, logicalEnd);
+	// note: includes traffic of other clients of the server
+	state.counters["wire_bytes"] = benchmark::Counter(
+		static_cast<double>(physicalEnd - physicalBegin), benchmark::Counter::kAvgIterations);
+	state.counters["uncompressed_bytes"] = benchmark::Counter(
+		static_cast<double>(logicalEnd - logicalBegin), benchmark::Counter::kAvgIterations);
+	state.counters["documents"] = benchmark::Counter(
+		static_cast<double>(numDocuments), benchmark::Counter::kAvgIterations);
+	state.SetLabel(compressors[0] == '\0' ? "none" : compressors);
+}
+
+static void BM_WireMatch(benchmark::State &state)
+{
+	// transfers all documents of one predicate, as in the lookup of a triple pattern
+	bson_t *pipelineDoc = BCON_NEW("pipeline", "[",
+		"{", "$match", "{", "p", BCON_UTF8("http://knowrob.org/bench#relation0"), "}", "}",
+		"{", "$project", "{", "_id", BCON_INT32(0), "}", "}",
+		"]");
+	runAggregation(state, pipelineDoc);
+	bson_destroy(pipelineDoc);
+}
+
+static void BM_WireGroup(benchmark::State &state)
+{
+	// transfers only aggregated values, as for aggregate queries
+	bson_t *pipelineDoc = BCON_NEW("pipeline", "[",
+		"{", "$group", "{", "_id", BCON_UTF8("$p"), "count", "{", "$sum", BCON_INT32(1), "}", "}", "}",
+		"]");
+	runAggregation(state, pipelineDoc);
+	bson_destroy(pipelineDoc);
+}
+
+static void benchmarkArguments(benchmark::internal::Benchmark *b)
+{
+	// number of documents used in the benchmarks: 1000, 10000, 100000
+	for(int64_t numDocuments : { 1000, 10000, 100000 }) {
+		for(int64_t compressor=0; compressor<4; ++compressor) {
+			b->Args({ compressor, numDocuments });
+		}
+	}
+	b->ArgNames({ "compressor", "documents" })->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK(BM_WireMatch)->Apply(benchmarkArguments);
+BENCHMARK(BM_WireGroup)->Apply(benchmarkArguments);
@@ -10,30 +10,39 @@
 #define KNOWROB_KNOWLEDGE_BASE_H
 
 #include <memory>
+#include <mutex>
+#include <functional>
 #include <boost/property_tree/ptree.hpp>
 #include "knowrob/reasoner/ReasonerManager.h"
 #include "knowrob/semweb/KnowledgeGraphManager.h"
+#include "knowrob/semweb/GroupCommitWriter.h"
 #include "ThreadPool.h"
 #include "knowrob/queries/DependencyGraph.h"
+#include "knowrob/queries/QueryAggregate.h"
 #include "knowrob/queries/QueryPipeline.h"
+#include "knowrob/queries/QueryPlan.h"
+#include "knowrob/queries/QueryProfile.h"
+#include "knowrob/queries/QueryTree.h"
 
 namespace knowrob {
     enum QueryFlag {
         QUERY_FLAG_ALL_SOLUTIONS     = 1 << 0,
         QUERY_FLAG_ONE_SOLUTION      = 1 << 1,
         QUERY_FLAG_PERSIST_SOLUTIONS = 1 << 2,
-        QUERY_FLAG_UNIQUE_SOLUTIONS  = 1 << 3
+        QUERY_FLAG_UNIQUE_SOLUTIONS  = 1 << 3,
+        // pages of answers may be taken in any order, which allows to stop evaluation once a page is complete
+        QUERY_FLAG_UNORDERED_SOLUTIONS = 1 << 4
     };
 
     class RDFComputable : public RDFLiteral
     {
     public:
-        RDFComputable(const RDFLiteral &lit, const std::vector<std::shared_ptr<Reasoner>> &reasonerList)
+        RDFComputable(const RDFLiteral &lit, const std::vector<std::shared_ptr<DefinedReasoner>> &reasonerList)
         : RDFLiteral(lit), reasonerList_(reasonerList) {}
 
         const auto& reasonerList() const { return reasonerList_; }
     protected:
-        std::vector<std::shared_ptr<Reasoner>> reasonerList_;
+        std::vector<std::shared_ptr<DefinedReasoner>> reasonerList_;
     };
     using RDFComputablePtr = std::shared_ptr<RDFComputable>;
 
@@ -57,16 +66,39 @@ namespace knowrob {
 
         /**
          * Asserts a sequence of propositions into the knowledge base.
+         * If group commit is enabled, concurrent assertions are written together,
+         * and the call blocks until the batch of the propositions was committed.
          * @param tripleData data representing a list of proposition.
          * @return true on success.
          */
         bool insert(const std::vector<StatementData> &propositions);
 
+        /**
+         * Removes all statements matching any of the expressions from the knowledge base.
+         * @param tripleExpressions expressions used to match statements.
+         */
+        void remove(const std::vector<RDFLiteralPtr> &tripleExpressions);
+
+        /**
+         * Removes all statements matching any of the expressions, and asserts
+         * a sequence of propositions into the knowledge base.
+         * @param tripleExpressions expressions used to match statements.
+         * @param propositions data representing a list of proposition.
+         * @return true on success.
+         */
+        bool replace(const std::vector<RDFLiteralPtr> &tripleExpressions,
+                     const std::vector<StatementData> &propositions);
+
         /**
          * @return a thread pool owned by this.
          */
         auto& threadPool() { return *threadPool_; }
 
+        /**
+         * @return the writer that coalesces concurrent assertions, or a null pointer if group commits are disabled.
+         */
+        const auto& groupCommitWriter() const { return groupCommitWriter_; }
+
         /**
          * @return the vocabulary of this knowledge base, i.e. all known properties and classes
          */
@@ -83,34 +115,122 @@ namespace knowrob {
          * Evaluate a query represented as a vector of literals.
          * The call is non-blocking and returns a stream of answers.
          * @param literals a vector of literals
-         * @param label an optional modalFrame label
+         * @param profile an optional profile where stage statistics are recorded
          * @return a stream of query results
          */
-        AnswerBufferPtr submitQuery(const GraphQueryPtr &graphQuery);
+        AnswerBufferPtr submitQuery(const GraphQueryPtr &graphQuery,
+                                    const QueryProfilePtr &profile={});
 
         /**
          * Evaluate a query represented as a Literal.
          * The call is non-blocking and returns a stream of answers.
          * @param query a literal
+         * @param profile an optional profile where stage statistics are recorded
          * @return a stream of query results
          */
-        AnswerBufferPtr submitQuery(const LiteralPtr &query, int queryFlags);
+        AnswerBufferPtr submitQuery(const LiteralPtr &query, int queryFlags,
+                                    const QueryProfilePtr &profile={});
 
         /**
          * Evaluate a query represented as a Formula.
          * The call is non-blocking and returns a stream of answers.
          * @param query a formula
+         * @param profile an optional profile where stage statistics are recorded
          * @return a stream of query results
          */
-        AnswerBufferPtr submitQuery(const FormulaPtr &query, int queryFlags);
+        AnswerBufferPtr submitQuery(const FormulaPtr &query, int queryFlags,
+                                    const QueryProfilePtr &profile={});
+
+        /**
+         * Evaluate a query represented as a Formula, and generate only a page of its answers.
+         * Answers are paged in a deterministic order: the same query yields the same
+         * pages as long as the knowledge base is not modified, and consecutive pages
+         * neither overlap nor miss answers.
+         * Limit and offset are pushed into the EDB query where possible, otherwise
+         * answers are ordered and sliced at the end of the pipeline.
+         * A limit of zero yields no answers without evaluating the query.
+         * @param query a formula
+         * @param limit the maximum number of answers, if any.
+         * @param offset the number of answers to skip.
+         * @param profile an optional profile where stage statistics are recorded
+         * @return a stream of query results
+         */
+        AnswerBufferPtr submitQuery(const FormulaPtr &query, int queryFlags,
+                                    std::optional<uint32_t> limit, uint32_t offset,
+                                    const QueryProfilePtr &profile={});
+
+        /**
+         * Evaluate a query represented as a Formula, and aggregate its answers.
+         * Aggregates are computed by the knowledge graph where possible, such that
+         * only aggregated values are transferred, otherwise answers are
+         * aggregated at the end of the pipeline while they are generated.
+         * @param query a formula
+         * @param aggregate an aggregate of answers
+         * @param profile an optional profile where stage statistics are recorded
+         * @return a stream of aggregated answers
+         */
+        AnswerBufferPtr submitQuery(const FormulaPtr &query, const QueryAggregatePtr &aggregate,
+                                    int queryFlags, const QueryProfilePtr &profile={});
+
+        /**
+         * Compute the plan that would be used to evaluate a query
+         * without evaluating it.
+         * @param query a formula
+         * @param queryFlags query flags
+         * @return the evaluation plan of the query
+         */
+        QueryPlanPtr explainQuery(const FormulaPtr &query, int queryFlags);
+
+        /**
+         * Compute the plan that would be used to evaluate a graph query
+         * without evaluating it.
+         * @param graphQuery a graph query
+         * @return the evaluation plan of the query
+         */
+        ConjunctiveQueryPlan explainQuery(const GraphQueryPtr &graphQuery);
+
+        /**
+         * @return the time in seconds needed to load each component at startup, in order of completion.
+         */
+        std::vector<std::pair<std::string, double>> startupTimes() const;
 
 	protected:
 		std::shared_ptr<ReasonerManager> reasonerManager_;
 		std::shared_ptr<KnowledgeGraphManager> backendManager_;
 		std::shared_ptr<ThreadPool> threadPool_;
+		std::vector<std::pair<std::string, double>> startupTimes_;
+		mutable std::mutex startupMutex_;
+		bool isParallelStartup_;
+		// coalesces concurrent assertions, if enabled
+		std::shared_ptr<semweb::GroupCommitWriter> groupCommitWriter_;
+
+		// a component that is loaded at startup
+		struct StartupTask {
+		    std::string name;
+		    std::function<void()> load;
+		};
 
 		void loadConfiguration(const boost::property_tree::ptree &config);
 
+		void runStartupTask(const StartupTask &task);
+
+		void runStartupTasks(const std::vector<StartupTask> &tasks);
+
+		bool commitStatements(const std::vector<StatementData> &propositions);
+
+        static GraphQueryPtr createPathQuery(const QueryTree::Path &path, int queryFlags);
+
+        AnswerBufferPtr submitFormula(const FormulaPtr &query, int queryFlags,
+                                      std::optional<uint32_t> limit, uint32_t offset,
+                                      const QueryAggregatePtr &aggregate,
+                                      const QueryProfilePtr &profile);
+
+        void splitLiterals(const GraphQueryPtr &graphQuery,
+                           std::vector<RDFLiteralPtr> &edbOnlyLiterals,
+                           std::vector<RDFComputablePtr> &computableLiterals,
+                           std::vector<RDFLiteralPtr> &negativeLiterals,
+                           std::vector<RDFLiteralPtr> &builtinLiterals);
+
         static std::vector<RDFComputablePtr> createComputationSequence(
                 const std::list<DependencyNodePtr> &dependencyGroup);
 
@@ -119,7 +239,11 @@ namespace knowrob {
             const std::vector<RDFComputablePtr> &computableLiterals,
             const std::shared_ptr<AnswerBroadcaster> &pipelineInput,
             const std::shared_ptr<AnswerBroadcaster> &pipelineOutput,
-            int queryFlags);
+            const GraphQueryPtr &graphQuery,
+            const QueryProfilePtr &profile);
+
+        // creates a handler that closes the pipeline in a worker thread
+        std::function<void()> createStopHandler(const std::shared_ptr<QueryPipeline> &pipeline);
 	};
 
     using KnowledgeBasePtr = std::shared_ptr<KnowledgeBase>;
@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2022, Daniel Beßler
+ * All rights reserved.
+ *
+ * This file is part of KnowRob, please consult
+ * https://github.com/knowrob/knowrob for license details.
+ */
+
+#ifndef KNOWROB_METRICS_H_
+#define KNOWROB_METRICS_H_
+
+#include <atomic>
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <ostream>
+#include <boost/property_tree/ptree.hpp>
+
+namespace knowrob {
+	/**
+	 * A monotonically increasing counter.
+	 * Updates are lock-free and use relaxed memory ordering.
+	 */
+	class MetricsCounter {
+	public:
+		MetricsCounter() : value_(0) {}
+
+		/**
+		 * @param n the amount by which the counter is increased.
+		 */
+		void increment(uint64_t n=1) { value_.fetch_add(n, std::memory_order_relaxed); }
+
+		/**
+		 * @return the current value of the counter.
+		 */
+		uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+	protected:
+		std::atomic<uint64_t> value_;
+	};
+
+	/**
+	 * A value that can go up and down, e.g. the size of a queue.
+	 * Updates are lock-free and use relaxed memory ordering.
+	 */
+	class MetricsGauge {
+	public:
+		MetricsGauge() : value_(0) {}
+
+		/**
+		 * @param v the new value of the gauge.
+		 */
+		void set(int64_t v) { value_.store(v, std::memory_order_relaxed); }
+
+		/**
+		 * @param n the amount which is added to the gauge, may be negative.
+		 */
+		void add(int64_t n) { value_.fetch_add(n, std::memory_order_relaxed); }
+
+		/**
+		 * @return the current value of the gauge.
+		 */
+		int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+	protected:
+		std::atomic<int64_t> value_;
+	};
+
+	/**
+	 * A histogram of non-negative integer values, e.g. latencies in nanoseconds.
+	 * Buckets are log-linear: each power of two is split into 2^SUB_BUCKET_BITS
+	 * sub-buckets such that the relative error of a recorded value is bounded
+	 * by 2^-SUB_BUCKET_BITS (as in HDR histograms).
+	 * Recording a value takes two relaxed atomic additions and never locks.
+	 */
+	class MetricsHistogram {
+	public:
+		static constexpr uint32_t SUB_BUCKET_BITS = 3;
+		static constexpr uint32_t SUB_BUCKET_COUNT = 1u << SUB_BUCKET_BITS;
+		static constexpr uint32_t NUM_BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+		MetricsHistogram();
+
+		/**
+		 * @param value a value to be recorded in the histogram.
+		 */
+		void record(uint64_t value)
+		{
+			buckets_[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+			sum_.fetch_add(value, std::memory_order_relaxed);
+		}
+
+		/**
+		 * @return the number of recorded values.
+		 */
+		uint64_t count() const;
+
+		/**
+		 * @return the sum of all recorded values.
+		 */
+		uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+
+		/**
+		 * Estimate a quantile of the recorded values.
+		 * The estimate is the upper bound of the bucket where the quantile falls into.
+		 * @param q the quantile in the range [0,1].
+		 * @return the estimated quantile, or 0 if no value was recorded.
+		 */
+		uint64_t quantile(double q) const;
+
+		/**
+		 * @param value a value.
+		 * @return the index of the bucket where value is counted.
+		 */
+		static uint32_t bucketIndex(uint64_t value)
+		{
+			if(value < SUB_BUCKET_COUNT) return static_cast<uint32_t>(value);
+			uint32_t msb = 63 - __builtin_clzll(value);
+			uint32_t shift = msb - SUB_BUCKET_BITS;
+			return (shift + 1) * SUB_BUCKET_COUNT +
+			       static_cast<uint32_t>((value >> shift) & (SUB_BUCKET_COUNT - 1));
+		}
+
+		/**
+		 * @param index a bucket index.
+		 * @return the largest value that is counted in the bucket.
+		 */
+		static uint64_t bucketUpperBound(uint32_t index);
+
+	protected:
+		std::array<std::atomic<uint64_t>, NUM_BUCKETS> buckets_;
+		std::atomic<uint64_t> sum_;
+	};
+
+	/**
+	 * Records the time in nanoseconds between construction and destruction
+	 * in a histogram.
+	 */
+	class MetricsTimer {
+	public:
+		explicit MetricsTimer(MetricsHistogram &histogram)
+		: histogram_(histogram), begin_(std::chrono::steady_clock::now()) {}
+
+		~MetricsTimer()
+		{
+			histogram_.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - begin_).count());
+		}
+
+		/**
+		 * Cannot be copy-assigned.
+		 */
+		MetricsTimer(const MetricsTimer&) = delete;
+
+	protected:
+		MetricsHistogram &histogram_;
+		const std::chrono::steady_clock::time_point begin_;
+	};
+
+	/**
+	 * A registry of named metrics.
+	 * Registration of a metric requires a lock, hence instrumented code should
+	 * keep a reference to the metric, e.g. in a static variable, and only
+	 * update the metric in the hot path.
+	 * References returned by the registry stay valid for the duration of the program.
+	 */
+	class Metrics {
+	public:
+		/**
+		 * @return the global metrics registry.
+		 */
+		static Metrics& get();
+
+		/**
+		 * Cannot be copy-assigned.
+		 */
+		Metrics(const Metrics&) = delete;
+
+		/**
+		 * Get or create a counter.
+		 * @param name the name of the metric.
+		 * @param help a short description of the metric.
+		 * @return the counter.
+		 */
+		MetricsCounter& counter(const std::string &name, const std::string &help="");
+
+		/**
+		 * Get or create a gauge.
+		 * @param name the name of the metric.
+		 * @param help a short description of the metric.
+		 * @return the gauge.
+		 */
+		MetricsGauge& gauge(const std::string &name, const std::string &help="");
+
+		/**
+		 * Get or create a histogram of durations in nanoseconds.
+		 * The histogram is exported in seconds.
+		 * @param name the name of the metric.
+		 * @param help a short description of the metric.
+		 * @return the histogram.
+		 */
+		MetricsHistogram& histogram(const std::string &name, const std::string &help="");
+
+		/**
+		 * Write all metrics in the Prometheus text exposition format.
+		 * Histograms are written as summaries with a few quantiles.
+		 * @param os an output stream.
+		 * @return the output stream.
+		 */
+		std::ostream& writePrometheus(std::ostream &os) const;
+
+		/**
+		 * Write all metrics into a file in the Prometheus text exposition format.
+		 * The file is replaced atomically such that readers never see partial content.
+		 * @param path the path of the file.
+		 * @return true on success.
+		 */
+		bool writePrometheusFile(const std::string &path) const;
+
+		/**
+		 * Configure the metrics exporter using a property tree.
+		 * Supported keys are "file" and "interval" for periodically writing a
+		 * text file, "port" for serving metrics via HTTP on the loopback interface,
+		 * and "socket" for serving metrics via a Unix domain socket.
+		 * @param config a property tree.
+		 */
+		static void loadConfiguration(const boost::property_tree::ptree &config);
+
+	protected:
+		template<class T> struct Entry {
+			std::string help;
+			std::unique_ptr<T> metric;
+		};
+		std::map<std::string, Entry<MetricsCounter>> counters_;
+		std::map<std::string, Entry<MetricsGauge>> gauges_;
+		std::map<std::string, Entry<MetricsHistogram>> histograms_;
+		mutable std::mutex mutex_;
+
+		// hide implementation details of the exporter
+		struct Exporter;
+		std::unique_ptr<Exporter> exporter_;
+
+		Metrics();
+		~Metrics();
+	};
+}
+
+#endif //KNOWROB_METRICS_H_
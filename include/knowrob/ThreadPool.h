@@ -17,6 +17,7 @@
 #include <atomic>
 #include <iostream>
 #include <thread>
+#include "knowrob/Metrics.h"
 
 namespace knowrob {
 	/**
@@ -138,6 +139,10 @@ namespace knowrob {
 		std::atomic_uint32_t numFinishedThreads_;
         // number of currently active workers
         std::atomic_uint32_t numActiveWorker_;
+		// number of queued goals, shared by all pools
+		MetricsGauge &queueDepth_;
+		// number of finished goals, shared by all pools
+		MetricsCounter &numFinishedGoals_;
 		
 		// get work from queue
 		std::shared_ptr<ThreadPool::Runner> popWork();
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2022, Daniel Beßler
+ * All rights reserved.
+ *
+ * This file is part of KnowRob, please consult
+ * https://github.com/knowrob/knowrob for license details.
+ */
+
+#ifndef KNOWROB_TRACING_H_
+#define KNOWROB_TRACING_H_
+
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <boost/property_tree/ptree.hpp>
+
+namespace knowrob {
+	/**
+	 * A span of time recorded by the tracer.
+	 * Spans do not allocate memory such that they can be stored in
+	 * pre-allocated ring buffers.
+	 */
+	struct TraceEvent {
+		static constexpr uint32_t MAX_DETAIL_LENGTH = 96;
+		// a static string naming the span
+		const char *name;
+		// the ID of the query the span belongs to
+		uint64_t queryID;
+		// begin and end time of a monotonic clock in nanoseconds
+		int64_t beginNs;
+		int64_t endNs;
+		// optional details about the span, truncated if too long
+		char detail[MAX_DETAIL_LENGTH];
+	};
+
+	/**
+	 * Opt-in tracing of query evaluation.
+	 * Spans are recorded into a ring buffer owned by the thread that records them,
+	 * and can be written in the Chrome trace event format, e.g. to be viewed in Perfetto.
+	 * If tracing is disabled, recording a span costs a single branch.
+	 */
+	class Tracer {
+	public:
+		/**
+		 * @return true if tracing is enabled.
+		 */
+		static bool isEnabled() { return isEnabled_.load(std::memory_order_relaxed); }
+
+		/**
+		 * @param enabled true to enable tracing.
+		 */
+		static void setEnabled(bool enabled) { isEnabled_ = enabled; }
+
+		/**
+		 * @param size the number of spans each thread keeps, applies to threads that record their first span after the call.
+		 */
+		static void setBufferSize(uint32_t size);
+
+		/**
+		 * Automatically dump a trace whenever a query exceeds a latency threshold.
+		 * @param seconds the latency threshold, a non-positive value disables automatic dumps.
+		 * @param directory the directory where trace files are written.
+		 */
+		static void setLatencyThreshold(double seconds, const std::string &directory=".");
+
+		/**
+		 * Configure tracing using a property tree.
+		 * Supported keys are "enabled", "buffer-size", "latency-threshold" and "directory".
+		 * @param config a property tree.
+		 */
+		static void loadConfiguration(const boost::property_tree::ptree &config);
+
+		/**
+		 * @return current time of a monotonic clock in nanoseconds.
+		 */
+		static int64_t now()
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		/**
+		 * Record a span in the ring buffer of the calling thread.
+		 * @param name a static string naming the span.
+		 * @param queryID the ID of the query the span belongs to.
+		 * @param beginNs begin time of the span.
+		 * @param endNs end time of the span.
+		 * @param detail optional details about the span.
+		 */
+		static void record(const char *name, uint64_t queryID,
+						   int64_t beginNs, int64_t endNs,
+						   std::string_view detail={});
+
+		/**
+		 * Notify the tracer that a query was completed. Writes a trace file
+		 * if the latency of the query exceeds the configured threshold.
+		 * @param queryID the ID of the query.
+		 * @param beginNs time when the query was submitted.
+		 * @param endNs time when the last answer of the query was generated.
+		 */
+		static void queryCompleted(uint64_t queryID, int64_t beginNs, int64_t endNs);
+
+		/**
+		 * Write all recorded spans in the Chrome trace event format.
+		 * @param os an output stream.
+		 * @return the output stream.
+		 */
+		static std::ostream& writeChromeTrace(std::ostream &os);
+
+		/**
+		 * Write all recorded spans into a file in the Chrome trace event format.
+		 * @param path the path of the file.
+		 * @return true on success.
+		 */
+		static bool dump(const std::string &path);
+
+		/**
+		 * Drop all recorded spans.
+		 */
+		static void clear();
+
+		/**
+		 * Buffers of exited threads are re-used by new threads.
+		 * @return the number of span buffers.
+		 */
+		static uint32_t numBuffers();
+
+	protected:
+		struct ThreadBuffer;
+		static std::atomic<bool> isEnabled_;
+
+		static ThreadBuffer& threadBuffer();
+
+		friend struct TracerState;
+		friend struct ThreadBufferLease;
+	};
+
+	/**
+	 * A span that begins with construction and ends with destruction of this object.
+	 */
+	class TraceSpan {
+	public:
+		/**
+		 * @param name a static string naming the span.
+		 * @param queryID the ID of the query the span belongs to.
+		 */
+		TraceSpan(const char *name, uint64_t queryID)
+		: name_(name), queryID_(queryID), beginNs_(Tracer::isEnabled() ? Tracer::now() : 0) {}
+
+		~TraceSpan()
+		{
+			if(beginNs_) Tracer::record(name_, queryID_, beginNs_, Tracer::now());
+		}
+
+		/**
+		 * Cannot be copy-assigned.
+		 */
+		TraceSpan(const TraceSpan&) = delete;
+
+	protected:
+		const char *name_;
+		const uint64_t queryID_;
+		const int64_t beginNs_;
+	};
+}
+
+#endif //KNOWROB_TRACING_H_
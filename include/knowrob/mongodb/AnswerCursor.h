@@ -5,7 +5,12 @@
 #ifndef KNOWROB_MONGO_ANSWER_CURSOR_H
 #define KNOWROB_MONGO_ANSWER_CURSOR_H
 
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <vector>
 #include "Cursor.h"
+#include "knowrob/ThreadPool.h"
 #include "knowrob/queries/Answer.h"
 
 namespace knowrob::mongo {
@@ -13,11 +18,29 @@ namespace knowrob::mongo {
      * A mongo cursor tht generates Answer objects.
      * It is assumed that all grounding of free variables are recorded
      * in output documents in a dedicated field.
+     * In prefetch mode, result documents after the first batch are fetched in batches
+     * by a worker of a thread pool such that the next batch is received while the
+     * previous batch is decoded.
      */
     class AnswerCursor : public Cursor {
     public:
         explicit AnswerCursor(const std::shared_ptr<Collection> &collection);
 
+        ~AnswerCursor();
+
+        /**
+         * Fetch result documents in a worker of a thread pool.
+         * The first batch is decoded directly, and prefetching only starts once
+         * a result needs more than the first batch.
+         * Batches are then handed over with the batch size of the cursor,
+         * at most one batch is buffered while the previous batch is decoded.
+         * If no worker of the pool becomes available, the documents are fetched
+         * by the thread that pulls the answers.
+         * Must be called before the first answer is pulled.
+         * @param threadPool a thread pool, or null to disable prefetching.
+         */
+        void setPrefetching(const std::shared_ptr<ThreadPool> &threadPool) { fetchPool_ = threadPool; }
+
         /**
          * Pull the next answer from this cursor.
          * @param answer the answer
@@ -26,12 +49,56 @@ namespace knowrob::mongo {
         bool nextAnswer(const std::shared_ptr<Answer> &answer);
 
     protected:
+        using DocumentBatch = std::vector<bson_t*>;
+        // state shared with the worker that fetches documents
+        struct FetchState {
+            std::mutex mutex;
+            std::condition_variable cv;
+            // the batch that was received, but not yet decoded
+            DocumentBatch readyBatch;
+            bool hasReadyBatch = false;
+            // true once a worker fetches documents
+            bool isStarted = false;
+            // true if the worker must not start fetching documents anymore
+            bool isCancelled = false;
+            bool isDone = false;
+            bool isStopped = false;
+            std::exception_ptr error;
+        };
         const bson_t *resultDocument_;
         bson_iter_t resultIter_;
         bson_iter_t varIter_;
         bson_iter_t valIter_;
         bson_iter_t scopeIter_;
         bson_iter_t timeIter_;
+
+        // prefetching state
+        std::shared_ptr<ThreadPool> fetchPool_;
+        std::shared_ptr<FetchState> fetchState_;
+        // number of documents read without prefetching
+        std::size_t numDirectDocuments_;
+        // the batch that is currently decoded
+        DocumentBatch decodeBatch_;
+        std::size_t decodeIndex_;
+
+        bool decodeAnswer(const bson_t *resultDocument, const std::shared_ptr<Answer> &answer);
+
+        void startPrefetching();
+
+        void stopPrefetching();
+
+        /**
+         * Take the next batch received by the worker, or stop prefetching
+         * if no worker started to fetch documents.
+         * @return false if there are no documents left.
+         */
+        bool nextBatch();
+
+        void fetchLoop(FetchState &state);
+
+        static void destroyBatch(DocumentBatch &batch);
+
+        friend class AnswerCursorFetcher;
     };
 
     using AnswerCursorPtr = std::shared_ptr<AnswerCursor>;
@@ -7,6 +7,7 @@
 
 #include <mongoc.h>
 #include <memory>
+#include "Connection.h"
 
 namespace knowrob::mongo {
     /**
@@ -19,8 +20,10 @@ namespace knowrob::mongo {
          * Note that the pointer is owned by this object afterwards,
          * and it will take care of freeing its memory.
          * @param handle a handle to the mongoc_bulk_operation_t pointer.
+         * @param lease the client lease of the handle, released once the operation is executed.
          */
-        explicit BulkOperation(mongoc_bulk_operation_t *handle);
+        explicit BulkOperation(mongoc_bulk_operation_t *handle,
+                               const std::shared_ptr<ClientLease> &lease={});
 
         BulkOperation(const BulkOperation&) = delete;
 
@@ -30,19 +33,19 @@ namespace knowrob::mongo {
          * Add an insertion operation to this batch.
          * @param document a document.
          */
-        void pushInsert(bson_t *document);
+        void pushInsert(const bson_t *document);
 
         /**
          * Add a removal operation to this batch.
          * @param document a document pattern.
          */
-        void pushRemoveAll(bson_t *document);
+        void pushRemoveAll(const bson_t *document);
 
         /**
          * Add a removal operation to this batch.
          * @param document a document pattern.
          */
-        void pushRemoveOne(bson_t *document);
+        void pushRemoveOne(const bson_t *document);
 
         /**
          * Add an update operation to this batch.
@@ -59,6 +62,7 @@ namespace knowrob::mongo {
 
     protected:
         mongoc_bulk_operation_t *handle_;
+        std::shared_ptr<ClientLease> lease_;
 
         void validateBulkHandle();
     };
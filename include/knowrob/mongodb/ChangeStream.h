@@ -21,6 +21,7 @@ namespace knowrob::mongo {
     /**
      * A stream of query results that invokes a callback whenever a new
      * result is found.
+     * The stream holds a client of the pool for its whole lifetime.
      */
     class ChangeStream {
     public:
@@ -39,7 +40,7 @@ namespace knowrob::mongo {
         bool next();
 
     protected:
-        std::unique_ptr<Collection> collection_;
+        std::unique_ptr<ClientLease> lease_;
         ChangeStreamCallback callback_;
         mongoc_change_stream_t *stream_;
         bson_wrapper_ptr next_ptr_;
@@ -22,13 +22,16 @@ namespace knowrob::mongo {
      */
     struct IndexKey {
         explicit IndexKey(const char *key, const bool ascending=true)
-                : value(key), ascending(true) {};
+                : value(key), ascending(ascending) {};
         const char *value;
         const bool ascending;
     };
 
     /**
      * A named collection in Mongo DB.
+     * The collection does not own a client, instead each operation
+     * leases a client from the connection pool such that operations
+     * can be performed concurrently by different threads.
      */
     class Collection {
     public:
@@ -42,15 +45,12 @@ namespace knowrob::mongo {
         ~Collection();
 
         /**
-         * Append options to the session.
-         * @param opts some options
+         * Borrow a client of the connection pool for one operation.
+         * The client is returned to the pool once the lease is destroyed.
+         * Leases must not be shared between threads.
+         * @return a new lease.
          */
-        void appendSession(bson_t *opts);
-
-        /**
-         * @return the session handle.
-         */
-        mongoc_client_session_t* session();
+        std::shared_ptr<ClientLease> lease();
 
         /**
          * @return the client pool of this collection.
@@ -62,16 +62,6 @@ namespace knowrob::mongo {
          */
         auto connection() { return connection_; }
 
-        /**
-         * @return the mongo client managing of this collection.
-         */
-        auto client() const { return client_; }
-
-        /**
-         * @return the collection handle.
-         */
-        auto coll() { return coll_; }
-
         /**
          * @return the name of the collection.
          */
@@ -131,9 +121,23 @@ namespace knowrob::mongo {
         void evalAggregation(const bson_t *pipeline);
 
         /**
+         * @param isOrdered if true, operations are executed in the order they were added,
+         *                  and execution stops at the first error.
          * @return a new bulk operation.
          */
-        std::shared_ptr<BulkOperation> createBulkOperation();
+        std::shared_ptr<BulkOperation> createBulkOperation(bool isOrdered=false);
+
+        /**
+         * Set the write concern used by bulk operations of this collection.
+         * @param writeConcern a write concern, or a null pointer to use the default of the server.
+         */
+        void setWriteConcern(const std::shared_ptr<mongoc_write_concern_t> &writeConcern)
+        { writeConcern_ = writeConcern; }
+
+        /**
+         * @return the write concern used by bulk operations, if any.
+         */
+        const auto& writeConcern() const { return writeConcern_; }
 
         /**
          * Create a search index where each key is sorted in ascending order.
@@ -141,6 +145,14 @@ namespace knowrob::mongo {
          */
         void createAscendingIndex(const std::vector<const char*> &keys);
 
+        /**
+         * Create a partial search index where each key is sorted in ascending order.
+         * Only documents matching the filter are indexed.
+         * @param keys vector of keys
+         * @param partialFilter a filter document, e.g. { agent: { $exists: true } }
+         */
+        void createAscendingIndex(const std::vector<const char*> &keys, const bson_t *partialFilter);
+
         /**
          * Create a search index.
          * @param keys vector of keys
@@ -154,15 +166,12 @@ namespace knowrob::mongo {
 
     private:
         std::shared_ptr<Connection> connection_;
-        mongoc_client_t *client_;
-        mongoc_client_session_t *session_;
-        mongoc_collection_t *coll_;
-        mongoc_database_t *db_;
         const std::string name_;
         const std::string dbName_;
+        std::shared_ptr<mongoc_write_concern_t> writeConcern_;
 
         void remove(const Document &document, mongoc_remove_flags_t flag);
-        void createIndex_internal(const bson_t &keys);
+        void createIndex_internal(const bson_t &keys, const bson_t *partialFilter=nullptr);
     };
 }
 
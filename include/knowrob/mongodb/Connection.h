@@ -6,6 +6,8 @@
 #define KNOWROB_MONGO_CONNECTION_H
 
 #include <string>
+#include <vector>
+#include <memory>
 #include <mongoc/mongoc.h>
 // #include "knowrob/mongodb/QueryWatch.h"
 
@@ -17,12 +19,86 @@ namespace knowrob::mongo {
         // std::shared_ptr <QueryWatch> connectionWatch_;
         std::string uri_string_;
 
+        /**
+         * The maximum number of clients in the pool can be configured
+         * with the `maxPoolSize` option of the URI.
+         * Other options of the URI, e.g. `compressors`, `readPreference` and timeouts,
+         * are used by all clients of the pool.
+         * @param uri_string a mongo URI.
+         */
         explicit Connection(const std::string &uri_string);
 
         ~Connection();
+
+        /**
+         * @return the maximum number of clients that can be leased at the same time.
+         */
+        int32_t maxPoolSize() const;
+
+        /**
+         * Note that compressors are only used if the server supports them too.
+         * @return the wire compressors of this connection in order of preference.
+         */
+        std::vector<std::string> compressors() const;
     };
 
+    /**
+     * A client borrowed from the pool of a connection for the duration of one operation.
+     * Clients are not thread-safe, and neither are sessions, hence each operation
+     * that may run concurrently with others needs its own lease.
+     * The client is returned to the pool when the lease is destroyed.
+     * Leasing blocks if all clients of the pool are currently leased.
+     */
+    class ClientLease {
+    public:
+        /**
+         * @param pool the client pool.
+         * @param dbName the database name.
+         * @param collectionName the collection name.
+         */
+        ClientLease(mongoc_client_pool_t *pool,
+                    const std::string &dbName,
+                    const std::string &collectionName);
+
+        ClientLease(const ClientLease&) = delete;
+
+        ~ClientLease();
+
+        /**
+         * @return the leased client.
+         */
+        auto client() const { return client_; }
 
+        /**
+         * @return the collection handle of the leased client.
+         */
+        auto coll() const { return coll_; }
+
+        /**
+         * @return the database handle of the leased client.
+         */
+        mongoc_database_t* db();
+
+        /**
+         * The session is started on first access, and ends with the lease.
+         * @return the session handle, or null if no session could be started.
+         */
+        mongoc_client_session_t* session();
+
+        /**
+         * Append options to the session.
+         * @param opts some options
+         */
+        void appendSession(bson_t *opts);
+
+    private:
+        mongoc_client_pool_t *pool_;
+        mongoc_client_t *client_;
+        mongoc_collection_t *coll_;
+        mongoc_database_t *db_;
+        mongoc_client_session_t *session_;
+        const std::string dbName_;
+    };
 }
 
 
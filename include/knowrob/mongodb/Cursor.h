@@ -17,6 +17,9 @@
 namespace knowrob::mongo {
     /**
      * A cursor that iterates over different results of a query.
+     * The cursor leases a client of the connection pool when the query is started,
+     * and returns it to the pool once all results have been retrieved, or
+     * when the cursor is destroyed.
      */
     class Cursor {
     public:
@@ -37,6 +40,25 @@ namespace knowrob::mongo {
          */
         void limit(unsigned int limit);
 
+        /**
+         * Set the number of documents returned by the server in each batch.
+         * A small first batch can be used to receive first results quickly,
+         * while larger batches avoid round trips for subsequent results.
+         * @param size the batch size, or zero for the default of the server.
+         * @param firstBatchSize the size of the first batch, or zero to use size.
+         */
+        void batchSize(uint32_t size, uint32_t firstBatchSize=0);
+
+        /**
+         * @return the batch size, or zero for the default of the server.
+         */
+        auto batchSize() const { return batchSize_; }
+
+        /**
+         * @return the size of the first batch, or zero for the default of the server.
+         */
+        auto firstBatchSize() const { return firstBatchSize_ ? firstBatchSize_ : batchSize_; }
+
         /**
          * Sort results in ascending order.
          * @param key a field name in result documents.
@@ -82,11 +104,18 @@ namespace knowrob::mongo {
 
     private:
         std::shared_ptr<Collection> collection_;
+        std::shared_ptr<ClientLease> lease_;
         mongoc_cursor_t *cursor_;
         bson_t *query_;
         bson_t *opts_;
         std::string id_;
         bool isAggregateQuery_;
+        bool isExhausted_;
+        bool hasFirstBatch_;
+        uint32_t batchSize_;
+        uint32_t firstBatchSize_;
+
+        void release();
     };
 }
 
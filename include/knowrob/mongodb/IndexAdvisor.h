@@ -0,0 +1,197 @@
+//
+// Created by daniel on 18.10.26.
+//
+
+#ifndef KNOWROB_MONGO_INDEX_ADVISOR_H
+#define KNOWROB_MONGO_INDEX_ADVISOR_H
+
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <set>
+#include <string>
+#include <vector>
+#include <map>
+#include <atomic>
+#include <mongoc.h>
+#include "knowrob/mongodb/Collection.h"
+
+namespace knowrob::mongo {
+    /**
+     * The fields constrained by a selector document, and how they are constrained.
+     */
+    struct SelectorShape {
+        // fields matched against a single value
+        std::vector<std::string> equalityFields;
+        // fields matched against a range of values
+        std::vector<std::string> rangeFields;
+        // fields that must exist in matching documents
+        std::vector<std::string> requiredFields;
+
+        /**
+         * @return a string that uniquely identifies the shape.
+         */
+        std::string key() const;
+    };
+
+    /**
+     * An index recommended for a selector shape.
+     */
+    struct IndexRecommendation {
+        // the index keys, all in ascending order
+        std::vector<std::string> keys;
+        // only documents where these fields exist are indexed
+        std::vector<std::string> partialFields;
+        // the number of recorded selectors that would use this index
+        uint64_t numSelectors = 0;
+
+        /**
+         * @return the name of the index.
+         */
+        std::string name() const;
+    };
+
+    /**
+     * Usage statistics of an existing index.
+     */
+    struct IndexUsage {
+        std::string name;
+        std::vector<std::string> keys;
+        // the number of operations that used the index since the server was started
+        int64_t numOps = 0;
+        // the time when the statistics of the index started to be recorded
+        std::chrono::system_clock::time_point since;
+    };
+
+    /**
+     * Indexes recommended to be created and dropped.
+     */
+    struct IndexAdvice {
+        std::vector<IndexRecommendation> create;
+        std::vector<IndexUsage> drop;
+
+        /**
+         * @param collectionName the name of the collection.
+         * @return mongo shell commands that create the recommended indexes.
+         */
+        std::string createScript(const std::string &collectionName) const;
+
+        /**
+         * @param collectionName the name of the collection.
+         * @return mongo shell commands that drop unused indexes.
+         */
+        std::string dropScript(const std::string &collectionName) const;
+    };
+
+    /**
+     * Recommends indexes of a collection based on the selectors that were
+     * used to query it.
+     * Selectors are reduced to their shape, i.e. the set of constrained fields.
+     * Indexes are recommended for shapes where the query planner has no index that
+     * supports all equality fields of the shape, their keys are ordered such that
+     * equality fields come before range fields.
+     * Indexes are recommended to be dropped if $indexStats reports no usage,
+     * note that these statistics are reset when the server restarts.
+     * Hence, an index is only recommended to be dropped if its usage was observed
+     * for a minimum time, and while a minimum number of selectors was recorded.
+     * Indexes required by the backend, and indexes that were recently recommended
+     * or created by the advisor are never recommended to be dropped.
+     */
+    class IndexAdvisor {
+    public:
+        static constexpr std::chrono::seconds DEFAULT_MIN_DROP_WINDOW = std::chrono::hours(24);
+        static constexpr uint64_t DEFAULT_MIN_DROP_SELECTORS = 10000;
+
+        explicit IndexAdvisor(const std::shared_ptr<Collection> &collection);
+
+        IndexAdvisor(const IndexAdvisor&) = delete;
+
+        /**
+         * Record a selector used to query the collection.
+         * @param selectorDoc a selector document.
+         */
+        void recordSelector(const bson_t *selectorDoc);
+
+        /**
+         * @return the number of recorded selectors.
+         */
+        uint64_t numSelectors() const { return numSelectors_; }
+
+        /**
+         * Declare an index that is required by the backend, it is never recommended to be dropped.
+         * @param keys the keys of the index, all in ascending order.
+         */
+        void addRequiredIndex(const std::vector<std::string> &keys);
+
+        /**
+         * Set how long index usage must be observed before an unused index is recommended to be dropped.
+         * @param minWindow the minimum time since index statistics are recorded, and since an index was recommended.
+         * @param minSelectors the minimum number of recorded selectors.
+         */
+        void setDropThresholds(std::chrono::seconds minWindow, uint64_t minSelectors);
+
+        /**
+         * @param usage usage statistics of an index.
+         * @param now the current time.
+         * @return true if the index is recommended to be dropped.
+         */
+        bool isDropCandidate(const IndexUsage &usage, std::chrono::system_clock::time_point now);
+
+        /**
+         * Read index statistics, and explain the query plan of each recorded
+         * shape to generate an advice.
+         * @param minSelectors the minimum number of selectors with a shape to recommend an index for it.
+         * @return the advice.
+         */
+        IndexAdvice advise(uint64_t minSelectors=1);
+
+        /**
+         * Create the indexes recommended by an advice.
+         * Indexes are not dropped automatically.
+         * @param advice an advice.
+         */
+        void apply(const IndexAdvice &advice);
+
+        /**
+         * @param selectorDoc a selector document.
+         * @return the shape of the selector.
+         */
+        static SelectorShape readShape(const bson_t *selectorDoc);
+
+        /**
+         * @param shape a selector shape.
+         * @return an index that supports all selectors with this shape.
+         */
+        static IndexRecommendation recommendIndex(const SelectorShape &shape);
+
+        /**
+         * @param shape a selector shape.
+         * @param keys the keys of an index.
+         * @return true if the index supports all equality fields of the shape.
+         */
+        static bool supportsShape(const SelectorShape &shape, const std::vector<std::string> &keys);
+
+    protected:
+        struct ShapeRecord {
+            SelectorShape shape;
+            std::shared_ptr<bson_t> sample;
+            uint64_t count;
+        };
+        std::shared_ptr<Collection> collection_;
+        std::map<std::string, ShapeRecord> shapes_;
+        // names of indexes that must not be dropped
+        std::set<std::string> requiredIndexes_;
+        // the last time each index was recommended or created by the advisor
+        std::map<std::string, std::chrono::system_clock::time_point> recommendedIndexes_;
+        std::chrono::seconds minDropWindow_;
+        uint64_t minDropSelectors_;
+        std::mutex mutex_;
+        std::atomic<uint64_t> numSelectors_;
+
+        std::vector<IndexUsage> readIndexStats();
+
+        std::vector<std::vector<std::string>> explainIndexKeys(const bson_t *selectorDoc);
+    };
+}
+
+#endif //KNOWROB_MONGO_INDEX_ADVISOR_H
@@ -14,6 +14,8 @@
 #include "knowrob/formulas/Literal.h"
 #include "knowrob/mongodb/TripleLoader.h"
 #include "knowrob/mongodb/AnswerCursor.h"
+#include "knowrob/mongodb/MongoMaterializer.h"
+#include "knowrob/mongodb/IndexAdvisor.h"
 #include "knowrob/semweb/ImportHierarchy.h"
 
 namespace knowrob {
@@ -51,11 +53,41 @@ namespace knowrob {
          */
         bool isReadOnly() const;
 
+        /**
+         * Enable materialization of entailments, i.e. derived triples are stored
+         * in the database and maintained on insert and remove.
+         * All triples in the database are materialized when this function is called.
+         */
+        void enableMaterialization();
+
+        /**
+         * @return true if entailments are materialized.
+         */
+        bool isMaterialized() const { return materializer_ != nullptr; }
+
         /**
          * (re)create search indices.
          */
         void createSearchIndices();
 
+        /**
+         * @return the keys of the search indices created by the backend.
+         */
+        static const std::vector<std::vector<std::string>>& searchIndexKeys();
+
+        /**
+         * Recommend search indices based on the selectors that were used to
+         * query the triples collection.
+         * The index advisor needs to be enabled in the settings for this.
+         * @return the advice, including scripts to create and drop indices.
+         */
+        mongo::IndexAdvice adviseIndices();
+
+        /**
+         * @return the index advisor, or a null pointer if it is not enabled.
+         */
+        const auto& indexAdvisor() const { return indexAdvisor_; }
+
         /**
          * Delete all statements in a named graph
          * @param graphName a graph name
@@ -91,6 +123,14 @@ namespace knowrob {
          */
         mongo::AnswerCursorPtr lookup(const std::vector<RDFLiteralPtr> &tripleExpressions);
 
+        /**
+         * Lookup up a path of matching triples.
+         * Limit and offset of the query are applied within the lookup pipeline.
+         * @param query a graph query
+         * @return a cursor over matching triples
+         */
+        mongo::AnswerCursorPtr lookup(const GraphQuery &query);
+
         /**
          * @param graphName the name of a graph
          * @return the version string associated to the named graph if any
@@ -115,16 +155,34 @@ namespace knowrob {
         // Override KnowledgeGraph
         void removeOne(const RDFLiteral &tripleExpression) override;
 
+        // Override KnowledgeGraph
+        void remove(const std::vector<RDFLiteralPtr> &tripleExpressions) override;
+
+        // Override KnowledgeGraph
+        bool replace(const std::vector<RDFLiteralPtr> &tripleExpressions,
+                     const std::vector<StatementData> &tripleData) override;
+
         // Override KnowledgeGraph
         void evaluateQuery(const GraphQueryPtr &query, AnswerBufferPtr &resultStream) override;
 
         // Override KnowledgeGraph
         AnswerBufferPtr watchQuery(const GraphQueryPtr &literal) override;
 
+        // Override KnowledgeGraph
+        std::string explainQuery(const GraphQueryPtr &query) override;
+
     protected:
         std::shared_ptr<mongo::Collection> tripleCollection_;
         std::shared_ptr<mongo::Collection> oneCollection_;
+        std::shared_ptr<mongo::MongoMaterializer> materializer_;
         bool isReadOnly_;
+        bool isPrefetching_;
+        uint32_t batchSize_;
+        uint32_t firstBatchSize_;
+        std::shared_ptr<mongo::IndexAdvisor> indexAdvisor_;
+        bool isAutoIndexing_;
+        uint32_t indexAdvisorInterval_;
+        std::atomic<bool> isAdvisingIndices_;
 
         void initialize();
 
@@ -140,9 +198,21 @@ namespace knowrob {
 
         static std::string getURI(const boost::property_tree::ptree &config);
 
+        void appendLookupPipeline(bson_t *pipelineDoc, const std::vector<RDFLiteralPtr> &tripleExpressions);
+
+        void appendLookupPipeline(bson_t *pipelineDoc, const GraphQuery &query);
+
         void updateHierarchy(mongo::TripleLoader &tripleLoader);
 
-        void updateTimeInterval(const StatementData &tripleLoader);
+        void recordSelector(const bson_t *selectorDoc);
+
+        void updateTimeIntervals(const std::vector<StatementData> &statements);
+
+        // groups statements by the name of their graph
+        std::vector<std::pair<std::string, std::vector<const StatementData*>>>
+        groupByGraph(const std::vector<StatementData> &statements);
+
+        void removeMaterialized(const RDFLiteral &tripleExpression, bool removeAll);
 
         static bson_t* getSelector(const RDFLiteral &tripleExpression, bool isTaxonomicProperty);
 
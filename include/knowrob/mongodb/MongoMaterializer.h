@@ -0,0 +1,61 @@
+//
+// Created by daniel on 18.10.23.
+//
+
+#ifndef KNOWROB_MONGO_MATERIALIZER_H
+#define KNOWROB_MONGO_MATERIALIZER_H
+
+#include <memory>
+#include <string>
+#include "knowrob/semweb/Materializer.h"
+#include "knowrob/mongodb/Collection.h"
+
+namespace knowrob::mongo {
+    /**
+     * Stores entailments of a knowledge graph in the triples collection such that
+     * they can be retrieved with plain indexed matches.
+     * Derived triples are stored in a separate named graph.
+     */
+    class MongoMaterializer : public semweb::Materializer {
+    public:
+        /**
+         * The named graph of derived triples.
+         */
+        static const std::string DERIVED_GRAPH;
+
+        MongoMaterializer(const std::shared_ptr<Collection> &tripleCollection,
+                          const std::shared_ptr<Collection> &oneCollection,
+                          const semweb::VocabularyPtr &vocabulary);
+
+        /**
+         * Read all triples of a named graph that are relevant for materialization.
+         * @param graphName the name of a graph.
+         * @param triples the list of triples.
+         */
+        void matchGraph(const std::string &graphName, std::vector<semweb::Triple> &triples);
+
+    protected:
+        std::shared_ptr<Collection> tripleCollection_;
+        std::shared_ptr<Collection> oneCollection_;
+
+        // Override Materializer
+        void match(const std::string *subject,
+                   const std::string &predicate,
+                   const std::string *object,
+                   const semweb::TripleVisitor &visitor) override;
+
+        // Override Materializer
+        void insertDerived(const std::vector<semweb::Triple> &triples) override;
+
+        // Override Materializer
+        void removeDerived(const std::vector<semweb::Triple> &triples) override;
+
+        // Override Materializer
+        void removeAllDerived() override;
+
+        static void appendUnscopedSelector(bson_t *selectorDoc);
+    };
+
+} // knowrob::mongo
+
+#endif //KNOWROB_MONGO_MATERIALIZER_H
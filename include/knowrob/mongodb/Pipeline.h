@@ -8,6 +8,7 @@
 #include <mongoc.h>
 #include <list>
 #include <string_view>
+#include <vector>
 #include "bson-helper.h"
 
 namespace knowrob::mongo::aggregation {
@@ -32,10 +33,18 @@ namespace knowrob::mongo::aggregation {
 
         /**
          * Append a $limit stage.
+         * Note that the server rejects a limit of zero, in this case
+         * a stage is appended that drops all documents.
          * @param maxDocuments limit of resulting documents.
          */
         void limit(uint32_t maxDocuments);
 
+        /**
+         * Append a $skip stage.
+         * @param numDocuments number of documents to skip.
+         */
+        void skip(uint32_t numDocuments);
+
         /**
          * Append a $unwind stage.
          * @param field an array value
@@ -78,6 +87,12 @@ namespace knowrob::mongo::aggregation {
          */
         void sortAscending(const std::string_view &field);
 
+        /**
+         * Append a $sort stage with ascending sort order.
+         * @param fields document fields, later fields are used to order documents with equal values of earlier fields.
+         */
+        void sortAscending(const std::vector<std::string_view> &fields);
+
         /**
          * Append a $sort stage with descending sort order.
          * @param newRootField a document field
@@ -9,6 +9,9 @@
 #include "memory"
 #include "list"
 #include "set"
+#include "vector"
+#include "unordered_map"
+#include "unordered_set"
 #include "knowrob/semweb/KnowledgeGraph.h"
 #include "knowrob/semweb/Class.h"
 #include "knowrob/semweb/Property.h"
@@ -18,6 +21,9 @@
 namespace knowrob::mongo {
     /**
      * Handles loading of triples into the database.
+     * Triple documents are encoded into a buffer that is reused for each triple,
+     * and parents of properties and classes are cached while loading.
+     * A loader must not be used by multiple threads at the same time.
      */
     class TripleLoader : public ITripleLoader {
     public:
@@ -60,10 +66,19 @@ namespace knowrob::mongo {
         // Override ITripleLoader
         void flush() override;
 
+        /**
+         * Remove all documents matching a selector.
+         * The removal is executed in the same batch as triples loaded afterwards,
+         * and before them.
+         * @param selectorDoc a selector document.
+         */
+        void removeAll(const bson_t *selectorDoc);
+
     protected:
         const std::string graphName_;
         const uint32_t batchSize_;
         uint32_t operationCounter_;
+        bool isOrderedBatch_;
 
         std::shared_ptr<Collection> tripleCollection_;
         std::shared_ptr<Collection> oneCollection_;
@@ -75,9 +90,57 @@ namespace knowrob::mongo {
         std::list<ClassPair> subClassAssertions_;
         std::list<PropertyPair> subPropertyAssertions_;
 
-        bson_t* createTripleDocument(const StatementData &tripleData,
-                                     const std::string &graphName,
-                                     bool isTaxonomic);
+        // parents of a resource as stored in "p*" and "o*" fields
+        struct ParentsEntry {
+            std::string iri;
+            std::vector<std::string> parents;
+        };
+        // keys are views on the IRI stored in the entry
+        using ParentsCache = std::unordered_map<std::string_view, std::unique_ptr<ParentsEntry>>;
+        // maps a resource to the cached entries that list it as a parent, i.e. to its descendants
+        using DescendantsIndex = std::unordered_map<std::string, std::unordered_set<std::string>>;
+        ParentsCache propertyParents_;
+        ParentsCache objectParents_;
+        DescendantsIndex propertyDescendants_;
+        DescendantsIndex objectDescendants_;
+        // buffer of the triple document that is re-initialized for each triple
+        bson_t tripleDoc_;
+
+        /**
+         * Encode a triple document.
+         * The document is only valid until the next triple is encoded.
+         * @param tripleData the triple data.
+         * @param graphName the name of the graph.
+         * @param isTaxonomic true if the triple has a taxonomic property.
+         * @return the triple document.
+         */
+        const bson_t* encodeTriple(const StatementData &tripleData,
+                                   const std::string &graphName,
+                                   bool isTaxonomic);
+
+        /**
+         * Keep track of imports, and of the class and property hierarchies.
+         * @param tripleData the triple data.
+         * @return true if the triple has a taxonomic property.
+         */
+        bool updateVocabulary(const StatementData &tripleData);
+
+        const ParentsEntry& getPropertyParents(const char *propertyIRI);
+
+        const ParentsEntry* getObjectParents(const char *objectIRI);
+
+        /**
+         * Drop cached parents of a resource and of all its descendants,
+         * e.g. because a new parent was asserted for the resource.
+         * @param cache a cache of parents.
+         * @param descendants the descendants index of the cache.
+         * @param iri the IRI of a resource.
+         */
+        static void invalidateParents(ParentsCache &cache, DescendantsIndex &descendants, const char *iri);
+
+        static void cacheParents(ParentsCache &cache, DescendantsIndex &descendants, std::unique_ptr<ParentsEntry> entry);
+
+        static void appendParents(bson_t *tripleDoc, const char *key, const std::vector<std::string> &parents);
     };
 
 } // knowrob::mongo
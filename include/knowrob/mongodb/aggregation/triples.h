@@ -12,6 +12,7 @@
 #include "knowrob/mongodb/Pipeline.h"
 #include "knowrob/semweb/Vocabulary.h"
 #include "knowrob/semweb/RDFLiteral.h"
+#include "knowrob/queries/QueryAggregate.h"
 
 namespace knowrob::mongo::aggregation
 {
@@ -20,13 +21,16 @@ namespace knowrob::mongo::aggregation
         : expr(expr),
           maxNumOfTriples(0),
           mayHasMoreGroundings(true),
-          forceTransitiveLookup(false)
+          forceTransitiveLookup(false),
+          isMaterialized(false)
           {}
         const RDFLiteral *expr;
         uint32_t maxNumOfTriples;
         std::set<std::string_view> knownGroundedVariables;
         bool mayHasMoreGroundings;
         bool forceTransitiveLookup;
+        // true if entailments such as the transitive closure of properties are stored
+        bool isMaterialized;
     };
 
     void appendTripleSelector(
@@ -56,7 +60,21 @@ namespace knowrob::mongo::aggregation
             aggregation::Pipeline &pipeline,
             const std::string_view &collection,
             const std::shared_ptr<semweb::Vocabulary> &vocabulary,
-            const std::vector<RDFLiteralPtr> &tripleExpressions);
+            const std::vector<RDFLiteralPtr> &tripleExpressions,
+            bool isMaterialized=false);
+
+    /**
+     * Append stages that aggregate the answer documents generated by
+     * the lookup of triple paths.
+     * Each resulting document has the same layout as answer documents, and holds
+     * values of the group variables and the aggregated value.
+     * Note that no document is generated if there are no answers.
+     * @param pipeline a pipeline with triple lookup stages.
+     * @param aggregate the aggregate.
+     */
+    void aggregateTriplePaths(
+            aggregation::Pipeline &pipeline,
+            const QueryAggregate &aggregate);
 }
 
 #endif //KNOWROB_MONGO_AGGREGATION_TRIPLES_H
@@ -0,0 +1,45 @@
+//
+// Created by daniel on 18.10.26.
+//
+
+#ifndef KNOWROB_ANSWER_AGGREGATOR_H
+#define KNOWROB_ANSWER_AGGREGATOR_H
+
+#include <map>
+#include <mutex>
+#include "AnswerBroadcaster.h"
+#include "QueryAggregate.h"
+
+namespace knowrob {
+    /**
+     * A stage that aggregates answers while they are received,
+     * and that broadcasts one answer per group once EOS has been received.
+     * Only the aggregated values are kept, not the answers.
+     */
+    class AnswerAggregator : public AnswerBroadcaster {
+    public:
+        explicit AnswerAggregator(QueryAggregatePtr aggregate);
+
+    protected:
+        struct Group {
+            std::vector<TermPtr> key;
+            uint64_t count = 0;
+            double sum = 0.0;
+            // the term with minimum or maximum value so far
+            TermPtr selected;
+            double selectedValue = 0.0;
+        };
+        const QueryAggregatePtr aggregate_;
+        std::map<std::string, Group> groups_;
+        bool isEOSSent_;
+        std::mutex mutex_;
+
+        // Override AnswerBroadcaster
+        void push(const AnswerPtr &msg) override;
+
+        void pushGroup(const Group &group);
+    };
+
+} // knowrob
+
+#endif //KNOWROB_ANSWER_AGGREGATOR_H
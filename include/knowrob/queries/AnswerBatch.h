@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2023, Daniel Beßler
+ * All rights reserved.
+ *
+ * This file is part of KnowRob, please consult
+ * https://github.com/knowrob/knowrob for license details.
+ */
+
+#ifndef KNOWROB_ANSWER_BATCH_H_
+#define KNOWROB_ANSWER_BATCH_H_
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+#include "knowrob/queries/Answer.h"
+
+namespace knowrob {
+	/**
+	 * Comparison operators of numeric builtins.
+	 */
+	enum class BatchComparison { LT, LEQ, GT, GEQ, EQ, NEQ };
+
+	/**
+	 * Arithmetic operators of numeric builtins.
+	 */
+	enum class BatchArithmetic { ADD, SUB, MUL, DIV, MIN, MAX };
+
+	namespace batch {
+		/**
+		 * Compare two arrays element-wise.
+		 * Comparisons involving NaN yield zero.
+		 * @param lhs left operands.
+		 * @param rhs right operands.
+		 * @param n number of elements.
+		 * @param op the comparison operator.
+		 * @param mask receives one for each element where the comparison holds, else zero.
+		 */
+		void compare(const double *lhs, const double *rhs, std::size_t n, BatchComparison op, uint8_t *mask);
+
+		/**
+		 * Compare an array element-wise with a constant.
+		 * Comparisons involving NaN yield zero.
+		 * @param lhs left operands.
+		 * @param rhs the right operand.
+		 * @param n number of elements.
+		 * @param op the comparison operator.
+		 * @param mask receives one for each element where the comparison holds, else zero.
+		 */
+		void compare(const double *lhs, double rhs, std::size_t n, BatchComparison op, uint8_t *mask);
+
+		/**
+		 * Apply an arithmetic operator to two arrays element-wise.
+		 * @param lhs left operands.
+		 * @param rhs right operands.
+		 * @param n number of elements.
+		 * @param op the arithmetic operator.
+		 * @param out receives the results, may be one of the operands.
+		 */
+		void compute(const double *lhs, const double *rhs, std::size_t n, BatchArithmetic op, double *out);
+
+		/**
+		 * Apply an arithmetic operator to an array and a constant element-wise.
+		 * @param lhs left operands.
+		 * @param rhs the right operand.
+		 * @param n number of elements.
+		 * @param op the arithmetic operator.
+		 * @param out receives the results, may be the left operands.
+		 */
+		void compute(const double *lhs, double rhs, std::size_t n, BatchArithmetic op, double *out);
+	}
+
+	/**
+	 * A batch of answers with numeric columns.
+	 * A column holds one value per answer, e.g. the numeric value of a variable
+	 * binding, or the begin of the time interval of an answer.
+	 * Columns are extracted from the answers once and are then evaluated by
+	 * comparison and arithmetic kernels over contiguous arrays.
+	 * Filtering removes answers from the batch in place, and all columns
+	 * are compacted accordingly.
+	 */
+	class AnswerBatch {
+	public:
+		// the index of a column
+		using Column = std::size_t;
+
+		explicit AnswerBatch(std::vector<AnswerPtr> answers={});
+
+		/**
+		 * Append an answer, columns already extracted are extended.
+		 * Computed columns receive NaN for the new answer.
+		 * @param answer an answer.
+		 */
+		void push_back(const AnswerPtr &answer);
+
+		/**
+		 * @return the answers in the batch.
+		 */
+		const auto& answers() const { return answers_; }
+
+		/**
+		 * @return number of answers in the batch.
+		 */
+		auto size() const { return answers_.size(); }
+
+		/**
+		 * @param column a column index.
+		 * @return the values of the column.
+		 */
+		const std::vector<double>& values(Column column) const { return columns_[column]; }
+
+		/**
+		 * The column of a variable holds NaN for answers where the variable
+		 * is not substituted by a number.
+		 * @param var a variable.
+		 * @return the column of numeric values substituted for the variable.
+		 */
+		Column column(const Variable &var);
+
+		/**
+		 * The column holds -inf for answers without a lower time bound.
+		 * @return the column of time interval begins.
+		 */
+		Column sinceColumn();
+
+		/**
+		 * The column holds +inf for answers without an upper time bound.
+		 * @return the column of time interval ends.
+		 */
+		Column untilColumn();
+
+		/**
+		 * @param value a number.
+		 * @return a column holding the value for each answer.
+		 */
+		Column constant(double value);
+
+		/**
+		 * Compile an arithmetic expression into a column.
+		 * The expression may be a number, a variable, or one of the functors
+		 * `+`, `-`, `*`, `/`, `min`, `max` applied to expressions.
+		 * @param expression an arithmetic expression.
+		 * @return a column holding the value of the expression for each answer.
+		 * @throws QueryError if the expression is not supported.
+		 */
+		Column evaluate(const TermPtr &expression);
+
+		/**
+		 * @param lhs a column.
+		 * @param op an arithmetic operator.
+		 * @param rhs a column.
+		 * @return a column holding the result for each answer.
+		 */
+		Column compute(Column lhs, BatchArithmetic op, Column rhs);
+
+		/**
+		 * @param lhs a column.
+		 * @param op an arithmetic operator.
+		 * @param rhs a number.
+		 * @return a column holding the result for each answer.
+		 */
+		Column compute(Column lhs, BatchArithmetic op, double rhs);
+
+		/**
+		 * Remove all answers for which a comparison does not hold.
+		 * @param lhs a column.
+		 * @param op a comparison operator.
+		 * @param rhs a column.
+		 * @return the number of remaining answers.
+		 */
+		std::size_t filter(Column lhs, BatchComparison op, Column rhs);
+
+		/**
+		 * Remove all answers for which a comparison does not hold.
+		 * @param lhs a column.
+		 * @param op a comparison operator.
+		 * @param rhs a number.
+		 * @return the number of remaining answers.
+		 */
+		std::size_t filter(Column lhs, BatchComparison op, double rhs);
+
+		/**
+		 * Remove all answers for which a comparison of two arithmetic expressions does not hold.
+		 * @param lhs an arithmetic expression.
+		 * @param op a comparison operator.
+		 * @param rhs an arithmetic expression.
+		 * @return the number of remaining answers.
+		 */
+		std::size_t filter(const TermPtr &lhs, BatchComparison op, const TermPtr &rhs);
+
+		/**
+		 * Substitute a variable in each answer by the value of a column.
+		 * Answers where the value is NaN are removed.
+		 * @param var a variable.
+		 * @param column a column.
+		 * @return the number of remaining answers.
+		 */
+		std::size_t extend(const Variable &var, Column column);
+
+	protected:
+		std::vector<AnswerPtr> answers_;
+		std::vector<std::vector<double>> columns_;
+		// extraction functions of columns that are read from answers, empty for computed columns
+		std::vector<std::function<double(const Answer&)>> extractors_;
+		std::map<std::string, Column, std::less<>> variableColumns_;
+		std::optional<Column> sinceColumn_;
+		std::optional<Column> untilColumn_;
+		std::vector<uint8_t> mask_;
+
+		Column addColumn(const std::function<double(const Answer&)> &extractor);
+
+		Column addComputedColumn();
+
+		std::size_t compact();
+	};
+}
+
+#endif //KNOWROB_ANSWER_BATCH_H_
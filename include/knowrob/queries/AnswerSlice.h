@@ -0,0 +1,76 @@
+//
+// Created by daniel on 18.10.26.
+//
+
+#ifndef KNOWROB_ANSWER_SLICE_H
+#define KNOWROB_ANSWER_SLICE_H
+
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <string>
+#include <vector>
+#include "AnswerBroadcaster.h"
+
+namespace knowrob {
+    /**
+     * A stage that takes a page of answers from its input stream.
+     * Answers are generated in no particular order, e.g. by concurrent reasoners.
+     * To make pages deterministic, answers are ordered by their textual
+     * representation, and the page is broadcast once EOS was received.
+     * Hence, the same query yields the same pages as long as the knowledge
+     * base is not modified, and consecutive pages neither overlap nor miss answers.
+     * Ordered pages cannot be taken before EOS as any answer that arrives later
+     * may precede the ones received so far. Only the first offset+limit answers
+     * in this order are kept in memory.
+     * If no order is required, answers are broadcast as they arrive, and the
+     * generation of further answers is stopped once the page is complete.
+     */
+    class AnswerSlice : public AnswerBroadcaster {
+    public:
+        using StopHandler = std::function<void()>;
+
+        /**
+         * @param limit the maximum number of answers, if any.
+         * @param offset the number of answers to skip.
+         * @param isOrdered true if the page is taken from ordered answers.
+         */
+        explicit AnswerSlice(std::optional<uint32_t> limit, uint32_t offset=0, bool isOrdered=true);
+
+        /**
+         * The handler is called once an unordered page is complete, and should stop
+         * the stages that generate the input of this stage.
+         * Note that it is called from within the input stream, i.e. while upstream
+         * stages are broadcasting.
+         * @param stopHandler a handler that stops upstream stages.
+         */
+        void setStopHandler(StopHandler stopHandler) { stopHandler_ = std::move(stopHandler); }
+
+    protected:
+        using OrderedAnswer = std::pair<std::string, AnswerPtr>;
+        struct OrderedAnswerCompare {
+            bool operator()(const OrderedAnswer &a, const OrderedAnswer &b) const { return a.first < b.first; }
+        };
+
+        const std::optional<uint32_t> limit_;
+        const uint32_t offset_;
+        const bool isOrdered_;
+        // max-heap of answers ordered by their textual representation
+        std::priority_queue<OrderedAnswer, std::vector<OrderedAnswer>, OrderedAnswerCompare> orderedAnswers_;
+        // number of answers received so far
+        uint32_t numAnswers_;
+        StopHandler stopHandler_;
+        bool isEOSSent_;
+        std::mutex mutex_;
+
+        // broadcast the page taken from the ordered answers
+        void pushOrderedPage();
+
+        // Override AnswerBroadcaster
+        void push(const AnswerPtr &msg) override;
+    };
+
+} // knowrob
+
+#endif //KNOWROB_ANSWER_SLICE_H
@@ -0,0 +1,65 @@
+//
+// Created by daniel on 18.10.26.
+//
+
+#ifndef KNOWROB_BUILTIN_STAGE_H
+#define KNOWROB_BUILTIN_STAGE_H
+
+#include <mutex>
+#include <vector>
+#include "AnswerBroadcaster.h"
+#include "AnswerBatch.h"
+#include "QueryProfile.h"
+#include "knowrob/semweb/RDFLiteral.h"
+
+namespace knowrob {
+    /**
+     * A stage that evaluates numeric builtin literals over batches of answers.
+     * Comparisons (`<`, `>`, `=<`, `>=`, `=:=`, `=\=`) remove answers for which they
+     * do not hold, and `is/2` substitutes its first argument by the value of an
+     * arithmetic expression.
+     * Input answers are collected into an AnswerBatch such that the builtins are evaluated
+     * by its columnar kernels. A batch is evaluated once it is full, or when the input stream ends.
+     */
+    class BuiltinStage : public AnswerBroadcaster {
+    public:
+        static constexpr std::size_t DEFAULT_BATCH_SIZE = 256;
+
+        /**
+         * @param builtins the builtin literals, evaluated in the given order.
+         * @param batchSize the maximum number of answers in a batch.
+         */
+        explicit BuiltinStage(std::vector<RDFLiteralPtr> builtins, std::size_t batchSize=DEFAULT_BATCH_SIZE);
+
+        /**
+         * @param literal a literal.
+         * @return true if the literal is a builtin that can be evaluated by this stage.
+         */
+        static bool isBuiltin(const RDFLiteral &literal);
+
+        /**
+         * Statistics are recorded in the given profile while the stage is active.
+         * @param profile a stage profile.
+         */
+        void setProfile(const StageProfilePtr &profile) { profile_ = profile; }
+
+    protected:
+        const std::vector<RDFLiteralPtr> builtins_;
+        const std::size_t batchSize_;
+        AnswerBatch batch_;
+        StageProfilePtr profile_;
+        bool isEOSSent_;
+        std::mutex mutex_;
+
+        // evaluates the builtins over the current batch, and broadcasts the remaining answers
+        void flush();
+
+        static void evaluate(const RDFLiteral &builtin, AnswerBatch &batch);
+
+        // Override AnswerBroadcaster
+        void push(const AnswerPtr &msg) override;
+    };
+
+} // knowrob
+
+#endif //KNOWROB_BUILTIN_STAGE_H
@@ -6,6 +6,7 @@
 #define KNOWROB_GRAPH_QUERY_H
 
 #include <utility>
+#include <optional>
 
 #include "memory"
 #include "vector"
@@ -15,6 +16,7 @@
 #include "knowrob/ThreadPool.h"
 #include "knowrob/queries/AnswerBuffer.h"
 #include "knowrob/queries/Query.h"
+#include "knowrob/queries/QueryAggregate.h"
 #include "knowrob/formulas/Conjunction.h"
 
 namespace knowrob {
@@ -42,6 +44,46 @@ namespace knowrob {
 
         const auto& literals() const { return literals_; }
 
+        /**
+         * Limit the number of answers of this query.
+         * Note that limit and offset refer to answers in a deterministic order,
+         * such that consecutive pages of answers do not overlap.
+         * @param limit the maximum number of answers.
+         */
+        void setLimit(uint32_t limit) { limit_ = limit; }
+
+        /**
+         * Skip some answers of this query.
+         * @param offset the number of answers to skip before answers are generated.
+         */
+        void setOffset(uint32_t offset) { offset_ = offset; }
+
+        /**
+         * @return the maximum number of answers, if any.
+         */
+        const auto& limit() const { return limit_; }
+
+        /**
+         * @return the number of answers to skip.
+         */
+        auto offset() const { return offset_; }
+
+        /**
+         * Aggregate answers of this query instead of generating them.
+         * @param aggregate an aggregate.
+         */
+        void setAggregate(const QueryAggregatePtr &aggregate) { aggregate_ = aggregate; }
+
+        /**
+         * @return the aggregate of answers, or a null reference if answers are not aggregated.
+         */
+        const auto& aggregate() const { return aggregate_; }
+
+        /**
+         * @return true if limit or offset are set.
+         */
+        bool isPaged() const { return limit_.has_value() || offset_>0; }
+
         // Override Query
 		const FormulaPtr& formula() const override;
 
@@ -51,6 +93,9 @@ namespace knowrob {
     protected:
         std::vector<RDFLiteralPtr> literals_;
         FormulaPtr formula_;
+        std::optional<uint32_t> limit_;
+        uint32_t offset_;
+        QueryAggregatePtr aggregate_;
 
         void init();
     };
@@ -27,12 +27,17 @@ namespace knowrob {
 		/**
 		 * @formula the formula associated to this query.
 		 */
-        explicit Query(int flags) : flags_(flags) {}
+        explicit Query(int flags) : flags_(flags), queryID_(nextQueryID()) {}
 
         static int defaultFlags();
 
         int flags() const { return flags_; }
 
+		/**
+		 * @return an ID that is unique for each query created in this process.
+		 */
+        uint64_t queryID() const { return queryID_; }
+
         virtual std::ostream& print(std::ostream &os) const = 0;
 
 		/**
@@ -42,6 +47,9 @@ namespace knowrob {
 
 	protected:
 		const int flags_;
+		const uint64_t queryID_;
+
+		static uint64_t nextQueryID();
 	};
 }
 
@@ -0,0 +1,108 @@
+//
+// Created by daniel on 18.10.26.
+//
+
+#ifndef KNOWROB_QUERY_AGGREGATE_H
+#define KNOWROB_QUERY_AGGREGATE_H
+
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string_view>
+#include <vector>
+#include "knowrob/terms/Variable.h"
+#include "knowrob/queries/Answer.h"
+
+namespace knowrob {
+    /**
+     * Functions that aggregate answers of a query into a single value.
+     */
+    enum class AggregateFunction {
+        // the number of answers
+        COUNT,
+        // one if there is any answer, else zero
+        EXISTS,
+        // the minimum value of a variable
+        MIN,
+        // the maximum value of a variable
+        MAX,
+        // the sum of values of a variable
+        SUM
+    };
+
+    /**
+     * Aggregates the answers of a query instead of generating them.
+     * Answers can be grouped by the values of some variables, in which case
+     * one answer is generated for each group.
+     * The aggregated value is substituted for the result variable.
+     */
+    class QueryAggregate {
+    public:
+        /**
+         * @param function the aggregate function.
+         * @param result the variable that receives the aggregated value.
+         * @param value the aggregated variable, not used for count and exists.
+         * @param groupBy variables whose values distinguish groups of answers.
+         */
+        QueryAggregate(AggregateFunction function,
+                       std::shared_ptr<Variable> result,
+                       std::shared_ptr<Variable> value={},
+                       std::vector<std::shared_ptr<Variable>> groupBy={});
+
+        /**
+         * @return the aggregate function.
+         */
+        auto function() const { return function_; }
+
+        /**
+         * @return the variable that receives the aggregated value.
+         */
+        const auto& result() const { return result_; }
+
+        /**
+         * @return the aggregated variable, if any.
+         */
+        const auto& value() const { return value_; }
+
+        /**
+         * @return variables whose values distinguish groups of answers.
+         */
+        const auto& groupBy() const { return groupBy_; }
+
+        /**
+         * @return true if an answer is generated even if the query has no answer.
+         */
+        bool hasEmptyAnswer() const;
+
+        /**
+         * @return the answer generated if the query has no answer, e.g. a count of zero.
+         */
+        AnswerPtr emptyAnswer() const;
+
+        /**
+         * @param name the name of an aggregate function, e.g. "count".
+         * @return the aggregate function, or nothing if the name is unknown.
+         */
+        static std::optional<AggregateFunction> functionFromName(const std::string_view &name);
+
+        /**
+         * @param function an aggregate function.
+         * @return the name of the aggregate function.
+         */
+        static const char* functionName(AggregateFunction function);
+
+    protected:
+        const AggregateFunction function_;
+        const std::shared_ptr<Variable> result_;
+        const std::shared_ptr<Variable> value_;
+        const std::vector<std::shared_ptr<Variable>> groupBy_;
+    };
+
+    using QueryAggregatePtr = std::shared_ptr<QueryAggregate>;
+} // knowrob
+
+namespace std {
+    std::ostream& operator<<(std::ostream& os, const knowrob::QueryAggregate& aggregate);
+}
+
+#endif //KNOWROB_QUERY_AGGREGATE_H
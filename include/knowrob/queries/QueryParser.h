@@ -7,6 +7,7 @@
 
 #include "knowrob/formulas/Formula.h"
 #include "knowrob/formulas/Predicate.h"
+#include "knowrob/queries/QueryAggregate.h"
 
 namespace knowrob {
 	// note: forward declared to avoid including parser library in the header.
@@ -30,6 +31,16 @@ namespace knowrob {
 
         static TermPtr parseConstant(const std::string &queryString);
 
+        /**
+         * Parse an aggregate query of the form `aggregate_all(Spec, Goal, Result)`,
+         * or `aggregate_all(Spec, [Var1,...], Goal, Result)` to aggregate
+         * answers grouped by the values of some variables.
+         * Spec is one of `count`, `exists`, `min(Var)`, `max(Var)` or `sum(Var)`.
+         * @param queryString a string encoding an aggregate query.
+         * @return the goal formula and the aggregate.
+         */
+        static std::pair<FormulaPtr, QueryAggregatePtr> parseAggregate(const std::string &queryString);
+
 	protected:
 		ParserRules *bnf_;
 	};
@@ -6,6 +6,7 @@
 #define KNOWROB_QUERY_PIPELINE_H
 
 #include "memory"
+#include "mutex"
 #include "AnswerStream.h"
 
 namespace knowrob {
@@ -21,8 +22,14 @@ namespace knowrob {
 
         void addStage(const std::shared_ptr<AnswerStream> &stage);
 
+        /**
+         * Stops each stage of the pipeline, e.g. when no more answers are needed.
+         */
+        void close();
+
     protected:
         std::vector<std::shared_ptr<AnswerStream>> stages_;
+        std::mutex mutex_;
     };
 }
 
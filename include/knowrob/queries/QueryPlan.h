@@ -0,0 +1,76 @@
+//
+// Created by daniel on 18.10.23.
+//
+
+#ifndef KNOWROB_QUERY_PLAN_H
+#define KNOWROB_QUERY_PLAN_H
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <ostream>
+#include "knowrob/semweb/RDFLiteral.h"
+
+namespace knowrob {
+    /**
+     * A computable literal in a query plan together with the names
+     * of the reasoners that are used to compute it.
+     */
+    struct PlannedLiteral {
+        RDFLiteralPtr literal;
+        std::vector<std::string> reasonerNames;
+    };
+
+    /**
+     * The evaluation plan of a conjunctive query.
+     */
+    struct ConjunctiveQueryPlan {
+        // literals that are evaluated in a single EDB query, in evaluation order
+        std::vector<RDFLiteralPtr> edbLiterals;
+        // the EDB query as generated by the knowledge graph, e.g. an aggregation pipeline in JSON format
+        std::string edbQuery;
+        // groups of computable literals, each group in the order of evaluation
+        std::vector<std::vector<PlannedLiteral>> dependencyGroups;
+        // numeric builtins evaluated over batches of answers of all positive literals
+        std::vector<RDFLiteralPtr> builtinLiterals;
+        // negative literals evaluated after all positive literals
+        std::vector<RDFLiteralPtr> negativeLiterals;
+    };
+
+    /**
+     * The evaluation plan of a query.
+     * The plan has one conjunctive plan for each path in the DNF of the query.
+     */
+    class QueryPlan {
+    public:
+        QueryPlan() = default;
+
+        /**
+         * @param path the plan of a conjunctive query.
+         */
+        void addPath(ConjunctiveQueryPlan path) { paths_.push_back(std::move(path)); }
+
+        /**
+         * @return plans of conjunctive queries, one for each path in the DNF of the query.
+         */
+        const auto& paths() const { return paths_; }
+
+        /**
+         * Print this plan to an output stream.
+         * @param os an output stream
+         * @return the output stream
+         */
+        std::ostream& print(std::ostream &os) const;
+
+    protected:
+        std::vector<ConjunctiveQueryPlan> paths_;
+    };
+
+    using QueryPlanPtr = std::shared_ptr<QueryPlan>;
+} // knowrob
+
+namespace std {
+    std::ostream& operator<<(std::ostream& os, const knowrob::QueryPlan& plan);
+}
+
+#endif //KNOWROB_QUERY_PLAN_H
@@ -0,0 +1,126 @@
+//
+// Created by daniel on 18.10.23.
+//
+
+#ifndef KNOWROB_QUERY_PROFILE_H
+#define KNOWROB_QUERY_PROFILE_H
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <ostream>
+
+namespace knowrob {
+    /**
+     * Runtime statistics of a single stage in a query pipeline.
+     * Counters are updated concurrently by the threads that push
+     * messages through the stage.
+     */
+    class StageProfile {
+    public:
+        /**
+         * @param name a human readable name of the stage.
+         */
+        explicit StageProfile(std::string name);
+
+        /**
+         * @return a human readable name of the stage.
+         */
+        const std::string& name() const { return name_; }
+
+        /**
+         * Marks the time of the first input of the stage.
+         * Only the first call has an effect.
+         */
+        void begin();
+
+        /**
+         * Marks the time when the stage has sent EOS.
+         */
+        void end();
+
+        /**
+         * @return wall time in seconds between first input and EOS of the stage.
+         */
+        double wallTime() const;
+
+        /**
+         * @return CPU time in seconds spent within the stage.
+         */
+        double cpuTime() const { return static_cast<double>(cpuTimeNs) / 1e9; }
+
+        /**
+         * @return time in seconds the stage was blocked waiting for locks on its queues.
+         */
+        double blockedTime() const { return static_cast<double>(blockedTimeNs) / 1e9; }
+
+        /**
+         * @return current CPU time of the calling thread in nanoseconds.
+         */
+        static int64_t threadCPUTime();
+
+        /**
+         * @return current time of a monotonic clock in nanoseconds.
+         */
+        static int64_t steadyTime();
+
+        std::atomic<uint64_t> numSubQueries;
+        std::atomic<uint64_t> numAnswersIn;
+        std::atomic<uint64_t> numAnswersOut;
+        std::atomic<int64_t> cpuTimeNs;
+        std::atomic<int64_t> blockedTimeNs;
+
+    protected:
+        const std::string name_;
+        std::atomic<int64_t> beginTimeNs_;
+        std::atomic<int64_t> endTimeNs_;
+    };
+    using StageProfilePtr = std::shared_ptr<StageProfile>;
+
+    /**
+     * Runtime statistics of all stages of a query pipeline.
+     */
+    class QueryProfile {
+    public:
+        QueryProfile();
+
+        /**
+         * Add a new stage to the profile.
+         * @param name a human readable name of the stage.
+         * @return the profile of the stage.
+         */
+        StageProfilePtr addStage(const std::string &name);
+
+        /**
+         * @return the profiles of all stages in order of creation.
+         */
+        std::vector<StageProfilePtr> stages() const;
+
+        /**
+         * @return wall time in seconds since the profile was created.
+         */
+        double totalWallTime() const;
+
+        /**
+         * Print this profile to an output stream.
+         * @param os an output stream
+         * @return the output stream
+         */
+        std::ostream& print(std::ostream &os) const;
+
+    protected:
+        std::vector<StageProfilePtr> stages_;
+        mutable std::mutex mutex_;
+        const int64_t creationTimeNs_;
+    };
+
+    using QueryProfilePtr = std::shared_ptr<QueryProfile>;
+} // knowrob
+
+namespace std {
+    std::ostream& operator<<(std::ostream& os, const knowrob::QueryProfile& profile);
+}
+
+#endif //KNOWROB_QUERY_PROFILE_H
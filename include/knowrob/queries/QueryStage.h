@@ -11,6 +11,7 @@
 #include "AnswerBroadcaster.h"
 #include "DependencyGraph.h"
 #include "Query.h"
+#include "QueryProfile.h"
 #include "knowrob/semweb/RDFLiteral.h"
 
 namespace knowrob {
@@ -25,6 +26,23 @@ namespace knowrob {
 
         void setQueryFlags(int flags);
 
+        /**
+         * Enable profiling of this stage.
+         * Statistics are recorded in the given profile while the stage is active.
+         * @param profile a stage profile.
+         */
+        void setProfile(const StageProfilePtr &profile) { profile_ = profile; }
+
+        /**
+         * @return the profile of this stage, or a null reference if profiling is disabled.
+         */
+        const StageProfilePtr& profile() const { return profile_; }
+
+        /**
+         * @param queryID the ID of the query this stage belongs to, used for tracing.
+         */
+        void setQueryID(uint64_t queryID) { queryID_ = queryID; }
+
         /**
          * Request the stage to stop any active processes.
          * This will not necessary cause the processes to immediately exit,
@@ -53,6 +71,8 @@ namespace knowrob {
         using ActiveQuery = std::pair<AnswerBufferPtr, std::shared_ptr<AnswerStream>>;
         std::list<ActiveQuery> graphQueries_;
         int queryFlags_;
+        StageProfilePtr profile_;
+        uint64_t queryID_;
 
         void push(const AnswerPtr &msg) override;
 
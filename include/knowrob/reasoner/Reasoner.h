@@ -98,6 +98,21 @@ namespace knowrob {
 
         virtual AnswerBufferPtr submitQuery(const RDFLiteralPtr &literal, int queryFlags) = 0;
 
+		/**
+		 * Called after statements were asserted into the knowledge base.
+		 * Reasoners that infer facts bottom-up may use this to update their inferences.
+		 * @param statements the asserted statements.
+		 */
+		virtual void onInsert(const std::vector<StatementData> &statements) {}
+
+		/**
+		 * Called after statements were removed from the knowledge base.
+		 * Reasoners that cache or infer facts may use this to drop facts that
+		 * depend on removed statements.
+		 * @param tripleExpressions patterns of the removed statements.
+		 */
+		virtual void onRemove(const std::vector<RDFLiteralPtr> &tripleExpressions) {}
+
 	protected:
 		std::map<std::string, DataSourceLoader> dataSourceHandler_;
         uint32_t reasonerManagerID_;
@@ -106,6 +121,12 @@ namespace knowrob {
 
         void setReasonerManager(uint32_t managerID);
 
+		/**
+		 * Needs to be called when the reasoner defines predicates after it was configured,
+		 * e.g. by asserting facts, such that they are no longer dispatched as undefined.
+		 */
+		void notifyPredicatesDefined();
+
 		friend class ReasonerManager;
 	};
 }
@@ -9,6 +9,11 @@
 #ifndef KNOWROB_REASONER_MANAGER_H_
 #define KNOWROB_REASONER_MANAGER_H_
 
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
 #include "knowrob/reasoner/TypedReasonerFactory.h"
 #include "knowrob/reasoner/ReasonerPlugin.h"
 #include "knowrob/reasoner/DefinedPredicate.h"
@@ -54,6 +59,25 @@ namespace knowrob {
 		 */
 		void loadReasoner(const boost::property_tree::ptree &config);
 
+		/**
+		 * Create a new reasoner instance and add it to the reasoner manager
+		 * without loading its configuration.
+		 * This must not be called concurrently with other calls that modify the manager.
+		 * @param config a property tree holding a reasoner configuration
+		 * @return the reasoner created
+		 */
+		std::shared_ptr<DefinedReasoner> createReasoner(const boost::property_tree::ptree &config);
+
+		/**
+		 * Load the configuration and data sources of a reasoner created by createReasoner().
+		 * Different reasoners can be configured concurrently.
+		 * The predicates defined by the reasoner are re-indexed afterwards.
+		 * @param reasoner a reasoner of this manager
+		 * @param config a property tree holding the reasoner configuration
+		 */
+		void configureReasoner(const std::shared_ptr<DefinedReasoner> &reasoner,
+		                       const boost::property_tree::ptree &config);
+
 		/**
 		 * Get the definition of a predicate.
 		 * @param predicate the predicate in question
@@ -62,6 +86,29 @@ namespace knowrob {
 		std::shared_ptr<DefinedPredicate> getPredicateDefinition(
 				const std::shared_ptr<PredicateIndicator> &predicate);
 
+		/**
+		 * Get all reasoners that define a predicate.
+		 * Results are kept in a dispatch index such that reasoners are only asked
+		 * once for each predicate, including predicates that no reasoner defines.
+		 * @param functor the functor of a predicate, e.g. a property IRI.
+		 * @param arity the arity of the predicate.
+		 * @return the reasoners defining the predicate, possibly empty.
+		 */
+		std::vector<std::shared_ptr<DefinedReasoner>> getReasonersForPredicate(
+				const std::string &functor, uint32_t arity);
+
+		/**
+		 * Drop all entries of the dispatch index.
+		 * Needs to be called when a reasoner defines new predicates after it was configured.
+		 */
+		void invalidateDispatchIndex();
+
+		/**
+		 * Drop the entries of the dispatch index for predicates that no reasoner defines.
+		 * Needs to be called whenever a reasoner defines a predicate.
+		 */
+		void invalidateUndefinedPredicates();
+
 		/**
 		 * @param reasonerID a reasoner ID string.
 		 * @return a reasoner instance or a null pointer reference.
@@ -100,11 +147,24 @@ namespace knowrob {
 		std::map<std::string, std::shared_ptr<ReasonerPlugin>> loadedPlugins_;
 		// a counter used to generate unique IDs
 		uint32_t reasonerIndex_;
+		// reasoners defining a predicate, and the predicate descriptions they provide
+		struct PredicateDispatch {
+			std::vector<std::shared_ptr<DefinedReasoner>> reasoners;
+			std::vector<std::shared_ptr<PredicateDescription>> descriptions;
+		};
+		using PredicateDispatchPtr = std::shared_ptr<const PredicateDispatch>;
+		// maps functor and arity of a predicate to reasoners defining it
+		std::unordered_map<std::string, std::map<uint32_t, PredicateDispatchPtr>> dispatchIndex_;
+		// incremented when the index is invalidated
+		uint64_t dispatchGeneration_;
+		std::shared_mutex dispatchMutex_;
         // an identifier for this manager
         uint32_t managerID_;
 
 		std::shared_ptr<ReasonerPlugin> loadReasonerPlugin(const std::string &path);
 
+		PredicateDispatchPtr getPredicateDispatch(const std::string &functor, uint32_t arity);
+
         /**
          * Remove a reasoner from this manager.
          * @reasoner a reasoner.
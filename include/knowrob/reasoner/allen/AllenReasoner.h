@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2023, Daniel Beßler
+ * All rights reserved.
+ *
+ * This file is part of KnowRob, please consult
+ * https://github.com/knowrob/knowrob for license details.
+ */
+
+#ifndef KNOWROB_ALLEN_REASONER_H
+#define KNOWROB_ALLEN_REASONER_H
+
+#include <map>
+#include <set>
+#include <shared_mutex>
+#include "knowrob/reasoner/Reasoner.h"
+#include "knowrob/reasoner/allen/IntervalIndex.h"
+
+namespace knowrob::allen {
+	constexpr std::string_view hasTimeInterval  = "http://www.ontologydesignpatterns.org/ont/dul/DUL.owl#hasTimeInterval";
+	constexpr std::string_view hasIntervalBegin = "http://www.ease-crc.org/ont/SOMA.owl#hasIntervalBegin";
+	constexpr std::string_view hasIntervalEnd   = "http://www.ease-crc.org/ont/SOMA.owl#hasIntervalEnd";
+	// the functor of `interval(Event, [Begin,End])`
+	constexpr std::string_view interval         = "interval";
+}
+
+namespace knowrob {
+	/**
+	 * A reasoner that evaluates Allen's interval relations over the time intervals
+	 * of events without constructing event-endpoint graphs.
+	 * The intervals are read from the `soma:hasIntervalBegin` and `soma:hasIntervalEnd`
+	 * properties of an event, or of its `dul:hasTimeInterval`, and are kept in an
+	 * IntervalIndex that is updated when these properties are asserted.
+	 * The relations are answered for the SOMA properties `soma:before`, `soma:during`, etc.,
+	 * and `interval(Event, [Begin,End])` yields the interval of an event.
+	 */
+	class AllenReasoner : public Reasoner {
+	public:
+		explicit AllenReasoner(std::string reasonerID);
+
+		/**
+		 * @return the index of event intervals.
+		 */
+		const auto& intervalIndex() const { return index_; }
+
+		/**
+		 * Set the time interval of an event or time interval resource.
+		 * @param resource the IRI of an event or time interval.
+		 * @param begin the begin time if known.
+		 * @param end the end time if known.
+		 */
+		void setInterval(const std::string &resource, std::optional<double> begin, std::optional<double> end);
+
+		/**
+		 * Associate an event to its time interval resource.
+		 * @param event the event IRI.
+		 * @param timeInterval the time interval IRI.
+		 */
+		void setTimeInterval(const std::string &event, const std::string &timeInterval);
+
+		// Override Reasoner
+		void setDataBackend(const KnowledgeGraphPtr &knowledgeGraph) override;
+
+		// Override Reasoner
+		bool loadConfiguration(const ReasonerConfiguration &cfg) override;
+
+		// Override Reasoner
+		std::shared_ptr<PredicateDescription> getPredicateDescription(
+				const std::shared_ptr<PredicateIndicator> &indicator) override;
+
+		// Override Reasoner
+		unsigned long getCapabilities() const override;
+
+		// Override Reasoner
+		AnswerBufferPtr submitQuery(const RDFLiteralPtr &literal, int queryFlags) override;
+
+		// Override Reasoner
+		void onInsert(const std::vector<StatementData> &statements) override;
+
+		// Override Reasoner
+		void onRemove(const std::vector<RDFLiteralPtr> &tripleExpressions) override;
+
+	protected:
+		const std::string reasonerID_;
+		KnowledgeGraphPtr knowledgeGraph_;
+		allen::IntervalIndex index_;
+		// endpoints of time interval resources, including incomplete ones
+		std::map<std::string, std::pair<std::optional<double>, std::optional<double>>, std::less<>> endpoints_;
+		// maps time interval resources to events
+		std::map<std::string, std::set<std::string>, std::less<>> eventsOfInterval_;
+		mutable std::shared_mutex mutex_;
+
+		void loadIntervals();
+
+		void updateIndex(const std::string &resource);
+
+		void reindexEvent(const std::string &event);
+
+		void removeEndpoints(const RDFLiteral &literal, bool isBegin);
+
+		void removeTimeIntervals(const RDFLiteral &literal);
+
+		void answerRelation(allen::AllenRelation relation, const RDFLiteral &literal,
+		                    int queryFlags, const std::shared_ptr<AnswerStream::Channel> &channel);
+
+		void answerInterval(const RDFLiteral &literal,
+		                    int queryFlags, const std::shared_ptr<AnswerStream::Channel> &channel);
+
+		static const std::map<std::string, allen::AllenRelation, std::less<>>& relationProperties();
+	};
+}
+
+#endif //KNOWROB_ALLEN_REASONER_H
@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2023, Daniel Beßler
+ * All rights reserved.
+ *
+ * This file is part of KnowRob, please consult
+ * https://github.com/knowrob/knowrob for license details.
+ */
+
+#ifndef KNOWROB_ALLEN_INTERVAL_INDEX_H
+#define KNOWROB_ALLEN_INTERVAL_INDEX_H
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+
+namespace knowrob::allen {
+	/**
+	 * The relations of Allen's interval calculus.
+	 */
+	enum class AllenRelation {
+		EQUALS,
+		BEFORE,
+		AFTER,
+		MEETS,
+		MET_BY,
+		OVERLAPS,
+		OVERLAPPED_BY,
+		STARTS,
+		STARTED_BY,
+		FINISHES,
+		FINISHED_BY,
+		DURING,
+		CONTAINS
+	};
+
+	/**
+	 * @param r an Allen relation.
+	 * @return the relation r' such that r(A,B) iff r'(B,A).
+	 */
+	AllenRelation inverseOf(AllenRelation r);
+
+	/**
+	 * The time interval of an event.
+	 */
+	struct EventInterval {
+		double begin;
+		double end;
+	};
+
+	/**
+	 * @param a an interval.
+	 * @param r an Allen relation.
+	 * @param b an interval.
+	 * @return true if r(a,b) holds.
+	 */
+	bool holds(const EventInterval &a, AllenRelation r, const EventInterval &b);
+
+	// called for each event found, iteration stops if false is returned
+	using EventVisitor = std::function<bool(const std::string &event, const EventInterval &interval)>;
+
+	/**
+	 * A balanced search tree (a treap) over one endpoint of event intervals.
+	 * Each node is augmented with the minimum and maximum of the other endpoint
+	 * of the events in its subtree, such that subtrees without events whose other endpoint
+	 * is within a given range are skipped.
+	 */
+	class EndpointTree {
+	public:
+		// called for each event found, iteration stops if false is returned
+		using Visitor = std::function<bool(const std::string *event)>;
+
+		EndpointTree() = default;
+
+		EndpointTree(const EndpointTree&) = delete;
+
+		/**
+		 * @param key the endpoint by which the event is sorted.
+		 * @param other the other endpoint of the event.
+		 * @param event the event.
+		 */
+		void insert(double key, double other, const std::string *event);
+
+		/**
+		 * @param key the endpoint by which the event was inserted.
+		 * @param event the event.
+		 */
+		void remove(double key, const std::string *event);
+
+		/**
+		 * Iterate over all events with keyMin <= key <= keyMax and otherMin <= other <= otherMax.
+		 * @return false if the iteration was stopped by the visitor.
+		 */
+		bool visit(double keyMin, double keyMax, double otherMin, double otherMax, const Visitor &visitor) const;
+
+	protected:
+		struct Node {
+			Node(double key, double other, const std::string *event, uint32_t priority)
+			: key(key), other(other), event(event), priority(priority), minOther(other), maxOther(other) {}
+			const double key;
+			const double other;
+			const std::string *event;
+			const uint32_t priority;
+			double minOther;
+			double maxOther;
+			std::unique_ptr<Node> left;
+			std::unique_ptr<Node> right;
+		};
+		using NodePtr = std::unique_ptr<Node>;
+		NodePtr root_;
+		std::minstd_rand priorityGenerator_;
+
+		static bool isLess(const Node &n, double key, const std::string *event);
+
+		static void update(Node &n);
+
+		// splits a tree into nodes before (key,event), and the others, or,
+		// if inclusive is true, into nodes up to (key,event), and the others.
+		static void split(NodePtr n, double key, const std::string *event, bool inclusive,
+		                  NodePtr &lower, NodePtr &upper);
+
+		static NodePtr merge(NodePtr lower, NodePtr upper);
+
+		static bool visit(const Node *n, double keyMin, double keyMax,
+		                  double otherMin, double otherMax, const Visitor &visitor);
+	};
+
+	/**
+	 * An index of event intervals sorted by their endpoints.
+	 * An event related to a given interval is found by a range query over
+	 * one of the endpoint trees, restricted to a range of the other endpoint.
+	 * As the trees skip subtrees without events in the range of the other endpoint,
+	 * each relation is evaluated in O(log n + k log n) expected time where k is the number of results,
+	 * including the containment-type relations DURING, CONTAINS, OVERLAPS and OVERLAPPED_BY.
+	 */
+	class IntervalIndex {
+	public:
+		IntervalIndex() = default;
+
+		IntervalIndex(const IntervalIndex&) = delete;
+
+		/**
+		 * Add an event, or update the interval of an event.
+		 * @param event the event IRI.
+		 * @param interval the time interval of the event.
+		 */
+		void set(std::string_view event, const EventInterval &interval);
+
+		/**
+		 * @param event the event IRI.
+		 * @return true if the event was removed.
+		 */
+		bool remove(std::string_view event);
+
+		/**
+		 * @param event the event IRI.
+		 * @return the time interval of the event if known.
+		 */
+		std::optional<EventInterval> get(std::string_view event) const;
+
+		/**
+		 * @return number of events in the index.
+		 */
+		auto size() const { return intervals_.size(); }
+
+		/**
+		 * @param a an event IRI.
+		 * @param r an Allen relation.
+		 * @param b an event IRI.
+		 * @return true if both events are known and r(a,b) holds.
+		 */
+		bool holds(std::string_view a, AllenRelation r, std::string_view b) const;
+
+		/**
+		 * Iterate over all events b such that r(a,b) holds.
+		 * @param a the time interval of an event.
+		 * @param r an Allen relation.
+		 * @param visitor called for each event b.
+		 * @return false if the iteration was stopped by the visitor.
+		 */
+		bool forEachRelated(const EventInterval &a, AllenRelation r, const EventVisitor &visitor) const;
+
+		/**
+		 * Iterate over all events with a given time interval.
+		 * @param interval a time interval.
+		 * @param visitor called for each event.
+		 * @return false if the iteration was stopped by the visitor.
+		 */
+		bool forEachWithInterval(const EventInterval &interval, const EventVisitor &visitor) const;
+
+		/**
+		 * Iterate over all events in the index.
+		 * @param visitor called for each event.
+		 * @return false if the iteration was stopped by the visitor.
+		 */
+		bool forEach(const EventVisitor &visitor) const;
+
+	protected:
+		std::map<std::string, EventInterval, std::less<>> intervals_;
+		// events sorted by begin and end time, pointing to keys of intervals_
+		EndpointTree begins_;
+		EndpointTree ends_;
+
+		bool visitRange(const EndpointTree &tree, double keyMin, double keyMax, double otherMin, double otherMax,
+		                const EventInterval &a, AllenRelation r, const EventVisitor &visitor) const;
+	};
+}
+
+#endif //KNOWROB_ALLEN_INTERVAL_INDEX_H
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2023, Daniel Beßler
+ * All rights reserved.
+ *
+ * This file is part of KnowRob, please consult
+ * https://github.com/knowrob/knowrob for license details.
+ */
+
+#ifndef KNOWROB_PROLOG_LIST_H_
+#define KNOWROB_PROLOG_LIST_H_
+
+#include <memory>
+#include <vector>
+#include <SWI-Prolog.h>
+#include "knowrob/terms/ListTerm.h"
+
+namespace knowrob {
+	/**
+	 * A ground list read from a Prolog term.
+	 * The list is copied into a flat buffer of cells when an answer is read,
+	 * and its elements are only constructed as Term objects when they are accessed.
+	 * This avoids allocating a Term tree for large lists, e.g. trajectories,
+	 * that are only forwarded by the consumer of an answer.
+	 */
+	class PrologList : public ListTerm {
+	public:
+		/**
+		 * Reads a ground list from a Prolog term.
+		 * Must be called in a thread with an attached Prolog engine.
+		 * @param t a Prolog term.
+		 * @return the list, or a null pointer if t is not a ground proper list.
+		 */
+		static std::shared_ptr<PrologList> read(term_t t);
+
+		/**
+		 * @return the number of elements of this list.
+		 */
+		auto size() const { return numElements_; }
+
+	protected:
+		struct Cell {
+			enum Type {
+				// an atom, string, or top/bottom
+				CONSTANT,
+				LONG,
+				DOUBLE,
+				// a predicate, followed by the cells of its arguments
+				PREDICATE,
+				// a list, followed by the cells of its elements
+				LIST
+			};
+			Type type;
+			// number of arguments of a predicate, or number of elements of a list
+			uint32_t arity = 0;
+			union {
+				long longValue;
+				double doubleValue;
+			};
+			// the constant term, or a string term with the functor of a predicate
+			TermPtr constant;
+		};
+		std::vector<Cell> cells_;
+		size_t numElements_;
+
+		explicit PrologList(size_t numElements);
+
+		bool readCell(term_t t);
+
+		TermPtr construct(size_t &cellIndex) const;
+
+		// Override ListTerm
+		void materialize(std::vector<TermPtr> &elements) const override;
+	};
+}
+
+#endif //KNOWROB_PROLOG_LIST_H_
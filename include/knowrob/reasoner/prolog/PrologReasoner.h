@@ -10,11 +10,13 @@
 #define KNOWROB_PROLOG_REASONER_H_
 
 // STD
+#include <atomic>
 #include <string>
 #include <list>
 #include <filesystem>
 #include <map>
 #include <memory>
+#include <set>
 // gtest
 #include <gtest/gtest.h>
 // KnowRob
@@ -28,6 +30,23 @@
 #include "knowrob/semweb/ImportHierarchy.h"
 
 namespace knowrob {
+    /**
+     * Statistics about the tables of a tabled Prolog predicate.
+     */
+    struct PrologTableStatistics {
+        std::shared_ptr<PredicateIndicator> indicator;
+        // number of call variants with a table
+        uint64_t numTables;
+        // number of answers in all tables
+        uint64_t numAnswers;
+        // number of calls of the predicate
+        uint64_t numCalls;
+        // number of calls for which a table existed already
+        uint64_t numHits;
+        // number of times the tables were invalidated
+        uint64_t numInvalidations;
+    };
+
     /**
      * A Prolog reasoner that answers queries using SWI Prolog.
      */
@@ -173,6 +192,24 @@ namespace knowrob {
 
         auto& importHierarchy() { return importHierarchy_; }
 
+        /**
+         * Declare a predicate as tabled such that its answers are memoized across queries.
+         * Tables are invalidated when statements are asserted into the knowledge base,
+         * and, through incremental tabling, when dynamic predicates it depends on change.
+         * @param indicator the indicator of a predicate defined by this reasoner.
+         * @param dependencies IRIs of properties whose assertion invalidates the tables, if empty any assertion does.
+         * @param dynamicPredicates dynamic predicates the tabled predicate depends on.
+         * @return true on success.
+         */
+        bool tablePredicate(const std::shared_ptr<PredicateIndicator> &indicator,
+                            const std::set<std::string, std::less<>> &dependencies={},
+                            const std::vector<std::shared_ptr<PredicateIndicator>> &dynamicPredicates={});
+
+        /**
+         * @return statistics about the tables of each tabled predicate.
+         */
+        std::vector<PrologTableStatistics> tableStatistics();
+
         // Override LogicProgramReasoner
         bool assertFact(const std::shared_ptr<Predicate> &predicate) override;
 
@@ -192,6 +229,12 @@ namespace knowrob {
         // Override IReasoner
         AnswerBufferPtr submitQuery(const RDFLiteralPtr &literal, int queryFlags) override;
 
+        // Override IReasoner
+        void onInsert(const std::vector<StatementData> &statements) override;
+
+        // Override IReasoner
+        void onRemove(const std::vector<RDFLiteralPtr> &tripleExpressions) override;
+
     protected:
         static bool isPrologInitialized_;
         static bool isKnowRobInitialized_;
@@ -204,13 +247,32 @@ namespace knowrob {
 
         std::mutex request_mutex_;
 
+        struct TabledPredicate {
+            std::shared_ptr<PredicateIndicator> indicator;
+            std::set<std::string, std::less<>> dependencies;
+            std::vector<std::shared_ptr<PredicateIndicator>> dynamicPredicates;
+            std::atomic<uint64_t> numInvalidations{0};
+        };
+        std::vector<std::shared_ptr<TabledPredicate>> tabledPredicates_;
+        std::mutex tableMutex_;
+
+        bool declareTable(const TabledPredicate &tabled);
+
+        /**
+         * Abolish the tables of tabled predicates affected by a change of the knowledge base.
+         * Tables without dependencies are always abolished.
+         * @param isDependency true if a change of the property affects tables that depend on it.
+         */
+        void invalidateTables(const std::function<bool(const std::set<std::string, std::less<>>&)> &isDependency);
+
+        bool loadTableConfiguration(const boost::property_tree::ptree &config);
+
         static void initializeProlog();
         virtual bool initializeGlobalPackages();
 
         virtual bool initializeDefaultPackages() { return true; }
 
-        bool loadDataSourceWithUnknownFormat(const DataSourcePtr &dataFile) override
-        { return consult(dataFile->uri()); };
+        bool loadDataSourceWithUnknownFormat(const DataSourcePtr &dataFile) override;
 
         static PrologThreadPool& threadPool();
 
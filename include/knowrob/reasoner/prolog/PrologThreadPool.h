@@ -9,9 +9,98 @@
 #ifndef KNOWROB_PROLOG_THREAD_POOL_H_
 #define KNOWROB_PROLOG_THREAD_POOL_H_
 
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <SWI-Prolog.h>
 #include "knowrob/ThreadPool.h"
+#include "knowrob/terms/Constant.h"
 
 namespace knowrob {
+	/**
+	 * Atoms, functors and modules interned by the Prolog engine of the current thread.
+	 * Names are interned once per thread such that repeated queries do not need
+	 * to look them up again, and no locking is needed for the lookup.
+	 * Workers of a PrologThreadPool additionally keep a foreign frame open that is
+	 * rewound after each query, releasing all term references created by the query.
+	 */
+	class PrologEngineCache {
+	public:
+		/**
+		 * @return the cache of the calling thread.
+		 */
+		static PrologEngineCache& get();
+
+		/**
+		 * @param name an atom name.
+		 * @return the atom handle.
+		 */
+		atom_t atom(std::string_view name);
+
+		/**
+		 * @param name the name of a functor.
+		 * @param arity the arity of the functor.
+		 * @return the functor handle.
+		 */
+		functor_t functor(std::string_view name, uint32_t arity);
+
+		/**
+		 * @param name a module name.
+		 * @return the module handle.
+		 */
+		module_t module(std::string_view name);
+
+		/**
+		 * Maps an atom to a string term that is shared by all answers
+		 * read in this thread, e.g. such that an IRI appearing in many answers
+		 * is only copied once.
+		 * The atom is registered while it is cached such that it cannot be garbage collected.
+		 * @param atom an atom handle.
+		 * @return the string term of the atom.
+		 */
+		const std::shared_ptr<StringTerm>& stringTerm(atom_t atom);
+
+		/**
+		 * Opens the frame that is rewound after each query evaluated in this thread.
+		 */
+		void openFrame();
+
+		/**
+		 * Discards the frame opened by openFrame().
+		 */
+		void closeFrame();
+
+		/**
+		 * A scope in which term references can be created.
+		 * If the thread has a warm frame that is not used by an enclosing scope,
+		 * it is rewound when the scope ends.
+		 * Otherwise, a new frame is opened and discarded when the scope ends such that
+		 * a nested scope does not release term references of the enclosing scope.
+		 */
+		class FrameScope {
+		public:
+			FrameScope();
+			~FrameScope();
+			FrameScope(const FrameScope&) = delete;
+		protected:
+			fid_t frame_;
+			bool isWarm_;
+		};
+
+	protected:
+		std::map<std::string, atom_t, std::less<>> atoms_;
+		std::map<std::string, module_t, std::less<>> modules_;
+		// functors indexed by arity first to allow lookup with a string_view
+		std::map<uint32_t, std::map<std::string, functor_t, std::less<>>> functors_;
+		std::unordered_map<atom_t, std::shared_ptr<StringTerm>> stringTerms_;
+		fid_t frame_ = (fid_t)0;
+		// true while a FrameScope uses the warm frame
+		bool isFrameInUse_ = false;
+
+		void clearStringTerms();
+	};
+
 	/**
 	 * A pool of threads with attached Prolog engines.
 	 * Prolog threads have their own stacks and only share the Prolog heap:
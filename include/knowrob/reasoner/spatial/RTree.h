@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2023, Daniel Beßler
+ * All rights reserved.
+ *
+ * This file is part of KnowRob, please consult
+ * https://github.com/knowrob/knowrob for license details.
+ */
+
+#ifndef KNOWROB_SPATIAL_RTREE_H
+#define KNOWROB_SPATIAL_RTREE_H
+
+#include <array>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace knowrob::spatial {
+	/**
+	 * An axis-aligned bounding box.
+	 */
+	struct BoundingBox {
+		std::array<double,3> min;
+		std::array<double,3> max;
+
+		/**
+		 * @param center the center of the box.
+		 * @param extents the size of the box along each axis.
+		 * @return the box.
+		 */
+		static BoundingBox fromCenter(const std::array<double,3> &center, const std::array<double,3> &extents);
+
+		/**
+		 * @param margin a distance added on each side of the box.
+		 * @return the enlarged box.
+		 */
+		BoundingBox expand(double margin) const;
+
+		BoundingBox merge(const BoundingBox &other) const;
+
+		bool intersects(const BoundingBox &other) const;
+
+		bool contains(const BoundingBox &other) const;
+
+		double volume() const;
+
+		std::array<double,3> center() const;
+
+		/**
+		 * @param point a point.
+		 * @return the squared distance between the point and the closest point of the box.
+		 */
+		double squaredDistance(const std::array<double,3> &point) const;
+	};
+
+	// called for each object found, iteration stops if false is returned
+	using BoxVisitor = std::function<bool(const std::string &object, const BoundingBox &box)>;
+	// called for each pair of objects found, iteration stops if false is returned
+	using PairVisitor = std::function<bool(const std::string &a, const BoundingBox &boxA,
+	                                       const std::string &b, const BoundingBox &boxB)>;
+	// called for each object in order of increasing distance, iteration stops if false is returned
+	using DistanceVisitor = std::function<bool(const std::string &object, double squaredDistance)>;
+
+	/**
+	 * An R-tree of object bounding boxes.
+	 * Objects are inserted one by one with quadratic node splits.
+	 * Removal does not re-balance the tree, the bounding boxes of ancestor
+	 * nodes are shrunk instead, and empty nodes are pruned.
+	 */
+	class RTree {
+	public:
+		/**
+		 * @param maxEntries the maximum number of entries per node.
+		 */
+		explicit RTree(uint32_t maxEntries=8);
+
+		~RTree();
+
+		RTree(const RTree&) = delete;
+
+		/**
+		 * Add an object, or update the bounding box of an object.
+		 * @param object the object name.
+		 * @param box the bounding box of the object.
+		 */
+		void set(std::string_view object, const BoundingBox &box);
+
+		/**
+		 * @param object the object name.
+		 * @return true if the object was removed.
+		 */
+		bool remove(std::string_view object);
+
+		/**
+		 * @param object the object name.
+		 * @return the bounding box of the object if known.
+		 */
+		std::optional<BoundingBox> get(std::string_view object) const;
+
+		/**
+		 * @return number of objects in the tree.
+		 */
+		auto size() const { return objects_.size(); }
+
+		/**
+		 * Iterate over all objects whose box intersects a box.
+		 * @param box a bounding box.
+		 * @param visitor called for each object.
+		 * @return false if the iteration was stopped by the visitor.
+		 */
+		bool intersecting(const BoundingBox &box, const BoxVisitor &visitor) const;
+
+		/**
+		 * Iterate over all objects whose box is contained in a box.
+		 * @param box a bounding box.
+		 * @param visitor called for each object.
+		 * @return false if the iteration was stopped by the visitor.
+		 */
+		bool containedIn(const BoundingBox &box, const BoxVisitor &visitor) const;
+
+		/**
+		 * Iterate over all objects whose box contains a box.
+		 * @param box a bounding box.
+		 * @param visitor called for each object.
+		 * @return false if the iteration was stopped by the visitor.
+		 */
+		bool containing(const BoundingBox &box, const BoxVisitor &visitor) const;
+
+		/**
+		 * Find the objects closest to a point, in order of increasing distance.
+		 * @param point a point.
+		 * @param k the maximum number of objects.
+		 * @return the names of the closest objects.
+		 */
+		std::vector<std::string> nearest(const std::array<double,3> &point, uint32_t k) const;
+
+		/**
+		 * Iterate over objects in order of increasing distance to a point.
+		 * Nodes are only expanded as far as needed by the visitor.
+		 * @param point a point.
+		 * @param visitor called for each object with its squared distance to the point.
+		 * @return false if the iteration was stopped by the visitor.
+		 */
+		bool nearest(const std::array<double,3> &point, const DistanceVisitor &visitor) const;
+
+		/**
+		 * Iterate over all pairs of distinct objects whose boxes are at most
+		 * `margin` apart along each axis.
+		 * Each pair is visited in both orders.
+		 * @param margin the maximum gap between the boxes.
+		 * @param visitor called for each pair.
+		 * @return false if the iteration was stopped by the visitor.
+		 */
+		bool forEachPair(double margin, const PairVisitor &visitor) const;
+
+		/**
+		 * Iterate over all objects.
+		 * @param visitor called for each object.
+		 * @return false if the iteration was stopped by the visitor.
+		 */
+		bool forEach(const BoxVisitor &visitor) const;
+
+	protected:
+		struct Node;
+		struct Entry {
+			BoundingBox box;
+			// child node of inner nodes
+			std::unique_ptr<Node> child;
+			// object name of leaf entries, points to a key of objects_
+			const std::string *object = nullptr;
+		};
+		struct Node {
+			bool isLeaf = true;
+			Node *parent = nullptr;
+			std::vector<Entry> entries;
+			BoundingBox bounds() const;
+		};
+		struct ObjectData {
+			BoundingBox box;
+			Node *leaf;
+		};
+		const uint32_t maxEntries_;
+		std::unique_ptr<Node> root_;
+		std::map<std::string, ObjectData, std::less<>> objects_;
+
+		Node* chooseLeaf(const BoundingBox &box) const;
+
+		void insert(Node *node, Entry entry);
+
+		void split(Node *node);
+
+		void adjustBounds(Node *node);
+
+		void setParent(Node *node, Entry &entry);
+
+		// visits leaf entries matching matchBox in sub-trees whose bounds match visitNode
+		bool search(const Node *node,
+		            const std::function<bool(const BoundingBox&)> &visitNode,
+		            const std::function<bool(const BoundingBox&)> &matchBox,
+		            const BoxVisitor &visitor) const;
+	};
+}
+
+#endif //KNOWROB_SPATIAL_RTREE_H
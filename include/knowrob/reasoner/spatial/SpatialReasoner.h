@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2023, Daniel Beßler
+ * All rights reserved.
+ *
+ * This file is part of KnowRob, please consult
+ * https://github.com/knowrob/knowrob for license details.
+ */
+
+#ifndef KNOWROB_SPATIAL_REASONER_H
+#define KNOWROB_SPATIAL_REASONER_H
+
+#include <map>
+#include <set>
+#include <shared_mutex>
+#include "knowrob/reasoner/Reasoner.h"
+#include "knowrob/reasoner/spatial/RTree.h"
+
+namespace knowrob::spatial {
+	constexpr std::string_view isInsideOf   = "http://knowrob.org/kb/knowrob.owl#isInsideOf";
+	constexpr std::string_view isOntopOf    = "http://knowrob.org/kb/knowrob.owl#isOntopOf";
+	constexpr std::string_view isAboveOf    = "http://knowrob.org/kb/knowrob.owl#isAboveOf";
+	constexpr std::string_view isBelowOf    = "http://knowrob.org/kb/knowrob.owl#isBelowOf";
+	constexpr std::string_view isInCenterOf = "http://knowrob.org/kb/knowrob.owl#isInCenterOf";
+	constexpr std::string_view hasShape     = "http://www.ease-crc.org/ont/SOMA.owl#hasShape";
+	constexpr std::string_view hasRegion    = "http://www.ontologydesignpatterns.org/ont/dul/DUL.owl#hasRegion";
+	constexpr std::string_view hasDepth     = "http://www.ease-crc.org/ont/SOMA.owl#hasDepth";
+	constexpr std::string_view hasWidth     = "http://www.ease-crc.org/ont/SOMA.owl#hasWidth";
+	constexpr std::string_view hasHeight    = "http://www.ease-crc.org/ont/SOMA.owl#hasHeight";
+	constexpr std::string_view pose         = "http://knowrob.org/kb/knowrob.owl#pose";
+	constexpr std::string_view translation  = "http://knowrob.org/kb/knowrob.owl#translation";
+	// the functor of `nearest(Object, Other)`
+	constexpr std::string_view nearest      = "nearest";
+
+	/**
+	 * The spatial relations evaluated by the SpatialReasoner.
+	 */
+	enum class SpatialRelation {
+		INSIDE_OF,
+		ONTOP_OF,
+		ABOVE_OF,
+		BELOW_OF,
+		IN_CENTER_OF
+	};
+}
+
+namespace knowrob {
+	/**
+	 * A reasoner that evaluates qualitative spatial relations over an R-tree of
+	 * object bounding boxes.
+	 * The boxes are centered at the most recent position of an object relative to
+	 * a reference frame (default "map"), and sized by the depth, width and height of
+	 * the shape region of the object (`soma:hasShape`, `dul:hasRegion`).
+	 * As in the Prolog implementation, the name of the tf frame of an object
+	 * is the local name of its IRI.
+	 * Positions are read from the `knowrob:translation` of the `knowrob:pose` of an object,
+	 * which is taken to be relative to the reference frame, both when the reasoner is
+	 * configured and when such statements are asserted later.
+	 * Positions can further be set through setObjectPose, e.g. by the tf memory.
+	 * The relations are answered for the properties `knowrob:isInsideOf`,
+	 * `knowrob:isOntopOf`, etc., and `nearest(Object, Other)` yields the objects
+	 * closest to Object, which are several if they have the same distance.
+	 * If both arguments are unbound, all candidate pairs are enumerated.
+	 */
+	class SpatialReasoner : public Reasoner {
+	public:
+		explicit SpatialReasoner(std::string reasonerID);
+
+		~SpatialReasoner() override;
+
+		/**
+		 * Set the position of an object in all spatial reasoners that use
+		 * the parent frame as their reference frame.
+		 * @param frame the tf frame of the object.
+		 * @param parentFrame the parent tf frame.
+		 * @param position the position of the object relative to the parent frame.
+		 */
+		static void setObjectPose(const std::string &frame, const std::string &parentFrame,
+		                          const std::array<double,3> &position);
+
+		/**
+		 * Set the position of an object relative to the reference frame.
+		 * @param frame the tf frame of the object.
+		 * @param position the position of the object.
+		 */
+		void setPosition(const std::string &frame, const std::array<double,3> &position);
+
+		/**
+		 * @return the index of object bounding boxes, keys are tf frame names.
+		 */
+		const auto& boxIndex() const { return index_; }
+
+		// Override Reasoner
+		void setDataBackend(const KnowledgeGraphPtr &knowledgeGraph) override;
+
+		// Override Reasoner
+		bool loadConfiguration(const ReasonerConfiguration &cfg) override;
+
+		// Override Reasoner
+		std::shared_ptr<PredicateDescription> getPredicateDescription(
+				const std::shared_ptr<PredicateIndicator> &indicator) override;
+
+		// Override Reasoner
+		unsigned long getCapabilities() const override;
+
+		// Override Reasoner
+		AnswerBufferPtr submitQuery(const RDFLiteralPtr &literal, int queryFlags) override;
+
+		// Override Reasoner
+		void onInsert(const std::vector<StatementData> &statements) override;
+
+	protected:
+		const std::string reasonerID_;
+		KnowledgeGraphPtr knowledgeGraph_;
+		std::string referenceFrame_;
+		spatial::RTree index_;
+		// most recent position of each frame
+		std::map<std::string, std::array<double,3>, std::less<>> positions_;
+		// maps frame names to object IRIs
+		std::map<std::string, std::string, std::less<>> objectOfFrame_;
+		// links from objects to shapes to regions, and region sizes
+		std::map<std::string, std::string, std::less<>> shapeOfObject_;
+		std::map<std::string, std::string, std::less<>> regionOfShape_;
+		std::map<std::string, std::array<double,3>, std::less<>> regionExtents_;
+		// links from objects to poses, and translations of poses
+		std::map<std::string, std::string, std::less<>> poseOfObject_;
+		std::map<std::string, std::array<double,3>, std::less<>> poseTranslations_;
+		mutable std::shared_mutex mutex_;
+
+		void loadObjects();
+
+		void setShape(const std::string &object, const std::string &shape);
+
+		void setRegion(const std::string &shape, const std::string &region);
+
+		void setExtent(const std::string &region, int axis, double value);
+
+		void setPose(const std::string &object, const std::string &pose);
+
+		void setTranslation(const std::string &pose, const std::array<double,3> &position);
+
+		void updateIndex(const std::string &frame);
+
+		std::array<double,3> extentsOf(const std::string &frame) const;
+
+		std::string objectOfFrame(const std::string &frame) const;
+
+		void answerRelation(spatial::SpatialRelation relation, const RDFLiteral &literal,
+		                    int queryFlags, const std::shared_ptr<AnswerStream::Channel> &channel);
+
+		void answerNearest(const RDFLiteral &literal,
+		                   int queryFlags, const std::shared_ptr<AnswerStream::Channel> &channel);
+
+		static const std::map<std::string, spatial::SpatialRelation, std::less<>>& relationProperties();
+	};
+}
+
+#endif //KNOWROB_SPATIAL_REASONER_H
@@ -0,0 +1,289 @@
+/*
+ * Copyright (c) 2023, Daniel Beßler
+ * All rights reserved.
+ *
+ * This file is part of KnowRob, please consult
+ * https://github.com/knowrob/knowrob for license details.
+ */
+
+#ifndef KNOWROB_SWRL_ENGINE_H
+#define KNOWROB_SWRL_ENGINE_H
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <vector>
+#include "knowrob/reasoner/swrl/SWRLRule.h"
+#include "knowrob/semweb/KnowledgeGraph.h"
+#include "knowrob/semweb/Vocabulary.h"
+
+namespace knowrob::swrl {
+	/**
+	 * A fact without temporal or epistemic scope.
+	 * Class atoms are represented as facts with the rdf:type property.
+	 */
+	struct SWRLFact {
+		std::string subject;
+		std::string property;
+		std::string object;
+		RDFType objectType = RDF_RESOURCE;
+
+		bool operator<(const SWRLFact &other) const
+		{
+			return std::tie(subject, property, object, objectType) <
+			       std::tie(other.subject, other.property, other.object, other.objectType);
+		}
+		bool operator==(const SWRLFact &other) const
+		{
+			return subject == other.subject && property == other.property &&
+			       object == other.object && objectType == other.objectType;
+		}
+	};
+
+	/**
+	 * A pattern of facts, each argument is either a constant or a variable that matches any value.
+	 */
+	struct SWRLPattern {
+		SWRLTerm subject;
+		SWRLTerm property;
+		SWRLTerm object;
+	};
+
+	/**
+	 * Records how a fact was inferred.
+	 */
+	struct SWRLDerivation {
+		// the rule that was applied
+		SWRLRulePtr rule;
+		// the facts that matched the body atoms of the rule
+		std::vector<SWRLFact> premises;
+	};
+
+	/**
+	 * The order in which the body atoms of a rule are joined.
+	 */
+	struct SWRLJoinPlan {
+		SWRLRulePtr rule;
+		// index of the body atom that is matched with new facts, or -1 if the rule is evaluated from scratch
+		int seed;
+		// indices of the remaining body atoms in evaluation order
+		std::vector<uint32_t> steps;
+	};
+
+	// a mapping from variable names to constants
+	using SWRLBinding = std::map<std::string, SWRLTerm>;
+	// called for each fact that matches a pattern
+	using SWRLFactVisitor = std::function<void(const SWRLFact &fact)>;
+
+	/**
+	 * A bottom-up SWRL engine.
+	 * Rules are compiled into join plans that order body atoms such that each atom
+	 * is matched with as many bound arguments as possible, and builtins are evaluated
+	 * as soon as their arguments are bound.
+	 * The rules are evaluated semi-naively: each round only joins facts derived in the
+	 * previous round with all other facts, until no new facts are derived.
+	 * Facts inserted later are propagated in the same way such that re-evaluation is incremental.
+	 * The engine remembers a derivation for each inferred fact.
+	 */
+	class SWRLEngine {
+	public:
+		explicit SWRLEngine(semweb::VocabularyPtr vocabulary);
+
+		virtual ~SWRLEngine() = default;
+
+		/**
+		 * Compile a rule into join plans. The rule is not evaluated.
+		 * @param rule a SWRL rule.
+		 * @throws ReasonerError if a variable in the head or in a builtin cannot be bound by the body.
+		 */
+		void addRule(const SWRLRulePtr &rule);
+
+		/**
+		 * @return all rules of this engine.
+		 */
+		const auto& rules() const { return rules_; }
+
+		/**
+		 * @param rule a rule of this engine.
+		 * @return the plan used to evaluate the rule from scratch.
+		 */
+		const SWRLJoinPlan& fullPlan(const SWRLRulePtr &rule) const;
+
+		/**
+		 * @param statement a statement.
+		 * @param fact the fact to be filled.
+		 * @return false if the statement has temporal or epistemic scope.
+		 */
+		static bool toFact(const StatementData &statement, SWRLFact &fact);
+
+		/**
+		 * @param literal a triple expression.
+		 * @return a pattern matching the facts of the triple expression.
+		 */
+		static SWRLPattern toPattern(const RDFLiteral &literal);
+
+		/**
+		 * @param fact a fact.
+		 * @return true if the fact matches a body atom of some rule.
+		 */
+		bool isRelevant(const SWRLFact &fact);
+
+		/**
+		 * Evaluate rules from scratch and propagate the inferred facts through all rules.
+		 * @param rules rules of this engine.
+		 */
+		void evaluate(const std::vector<SWRLRulePtr> &rules);
+
+		/**
+		 * Evaluate all rules from scratch.
+		 */
+		void evaluateAll() { evaluate(rules_); }
+
+		/**
+		 * Infer the consequences of facts that were added to the fact store.
+		 * @param facts the new facts.
+		 */
+		void insert(const std::vector<SWRLFact> &facts);
+
+		/**
+		 * Retract the consequences of facts that were removed from the fact store.
+		 * Inferred facts that were derived from a removed fact are removed as well,
+		 * and rules that infer such facts are evaluated again to re-derive the
+		 * facts that have another derivation.
+		 * @param patterns patterns of the removed facts.
+		 */
+		void remove(const std::vector<SWRLPattern> &patterns);
+
+		/**
+		 * @param fact a fact.
+		 * @return a copy of the derivation of an inferred fact, or nothing if the fact was not inferred by this engine.
+		 */
+		std::optional<SWRLDerivation> provenance(const SWRLFact &fact) const;
+
+		/**
+		 * @return number of facts inferred so far.
+		 */
+		uint64_t numInferred() const { return numInferred_; }
+
+	protected:
+		semweb::VocabularyPtr vocabulary_;
+		std::vector<SWRLRulePtr> rules_;
+		std::map<SWRLRulePtr, SWRLJoinPlan> fullPlans_;
+		// maps class and property IRIs to plans seeded by an atom with that name
+		std::map<std::string, std::vector<SWRLJoinPlan>, std::less<>> seedPlans_;
+		std::map<SWRLFact, SWRLDerivation> inferred_;
+		std::atomic<uint64_t> numInferred_;
+		mutable std::mutex mutex_;
+
+		/**
+		 * Iterate over all facts matching a pattern.
+		 * A fact matches if its property is the property or a sub-property of it,
+		 * and for rdf:type also if its object is the class or a sub-class of it.
+		 * @param subject a constant, or a variable to match any subject.
+		 * @param property the property IRI.
+		 * @param object a constant, or a variable to match any object.
+		 * @param visitor called for each matching fact.
+		 */
+		virtual void match(const SWRLTerm &subject,
+		                   const std::string &property,
+		                   const SWRLTerm &object,
+		                   const SWRLFactVisitor &visitor) = 0;
+
+		/**
+		 * Look up which of the facts are in the fact store.
+		 * The default implementation matches each fact individually.
+		 * @param facts ground facts.
+		 * @param isKnown set to true for each fact that is in the fact store.
+		 */
+		virtual void matchKnown(const std::vector<SWRLFact> &facts, std::vector<bool> &isKnown);
+
+		/**
+		 * @param facts facts to be added to the fact store.
+		 */
+		virtual void insertInferred(const std::vector<SWRLFact> &facts) = 0;
+
+		/**
+		 * @param facts inferred facts to be removed from the fact store.
+		 */
+		virtual void removeInferred(const std::vector<SWRLFact> &facts) = 0;
+
+		bool matches(const SWRLPattern &pattern, const SWRLFact &fact);
+
+		void evaluateRules(const std::vector<SWRLRulePtr> &rules);
+
+		SWRLJoinPlan compilePlan(const SWRLRulePtr &rule, int seed) const;
+
+		void propagate(std::vector<SWRLFact> delta);
+
+		void join(const SWRLJoinPlan &plan, uint32_t stepIndex,
+		          SWRLBinding &binding, std::vector<SWRLFact> &premises,
+		          std::map<SWRLFact, SWRLDerivation> &derived);
+
+		std::vector<SWRLFact> commit(std::map<SWRLFact, SWRLDerivation> &derived);
+
+		void forallSeedNames(const SWRLFact &fact, const std::function<void(const std::string&)> &visitor);
+
+		static bool evaluateBuiltin(const SWRLAtom &atom, SWRLBinding &binding);
+
+		static bool unify(const SWRLAtom &atom, const SWRLFact &fact, SWRLBinding &binding);
+	};
+
+	/**
+	 * A SWRL engine that matches atoms in a knowledge graph, and writes inferred
+	 * facts into its INFERRED_GRAPH named graph.
+	 */
+	class KnowledgeGraphSWRLEngine : public SWRLEngine {
+	public:
+		using InsertHandler = std::function<void(const std::vector<StatementData>&)>;
+		using RemoveHandler = std::function<void(const std::vector<RDFLiteralPtr>&)>;
+
+		static const std::string INFERRED_GRAPH;
+
+		explicit KnowledgeGraphSWRLEngine(const KnowledgeGraphPtr &knowledgeGraph);
+
+		/**
+		 * Set a handler that is called with statements inferred by the engine
+		 * after they were written into the knowledge graph.
+		 * @param handler the handler.
+		 */
+		void setInsertHandler(const InsertHandler &handler) { insertHandler_ = handler; }
+
+		/**
+		 * Set a handler that is called with expressions of inferences
+		 * that were removed from the knowledge graph.
+		 * @param handler the handler.
+		 */
+		void setRemoveHandler(const RemoveHandler &handler) { removeHandler_ = handler; }
+
+	protected:
+		KnowledgeGraphPtr knowledgeGraph_;
+		InsertHandler insertHandler_;
+		RemoveHandler removeHandler_;
+
+		// Override SWRLEngine
+		void match(const SWRLTerm &subject, const std::string &property,
+		           const SWRLTerm &object, const SWRLFactVisitor &visitor) override;
+
+		// Override SWRLEngine
+		void matchKnown(const std::vector<SWRLFact> &facts, std::vector<bool> &isKnown) override;
+
+		// Override SWRLEngine
+		void insertInferred(const std::vector<SWRLFact> &facts) override;
+
+		// Override SWRLEngine
+		void removeInferred(const std::vector<SWRLFact> &facts) override;
+
+		static StatementData toStatement(const SWRLFact &fact);
+
+		AnswerBufferPtr submitMatch(const SWRLTerm &subject, const std::string &property, const SWRLTerm &object);
+
+		void readMatches(const AnswerBufferPtr &answerBuffer,
+		                 const SWRLTerm &subject, const std::string &property,
+		                 const SWRLTerm &object, const SWRLFactVisitor &visitor);
+	};
+}
+
+#endif //KNOWROB_SWRL_ENGINE_H
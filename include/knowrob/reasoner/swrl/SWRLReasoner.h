@@ -11,9 +11,17 @@
 
 // KnowRob
 #include <knowrob/reasoner/prolog/PrologReasoner.h>
+#include <knowrob/reasoner/swrl/SWRLEngine.h>
 
 namespace knowrob {
 
+	/**
+	 * A reasoner that evaluates SWRL rules.
+	 * By default, rules are evaluated top-down in Prolog when a query is submitted.
+	 * If the "bottom-up" setting is true, rules are instead evaluated by a
+	 * SWRLEngine that writes inferred facts into the data backend, and
+	 * that updates its inferences when statements are asserted.
+	 */
 	class SWRLReasoner : public PrologReasoner {
 	public:
 		static const std::string SWRL_FORMAT;
@@ -22,7 +30,33 @@ namespace knowrob {
 
 		bool loadSWRLFile(const DataSourcePtr &dataFile);
 
+		/**
+		 * @return the bottom-up engine, or a null pointer if rules are evaluated top-down.
+		 */
+		const auto& engine() const { return engine_; }
+
+		// Override PrologReasoner
+		bool loadConfiguration(const ReasonerConfiguration &cfg) override;
+
+		// Override PrologReasoner
+		void setDataBackend(const KnowledgeGraphPtr &knowledgeGraph) override;
+
+		// Override PrologReasoner
+		unsigned long getCapabilities() const override;
+
+		// Override Reasoner
+		void onInsert(const std::vector<StatementData> &statements) override;
+
+		// Override Reasoner
+		void onRemove(const std::vector<RDFLiteralPtr> &tripleExpressions) override;
+
 	protected:
+		KnowledgeGraphPtr knowledgeGraph_;
+		std::shared_ptr<swrl::KnowledgeGraphSWRLEngine> engine_;
+
+		// calls the visitor for every other reasoner of the reasoner manager
+		void forOtherReasoners(const std::function<void(Reasoner&)> &visitor);
+
 		// Override PrologReasoner
 		bool initializeDefaultPackages() override;
 	};
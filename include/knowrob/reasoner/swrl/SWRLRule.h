@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2023, Daniel Beßler
+ * All rights reserved.
+ *
+ * This file is part of KnowRob, please consult
+ * https://github.com/knowrob/knowrob for license details.
+ */
+
+#ifndef KNOWROB_SWRL_RULE_H
+#define KNOWROB_SWRL_RULE_H
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "knowrob/semweb/StatementData.h"
+
+namespace knowrob::swrl {
+	/**
+	 * An argument of a SWRL atom, either a variable or a constant.
+	 */
+	struct SWRLTerm {
+		// the variable name without leading "?", or the IRI or lexical form of a constant
+		std::string value;
+		// the type of a constant
+		RDFType type = RDF_RESOURCE;
+		bool isVariable = false;
+
+		static SWRLTerm variable(const std::string &name) { return { name, RDF_RESOURCE, true }; }
+		static SWRLTerm constant(const std::string &value, RDFType type=RDF_RESOURCE) { return { value, type, false }; }
+	};
+
+	/**
+	 * An atom in the body or head of a SWRL rule.
+	 */
+	struct SWRLAtom {
+		enum Type {
+			// C(?x) where C is a class IRI
+			CLASS,
+			// P(?x,?y) where P is a property IRI
+			PROPERTY,
+			// a builtin such as greaterThan(?x,17)
+			BUILTIN
+		};
+		Type type;
+		// the IRI of a class or property, or the name of a builtin
+		std::string name;
+		std::vector<SWRLTerm> args;
+	};
+
+	/**
+	 * A SWRL rule with a conjunctive body and head.
+	 */
+	struct SWRLRule {
+		std::string label;
+		std::vector<SWRLAtom> body;
+		std::vector<SWRLAtom> head;
+	};
+	using SWRLRulePtr = std::shared_ptr<SWRLRule>;
+
+	std::ostream& operator<<(std::ostream &os, const SWRLAtom &atom);
+	std::ostream& operator<<(std::ostream &os, const SWRLRule &rule);
+
+	/**
+	 * @param name a builtin name with or without swrlb prefix.
+	 * @return true if the name refers to a builtin supported by the SWRL engine.
+	 */
+	bool isSWRLBuiltin(const std::string &name);
+
+	/**
+	 * Reads SWRL rules written in the human-readable syntax used by *.swrl files, e.g.:
+	 *
+	 *     :- namespace('http://knowrob.org/kb/swrl_test#').
+	 *     :- { label: 'Driver' }, Person(?p), hasCar(?p,true) -> Driver(?p).
+	 *
+	 * Class expressions with "and", "or" and "value" restrictions are supported
+	 * in the body, a disjunction in the body yields one rule per disjunct.
+	 * Names without prefix are resolved against the current namespace.
+	 */
+	class SWRLParser {
+	public:
+		/**
+		 * @param path path to a *.swrl file.
+		 * @return the rules defined in the file.
+		 * @throws ReasonerError if the file cannot be read or parsed.
+		 */
+		std::vector<SWRLRulePtr> parseFile(const std::string &path);
+
+		/**
+		 * @param text the content of a *.swrl file.
+		 * @return the rules defined in the text.
+		 * @throws ReasonerError if the text cannot be parsed.
+		 */
+		std::vector<SWRLRulePtr> parse(const std::string &text);
+
+	protected:
+		struct ClassExpression;
+		std::string namespace_;
+
+		void parseClause(const std::string &clause, std::vector<SWRLRulePtr> &rules);
+		void parseConjunction(const std::string &text, std::vector<std::vector<SWRLAtom>> &alternatives);
+		void parseAtom(const std::string &text, std::vector<std::vector<SWRLAtom>> &alternatives);
+		SWRLTerm parseTerm(const std::string &text) const;
+		std::string resolve(const std::string &name) const;
+	};
+}
+
+#endif //KNOWROB_SWRL_RULE_H
@@ -27,7 +27,9 @@
 #include <knowrob/askallAction.h>
 #include <knowrob/askoneAction.h>
 #include <knowrob/askincrementalAction.h>
+#include <knowrob/askpagedAction.h>
 #include <knowrob/tellAction.h>
+#include <knowrob/explainAction.h>
 #include <actionlib/server/simple_action_server.h>
 
 namespace knowrob {
@@ -39,7 +41,9 @@ namespace knowrob {
         actionlib::SimpleActionServer <askallAction> askall_action_server_;
         actionlib::SimpleActionServer <askoneAction> askone_action_server_;
         actionlib::SimpleActionServer <askincrementalAction> askincremental_action_server_;
+        actionlib::SimpleActionServer <askpagedAction> askpaged_action_server_;
         actionlib::SimpleActionServer <tellAction> tell_action_server_;
+        actionlib::SimpleActionServer <explainAction> explain_action_server_;
         KnowledgeBase kb_;
     public:
         explicit ROSInterface(const boost::property_tree::ptree& ptree);
@@ -52,13 +56,20 @@ namespace knowrob {
 
         void executeAskIncrementalCB(const askincrementalGoalConstPtr &goal);
 
+        void executeAskPagedCB(const askpagedGoalConstPtr &goal);
+
         void executeTellCB(const tellGoalConstPtr &goal);
 
+        void executeExplainCB(const explainGoalConstPtr &goal);
+
         static FormulaPtr
         applyModality(const GraphQueryMessage &query,
                       FormulaPtr ptr);
 
         GraphAnswerMessage createGraphAnswer(std::shared_ptr<const Answer> sharedPtr);
+
+        static std::vector<RDFLiteralPtr>
+        readStatements(const GraphQueryMessage &query);
     };
 }
 
@@ -84,6 +84,11 @@ protected:
 	int buffer_index_;
 
 	void loadTF_internal(tf::tfMessage &tf_msg, int buffer_index);
+
+	/**
+	 * Forward the position of a frame to the spatial reasoners.
+	 */
+	void update_spatial_index(const geometry_msgs::TransformStamped &ts);
 };
 
 #endif //__KNOWROB_TF_MEMORY__
@@ -0,0 +1,96 @@
+//
+// Created by daniel on 18.10.26.
+//
+
+#ifndef KNOWROB_SEMWEB_GROUP_COMMIT_WRITER_H
+#define KNOWROB_SEMWEB_GROUP_COMMIT_WRITER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "knowrob/semweb/StatementData.h"
+
+namespace knowrob::semweb {
+    // writes a batch of statements, and returns true on success
+    using CommitFunction = std::function<bool(const std::vector<StatementData> &statements)>;
+
+    /**
+     * Coalesces concurrent writes into batches that are committed together.
+     * Once a write arrives, the writer waits for a short window during which
+     * further writes are added to the same batch, and then commits the batch
+     * in a single call of the commit function.
+     * Each write receives a future that becomes ready once its batch
+     * was committed, and that holds the exception if the commit failed.
+     * Note that the strings referred to by statements are not copied, so
+     * they must be kept alive until the future of the write is ready.
+     */
+    class GroupCommitWriter {
+    public:
+        /**
+         * @param commit a function that commits a batch of statements.
+         * @param window the maximum time a write waits for other writes to join its batch.
+         * @param maxBatchSize a batch is committed without waiting for the window to elapse once it has this many statements.
+         */
+        GroupCommitWriter(CommitFunction commit,
+                          std::chrono::microseconds window,
+                          uint32_t maxBatchSize);
+
+        GroupCommitWriter(const GroupCommitWriter&) = delete;
+
+        /**
+         * Commits pending writes, and stops the commit thread.
+         */
+        ~GroupCommitWriter();
+
+        /**
+         * Add statements to the next batch.
+         * @param statements a list of statements.
+         * @return a future that is ready once the statements were committed.
+         */
+        std::future<bool> write(const std::vector<StatementData> &statements);
+
+        /**
+         * Commits pending writes without waiting for the window to elapse,
+         * and blocks until all writes added before the call were committed.
+         */
+        void flush();
+
+        /**
+         * @return the number of batches committed so far.
+         */
+        uint64_t numCommits() const { return numCommits_; }
+
+    protected:
+        struct PendingWrite {
+            std::vector<StatementData> statements;
+            std::promise<bool> promise;
+        };
+        const CommitFunction commit_;
+        const std::chrono::microseconds window_;
+        const uint32_t maxBatchSize_;
+
+        std::vector<PendingWrite> pending_;
+        uint32_t numPendingStatements_;
+        // the number of writes added and committed so far
+        uint64_t numWrites_;
+        uint64_t numCommittedWrites_;
+        bool hasFlushRequest_;
+        std::mutex mutex_;
+        std::condition_variable pendingCV_;
+        std::condition_variable committedCV_;
+        std::atomic<bool> isTerminated_;
+        std::atomic<uint64_t> numCommits_;
+        std::thread thread_;
+
+        void run();
+
+        void commit(std::vector<PendingWrite> &batch);
+    };
+}
+
+#endif //KNOWROB_SEMWEB_GROUP_COMMIT_WRITER_H
@@ -12,6 +12,7 @@
 #include "knowrob/formulas/Literal.h"
 #include "knowrob/queries/AnswerBuffer.h"
 #include "knowrob/queries/GraphQuery.h"
+#include "knowrob/queries/QueryProfile.h"
 #include "knowrob/semweb/Vocabulary.h"
 #include "knowrob/semweb/RDFLiteral.h"
 #include "knowrob/semweb/StatementData.h"
@@ -132,6 +133,23 @@ namespace knowrob {
          */
         virtual void removeOne(const RDFLiteral &tripleExpression) = 0;
 
+        /**
+         * Delete all statements matching any of the expressions from this KG.
+         * The default implementation removes statements of one expression at a time.
+         * @param tripleExpressions expressions used to match statements in the KG.
+         */
+        virtual void remove(const std::vector<RDFLiteralPtr> &tripleExpressions);
+
+        /**
+         * Delete all statements matching any of the expressions, and add new assertions.
+         * Statements are deleted before the new assertions are added.
+         * @param tripleExpressions expressions used to match statements in the KG.
+         * @param tripleData data representing atomic propositions.
+         * @return true on success
+         */
+        virtual bool replace(const std::vector<RDFLiteralPtr> &tripleExpressions,
+                             const std::vector<StatementData> &tripleData);
+
         /**
          * Submits a graph query to this knowledge graph.
          * The query is evaluated concurrently, and evaluation may still be active
@@ -139,13 +157,15 @@ namespace knowrob {
          * The function returns a stream of solutions, the end of the stream is indicated
          * by an EOS message.
          * @param query a graph query
+         * @param profile optional stage profile, the CPU time of the evaluating thread is added to it.
          * @return a stream with answers to the query
          */
-        AnswerBufferPtr submitQuery(const GraphQueryPtr &query);
+        AnswerBufferPtr submitQuery(const GraphQueryPtr &query, const StageProfilePtr &profile={});
 
         /**
          * Evaluates a query and may block until evaluation completed.
          * All results will be written into the provided stream object.
+         * Limit and offset of the query are expected to be applied by the knowledge graph.
          * @param query a query.
          * @param resultStream a stream of answers.
          */
@@ -158,6 +178,14 @@ namespace knowrob {
          */
         virtual AnswerBufferPtr watchQuery(const GraphQueryPtr &query) = 0;
 
+        /**
+         * Describe how a query would be evaluated by this knowledge graph
+         * without evaluating it.
+         * @param query a graph query
+         * @return a backend specific description of the query, or an empty string if not supported.
+         */
+        virtual std::string explainQuery(const GraphQueryPtr &query) { return {}; }
+
         //virtual bool unwatchQuery(const BufferedAnswerStreamPtr &queryStream) = 0;
 
         /**
@@ -0,0 +1,170 @@
+//
+// Created by daniel on 18.10.23.
+//
+
+#ifndef KNOWROB_SEMWEB_MATERIALIZER_H
+#define KNOWROB_SEMWEB_MATERIALIZER_H
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "knowrob/semweb/StatementData.h"
+#include "knowrob/semweb/Vocabulary.h"
+
+namespace knowrob::semweb {
+    /**
+     * A triple without temporal or epistemic scope whose object is a resource.
+     */
+    struct Triple {
+        std::string subject;
+        std::string predicate;
+        std::string object;
+
+        bool operator<(const Triple &other) const
+        {
+            return std::tie(subject, predicate, object) <
+                   std::tie(other.subject, other.predicate, other.object);
+        }
+        bool operator==(const Triple &other) const
+        {
+            return subject == other.subject && predicate == other.predicate && object == other.object;
+        }
+    };
+
+    // called for each triple that matches a pattern
+    using TripleVisitor = std::function<void(const Triple &triple, bool isDerived)>;
+
+    /**
+     * Materializes RDFS/OWL-RL entailments of a knowledge graph.
+     * The following rules are applied, where P is a property defined in the vocabulary:
+     * - (x P y), (y P z) -> (x P z)   if P is transitive
+     * - (x P y) -> (y P x)            if P is symmetric
+     * - (x P y) -> (y Q x)            if Q is the inverse of P
+     * - (x P y) -> (x rdf:type C)     if C is a domain of P
+     * - (x P y) -> (y rdf:type C)     if C is a range of P
+     * Class and property subsumption is not materialized as it is handled by the
+     * knowledge graph itself.
+     * Derived triples are maintained incrementally: consequences of inserted triples are
+     * computed semi-naively, and removals are handled with the delete-rederive (DRed)
+     * algorithm, i.e. all consequences of removed triples are deleted first,
+     * and then the ones that have an alternative derivation are re-derived.
+     * Statements with temporal or epistemic scope are not considered.
+     * Removal of schema axioms (e.g. a property being transitive) is not supported.
+     */
+    class Materializer {
+    public:
+        explicit Materializer(VocabularyPtr vocabulary);
+
+        virtual ~Materializer() = default;
+
+        /**
+         * @param statement a statement.
+         * @return true if the statement has no temporal or epistemic scope, and a resource as object.
+         */
+        static bool isMaterializable(const StatementData &statement);
+
+        /**
+         * @param property a property IRI.
+         * @return true if any rule applies to triples with the property.
+         */
+        bool hasRules(const std::string_view &property) const;
+
+        /**
+         * @param triple a triple.
+         * @return true if the triple has consequences, or if it is an axiom that adds rules.
+         */
+        bool isRelevant(const Triple &triple) const;
+
+        /**
+         * Derive the consequences of triples that were inserted into the knowledge graph.
+         * @param insertedTriples a list of triples that were asserted.
+         */
+        void insert(const std::vector<Triple> &insertedTriples);
+
+        /**
+         * Maintain derived triples after triples were removed from the knowledge graph.
+         * @param removedTriples a list of triples that were retracted.
+         */
+        void remove(const std::vector<Triple> &removedTriples);
+
+        /**
+         * Drop all derived triples, and derive consequences of all triples in the knowledge graph.
+         */
+        void materializeAll();
+
+        /**
+         * @return number of derived triples that were added so far.
+         */
+        uint64_t numDerived() const { return numDerived_; }
+
+        /**
+         * @return number of derived triples that were deleted so far.
+         */
+        uint64_t numDeleted() const { return numDeleted_; }
+
+    protected:
+        VocabularyPtr vocabulary_;
+        std::atomic<uint64_t> numDerived_;
+        std::atomic<uint64_t> numDeleted_;
+        std::mutex mutex_;
+
+        /**
+         * Iterate over all triples matching a pattern, including derived ones.
+         * A triple matches the predicate if its predicate is the predicate or a sub-property of it.
+         * @param subject the subject, or nullptr to match any subject.
+         * @param predicate the predicate.
+         * @param object the object, or nullptr to match any object.
+         * @param visitor called for each matching triple.
+         */
+        virtual void match(const std::string *subject,
+                           const std::string &predicate,
+                           const std::string *object,
+                           const TripleVisitor &visitor) = 0;
+
+        /**
+         * @param triples triples to be stored as derived.
+         */
+        virtual void insertDerived(const std::vector<Triple> &triples) = 0;
+
+        /**
+         * @param triples derived triples to be deleted.
+         */
+        virtual void removeDerived(const std::vector<Triple> &triples) = 0;
+
+        /**
+         * Delete all derived triples.
+         */
+        virtual void removeAllDerived() = 0;
+
+        // an in-memory index of triples that are not (or no longer) stored
+        struct TripleIndex {
+            std::set<Triple> triples;
+            std::map<std::pair<std::string,std::string>, std::vector<std::string>> bySubject;
+            std::map<std::pair<std::string,std::string>, std::vector<std::string>> byObject;
+            bool add(const Triple &triple, Vocabulary &vocabulary);
+        };
+
+        void consequences(const Triple &triple, const TripleIndex &index, std::vector<Triple> &out);
+
+        bool hasDerivation(const Triple &triple);
+
+        void derive(const std::vector<Triple> &delta);
+
+        static bool isSchemaAxiom(const Triple &triple);
+
+        void addSchemaChanges(const std::vector<Triple> &triples, std::vector<Triple> &delta);
+
+        void matchAll(const std::string_view &property, std::vector<Triple> &out);
+
+        bool contains(const Triple &triple, bool *isDerivedOnly=nullptr);
+    };
+
+    using MaterializerPtr = std::shared_ptr<Materializer>;
+}
+
+#endif //KNOWROB_SEMWEB_MATERIALIZER_H
@@ -9,12 +9,15 @@
 #include <map>
 #include <functional>
 #include <optional>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
 
 namespace knowrob::semweb {
-    using OptionalStringRef = std::optional<std::reference_wrapper<const std::string>>;
-
     /**
      * Stores short names of IRI prefixes.
+     * The registry may be accessed concurrently, e.g. by reasoners
+     * that register namespaces while they are configured in parallel.
      */
     class PrefixRegistry {
     public:
@@ -36,14 +39,14 @@ namespace knowrob::semweb {
 		 * @param uri a URI
 		 * @return an alias, or nullopt if no alias is known.
 		 */
-        OptionalStringRef uriToAlias(const std::string &uri) const;
+        std::optional<std::string> uriToAlias(const std::string &uri) const;
 
 		/**
 		 * Maps alias to URI.
 		 * @param alias a URI alias
 		 * @return the corresponding URI, or nullopt if alias is unknown.
 		 */
-        OptionalStringRef aliasToUri(const std::string &alias) const;
+        std::optional<std::string> aliasToUri(const std::string &alias) const;
 
         /**
          * Construct a full IRI from alias and entity name.
@@ -60,22 +63,13 @@ namespace knowrob::semweb {
         std::vector<std::string_view> getAliasesWithPrefix(const std::string &prefix) const;
 
 		/**
-		 * An iterator of the registry map.
-		 */
-        using Iterator = std::map<std::string, std::string>::iterator;
-
-		/**
-		 * @return begin iterator over the registry map.
-		 */
-        Iterator begin() { return uriToAlias_.begin(); }
-
-		/**
-		 * @return end iterator over the registry map.
+		 * @return a copy of the map from URIs to aliases.
 		 */
-        Iterator end() { return uriToAlias_.end(); }
+        std::map<std::string, std::string> uriToAliasMap() const;
     private:
         PrefixRegistry();
 
+        mutable std::shared_mutex mutex_;
         std::map<std::string, std::string> uriToAlias_;
         std::map<std::string, std::string, std::less<>> aliasToURI_;
     };
@@ -9,6 +9,7 @@
 #include <list>
 #include <functional>
 #include "Resource.h"
+#include "Class.h"
 
 namespace knowrob::semweb {
     /**
@@ -57,6 +58,26 @@ namespace knowrob::semweb {
          */
         const auto& inverse() const { return inverse_; }
 
+        /**
+         * @param domain a class that is the domain of this property.
+         */
+        void addDomain(const std::shared_ptr<Class> &domain);
+
+        /**
+         * @return all classes that are declared as domain of this property.
+         */
+        const auto& domains() const { return domains_; }
+
+        /**
+         * @param range a class that is the range of this property.
+         */
+        void addRange(const std::shared_ptr<Class> &range);
+
+        /**
+         * @return all classes that are declared as range of this property.
+         */
+        const auto& ranges() const { return ranges_; }
+
         /**
          * @param flag a property flag.
          * @return true if this property has the flag.
@@ -74,6 +95,8 @@ namespace knowrob::semweb {
     protected:
         std::shared_ptr<Property> inverse_;
         std::list<std::shared_ptr<Property>> directParents_;
+        std::list<std::shared_ptr<Class>> domains_;
+        std::list<std::shared_ptr<Class>> ranges_;
         int flags_;
     };
 
@@ -104,6 +104,20 @@ namespace knowrob::semweb {
          */
         void setInverseOf(const std::string_view &a, const std::string_view &b);
 
+        /**
+         * Define the domain of a property.
+         * @param property a property IRI
+         * @param domain a class IRI
+         */
+        void addPropertyDomain(const std::string_view &property, const std::string_view &domain);
+
+        /**
+         * Define the range of a property.
+         * @param property a property IRI
+         * @param range a class IRI
+         */
+        void addPropertyRange(const std::string_view &property, const std::string_view &range);
+
         /**
          * @param iri a property IRI
          * @param flag a property flag
@@ -15,6 +15,8 @@ namespace knowrob::semweb {
         constexpr std::string_view comment           = "http://www.w3.org/2000/01/rdf-schema#comment";
         constexpr std::string_view seeAlso           = "http://www.w3.org/2000/01/rdf-schema#seeAlso";
         constexpr std::string_view label             = "http://www.w3.org/2000/01/rdf-schema#label";
+        constexpr std::string_view domain            = "http://www.w3.org/2000/01/rdf-schema#domain";
+        constexpr std::string_view range             = "http://www.w3.org/2000/01/rdf-schema#range";
     }
 
     /**
@@ -28,6 +30,18 @@ namespace knowrob::semweb {
      * @return true if iri=rdfs:'subPropertyOf'
      */
     bool isSubPropertyOfIRI(std::string_view iri);
+
+    /**
+     * @param iri the IRI of a RDF resource
+     * @return true if iri=rdfs:'domain'
+     */
+    bool isDomainIRI(std::string_view iri);
+
+    /**
+     * @param iri the IRI of a RDF resource
+     * @return true if iri=rdfs:'range'
+     */
+    bool isRangeIRI(std::string_view iri);
 } // knowrob::semweb
 
 #endif //KNOWROB_SEMWEB_RDFS_H
@@ -11,6 +11,7 @@
 
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <ostream>
 #include "Term.h"
 
@@ -37,17 +38,17 @@ namespace knowrob {
 		 * Get the elements of this list.
 		 * @return a vector of list elements.
 		 */
-		const std::vector<TermPtr>& elements() const { return elements_; }
+		const std::vector<TermPtr>& elements() const;
 
 		/**
 		 * @return an iterator ovr the elements of this list.
 		 */
-		std::vector<TermPtr>::const_iterator begin() { return elements_.begin(); }
+		std::vector<TermPtr>::const_iterator begin() { return elements().begin(); }
 
 		/**
 		 * @return the iterator object indicating the end of iteration.
 		 */
-		std::vector<TermPtr>::const_iterator end()   { return elements_.end(); }
+		std::vector<TermPtr>::const_iterator end()   { return elements().end(); }
 		
 		// Override Term
 		bool isGround() const override { return variables_.empty(); }
@@ -65,8 +66,25 @@ namespace knowrob {
         size_t computeHash() const override;
 	
 	protected:
-		const std::vector<TermPtr> elements_;
+		mutable std::vector<TermPtr> elements_;
 		const VariableSet variables_;
+		const bool isLazy_;
+		const std::size_t numLazyElements_;
+		mutable std::once_flag materializeFlag_;
+
+		/**
+		 * Constructs a ground list whose elements are only created
+		 * by materialize() when they are accessed the first time.
+		 * @param numElements the number of elements of the list.
+		 * @param isLazy true if elements are created by materialize().
+		 */
+		ListTerm(std::size_t numElements, bool isLazy);
+
+		/**
+		 * Creates the elements of a lazy list.
+		 * @param elements the vector to fill.
+		 */
+		virtual void materialize(std::vector<TermPtr>&) const {}
 
 		VariableSet getVariables1() const;
 		// Override Term
@@ -6,10 +6,18 @@
  * https://github.com/knowrob/knowrob for license details.
  */
 
+#include <gtest/gtest.h>
 #include <thread>
 #include <utility>
+#include <sstream>
+#include <chrono>
+#include <iomanip>
+#include <set>
+#include <boost/property_tree/json_parser.hpp>
 
 #include <knowrob/Logger.h>
+#include <knowrob/Metrics.h>
+#include <knowrob/Tracing.h>
 #include <knowrob/KnowledgeBase.h>
 #include "knowrob/semweb/PrefixRegistry.h"
 #include "knowrob/queries/QueryParser.h"
@@ -17,6 +25,12 @@
 #include "knowrob/queries/AnswerCombiner.h"
 #include "knowrob/queries/IDBStage.h"
 #include "knowrob/queries/EDBStage.h"
+#include "knowrob/queries/AnswerSlice.h"
+#include "knowrob/queries/AnswerAggregator.h"
+#include "knowrob/queries/BuiltinStage.h"
+#include "knowrob/reasoner/spatial/SpatialReasoner.h"
+#include "knowrob/mongodb/MongoKnowledgeGraph.h"
+#include "knowrob/semweb/rdf.h"
 
 using namespace knowrob;
 
@@ -77,15 +91,93 @@ namespace knowrob
 
     class AnswerBuffer_WithReference : public AnswerBuffer {
     public:
-        explicit AnswerBuffer_WithReference(const std::shared_ptr<QueryPipeline> &pipeline)
-        : AnswerBuffer(), pipeline_(pipeline) {}
+        explicit AnswerBuffer_WithReference(const std::shared_ptr<QueryPipeline> &pipeline,
+                                            MetricsHistogram *latency=nullptr,
+                                            uint64_t queryID=0)
+        : AnswerBuffer(), pipeline_(pipeline), latency_(latency), queryID_(queryID),
+          submitTimeNs_(Tracer::now()) {}
     protected:
         std::shared_ptr<QueryPipeline> pipeline_;
+        // records the time between submission of the query and EOS
+        MetricsHistogram *latency_;
+        // the ID of a query whose completion is reported to the tracer
+        const uint64_t queryID_;
+        const int64_t submitTimeNs_;
+
+        void push(const AnswerPtr &msg) override {
+            if(AnswerStream::isEOS(msg)) {
+                auto eosTimeNs = Tracer::now();
+                if(latency_) latency_->record(eosTimeNs - submitTimeNs_);
+                if(queryID_) Tracer::queryCompleted(queryID_, submitTimeNs_, eosTimeNs);
+            }
+            AnswerBuffer::push(msg);
+        }
+    };
+
+    // counts the answers of a stage that is not a QueryStage, and marks its end at EOS
+    class AnswerBuffer_WithProfile : public AnswerBuffer {
+    public:
+        explicit AnswerBuffer_WithProfile(StageProfilePtr profile)
+        : AnswerBuffer(), profile_(std::move(profile)) {}
+    protected:
+        StageProfilePtr profile_;
+
+        void push(const AnswerPtr &msg) override {
+            if(AnswerStream::isEOS(msg)) profile_->end();
+            else profile_->numAnswersOut += 1;
+            AnswerBuffer::push(msg);
+        }
+    };
+
+    // loads a component at startup in a worker thread
+    class StartupRunner : public ThreadPool::Runner {
+    public:
+        explicit StartupRunner(std::function<void()> load)
+        : ThreadPool::Runner(), load_(std::move(load)) {}
+        void run() override { load_(); }
+    protected:
+        std::function<void()> load_;
+    };
+
+    // writes statements into one knowledge graph in a worker thread
+    // closes a pipeline in a worker thread, as its stages may be locked by the thread that requests closing
+    class QueryPipelineCloseRunner : public ThreadPool::Runner {
+    public:
+        explicit QueryPipelineCloseRunner(std::weak_ptr<QueryPipeline> pipeline)
+        : ThreadPool::Runner(), pipeline_(std::move(pipeline)) {}
+        void run() override {
+            auto pipeline = pipeline_.lock();
+            if(pipeline) pipeline->close();
+        }
+    protected:
+        std::weak_ptr<QueryPipeline> pipeline_;
+    };
+
+    class KnowledgeGraphWriteRunner : public ThreadPool::Runner {
+    public:
+        KnowledgeGraphWriteRunner(std::shared_ptr<KnowledgeGraph> kg, const std::vector<StatementData> &statements)
+        : ThreadPool::Runner(), kg_(std::move(kg)), statements_(statements), status_(false) {}
+        void run() override {
+            try {
+                status_ = kg_->insert(statements_);
+            }
+            catch(...) {
+                error_ = std::current_exception();
+            }
+        }
+        bool status() const { return status_; }
+        const auto& error() const { return error_; }
+    protected:
+        std::shared_ptr<KnowledgeGraph> kg_;
+        const std::vector<StatementData> &statements_;
+        bool status_;
+        std::exception_ptr error_;
     };
 }
 
 KnowledgeBase::KnowledgeBase(const boost::property_tree::ptree &config)
-: threadPool_(std::make_shared<ThreadPool>(std::thread::hardware_concurrency()))
+: threadPool_(std::make_shared<ThreadPool>(std::thread::hardware_concurrency())),
+  isParallelStartup_(true)
 {
 	backendManager_ = std::make_shared<KnowledgeGraphManager>(threadPool_);
 	reasonerManager_ = std::make_shared<ReasonerManager>(threadPool_, backendManager_);
@@ -94,6 +186,15 @@ KnowledgeBase::KnowledgeBase(const boost::property_tree::ptree &config)
 
 void KnowledgeBase::loadConfiguration(const boost::property_tree::ptree &config)
 {
+    auto metricsTree = config.get_child_optional("metrics");
+    if(metricsTree) {
+        Metrics::loadConfiguration(metricsTree.value());
+    }
+    auto tracingTree = config.get_child_optional("tracing");
+    if(tracingTree) {
+        Tracer::loadConfiguration(tracingTree.value());
+    }
+
     auto semwebTree = config.get_child_optional("semantic-web");
     if(semwebTree) {
         // load RDF URI aliases
@@ -110,16 +211,29 @@ void KnowledgeBase::loadConfiguration(const boost::property_tree::ptree &config)
         }
     }
 
+    // optionally coalesce concurrent assertions into one write per knowledge graph
+    auto groupCommitTree = config.get_child_optional("group-commit");
+    if(groupCommitTree) {
+        auto window = std::chrono::microseconds(groupCommitTree.value().get<uint32_t>("window-us", 1000));
+        auto maxBatchSize = groupCommitTree.value().get<uint32_t>("max-batch-size", 1000);
+        groupCommitWriter_ = std::make_shared<semweb::GroupCommitWriter>(
+            [this](const std::vector<StatementData> &statements) { return commitStatements(statements); },
+            window, maxBatchSize);
+    }
+
+    // components are loaded in the order backends, reasoners, data sources.
+    // independent reasoners and data sources are loaded concurrently.
+    isParallelStartup_ = config.get("startup.parallel", true);
+    auto startupBegin = std::chrono::steady_clock::now();
+
     // initialize RDF data backends from configuration
 	auto backendList = config.get_child_optional("data-backends");
 	if(backendList) {
 		for(const auto &pair : backendList.value()) {
-			try {
-                backendManager_->loadKnowledgeGraph(pair.second);
-			}
-			catch(std::exception& e) {
-				KB_ERROR("failed to load a knowledgeGraph: {}", e.what());
-			}
+			runStartupTask({
+				"data-backend " + pair.second.get("name", std::string()),
+				[this,&pair]{ backendManager_->loadKnowledgeGraph(pair.second); }
+			});
 		}
 	}
 	else {
@@ -128,14 +242,35 @@ void KnowledgeBase::loadConfiguration(const boost::property_tree::ptree &config)
 
 	auto reasonerList = config.get_child_optional("reasoner");
 	if(reasonerList) {
+		// reasoners of the same type may share global state that is initialized
+		// when the first of them is configured, e.g. the Prolog engine.
+		// so the first reasoner of each type is configured in this thread,
+		// and the others concurrently afterwards.
+		std::set<std::string> configuredTypes;
+		std::vector<StartupTask> reasonerTasks;
 		for(const auto &pair : reasonerList.value()) {
+			auto &reasonerConfig = pair.second;
+			std::shared_ptr<DefinedReasoner> reasoner;
 			try {
-				reasonerManager_->loadReasoner(pair.second);
+				reasoner = reasonerManager_->createReasoner(reasonerConfig);
 			}
 			catch(std::exception& e) {
 				KB_ERROR("failed to load a reasoner: {}", e.what());
+				continue;
+			}
+			StartupTask task = {
+				"reasoner " + reasoner->name(),
+				[this,reasoner,&reasonerConfig]{ reasonerManager_->configureReasoner(reasoner, reasonerConfig); }
+			};
+			auto reasonerType = reasonerConfig.get("type", reasonerConfig.get("lib", std::string()));
+			if(configuredTypes.insert(reasonerType).second) {
+				runStartupTask(task);
+			}
+			else {
+				reasonerTasks.push_back(task);
 			}
 		}
+		runStartupTasks(reasonerTasks);
 	}
 	else {
 		KB_ERROR("configuration has no 'reasoner' key.");
@@ -145,18 +280,84 @@ void KnowledgeBase::loadConfiguration(const boost::property_tree::ptree &config)
 	if(dataSourcesList) {
 	    static const std::string formatDefault = {};
 
+	    std::vector<std::shared_ptr<DataSource>> dataSources;
 		for(const auto &pair : dataSourcesList.value()) {
 			auto &subtree = pair.second;
 			auto dataFormat = subtree.get("format",formatDefault);
 			auto source = std::make_shared<DataSource>(dataFormat);
 			source->loadSettings(subtree);
+			dataSources.push_back(source);
+        }
+		// the data sources are loaded into different knowledge graphs concurrently
+		std::vector<StartupTask> dataSourceTasks;
+		for(auto &kg_pair : backendManager_->knowledgeGraphPool()) {
+			auto kg = kg_pair.second->knowledgeGraph();
+			dataSourceTasks.push_back({
+				"data-sources of " + kg_pair.first,
+				[kg,dataSources]{
+					for(auto &source : dataSources) {
+					    // FIXME: handle format specified in settings file
+					    kg->loadFile(source->uri(), TripleFormat::RDF_XML);
+					}
+				}
+			});
+		}
+		runStartupTasks(dataSourceTasks);
+    }
 
-			for(auto &kg_pair : backendManager_->knowledgeGraphPool()) {
-			    // FIXME: handle format specified in settings file
-			    kg_pair.second->knowledgeGraph()->loadFile(source->uri(), TripleFormat::RDF_XML);
-			}
+    static auto &startupTime = Metrics::get().gauge(
+            "knowrob_startup_milliseconds", "Time needed to load the knowledge base configuration.");
+    auto startupDuration = std::chrono::duration<double>(std::chrono::steady_clock::now() - startupBegin);
+    startupTime.set(static_cast<int64_t>(startupDuration.count() * 1000.0));
+    {
+        std::lock_guard<std::mutex> lock(startupMutex_);
+        std::stringstream ss;
+        for(auto &pair : startupTimes_) {
+            ss << "\n  " << pair.first << ": " << std::fixed << std::setprecision(3) << pair.second << "s";
         }
+        KB_INFO("Knowledge base startup took {:.3f}s:{}", startupDuration.count(), ss.str());
+    }
+}
+
+void KnowledgeBase::runStartupTask(const StartupTask &task)
+{
+    auto begin = std::chrono::steady_clock::now();
+    try {
+        task.load();
+    }
+    catch(std::exception& e) {
+        KB_ERROR("failed to load {}: {}", task.name, e.what());
+    }
+    auto duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    KB_DEBUG("Loaded {} in {:.3f}s.", task.name, duration);
+    std::lock_guard<std::mutex> lock(startupMutex_);
+    startupTimes_.emplace_back(task.name, duration);
+}
+
+void KnowledgeBase::runStartupTasks(const std::vector<StartupTask> &tasks)
+{
+    if(!isParallelStartup_ || tasks.size() < 2) {
+        for(auto &task : tasks) runStartupTask(task);
+        return;
+    }
+    // note: a dedicated pool is used such that components can submit work
+    //       to the thread pool of the knowledge base while being loaded.
+    ThreadPool startupPool(std::min<uint32_t>(tasks.size(), std::thread::hardware_concurrency()));
+    std::vector<std::shared_ptr<ThreadPool::Runner>> runners;
+    for(auto &task : tasks) {
+        auto runner = std::make_shared<StartupRunner>([this,&task]{ runStartupTask(task); });
+        startupPool.pushWork(runner, [&task](const std::exception &e) {
+            KB_ERROR("failed to load {}: {}", task.name, e.what());
+        });
+        runners.push_back(runner);
     }
+    for(auto &runner : runners) runner->join();
+}
+
+std::vector<std::pair<std::string, double>> KnowledgeBase::startupTimes() const
+{
+    std::lock_guard<std::mutex> lock(startupMutex_);
+    return startupTimes_;
 }
 
 std::shared_ptr<KnowledgeGraph> KnowledgeBase::centralKG()
@@ -172,8 +373,57 @@ std::shared_ptr<KnowledgeGraph> KnowledgeBase::centralKG()
     }
 }
 
-AnswerBufferPtr KnowledgeBase::submitQuery(const FormulaPtr &phi, int queryFlags)
+static AnswerBufferPtr noAnswers()
+{
+    // a stream that only contains EOS, e.g. for queries with a limit of zero
+    auto out = std::make_shared<AnswerBuffer>();
+    auto channel = AnswerStream::Channel::create(out);
+    channel->push(AnswerStream::eos());
+    return out;
+}
+
+GraphQueryPtr KnowledgeBase::createPathQuery(const QueryTree::Path &path, int queryFlags)
+{
+    auto &literals = path.literals();
+    std::vector<RDFLiteralPtr> rdfLiterals(literals.size());
+    uint32_t literalIndex=0;
+    for(auto &l : literals) {
+        rdfLiterals[literalIndex++] = RDFLiteral::fromLiteral(l);
+    }
+    return std::make_shared<GraphQuery>(rdfLiterals, queryFlags);
+}
+
+AnswerBufferPtr KnowledgeBase::submitQuery(const FormulaPtr &phi, int queryFlags, const QueryProfilePtr &profile)
+{
+    return submitFormula(phi, queryFlags, std::nullopt, 0, {}, profile);
+}
+
+AnswerBufferPtr KnowledgeBase::submitQuery(const FormulaPtr &phi, int queryFlags,
+                                           std::optional<uint32_t> limit, uint32_t offset,
+                                           const QueryProfilePtr &profile)
+{
+    return submitFormula(phi, queryFlags, limit, offset, {}, profile);
+}
+
+AnswerBufferPtr KnowledgeBase::submitQuery(const FormulaPtr &phi, const QueryAggregatePtr &aggregate,
+                                           int queryFlags, const QueryProfilePtr &profile)
+{
+    return submitFormula(phi, queryFlags, std::nullopt, 0, aggregate, profile);
+}
+
+AnswerBufferPtr KnowledgeBase::submitFormula(const FormulaPtr &phi, int queryFlags,
+                                             std::optional<uint32_t> limit, uint32_t offset,
+                                             const QueryAggregatePtr &aggregate,
+                                             const QueryProfilePtr &profile)
 {
+    static auto &numQueries = Metrics::get().counter(
+            "knowrob_queries_total", "Number of queries submitted to the knowledge base.");
+    static auto &queryLatency = Metrics::get().histogram(
+            "knowrob_query_seconds", "Time between submission of a query and its last answer.");
+    numQueries.increment();
+    // no answer is requested, the query does not need to be evaluated
+    if(limit.has_value() && limit.value()==0) return noAnswers();
+
     auto outStream = std::make_shared<AnswerBuffer>();
 
     auto pipeline = std::make_shared<QueryPipeline>();
@@ -186,28 +436,61 @@ AnswerBufferPtr KnowledgeBase::submitQuery(const FormulaPtr &phi, int queryFlags
     // it is assumed here that queries are rather simple and that
     // the number of path's in the query tree is rather low.
     QueryTree qt(phi);
+    bool isPaged = (limit.has_value() || offset>0);
+    bool isSinglePath = (qt.numPaths()==1);
     for(auto &path : qt)
     {
-        auto &literals = path.literals();
-        std::vector<RDFLiteralPtr> rdfLiterals(literals.size());
-        uint32_t literalIndex=0;
-        for(auto &l : literals) {
-            rdfLiterals[literalIndex++] = RDFLiteral::fromLiteral(l);
+        auto pathQuery = createPathQuery(path, queryFlags);
+        if(isSinglePath) {
+            // the path query generates all answers, it can aggregate and page them
+            pathQuery->setAggregate(aggregate);
+            pathQuery->setOffset(offset);
+            if(limit.has_value()) pathQuery->setLimit(limit.value());
         }
-        auto pathQuery = std::make_shared<GraphQuery>(rdfLiterals, queryFlags);
 
-        auto pathOutput = submitQuery(pathQuery);
+        auto pathOutput = submitQuery(pathQuery, profile);
         pathOutput >> outStream;
         pathOutput->stopBuffering();
         pipeline->addStage(pathOutput);
     }
 
-    auto out = std::make_shared<AnswerBuffer_WithReference>(pipeline);
-    outStream >> out;
+    auto out = std::make_shared<AnswerBuffer_WithReference>(pipeline, &queryLatency);
+    std::shared_ptr<AnswerBroadcaster> lastStage = outStream;
+    if(aggregate && !isSinglePath) {
+        // answers of all paths are aggregated together
+        auto aggregator = std::make_shared<AnswerAggregator>(aggregate);
+        pipeline->addStage(aggregator);
+        lastStage >> aggregator;
+        lastStage = aggregator;
+    }
+    if(isPaged && !isSinglePath) {
+        // the page is taken from the ordered union of answers of all paths.
+        // note that paths cannot be limited as their answers are ordered only after the union.
+        auto slice = std::make_shared<AnswerSlice>(limit, offset, !(queryFlags & QUERY_FLAG_UNORDERED_SOLUTIONS));
+        slice->setStopHandler(createStopHandler(pipeline));
+        pipeline->addStage(slice);
+        lastStage >> slice;
+        lastStage = slice;
+    }
+    lastStage >> out;
     outStream->stopBuffering();
     return out;
 }
 
+std::function<void()> KnowledgeBase::createStopHandler(const std::shared_ptr<QueryPipeline> &pipeline)
+{
+    std::weak_ptr<QueryPipeline> weakPipeline = pipeline;
+    std::weak_ptr<ThreadPool> weakPool = threadPool_;
+    return [weakPipeline, weakPool]() {
+        auto pool = weakPool.lock();
+        if(!pool) return;
+        pool->pushWork(std::make_shared<QueryPipelineCloseRunner>(weakPipeline),
+                       [](const std::exception &e) {
+            KB_WARN("failed to stop query pipeline: {}", e.what());
+        });
+    };
+}
+
 std::vector<RDFComputablePtr> KnowledgeBase::createComputationSequence(
         const std::list<DependencyNodePtr> &dependencyGroup)
 {
@@ -275,7 +558,8 @@ void KnowledgeBase::createComputationPipeline(
     const std::vector<RDFComputablePtr> &computableLiterals,
     const std::shared_ptr<AnswerBroadcaster> &pipelineInput,
     const std::shared_ptr<AnswerBroadcaster> &pipelineOutput,
-    int queryFlags)
+    const GraphQueryPtr &graphQuery,
+    const QueryProfilePtr &profile)
 {
     // This function generates a query pipeline for literals that
     // can be computed (EDB-only literals are processed separately).
@@ -301,15 +585,27 @@ void KnowledgeBase::createComputationPipeline(
         auto stepOutput = std::make_shared<AnswerBroadcaster>();
         pipeline->addStage(stepOutput);
 
-        auto edbStage = std::make_shared<EDBStage>(edb, lit, queryFlags);
+        auto edbStage = std::make_shared<EDBStage>(edb, lit, graphQuery->flags());
         edbStage->selfWeakRef_ = edbStage;
+        edbStage->setQueryID(graphQuery->queryID());
+        if(profile) {
+            std::stringstream ss;
+            ss << "EDB " << *lit;
+            edbStage->setProfile(profile->addStage(ss.str()));
+        }
         stepInput >> edbStage;
         edbStage >> stepOutput;
         pipeline->addStage(edbStage);
 
         for(auto &r : lit->reasonerList()) {
-            auto idbStage = std::make_shared<IDBStage>(r, lit, threadPool_, queryFlags);
+            auto idbStage = std::make_shared<IDBStage>(r->reasoner(), lit, threadPool_, graphQuery->flags());
             idbStage->selfWeakRef_ = idbStage;
+            idbStage->setQueryID(graphQuery->queryID());
+            if(profile) {
+                std::stringstream ss;
+                ss << "IDB(" << r->name() << ") " << *lit;
+                idbStage->setProfile(profile->addStage(ss.str()));
+            }
             stepInput >> idbStage;
             idbStage >> stepOutput;
             pipeline->addStage(idbStage);
@@ -321,28 +617,22 @@ void KnowledgeBase::createComputationPipeline(
     lastOut >> pipelineOutput;
 }
 
-AnswerBufferPtr KnowledgeBase::submitQuery(const GraphQueryPtr &graphQuery)
+void KnowledgeBase::splitLiterals(const GraphQueryPtr &graphQuery,
+                                  std::vector<RDFLiteralPtr> &edbOnlyLiterals,
+                                  std::vector<RDFComputablePtr> &computableLiterals,
+                                  std::vector<RDFLiteralPtr> &negativeLiterals,
+                                  std::vector<RDFLiteralPtr> &builtinLiterals)
 {
-    auto allLiterals = graphQuery->literals();
-
-    // --------------------------------------
-    // Construct a pipeline that holds references to stages.
-    // --------------------------------------
-    auto pipeline = std::make_shared<QueryPipeline>();
-
-    // --------------------------------------
-    // Pick a Knowledge Graph for EDB queries
-    // --------------------------------------
-    std::shared_ptr<KnowledgeGraph> kg = centralKG();
-
     // --------------------------------------
-    // split input literals into positive and negative literals.
-    // negative literals are evaluated in parallel after all positive literals.
+    // split input literals into positive, negative and builtin literals.
+    // negative literals are evaluated in parallel after all positive literals,
+    // and builtins are evaluated over batches of answers of the positive literals.
     // --------------------------------------
-    std::vector<RDFLiteralPtr> positiveLiterals, negativeLiterals;
-    for(auto &l : allLiterals) {
-        if(l->isNegated()) negativeLiterals.push_back(l);
-        else               positiveLiterals.push_back(l);
+    std::vector<RDFLiteralPtr> positiveLiterals;
+    for(auto &l : graphQuery->literals()) {
+        if(l->isNegated())                    negativeLiterals.push_back(l);
+        else if(BuiltinStage::isBuiltin(*l)) builtinLiterals.push_back(l);
+        else                                  positiveLiterals.push_back(l);
     }
 
     // --------------------------------------
@@ -354,17 +644,42 @@ AnswerBufferPtr KnowledgeBase::submitQuery(const GraphQueryPtr &graphQuery)
     // split positive literals into edb-only and computable.
     // also associate list of reasoner to computable literals.
     // --------------------------------------
-    std::vector<RDFLiteralPtr> edbOnlyLiterals;
-    std::vector<RDFComputablePtr> computableLiterals;
     for(auto &l : positiveLiterals) {
-        std::vector<std::shared_ptr<Reasoner>> l_reasoner;
-        for(auto &pair : reasonerManager_->reasonerPool()) {
-            auto &r = pair.second->reasoner();
-            if(r->canEvaluate(*l)) l_reasoner.push_back(r);
+        // note: literals with variable property are not evaluated by reasoners.
+        std::vector<std::shared_ptr<DefinedReasoner>> l_reasoner;
+        if(l->propertyTerm()->type() == TermType::STRING) {
+            auto &property = std::static_pointer_cast<StringTerm>(l->propertyTerm())->value();
+            l_reasoner = reasonerManager_->getReasonersForPredicate(property, 2);
         }
         if(l_reasoner.empty()) edbOnlyLiterals.push_back(l);
         else computableLiterals.push_back(std::make_shared<RDFComputable>(*l, l_reasoner));
     }
+}
+
+AnswerBufferPtr KnowledgeBase::submitQuery(const GraphQueryPtr &graphQuery, const QueryProfilePtr &profile)
+{
+    static auto &numGraphQueries = Metrics::get().counter(
+            "knowrob_graph_queries_total", "Number of conjunctive graph queries submitted to the knowledge base.");
+    static auto &graphQueryLatency = Metrics::get().histogram(
+            "knowrob_graph_query_seconds", "Time between submission of a graph query and its last answer.");
+    numGraphQueries.increment();
+    // no answer is requested, the query does not need to be evaluated
+    if(graphQuery->limit().has_value() && graphQuery->limit().value()==0) return noAnswers();
+
+    // --------------------------------------
+    // Construct a pipeline that holds references to stages.
+    // --------------------------------------
+    auto pipeline = std::make_shared<QueryPipeline>();
+
+    // --------------------------------------
+    // Pick a Knowledge Graph for EDB queries
+    // --------------------------------------
+    std::shared_ptr<KnowledgeGraph> kg = centralKG();
+
+    std::vector<RDFLiteralPtr> edbOnlyLiterals, negativeLiterals, builtinLiterals;
+    std::vector<RDFComputablePtr> computableLiterals;
+    splitLiterals(graphQuery, edbOnlyLiterals, computableLiterals, negativeLiterals, builtinLiterals);
+    bool isEDBOnly = (computableLiterals.empty() && negativeLiterals.empty() && builtinLiterals.empty());
 
     std::shared_ptr<AnswerBuffer> edbOut;
     // --------------------------------------
@@ -381,7 +696,28 @@ AnswerBufferPtr KnowledgeBase::submitQuery(const GraphQueryPtr &graphQuery)
         auto edbOnlyQuery = std::make_shared<GraphQuery>(
                     edbOnlyLiterals,
                     graphQuery->flags());
-        edbOut = kg->submitQuery(edbOnlyQuery);
+        if(isEDBOnly) {
+            // the EDB query generates all answers, so it can also aggregate them and apply limit and offset
+            edbOnlyQuery->setAggregate(graphQuery->aggregate());
+            edbOnlyQuery->setOffset(graphQuery->offset());
+            if(graphQuery->limit().has_value()) edbOnlyQuery->setLimit(graphQuery->limit().value());
+        }
+        if(profile) {
+            std::stringstream ss;
+            ss << "EDB";
+            for(auto &l : edbOnlyLiterals) ss << ' ' << *l;
+            auto edbProfile = profile->addStage(ss.str());
+            edbProfile->begin();
+            edbProfile->numSubQueries += 1;
+            auto kgOut = kg->submitQuery(edbOnlyQuery, edbProfile);
+            edbOut = std::make_shared<AnswerBuffer_WithProfile>(edbProfile);
+            kgOut >> edbOut;
+            pipeline->addStage(kgOut);
+            kgOut->stopBuffering();
+        }
+        else {
+            edbOut = kg->submitQuery(edbOnlyQuery);
+        }
     }
     pipeline->addStage(edbOut);
 
@@ -410,7 +746,8 @@ AnswerBufferPtr KnowledgeBase::submitQuery(const GraphQueryPtr &graphQuery)
                     createComputationSequence(literalGroup.member_),
                     edbOut,
                     idbOut,
-                    graphQuery->flags());
+                    graphQuery,
+                    profile);
         }
         else {
             // there are multiple dependency groups. They can be evaluated in parallel.
@@ -428,7 +765,8 @@ AnswerBufferPtr KnowledgeBase::submitQuery(const GraphQueryPtr &graphQuery)
                         createComputationSequence(literalGroup.member_),
                         edbOut,
                         answerCombiner,
-                        graphQuery->flags());
+                        graphQuery,
+                        profile);
             }
             answerCombiner >> idbOut;
             pipeline->addStage(answerCombiner);
@@ -450,6 +788,41 @@ AnswerBufferPtr KnowledgeBase::submitQuery(const GraphQueryPtr &graphQuery)
         lastStage = idbOut;
     }
 
+    // evaluate builtins over batches of answers, their arguments are grounded by the other literals
+    if(!builtinLiterals.empty()) {
+        auto builtinStage = std::make_shared<BuiltinStage>(builtinLiterals);
+        if(profile) {
+            std::stringstream ss;
+            ss << "Builtins";
+            for(auto &l : builtinLiterals) ss << ' ' << *l;
+            builtinStage->setProfile(profile->addStage(ss.str()));
+        }
+        pipeline->addStage(builtinStage);
+        lastStage >> builtinStage;
+        lastStage = builtinStage;
+    }
+
+    // aggregate answers of computable literals while they are generated
+    if(graphQuery->aggregate() && !isEDBOnly) {
+        auto aggregator = std::make_shared<AnswerAggregator>(graphQuery->aggregate());
+        pipeline->addStage(aggregator);
+        lastStage >> aggregator;
+        lastStage = aggregator;
+    }
+
+    // apply limit and offset to the ordered answers of computable literals.
+    // an ordered page can only be taken once all answers were generated, as
+    // reasoners generate answers concurrently and in no particular order.
+    // unordered pages are complete once offset+limit answers were generated.
+    if(graphQuery->isPaged() && !isEDBOnly) {
+        auto slice = std::make_shared<AnswerSlice>(graphQuery->limit(), graphQuery->offset(),
+                                                   !(graphQuery->flags() & QUERY_FLAG_UNORDERED_SOLUTIONS));
+        slice->setStopHandler(createStopHandler(pipeline));
+        pipeline->addStage(slice);
+        lastStage >> slice;
+        lastStage = slice;
+    }
+
     /*
             // optionally add a stage to the pipeline that drops all redundant result.
             if(graphQuery->flags() & QUERY_FLAG_UNIQUE_SOLUTIONS) {
@@ -466,33 +839,159 @@ AnswerBufferPtr KnowledgeBase::submitQuery(const GraphQueryPtr &graphQuery)
             }
     */
 
-    auto out = std::make_shared<AnswerBuffer_WithReference>(pipeline);
+    auto out = std::make_shared<AnswerBuffer_WithReference>(
+            pipeline, &graphQueryLatency, graphQuery->queryID());
     lastStage >> out;
     edbOut->stopBuffering();
     return out;
 }
 
-AnswerBufferPtr KnowledgeBase::submitQuery(const LiteralPtr &literal, int queryFlags)
+AnswerBufferPtr KnowledgeBase::submitQuery(const LiteralPtr &literal, int queryFlags, const QueryProfilePtr &profile)
 {
     auto rdfLiteral = RDFLiteral::fromLiteral(literal);
     return submitQuery(std::make_shared<GraphQuery>(
-        GraphQuery({rdfLiteral}, queryFlags)));
+        GraphQuery({rdfLiteral}, queryFlags)), profile);
+}
+
+QueryPlanPtr KnowledgeBase::explainQuery(const FormulaPtr &phi, int queryFlags)
+{
+    auto plan = std::make_shared<QueryPlan>();
+    // same as in submitQuery, each path in the DNF of the query is planned separately.
+    QueryTree qt(phi);
+    for(auto &path : qt) {
+        plan->addPath(explainQuery(createPathQuery(path, queryFlags)));
+    }
+    return plan;
+}
+
+ConjunctiveQueryPlan KnowledgeBase::explainQuery(const GraphQueryPtr &graphQuery)
+{
+    ConjunctiveQueryPlan plan;
+    std::vector<RDFComputablePtr> computableLiterals;
+    splitLiterals(graphQuery, plan.edbLiterals, computableLiterals, plan.negativeLiterals, plan.builtinLiterals);
+
+    // let the EDB describe how it would evaluate the edb-only literals
+    auto kg = centralKG();
+    if(kg && !plan.edbLiterals.empty()) {
+        plan.edbQuery = kg->explainQuery(std::make_shared<GraphQuery>(
+                plan.edbLiterals, graphQuery->flags()));
+    }
+
+    // computable literals are evaluated in dependency groups
+    if(!computableLiterals.empty()) {
+        DependencyGraph dg;
+        dg.insert(computableLiterals.begin(), computableLiterals.end());
+        for(auto &literalGroup : dg) {
+            std::vector<PlannedLiteral> groupPlan;
+            for(auto &lit : createComputationSequence(literalGroup.member_)) {
+                PlannedLiteral &step = groupPlan.emplace_back();
+                step.literal = lit;
+                for(auto &r : lit->reasonerList()) {
+                    step.reasonerNames.push_back(r->name());
+                }
+            }
+            plan.dependencyGroups.push_back(groupPlan);
+        }
+    }
+
+    return plan;
+}
+
+bool KnowledgeBase::commitStatements(const std::vector<StatementData> &propositions)
+{
+    auto &knowledgeGraphs = backendManager_->knowledgeGraphPool();
+    bool status = true;
+    if(knowledgeGraphs.size() == 1) {
+        status = knowledgeGraphs.begin()->second->knowledgeGraph()->insert(propositions);
+    }
+    else {
+        // write into the knowledge graphs concurrently
+        std::vector<std::shared_ptr<KnowledgeGraphWriteRunner>> runners;
+        for(auto &kg : knowledgeGraphs) {
+            auto runner = std::make_shared<KnowledgeGraphWriteRunner>(kg.second->knowledgeGraph(), propositions);
+            threadPool_->pushWork(runner, [](const std::exception &e) {
+                KB_WARN("assertion of triple data failed: {}", e.what());
+            });
+            runners.push_back(runner);
+        }
+        std::exception_ptr error;
+        for(auto &runner : runners) {
+            runner->join();
+            if(runner->error()) error = runner->error();
+            else if(!runner->status()) status = false;
+        }
+        if(error) std::rethrow_exception(error);
+    }
+    if(!status) {
+        KB_WARN("assertion of triple data failed!");
+    }
+    return status;
 }
 
 bool KnowledgeBase::insert(const std::vector<StatementData> &propositions)
 {
+    bool status;
+    if(groupCommitWriter_) {
+        // note: blocks until the batch was committed, so propositions remain valid
+        status = groupCommitWriter_->write(propositions).get();
+    }
+    else {
+        status = commitStatements(propositions);
+    }
+    // notify reasoners that maintain inferences bottom-up
+    if(status) {
+        for(auto &pair : reasonerManager_->reasonerPool()) {
+            pair.second->reasoner()->onInsert(propositions);
+        }
+    }
+    return status;
+}
+
+void KnowledgeBase::remove(const std::vector<RDFLiteralPtr> &tripleExpressions)
+{
+    for(auto &kg : backendManager_->knowledgeGraphPool()) {
+        kg.second->knowledgeGraph()->remove(tripleExpressions);
+    }
+    // notify reasoners that maintain inferences bottom-up
+    for(auto &pair : reasonerManager_->reasonerPool()) {
+        pair.second->reasoner()->onRemove(tripleExpressions);
+    }
+}
+
+bool KnowledgeBase::replace(const std::vector<RDFLiteralPtr> &tripleExpressions,
+                            const std::vector<StatementData> &propositions)
+{
+    // statements queued for a group commit before the replacement must not be written after it
+    if(groupCommitWriter_) {
+        groupCommitWriter_->flush();
+    }
     bool status = true;
     for(auto &kg : backendManager_->knowledgeGraphPool()) {
-        if(!kg.second->knowledgeGraph()->insert(propositions)) {
-            KB_WARN("assertion of triple data failed!");
+        if(!kg.second->knowledgeGraph()->replace(tripleExpressions, propositions)) {
+            KB_WARN("replacement of triple data failed!");
             status = false;
         }
     }
+    if(!status) return false;
+    // notify reasoners that maintain inferences bottom-up
+    if(!tripleExpressions.empty()) {
+        for(auto &pair : reasonerManager_->reasonerPool()) {
+            pair.second->reasoner()->onRemove(tripleExpressions);
+        }
+    }
+    if(!propositions.empty()) {
+        for(auto &pair : reasonerManager_->reasonerPool()) {
+            pair.second->reasoner()->onInsert(propositions);
+        }
+    }
     return status;
 }
 
 bool KnowledgeBase::insert(const StatementData &proposition)
 {
+    if(groupCommitWriter_) {
+        return insert(std::vector<StatementData>{ proposition });
+    }
     bool status = true;
     // assert each statement into each knowledge graph backend
     for(auto &kg : backendManager_->knowledgeGraphPool()) {
@@ -501,5 +1000,171 @@ bool KnowledgeBase::insert(const StatementData &proposition)
             status = false;
         }
     }
+    if(status) {
+        for(auto &pair : reasonerManager_->reasonerPool()) {
+            pair.second->reasoner()->onInsert({ proposition });
+        }
+    }
     return status;
 }
+
+// fixture class for testing
+class KnowledgeBaseTest : public ::testing::Test {
+protected:
+    static std::shared_ptr<KnowledgeBase> kb_;
+
+    static std::string iri(const std::string &name)
+    { return "http://knowrob.org/kb/test_profile.owl#" + name; }
+
+    static void SetUpTestSuite() {
+        std::stringstream config(R"({
+            "data-backends": [
+                { "type": "MongoDB", "name": "mongodb", "host": "localhost", "port": 27017,
+                  "db": "knowrob_test_profile", "read-only": false }
+            ],
+            "reasoner": [
+                { "type": "Spatial", "name": "spatial", "data-backend": "mongodb" }
+            ]
+        })");
+        boost::property_tree::ptree ptree;
+        boost::property_tree::read_json(config, ptree);
+        kb_ = std::make_shared<KnowledgeBase>(ptree);
+
+        // the cup is the only instance of Cup, and the plate is its nearest object
+        auto cup = iri("cup"), cupPose = iri("Pose_cup"), cupType = iri("Cup");
+        auto plate = iri("plate"), platePose = iri("Pose_plate");
+        auto weight = iri("weight");
+        std::vector<StatementData> statements = {
+            StatementData(cup.c_str(), semweb::rdf::type.data(), cupType.c_str()),
+            StatementData(cup.c_str(), spatial::pose.data(), cupPose.c_str()),
+            StatementData(cupPose.c_str(), spatial::translation.data(), "0.0 0.0 0.0"),
+            StatementData(plate.c_str(), spatial::pose.data(), platePose.c_str()),
+            StatementData(platePose.c_str(), spatial::translation.data(), "1.0 0.0 0.0"),
+            StatementData(cup.c_str(), weight.c_str(), nullptr),
+            StatementData(plate.c_str(), weight.c_str(), nullptr)
+        };
+        statements[2].objectType = RDF_STRING_LITERAL;
+        statements[4].objectType = RDF_STRING_LITERAL;
+        statements[5].objectType = RDF_DOUBLE_LITERAL;
+        statements[5].objectDouble = 0.3;
+        statements[6].objectType = RDF_DOUBLE_LITERAL;
+        statements[6].objectDouble = 0.8;
+        kb_->insert(statements);
+    }
+    static void TearDownTestSuite() {
+        kb_ = nullptr;
+    }
+
+    static RDFLiteralPtr literal(const std::string &s, std::string_view p, const TermPtr &o) {
+        return std::make_shared<RDFLiteral>(
+                std::make_shared<StringTerm>(s),
+                std::make_shared<StringTerm>(std::string(p)), o, false);
+    }
+
+    static uint32_t countAnswers(const std::vector<RDFLiteralPtr> &literals, const QueryProfilePtr &profile) {
+        auto query = std::make_shared<GraphQuery>(literals, QUERY_FLAG_ALL_SOLUTIONS);
+        auto answerQueue = kb_->submitQuery(query, profile)->createQueue();
+        uint32_t numAnswers = 0;
+        while(!AnswerStream::isEOS(answerQueue->pop_front())) numAnswers += 1;
+        return numAnswers;
+    }
+
+    static std::vector<AnswerPtr> answersOf(const std::string &queryString, const QueryProfilePtr &profile) {
+        auto answerQueue = kb_->submitQuery(
+                QueryParser::parse(queryString), QUERY_FLAG_ALL_SOLUTIONS, profile)->createQueue();
+        std::vector<AnswerPtr> answers;
+        while(true) {
+            auto answer = answerQueue->pop_front();
+            if(AnswerStream::isEOS(answer)) break;
+            answers.push_back(answer);
+        }
+        return answers;
+    }
+
+    static bool hasPrefix(const StageProfilePtr &stage, std::string_view prefix) {
+        return stage->name().rfind(prefix, 0) == 0;
+    }
+};
+std::shared_ptr<KnowledgeBase> KnowledgeBaseTest::kb_;
+
+TEST_F(KnowledgeBaseTest, ProfileOfEDBOnlyQuery)
+{
+    auto profile = std::make_shared<QueryProfile>();
+    EXPECT_EQ(countAnswers({ literal(iri("cup"), semweb::rdf::type, std::make_shared<Variable>("T")) }, profile), 1);
+    auto stages = profile->stages();
+    ASSERT_EQ(stages.size(), 1);
+    EXPECT_TRUE(hasPrefix(stages[0], "EDB "));
+    EXPECT_EQ(stages[0]->numSubQueries, 1);
+    EXPECT_EQ(stages[0]->numAnswersOut, 1);
+    EXPECT_GE(stages[0]->wallTime(), 0.0);
+}
+
+TEST_F(KnowledgeBaseTest, ProfileOfMixedQuery)
+{
+    auto profile = std::make_shared<QueryProfile>();
+    EXPECT_EQ(countAnswers({
+        literal(iri("cup"), semweb::rdf::type, std::make_shared<Variable>("T")),
+        literal(iri("cup"), spatial::nearest, std::make_shared<Variable>("Other")) }, profile), 1);
+    auto stages = profile->stages();
+    ASSERT_EQ(stages.size(), 3);
+    // the EDB-only literals are evaluated first
+    EXPECT_TRUE(hasPrefix(stages[0], "EDB "));
+    EXPECT_EQ(stages[0]->numAnswersOut, 1);
+    // the computable literal is evaluated by the EDB and the reasoner for each EDB answer
+    EXPECT_TRUE(hasPrefix(stages[1], "EDB "));
+    EXPECT_EQ(stages[1]->numAnswersIn, 1);
+    EXPECT_EQ(stages[1]->numAnswersOut, 0);
+    EXPECT_TRUE(hasPrefix(stages[2], "IDB(spatial) "));
+    EXPECT_EQ(stages[2]->numAnswersIn, 1);
+    EXPECT_EQ(stages[2]->numAnswersOut, 1);
+}
+
+TEST_F(KnowledgeBaseTest, BuiltinsOfQuery)
+{
+    auto weight = "'" + iri("weight") + "'";
+    auto profile = std::make_shared<QueryProfile>();
+    auto light = answersOf(weight + "(X, W), '<'(W, 0.5)", profile);
+    ASSERT_EQ(light.size(), 1);
+    EXPECT_EQ(*light[0]->substitution()->get(Variable("X")), StringTerm(iri("cup")));
+    // the comparison is evaluated over the answers of the EDB by the builtin stage
+    auto stages = profile->stages();
+    ASSERT_EQ(stages.size(), 2);
+    EXPECT_TRUE(hasPrefix(stages[0], "EDB "));
+    EXPECT_TRUE(hasPrefix(stages[1], "Builtins "));
+    EXPECT_EQ(stages[1]->numAnswersIn, 2);
+    EXPECT_EQ(stages[1]->numAnswersOut, 1);
+
+    auto heavy = answersOf(weight + "(X, W), is(G, '*'(W, 1000)), '>'(G, 500)", {});
+    ASSERT_EQ(heavy.size(), 1);
+    EXPECT_EQ(*heavy[0]->substitution()->get(Variable("X")), StringTerm(iri("plate")));
+    EXPECT_EQ(*heavy[0]->substitution()->get(Variable("G")), DoubleTerm(800.0));
+}
+
+TEST_F(KnowledgeBaseTest, GroupCommitKeepsGraph)
+{
+    std::stringstream config(R"({
+        "group-commit": { "window-us": 1000, "max-batch-size": 100 },
+        "data-backends": [
+            { "type": "MongoDB", "name": "mongodb", "host": "localhost", "port": 27017,
+              "db": "knowrob_test_group_commit", "read-only": false }
+        ]
+    })");
+    boost::property_tree::ptree ptree;
+    boost::property_tree::read_json(config, ptree);
+    auto kb = std::make_shared<KnowledgeBase>(ptree);
+    ASSERT_TRUE(kb->groupCommitWriter());
+    auto kg = std::dynamic_pointer_cast<MongoKnowledgeGraph>(kb->centralKG());
+    ASSERT_TRUE(kg);
+    kg->dropGraph("test_graph");
+
+    auto cup = iri("cup"), name = iri("name");
+    StatementData statement(cup.c_str(), name.c_str(), "Cup", "test_graph");
+    EXPECT_TRUE(kb->insert(statement));
+    // the statement was written by the group commit writer into its graph
+    EXPECT_EQ(kb->groupCommitWriter()->numCommits(), 1);
+    auto inGraph = std::make_shared<Answer>(), inOtherGraph = std::make_shared<Answer>();
+    EXPECT_TRUE(kg->lookup(statement)->nextAnswer(inGraph));
+    StatementData otherGraph(cup.c_str(), name.c_str(), "Cup", "other_graph");
+    EXPECT_FALSE(kg->lookup(otherGraph)->nextAnswer(inOtherGraph));
+    kg->dropGraph("test_graph");
+}
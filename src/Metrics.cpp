@@ -0,0 +1,379 @@
+/*
+ * Copyright (c) 2022, Daniel Beßler
+ * All rights reserved.
+ *
+ * This file is part of KnowRob, please consult
+ * https://github.com/knowrob/knowrob for license details.
+ */
+
+// STD
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+// POSIX
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+// GTEST
+#include <gtest/gtest.h>
+// KnowRob
+#include <knowrob/Logger.h>
+#include <knowrob/Metrics.h>
+
+using namespace knowrob;
+
+MetricsHistogram::MetricsHistogram()
+: sum_(0)
+{
+	for(auto &bucket : buckets_) bucket.store(0, std::memory_order_relaxed);
+}
+
+uint64_t MetricsHistogram::count() const
+{
+	uint64_t total = 0;
+	for(auto &bucket : buckets_) total += bucket.load(std::memory_order_relaxed);
+	return total;
+}
+
+uint64_t MetricsHistogram::bucketUpperBound(uint32_t index)
+{
+	if(index < SUB_BUCKET_COUNT) return index;
+	uint32_t shift = index / SUB_BUCKET_COUNT - 1;
+	uint64_t subBucket = index % SUB_BUCKET_COUNT;
+	uint64_t lowerBound = (SUB_BUCKET_COUNT + subBucket) << shift;
+	return lowerBound + ((uint64_t(1) << shift) - 1);
+}
+
+uint64_t MetricsHistogram::quantile(double q) const
+{
+	// take a snapshot of the buckets first as they may change concurrently
+	std::vector<uint64_t> counts(NUM_BUCKETS);
+	uint64_t total = 0;
+	for(uint32_t i=0; i<NUM_BUCKETS; ++i) {
+		counts[i] = buckets_[i].load(std::memory_order_relaxed);
+		total += counts[i];
+	}
+	if(total == 0) return 0;
+
+	auto rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(total)));
+	if(rank < 1) rank = 1;
+	uint64_t cumulative = 0;
+	for(uint32_t i=0; i<NUM_BUCKETS; ++i) {
+		cumulative += counts[i];
+		if(cumulative >= rank) return bucketUpperBound(i);
+	}
+	return bucketUpperBound(NUM_BUCKETS-1);
+}
+
+namespace knowrob {
+	/**
+	 * Exports metrics periodically into a file, and serves them via
+	 * sockets on request.
+	 */
+	struct Metrics::Exporter {
+		explicit Exporter(const Metrics &metrics,
+						  const boost::property_tree::ptree &config);
+		~Exporter();
+
+		const Metrics &metrics_;
+		std::string filePath_;
+		std::string socketPath_;
+		std::chrono::milliseconds fileInterval_;
+		int httpSocket_;
+		int unixSocket_;
+		std::atomic<bool> hasStopRequest_;
+		std::thread thread_;
+
+		void run();
+		void serve(int serverSocket, bool isHTTP) const;
+	};
+}
+
+Metrics::Exporter::Exporter(const Metrics &metrics, const boost::property_tree::ptree &config)
+: metrics_(metrics),
+  filePath_(config.get<std::string>("file", "")),
+  socketPath_(config.get<std::string>("socket", "")),
+  fileInterval_(static_cast<int64_t>(config.get<double>("interval", 10.0) * 1000.0)),
+  httpSocket_(-1),
+  unixSocket_(-1),
+  hasStopRequest_(false)
+{
+	auto port = config.get<int>("port", 0);
+	if(port > 0) {
+		httpSocket_ = socket(AF_INET, SOCK_STREAM, 0);
+		int reuse = 1;
+		setsockopt(httpSocket_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+		struct sockaddr_in addr{};
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(static_cast<uint16_t>(port));
+		// only serve metrics on the loopback interface
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		if(httpSocket_ < 0 ||
+		   bind(httpSocket_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+		   listen(httpSocket_, 8) != 0) {
+			KB_ERROR("Failed to serve metrics on port {}: {}.", port, std::strerror(errno));
+			if(httpSocket_ >= 0) close(httpSocket_);
+			httpSocket_ = -1;
+		}
+		else {
+			KB_INFO("Serving metrics at http://127.0.0.1:{}/metrics.", port);
+		}
+	}
+	if(!socketPath_.empty()) {
+		unixSocket_ = socket(AF_UNIX, SOCK_STREAM, 0);
+		struct sockaddr_un addr{};
+		addr.sun_family = AF_UNIX;
+		std::strncpy(addr.sun_path, socketPath_.c_str(), sizeof(addr.sun_path)-1);
+		unlink(socketPath_.c_str());
+		if(unixSocket_ < 0 ||
+		   bind(unixSocket_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+		   listen(unixSocket_, 8) != 0) {
+			KB_ERROR("Failed to serve metrics at socket {}: {}.", socketPath_, std::strerror(errno));
+			if(unixSocket_ >= 0) close(unixSocket_);
+			unixSocket_ = -1;
+		}
+		else {
+			KB_INFO("Serving metrics at socket {}.", socketPath_);
+		}
+	}
+	if(!filePath_.empty() || httpSocket_ >= 0 || unixSocket_ >= 0) {
+		thread_ = std::thread(&Exporter::run, this);
+	}
+}
+
+Metrics::Exporter::~Exporter()
+{
+	hasStopRequest_ = true;
+	if(thread_.joinable()) thread_.join();
+	if(httpSocket_ >= 0) close(httpSocket_);
+	if(unixSocket_ >= 0) {
+		close(unixSocket_);
+		unlink(socketPath_.c_str());
+	}
+}
+
+void Metrics::Exporter::run()
+{
+	auto nextWrite = std::chrono::steady_clock::now();
+	while(!hasStopRequest_) {
+		if(!filePath_.empty() && std::chrono::steady_clock::now() >= nextWrite) {
+			metrics_.writePrometheusFile(filePath_);
+			nextWrite = std::chrono::steady_clock::now() + fileInterval_;
+		}
+		// wait for incoming connections, but wake up regularly to check for stop requests
+		struct pollfd fds[2];
+		nfds_t numFds = 0;
+		if(httpSocket_ >= 0) fds[numFds++] = { httpSocket_, POLLIN, 0 };
+		if(unixSocket_ >= 0) fds[numFds++] = { unixSocket_, POLLIN, 0 };
+		if(numFds == 0) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(200));
+			continue;
+		}
+		if(poll(fds, numFds, 200) <= 0) continue;
+		for(nfds_t i=0; i<numFds; ++i) {
+			if(fds[i].revents & POLLIN) serve(fds[i].fd, fds[i].fd == httpSocket_);
+		}
+	}
+}
+
+void Metrics::Exporter::serve(int serverSocket, bool isHTTP) const
+{
+	int client = accept(serverSocket, nullptr, nullptr);
+	if(client < 0) return;
+
+	std::stringstream body;
+	metrics_.writePrometheus(body);
+	std::string response;
+	if(isHTTP) {
+		// consume the request header, any request is answered with the metrics
+		char requestBuffer[1024];
+		struct pollfd fd = { client, POLLIN, 0 };
+		if(poll(&fd, 1, 1000) > 0) {
+			(void)!recv(client, requestBuffer, sizeof(requestBuffer), 0);
+		}
+		auto content = body.str();
+		std::stringstream os;
+		os << "HTTP/1.0 200 OK\r\n"
+		   << "Content-Type: text/plain; version=0.0.4\r\n"
+		   << "Content-Length: " << content.size() << "\r\n"
+		   << "Connection: close\r\n\r\n"
+		   << content;
+		response = os.str();
+	}
+	else {
+		response = body.str();
+	}
+
+	size_t offset = 0;
+	while(offset < response.size()) {
+		auto n = send(client, response.data()+offset, response.size()-offset, MSG_NOSIGNAL);
+		if(n <= 0) break;
+		offset += static_cast<size_t>(n);
+	}
+	close(client);
+}
+
+Metrics::Metrics() = default;
+
+Metrics::~Metrics() = default;
+
+Metrics& Metrics::get()
+{
+	static Metrics singleton;
+	return singleton;
+}
+
+void Metrics::loadConfiguration(const boost::property_tree::ptree &config)
+{
+	auto &metrics = get();
+	std::unique_ptr<Exporter> exporter;
+	{
+		std::lock_guard<std::mutex> scoped_lock(metrics.mutex_);
+		exporter = std::move(metrics.exporter_);
+	}
+	// note: the exporter thread must be stopped before creating a new one.
+	//       it is joined without holding the lock as it may wait for the lock in writePrometheus.
+	exporter.reset();
+	exporter = std::make_unique<Exporter>(metrics, config);
+	{
+		std::lock_guard<std::mutex> scoped_lock(metrics.mutex_);
+		std::swap(exporter, metrics.exporter_);
+	}
+	// an exporter created concurrently is replaced, and stopped outside the lock
+	exporter.reset();
+}
+
+template<class T> static T& getOrCreate(std::map<std::string, T> &map,
+										const std::string &name,
+										const std::string &help)
+{
+	auto it = map.find(name);
+	if(it == map.end()) {
+		auto &entry = map[name];
+		entry.help = help;
+		entry.metric = std::make_unique<typename decltype(entry.metric)::element_type>();
+		return entry;
+	}
+	return it->second;
+}
+
+MetricsCounter& Metrics::counter(const std::string &name, const std::string &help)
+{
+	std::lock_guard<std::mutex> scoped_lock(mutex_);
+	return *getOrCreate(counters_, name, help).metric;
+}
+
+MetricsGauge& Metrics::gauge(const std::string &name, const std::string &help)
+{
+	std::lock_guard<std::mutex> scoped_lock(mutex_);
+	return *getOrCreate(gauges_, name, help).metric;
+}
+
+MetricsHistogram& Metrics::histogram(const std::string &name, const std::string &help)
+{
+	std::lock_guard<std::mutex> scoped_lock(mutex_);
+	return *getOrCreate(histograms_, name, help).metric;
+}
+
+std::ostream& Metrics::writePrometheus(std::ostream &os) const
+{
+	static const double quantiles[] = { 0.5, 0.9, 0.99 };
+	std::lock_guard<std::mutex> scoped_lock(mutex_);
+
+	for(auto &pair : counters_) {
+		if(!pair.second.help.empty()) os << "# HELP " << pair.first << ' ' << pair.second.help << '\n';
+		os << "# TYPE " << pair.first << " counter\n";
+		os << pair.first << ' ' << pair.second.metric->value() << '\n';
+	}
+	for(auto &pair : gauges_) {
+		if(!pair.second.help.empty()) os << "# HELP " << pair.first << ' ' << pair.second.help << '\n';
+		os << "# TYPE " << pair.first << " gauge\n";
+		os << pair.first << ' ' << pair.second.metric->value() << '\n';
+	}
+	for(auto &pair : histograms_) {
+		auto &histogram = *pair.second.metric;
+		if(!pair.second.help.empty()) os << "# HELP " << pair.first << ' ' << pair.second.help << '\n';
+		os << "# TYPE " << pair.first << " summary\n";
+		for(auto q : quantiles) {
+			os << pair.first << "{quantile=\"" << q << "\"} "
+			   << static_cast<double>(histogram.quantile(q)) / 1e9 << '\n';
+		}
+		os << pair.first << "_sum " << static_cast<double>(histogram.sum()) / 1e9 << '\n';
+		os << pair.first << "_count " << histogram.count() << '\n';
+	}
+	return os;
+}
+
+bool Metrics::writePrometheusFile(const std::string &path) const
+{
+	auto tmpPath = path + ".tmp";
+	{
+		std::ofstream file(tmpPath);
+		if(!file.good()) {
+			KB_WARN("Failed to write metrics file {}.", tmpPath);
+			return false;
+		}
+		writePrometheus(file);
+	}
+	// rename is atomic, readers see either the old or the new file
+	if(std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+		KB_WARN("Failed to write metrics file {}.", path);
+		return false;
+	}
+	return true;
+}
+
+// fixture class for testing
+class MetricsTest : public ::testing::Test {
+protected:
+	void SetUp() override {}
+	void TearDown() override {}
+};
+
+TEST_F(MetricsTest, BucketBoundsContainValue)
+{
+	for(uint64_t value : { 0ul, 1ul, 7ul, 8ul, 15ul, 16ul, 17ul, 1000ul, 123456789ul, UINT64_MAX }) {
+		auto index = MetricsHistogram::bucketIndex(value);
+		ASSERT_LT(index, MetricsHistogram::NUM_BUCKETS);
+		EXPECT_GE(MetricsHistogram::bucketUpperBound(index), value);
+		if(index > 0) {
+			EXPECT_LT(MetricsHistogram::bucketUpperBound(index-1), value);
+		}
+	}
+}
+
+TEST_F(MetricsTest, HistogramQuantiles)
+{
+	MetricsHistogram histogram;
+	EXPECT_EQ(histogram.quantile(0.5), 0u);
+	for(uint64_t i=1; i<=1000; ++i) histogram.record(i*1000);
+	EXPECT_EQ(histogram.count(), 1000u);
+	EXPECT_EQ(histogram.sum(), 500500000u);
+	// estimates are within the relative error of the buckets
+	auto p50 = static_cast<double>(histogram.quantile(0.5));
+	auto p99 = static_cast<double>(histogram.quantile(0.99));
+	EXPECT_NEAR(p50, 500000.0, 500000.0/MetricsHistogram::SUB_BUCKET_COUNT);
+	EXPECT_NEAR(p99, 990000.0, 990000.0/MetricsHistogram::SUB_BUCKET_COUNT);
+}
+
+TEST_F(MetricsTest, PrometheusFormat)
+{
+	auto &counter = Metrics::get().counter("knowrob_test_counter_total", "A test counter.");
+	counter.increment(3);
+	// the same metric is returned for the same name
+	EXPECT_EQ(&counter, &Metrics::get().counter("knowrob_test_counter_total"));
+	Metrics::get().gauge("knowrob_test_gauge").set(-2);
+
+	std::stringstream os;
+	Metrics::get().writePrometheus(os);
+	auto text = os.str();
+	EXPECT_NE(text.find("# TYPE knowrob_test_counter_total counter\n"), std::string::npos);
+	EXPECT_NE(text.find("knowrob_test_counter_total 3\n"), std::string::npos);
+	EXPECT_NE(text.find("knowrob_test_gauge -2\n"), std::string::npos);
+}
@@ -11,6 +11,7 @@
 #include <utility>
 // KnowRob
 #include <knowrob/Logger.h>
+#include <knowrob/Metrics.h>
 #include <knowrob/ThreadPool.h>
 
 using namespace knowrob;
@@ -18,7 +19,11 @@ using namespace knowrob;
 ThreadPool::ThreadPool(uint32_t maxNumThreads)
 : maxNumThreads_(maxNumThreads),
   numFinishedThreads_(0),
-  numActiveWorker_(0)
+  numActiveWorker_(0),
+  queueDepth_(Metrics::get().gauge(
+		"knowrob_threadpool_queue_depth", "Number of queued work goals summed over all thread pools.")),
+  numFinishedGoals_(Metrics::get().counter(
+		"knowrob_threadpool_goals_total", "Number of work goals finished by all thread pools."))
 {
 	// NOTE: do not add worker threads in the constructor.
 	//  The problem is the virtual initializeWorker function that could be called
@@ -46,6 +51,7 @@ void ThreadPool::pushWork(const std::shared_ptr<ThreadPool::Runner> &goal, Excep
 		std::lock_guard<std::mutex> scoped_lock(workMutex_);
 		goal->setExceptionHandler(std::move(exceptionHandler));
 		workQueue_.push(goal);
+		queueDepth_.add(1);
 
         uint32_t numAliveThreads = workerThreads_.size()-numFinishedThreads_;
         uint32_t numAvailableThreads = numAliveThreads - numActiveWorker_;
@@ -69,6 +75,7 @@ std::shared_ptr<ThreadPool::Runner> ThreadPool::popWork()
 	else {
 		std::shared_ptr<ThreadPool::Runner> x = workQueue_.front();
 		workQueue_.pop();
+		queueDepth_.add(-1);
 		return x;
 	}
 }
@@ -126,6 +133,7 @@ void ThreadPool::Worker::run()
 		if(goal) {
 			KB_DEBUG("Worker has a new goal.");
 			goal->runInternal();
+			threadPool_->numFinishedGoals_.increment();
 			KB_DEBUG("Work finished.");
 		}
 	}
@@ -177,7 +185,11 @@ void ThreadPool::Runner::runInternal()
 		}
 	}
 	// toggle flag
-	isTerminated_ = true;
+	// note: the flag must be set while holding the mutex, else join() could miss the notification
+	{
+		std::lock_guard<std::mutex> lk(mutex_);
+		isTerminated_ = true;
+	}
 	finishedCV_.notify_all();
 }
 
@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) 2022, Daniel Beßler
+ * All rights reserved.
+ *
+ * This file is part of KnowRob, please consult
+ * https://github.com/knowrob/knowrob for license details.
+ */
+
+// STD
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <vector>
+// POSIX
+#include <unistd.h>
+// GTEST
+#include <gtest/gtest.h>
+// KnowRob
+#include <knowrob/Logger.h>
+#include <knowrob/Tracing.h>
+
+using namespace knowrob;
+
+#define KNOWROB_TRACE_DEFAULT_BUFFER_SIZE 16384
+// minimum time between two automatic dumps
+#define KNOWROB_TRACE_MIN_DUMP_INTERVAL_NS 1000000000
+
+namespace knowrob {
+	/**
+	 * A ring buffer of spans recorded by a single thread.
+	 * The mutex is only contended while a trace is written.
+	 */
+	struct Tracer::ThreadBuffer {
+		explicit ThreadBuffer(uint32_t size, uint32_t threadIndex)
+		: events(size), next(0), isWrapped(false), threadIndex(threadIndex) {}
+		std::vector<TraceEvent> events;
+		uint32_t next;
+		bool isWrapped;
+		const uint32_t threadIndex;
+		std::mutex mutex;
+	};
+
+	struct TracerState {
+		std::mutex mutex;
+		std::list<std::shared_ptr<Tracer::ThreadBuffer>> buffers;
+		// buffers of exited threads that can be re-used by new threads
+		std::vector<std::shared_ptr<Tracer::ThreadBuffer>> freeBuffers;
+		std::atomic<uint32_t> bufferSize = KNOWROB_TRACE_DEFAULT_BUFFER_SIZE;
+		std::atomic<int64_t> latencyThresholdNs = 0;
+		std::atomic<int64_t> lastDumpNs = 0;
+		std::string directory = ".";
+	};
+
+	static TracerState& tracerState()
+	{
+		static TracerState state;
+		return state;
+	}
+}
+
+std::atomic<bool> Tracer::isEnabled_(false);
+
+void Tracer::setBufferSize(uint32_t size)
+{
+	tracerState().bufferSize = std::max(size, 1u);
+}
+
+void Tracer::setLatencyThreshold(double seconds, const std::string &directory)
+{
+	auto &state = tracerState();
+	{
+		std::lock_guard<std::mutex> scoped_lock(state.mutex);
+		state.directory = directory;
+	}
+	state.latencyThresholdNs = static_cast<int64_t>(seconds * 1e9);
+}
+
+void Tracer::loadConfiguration(const boost::property_tree::ptree &config)
+{
+	setBufferSize(config.get<uint32_t>("buffer-size", KNOWROB_TRACE_DEFAULT_BUFFER_SIZE));
+	setLatencyThreshold(config.get<double>("latency-threshold", 0.0),
+						config.get<std::string>("directory", "."));
+	setEnabled(config.get<bool>("enabled", true));
+}
+
+namespace knowrob {
+	// returns the buffer of a thread to the free list when the thread exits
+	struct ThreadBufferLease {
+		std::shared_ptr<Tracer::ThreadBuffer> buffer;
+		~ThreadBufferLease() {
+			if(!buffer) return;
+			auto &state = tracerState();
+			std::lock_guard<std::mutex> scoped_lock(state.mutex);
+			state.freeBuffers.push_back(std::move(buffer));
+		}
+	};
+}
+
+Tracer::ThreadBuffer& Tracer::threadBuffer()
+{
+	// note: the buffer is also referenced by the tracer such that spans
+	//       are kept after the thread has exited, until another thread re-uses it.
+	thread_local ThreadBufferLease lease;
+	if(!lease.buffer) {
+		auto &state = tracerState();
+		std::lock_guard<std::mutex> scoped_lock(state.mutex);
+		if(state.freeBuffers.empty()) {
+			lease.buffer = std::make_shared<ThreadBuffer>(state.bufferSize, state.buffers.size()+1);
+			state.buffers.push_back(lease.buffer);
+		}
+		else {
+			lease.buffer = std::move(state.freeBuffers.back());
+			state.freeBuffers.pop_back();
+		}
+	}
+	return *lease.buffer;
+}
+
+uint32_t Tracer::numBuffers()
+{
+	auto &state = tracerState();
+	std::lock_guard<std::mutex> scoped_lock(state.mutex);
+	return state.buffers.size();
+}
+
+void Tracer::record(const char *name, uint64_t queryID,
+					int64_t beginNs, int64_t endNs,
+					std::string_view detail)
+{
+	auto &buffer = threadBuffer();
+	std::lock_guard<std::mutex> scoped_lock(buffer.mutex);
+	auto &event = buffer.events[buffer.next];
+	event.name = name;
+	event.queryID = queryID;
+	event.beginNs = beginNs;
+	event.endNs = endNs;
+	auto detailLength = std::min<size_t>(detail.size(), TraceEvent::MAX_DETAIL_LENGTH-1);
+	std::memcpy(event.detail, detail.data(), detailLength);
+	event.detail[detailLength] = '\0';
+
+	if(++buffer.next == buffer.events.size()) {
+		buffer.next = 0;
+		buffer.isWrapped = true;
+	}
+}
+
+void Tracer::queryCompleted(uint64_t queryID, int64_t beginNs, int64_t endNs)
+{
+	if(!isEnabled()) return;
+	record("query", queryID, beginNs, endNs);
+
+	auto &state = tracerState();
+	auto threshold = state.latencyThresholdNs.load();
+	if(threshold <= 0 || (endNs - beginNs) < threshold) return;
+
+	// avoid flooding the disk in case many queries exceed the threshold
+	auto lastDump = state.lastDumpNs.load();
+	if(endNs - lastDump < KNOWROB_TRACE_MIN_DUMP_INTERVAL_NS ||
+	   !state.lastDumpNs.compare_exchange_strong(lastDump, endNs)) return;
+
+	std::string directory;
+	{
+		std::lock_guard<std::mutex> scoped_lock(state.mutex);
+		directory = state.directory;
+	}
+	std::stringstream path;
+	path << directory << "/knowrob-trace-" << queryID << ".json";
+	KB_INFO("Query {} took {}s, writing trace to {}.",
+			queryID, static_cast<double>(endNs - beginNs) / 1e9, path.str());
+	dump(path.str());
+}
+
+static void writeJSONString(std::ostream &os, const char *str)
+{
+	os << '"';
+	for(auto *c = str; *c != '\0'; ++c) {
+		switch(*c) {
+			case '"':  os << "\\\""; break;
+			case '\\': os << "\\\\"; break;
+			case '\n': os << "\\n"; break;
+			case '\t': os << "\\t"; break;
+			default:
+				if(static_cast<unsigned char>(*c) < 0x20) os << ' ';
+				else os << *c;
+				break;
+		}
+	}
+	os << '"';
+}
+
+std::ostream& Tracer::writeChromeTrace(std::ostream &os)
+{
+	auto &state = tracerState();
+	std::list<std::shared_ptr<ThreadBuffer>> buffers;
+	{
+		std::lock_guard<std::mutex> scoped_lock(state.mutex);
+		buffers = state.buffers;
+	}
+	auto pid = getpid();
+	bool isFirst = true;
+	auto precision = os.precision();
+	os << std::fixed << std::setprecision(3);
+
+	os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	for(auto &buffer : buffers) {
+		std::lock_guard<std::mutex> scoped_lock(buffer->mutex);
+		uint32_t begin = buffer->isWrapped ? buffer->next : 0;
+		uint32_t count = buffer->isWrapped ? buffer->events.size() : buffer->next;
+		for(uint32_t i=0; i<count; ++i) {
+			auto &event = buffer->events[(begin + i) % buffer->events.size()];
+			if(!isFirst) os << ',';
+			isFirst = false;
+			// complete events ("X") with time stamps in microseconds
+			os << "\n{\"name\":";
+			writeJSONString(os, event.name);
+			os << ",\"cat\":\"knowrob\",\"ph\":\"X\""
+			   << ",\"ts\":" << static_cast<double>(event.beginNs) / 1e3
+			   << ",\"dur\":" << static_cast<double>(event.endNs - event.beginNs) / 1e3
+			   << ",\"pid\":" << pid
+			   << ",\"tid\":" << buffer->threadIndex
+			   << ",\"args\":{\"query\":" << event.queryID;
+			if(event.detail[0] != '\0') {
+				os << ",\"detail\":";
+				writeJSONString(os, event.detail);
+			}
+			os << "}}";
+		}
+	}
+	os << "\n]}\n";
+	os.unsetf(std::ios_base::floatfield);
+	os.precision(precision);
+	return os;
+}
+
+bool Tracer::dump(const std::string &path)
+{
+	std::ofstream file(path);
+	if(!file.good()) {
+		KB_WARN("Failed to write trace file {}.", path);
+		return false;
+	}
+	writeChromeTrace(file);
+	return true;
+}
+
+void Tracer::clear()
+{
+	auto &state = tracerState();
+	std::lock_guard<std::mutex> scoped_lock(state.mutex);
+	for(auto &buffer : state.buffers) {
+		std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+		buffer->next = 0;
+		buffer->isWrapped = false;
+	}
+}
+
+// fixture class for testing
+class TracingTest : public ::testing::Test {
+protected:
+	void SetUp() override { Tracer::clear(); }
+	void TearDown() override { Tracer::setEnabled(false); Tracer::clear(); }
+};
+
+TEST_F(TracingTest, NoSpansWhenDisabled)
+{
+	Tracer::setEnabled(false);
+	{ TraceSpan span("disabled", 1); }
+	std::stringstream os;
+	Tracer::writeChromeTrace(os);
+	EXPECT_EQ(os.str().find("disabled"), std::string::npos);
+}
+
+TEST_F(TracingTest, SpansOfThreads)
+{
+	Tracer::setEnabled(true);
+	{ TraceSpan span("main", 1); }
+	std::thread worker([]{ TraceSpan span("worker", 2); });
+	worker.join();
+	Tracer::record("detailed", 3, 1000, 2000, "p(\"x\")");
+
+	std::stringstream os;
+	Tracer::writeChromeTrace(os);
+	auto trace = os.str();
+	EXPECT_NE(trace.find("\"name\":\"main\""), std::string::npos);
+	EXPECT_NE(trace.find("\"name\":\"worker\""), std::string::npos);
+	EXPECT_NE(trace.find("\"args\":{\"query\":2}"), std::string::npos);
+	EXPECT_NE(trace.find("\"detail\":\"p(\\\"x\\\")\""), std::string::npos);
+}
+
+TEST_F(TracingTest, BuffersOfExitedThreadsAreReused)
+{
+	Tracer::setEnabled(true);
+	std::thread first([]{ TraceSpan span("first", 1); });
+	first.join();
+	auto numBuffers = Tracer::numBuffers();
+	for(int i=0; i<10; ++i) {
+		std::thread worker([]{ TraceSpan span("worker", 2); });
+		worker.join();
+	}
+	EXPECT_EQ(Tracer::numBuffers(), numBuffers);
+}
@@ -2,25 +2,190 @@
 // Created by daniel on 08.04.23.
 //
 
+#include <chrono>
 #include "knowrob/Logger.h"
 #include "knowrob/mongodb/AnswerCursor.h"
 
 using namespace knowrob::mongo;
 
+// the number of documents in the first batch of a mongo cursor by default
+#define ANSWER_CURSOR_DEFAULT_BATCH_SIZE 101
+// time to wait for a worker to start fetching documents before they are fetched directly
+#define ANSWER_CURSOR_FETCH_START_TIMEOUT std::chrono::milliseconds(5)
+
+namespace knowrob::mongo {
+    /**
+     * Fetches the documents of a cursor in a worker thread.
+     */
+    class AnswerCursorFetcher : public ThreadPool::Runner {
+    public:
+        AnswerCursorFetcher(AnswerCursor *cursor, std::shared_ptr<AnswerCursor::FetchState> state)
+        : ThreadPool::Runner(), cursor_(cursor), state_(std::move(state)) {}
+
+        void run() override
+        {
+            {
+                std::lock_guard<std::mutex> lock(state_->mutex);
+                // note: the cursor may not exist anymore if fetching was cancelled
+                if(state_->isCancelled) return;
+                state_->isStarted = true;
+            }
+            state_->cv.notify_all();
+            cursor_->fetchLoop(*state_);
+        }
+    protected:
+        AnswerCursor *cursor_;
+        std::shared_ptr<AnswerCursor::FetchState> state_;
+    };
+}
+
 AnswerCursor::AnswerCursor(const std::shared_ptr<Collection> &collection)
 : Cursor(collection),
   resultDocument_(nullptr),
   resultIter_(),
   varIter_(),
   valIter_(),
-  scopeIter_()
+  scopeIter_(),
+  numDirectDocuments_(0),
+  decodeIndex_(0)
+{
+}
+
+AnswerCursor::~AnswerCursor()
 {
+    // the worker must be done before the mongo cursor is destroyed
+    stopPrefetching();
+    destroyBatch(decodeBatch_);
+}
+
+void AnswerCursor::destroyBatch(DocumentBatch &batch)
+{
+    for(auto doc : batch) bson_destroy(doc);
+    batch.clear();
 }
 
 bool AnswerCursor::nextAnswer(const std::shared_ptr<Answer> &answer)
 {
+    if(!fetchState_ && fetchPool_) {
+        std::size_t firstBatch = firstBatchSize();
+        if(firstBatch==0) firstBatch = ANSWER_CURSOR_DEFAULT_BATCH_SIZE;
+        if(numDirectDocuments_ >= firstBatch) startPrefetching();
+    }
+    if(fetchState_ && decodeIndex_ >= decodeBatch_.size()) {
+        if(!nextBatch()) return false;
+    }
+    // note: nextBatch() stops prefetching if no worker was available
+    if(fetchState_) {
+        return decodeAnswer(decodeBatch_[decodeIndex_++], answer);
+    }
+    // the first batch, or all documents if prefetching is disabled, are read directly
     if(!next(&resultDocument_)) return false;
-    if(!bson_iter_init(&resultIter_, resultDocument_)) return false;
+    numDirectDocuments_ += 1;
+    return decodeAnswer(resultDocument_, answer);
+}
+
+void AnswerCursor::startPrefetching()
+{
+    fetchState_ = std::make_shared<FetchState>();
+    fetchPool_->pushWork(std::make_shared<AnswerCursorFetcher>(this, fetchState_),
+        [](const std::exception &e) {
+            KB_WARN("failed to prefetch answers: {}.", e.what());
+        });
+}
+
+void AnswerCursor::stopPrefetching()
+{
+    if(!fetchState_) return;
+    {
+        std::unique_lock<std::mutex> lock(fetchState_->mutex);
+        if(fetchState_->isStarted) {
+            fetchState_->isStopped = true;
+            fetchState_->cv.notify_all();
+            fetchState_->cv.wait(lock, [this]{ return fetchState_->isDone; });
+        }
+        else {
+            fetchState_->isCancelled = true;
+        }
+        destroyBatch(fetchState_->readyBatch);
+    }
+    fetchState_ = nullptr;
+}
+
+bool AnswerCursor::nextBatch()
+{
+    destroyBatch(decodeBatch_);
+    decodeIndex_ = 0;
+
+    std::unique_lock<std::mutex> lock(fetchState_->mutex);
+    auto &state = *fetchState_;
+    // if all workers are busy, e.g. with queries that wait for their own cursors,
+    // the remaining documents are read by this thread instead.
+    if(!state.cv.wait_for(lock, ANSWER_CURSOR_FETCH_START_TIMEOUT, [&state]{ return state.isStarted; })) {
+        state.isCancelled = true;
+        lock.unlock();
+        fetchState_ = nullptr;
+        fetchPool_ = nullptr;
+        return true;
+    }
+    state.cv.wait(lock, [&state]{ return state.hasReadyBatch || state.isDone; });
+    if(state.hasReadyBatch) {
+        // take the batch, and let the worker hand over the next one
+        decodeBatch_.swap(state.readyBatch);
+        state.hasReadyBatch = false;
+        lock.unlock();
+        state.cv.notify_all();
+        return !decodeBatch_.empty();
+    }
+    else if(state.error) {
+        auto error = state.error;
+        state.error = nullptr;
+        std::rethrow_exception(error);
+    }
+    else {
+        return false;
+    }
+}
+
+void AnswerCursor::fetchLoop(FetchState &state)
+{
+    std::size_t maxBatchSize = batchSize();
+    if(maxBatchSize==0) maxBatchSize = ANSWER_CURSOR_DEFAULT_BATCH_SIZE;
+    DocumentBatch batch;
+    try {
+        const bson_t *doc;
+        bool hasMore = true;
+        while(hasMore) {
+            hasMore = next(&doc);
+            // documents are only valid until the next call of next(), hence they are copied
+            if(hasMore) batch.push_back(bson_copy(doc));
+            if(batch.size() < maxBatchSize && hasMore) continue;
+            if(batch.empty()) break;
+
+            // wait until the previous batch was taken by the decoding thread
+            std::unique_lock<std::mutex> lock(state.mutex);
+            state.cv.wait(lock, [&state]{ return !state.hasReadyBatch || state.isStopped; });
+            if(state.isStopped) break;
+            state.readyBatch.swap(batch);
+            state.hasReadyBatch = true;
+            lock.unlock();
+            state.cv.notify_all();
+        }
+    }
+    catch(...) {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.error = std::current_exception();
+    }
+    destroyBatch(batch);
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.isDone = true;
+    }
+    state.cv.notify_all();
+}
+
+bool AnswerCursor::decodeAnswer(const bson_t *resultDocument, const std::shared_ptr<Answer> &answer)
+{
+    if(!bson_iter_init(&resultIter_, resultDocument)) return false;
 
     while(bson_iter_next(&resultIter_)) {
         std::string_view resultKey(bson_iter_key(&resultIter_));
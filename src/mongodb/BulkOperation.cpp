@@ -7,8 +7,10 @@
 
 using namespace knowrob::mongo;
 
-BulkOperation::BulkOperation(mongoc_bulk_operation_t *handle)
-: handle_(handle)
+BulkOperation::BulkOperation(mongoc_bulk_operation_t *handle,
+                             const std::shared_ptr<ClientLease> &lease)
+: handle_(handle),
+  lease_(lease)
 {
 }
 
@@ -18,6 +20,7 @@ BulkOperation::~BulkOperation()
         mongoc_bulk_operation_destroy(handle_);
         handle_ = nullptr;
     }
+    lease_ = nullptr;
 }
 
 void BulkOperation::validateBulkHandle()
@@ -32,7 +35,7 @@ void BulkOperation::validateBulkHandle()
     }
 }
 
-void BulkOperation::pushInsert(bson_t *document)
+void BulkOperation::pushInsert(const bson_t *document)
 {
     validateBulkHandle();
 
@@ -47,7 +50,7 @@ void BulkOperation::pushInsert(bson_t *document)
     }
 }
 
-void BulkOperation::pushRemoveOne(bson_t *document)
+void BulkOperation::pushRemoveOne(const bson_t *document)
 {
     validateBulkHandle();
 
@@ -62,7 +65,7 @@ void BulkOperation::pushRemoveOne(bson_t *document)
     }
 }
 
-void BulkOperation::pushRemoveAll(bson_t *document)
+void BulkOperation::pushRemoveAll(const bson_t *document)
 {
     validateBulkHandle();
 
@@ -106,6 +109,8 @@ void BulkOperation::execute()
     bson_destroy(&bulk_reply);
     mongoc_bulk_operation_destroy(handle_);
     handle_ = nullptr;
+    // give the client back to the pool
+    lease_ = nullptr;
     // throw exception on error
     if(!success) {
         throw MongoException("bulk_operation", bulk_err);
@@ -19,17 +19,17 @@ ChangeStream::ChangeStream(
   queryID_(queryID),
   next_ptr_()
 {
-	// connect and append session ID to options
-	//collection_ = std::make_unique<Collection>(pool, database, collection);
+	// lease a client and append session ID to options
+	lease_ = std::make_unique<ClientLease>(pool, std::string(database), std::string(collection));
     bson_t *opts = BCON_NEW(
         //"batchSize": xx,
    		"maxAwaitTimeMS", BCON_INT32(1),                // the watcher should be non-blocking
    		"fullDocument",   BCON_UTF8("updateLookup")     // always fetch full document
    	);
-	collection_->appendSession(opts);
-    bson_destroy(opts);
+	lease_->appendSession(opts);
 	// create the stream object
-	stream_ = mongoc_collection_watch(collection_->coll(), query, opts);
+	stream_ = mongoc_collection_watch(lease_->coll(), query, opts);
+    bson_destroy(opts);
 }
 
 ChangeStream::~ChangeStream()
@@ -38,6 +38,7 @@ ChangeStream::~ChangeStream()
 		mongoc_change_stream_destroy(stream_);
 		stream_ = nullptr;
 	}
+	lease_ = nullptr;
 }
 
 bool ChangeStream::next()
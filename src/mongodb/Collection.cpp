@@ -25,49 +25,22 @@ Collection::Collection(
 	    const std::string_view &collectionName)
 : connection_(connection),
   name_(collectionName),
-  dbName_(databaseName),
-  session_(nullptr)
+  dbName_(databaseName)
 {
-	client_ = mongoc_client_pool_pop(connection_->pool_);
-	coll_ = mongoc_client_get_collection(client_, dbName_.c_str(), name_.c_str());
-    db_ = mongoc_client_get_database(client_, dbName_.c_str());
 }
 
-Collection::~Collection()
-{
-    if(session_) {
-        mongoc_client_session_destroy(session_);
-        session_ = nullptr;
-    }
-    mongoc_database_destroy(db_);
-	mongoc_collection_destroy(coll_);
-    mongoc_client_pool_push(connection_->pool_, client_);
-}
+Collection::~Collection() = default;
 
-mongoc_client_session_t* Collection::session()
+std::shared_ptr<ClientLease> Collection::lease()
 {
-    if(!session_) {
-        bson_error_t error;
-        session_ = mongoc_client_start_session (client_, nullptr, &error);
-    }
-    return session_;
-}
-
-void Collection::appendSession(bson_t *opts)
-{
-    auto s = session();
-	if(s!=nullptr) {
-		bson_error_t error;
-		if(!mongoc_client_session_append(s, opts, &error)) {
-		    throw MongoException("append_session", error);
-		}
-	}
+    return std::make_shared<ClientLease>(connection_->pool_, dbName_, name_);
 }
 
 void Collection::drop()
 {
 	bson_error_t err;
-	if(!mongoc_collection_drop(coll_,&err)) {
+	ClientLease l(connection_->pool_, dbName_, name_);
+	if(!mongoc_collection_drop(l.coll(),&err)) {
 		throw MongoException("drop_failed", err);
 	}
 }
@@ -75,8 +48,9 @@ void Collection::drop()
 void Collection::storeOne(const Document &document)
 {
     bson_error_t err;
+    ClientLease l(connection_->pool_, dbName_, name_);
     if(!mongoc_collection_insert(
-            coll_,
+            l.coll(),
             INSERT_NO_VALIDATE_FLAG,
             document.bson(),
             nullptr,
@@ -104,8 +78,9 @@ void Collection::removeOne(const Document &document)
 void Collection::remove(const Document &document, mongoc_remove_flags_t flag)
 {
     bson_error_t err;
+    ClientLease l(connection_->pool_, dbName_, name_);
     if(!mongoc_collection_remove(
-            coll_,
+            l.coll(),
             flag,
             document.bson(),
             nullptr,
@@ -123,8 +98,9 @@ void Collection::update(const Document &query, const Document &update, bool upse
     int flags = UPDATE_NO_VALIDATE_FLAG;
     if(upsert) flags |= MONGOC_UPDATE_UPSERT;
 
+    ClientLease l(connection_->pool_, dbName_, name_);
     if(!mongoc_collection_update(
-            coll_,
+            l.coll(),
             (mongoc_update_flags_t)flags,
             query.bson(),
             update.bson(),
@@ -137,8 +113,9 @@ void Collection::update(const Document &query, const Document &update, bool upse
 
 void Collection::evalAggregation(const bson_t *pipeline)
 {
+    ClientLease l(connection_->pool_, dbName_, name_);
     auto cursor = mongoc_collection_aggregate(
-            coll_,
+            l.coll(),
             MONGOC_QUERY_NONE,
             pipeline,
             nullptr,
@@ -155,30 +132,54 @@ void Collection::evalAggregation(const bson_t *pipeline)
     mongoc_cursor_destroy(cursor);
 }
 
-std::shared_ptr<BulkOperation> Collection::createBulkOperation()
+std::shared_ptr<BulkOperation> Collection::createBulkOperation(bool isOrdered)
 {
     bson_t opts = BSON_INITIALIZER;
-    BSON_APPEND_BOOL(&opts, "ordered", false);
-    // create the bulk operation
+    BSON_APPEND_BOOL(&opts, "ordered", isOrdered);
+    if(writeConcern_ && !mongoc_write_concern_append(writeConcern_.get(), &opts)) {
+        bson_destroy(&opts);
+        bson_error_t err;
+        bson_set_error(&err,
+                       MONGOC_ERROR_COMMAND,
+                       MONGOC_ERROR_COMMAND_INVALID_ARG,
+                       "invalid write concern");
+        throw MongoException("bulk_operation", err);
+    }
+    // the bulk operation keeps the client until it is executed
+    auto l = lease();
     mongoc_bulk_operation_t *bulk =
-            mongoc_collection_create_bulk_operation_with_opts(coll_, &opts);
+            mongoc_collection_create_bulk_operation_with_opts(l->coll(), &opts);
     bson_destroy(&opts);
-    return std::make_shared<BulkOperation>(bulk);
+    return std::make_shared<BulkOperation>(bulk, l);
 }
 
-void Collection::createIndex_internal(const bson_t &keys)
+void Collection::createIndex_internal(const bson_t &keys, const bson_t *partialFilter)
 {
     bson_error_t err;
     bson_t reply;
 
+    ClientLease l(connection_->pool_, dbName_, name_);
     char *index_name = mongoc_collection_keys_to_index_string(&keys);
-    bson_t *cmd = BCON_NEW ("createIndexes", BCON_UTF8(mongoc_collection_get_name(coll_)),
-                            "indexes", "[", "{",
-                            "key",  BCON_DOCUMENT(&keys),
-                            "name", BCON_UTF8(index_name),
-                            "}",  "]");
+    bson_t *cmd;
+    if(partialFilter) {
+        // partial indexes need a name that differs from the full index with same keys
+        std::string partialName = std::string(index_name) + "_partial";
+        cmd = BCON_NEW ("createIndexes", BCON_UTF8(name_.c_str()),
+                        "indexes", "[", "{",
+                        "key",  BCON_DOCUMENT(&keys),
+                        "name", BCON_UTF8(partialName.c_str()),
+                        "partialFilterExpression", BCON_DOCUMENT(partialFilter),
+                        "}",  "]");
+    }
+    else {
+        cmd = BCON_NEW ("createIndexes", BCON_UTF8(name_.c_str()),
+                        "indexes", "[", "{",
+                        "key",  BCON_DOCUMENT(&keys),
+                        "name", BCON_UTF8(index_name),
+                        "}",  "]");
+    }
     bool success = mongoc_database_write_command_with_opts (
-            db_,
+            l.db(),
             cmd,
             nullptr /* opts */,
             &reply,
@@ -200,6 +201,14 @@ void Collection::createAscendingIndex(const std::vector<const char*> &keys)
     createIndex_internal(b_keys);
 }
 
+void Collection::createAscendingIndex(const std::vector<const char*> &keys, const bson_t *partialFilter)
+{
+    bson_t b_keys;
+    bson_init(&b_keys);
+    for(auto key : keys) BSON_APPEND_INT32(&b_keys, key, 1);
+    createIndex_internal(b_keys, partialFilter);
+}
+
 void Collection::createIndex(const std::vector<IndexKey> &keys)
 {
     bson_t b_keys;
@@ -222,8 +231,9 @@ bool Collection::empty()
     bson_error_t error;
     int64_t count;
 
+    ClientLease l(connection_->pool_, dbName_, name_);
     count = mongoc_collection_count_documents(
-            coll_,
+            l.coll(),
             &filter,
             opts,
             nullptr,
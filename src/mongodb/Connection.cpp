@@ -8,9 +8,14 @@
 
 #include "knowrob/mongodb/Connection.h"
 #include "knowrob/mongodb/MongoException.h"
+#include "knowrob/Metrics.h"
+#include "knowrob/Logger.h"
 #include <string>
 using namespace knowrob::mongo;
 
+// the default of libmongoc
+#define MONGO_DEFAULT_MAX_POOL_SIZE 100
+
 Connection::Connection(const std::string &uri_string)
         : uri_string_(uri_string)
 {
@@ -22,6 +27,19 @@ Connection::Connection(const std::string &uri_string)
     pool_ = mongoc_client_pool_new(uri_);
     // connectionWatch_ = std::make_shared<QueryWatch>(pool_);
     mongoc_client_pool_set_error_api(pool_, 2);
+    // compressors that are not supported by libmongoc are dropped from the URI
+    if(uri_string_.find(MONGOC_URI_COMPRESSORS) != std::string::npos) {
+        auto enabled = compressors();
+        if(enabled.empty()) {
+            KB_WARN("None of the requested wire compressors is supported by libmongoc, "
+                    "the connection is not compressed.");
+        }
+        else {
+            std::string names;
+            for(auto &name : enabled) names += (names.empty() ? "" : ",") + name;
+            KB_DEBUG("Wire compressors of the connection: {}.", names);
+        }
+    }
 }
 
 Connection::~Connection()
@@ -29,4 +47,91 @@ Connection::~Connection()
     mongoc_client_pool_destroy(pool_);
     mongoc_uri_destroy(uri_);
     mongoc_cleanup();
-}
\ No newline at end of file
+}
+
+int32_t Connection::maxPoolSize() const
+{
+    return mongoc_uri_get_option_as_int32(uri_, MONGOC_URI_MAXPOOLSIZE, MONGO_DEFAULT_MAX_POOL_SIZE);
+}
+
+std::vector<std::string> Connection::compressors() const
+{
+    std::vector<std::string> names;
+    const bson_t *compressorsDoc = mongoc_uri_get_compressors(uri_);
+    bson_iter_t iter;
+    if(compressorsDoc && bson_iter_init(&iter, compressorsDoc)) {
+        while(bson_iter_next(&iter)) {
+            names.emplace_back(bson_iter_key(&iter));
+        }
+    }
+    return names;
+}
+
+ClientLease::ClientLease(mongoc_client_pool_t *pool,
+                         const std::string &dbName,
+                         const std::string &collectionName)
+        : pool_(pool),
+          db_(nullptr),
+          session_(nullptr),
+          dbName_(dbName)
+{
+    static auto &numLeases = knowrob::Metrics::get().counter(
+            "knowrob_mongo_client_leases_total", "Number of mongo clients leased from a pool.");
+    static auto &numWaiting = knowrob::Metrics::get().counter(
+            "knowrob_mongo_client_lease_waits_total", "Number of leases that had to wait for a free client.");
+    static auto &numLeased = knowrob::Metrics::get().gauge(
+            "knowrob_mongo_leased_clients", "Number of mongo clients currently leased from a pool.");
+    // try to get a client without blocking first to count leases that need to wait
+    client_ = mongoc_client_pool_try_pop(pool_);
+    if(!client_) {
+        numWaiting.increment();
+        client_ = mongoc_client_pool_pop(pool_);
+    }
+    numLeases.increment();
+    numLeased.add(1);
+    coll_ = mongoc_client_get_collection(client_, dbName_.c_str(), collectionName.c_str());
+}
+
+ClientLease::~ClientLease()
+{
+    static auto &numLeased = knowrob::Metrics::get().gauge(
+            "knowrob_mongo_leased_clients", "Number of mongo clients currently leased from a pool.");
+    if(session_) {
+        mongoc_client_session_destroy(session_);
+        session_ = nullptr;
+    }
+    if(db_) {
+        mongoc_database_destroy(db_);
+    }
+    mongoc_collection_destroy(coll_);
+    mongoc_client_pool_push(pool_, client_);
+    numLeased.add(-1);
+}
+
+mongoc_database_t* ClientLease::db()
+{
+    if(!db_) {
+        db_ = mongoc_client_get_database(client_, dbName_.c_str());
+    }
+    return db_;
+}
+
+mongoc_client_session_t* ClientLease::session()
+{
+    if(!session_) {
+        bson_error_t error;
+        session_ = mongoc_client_start_session(client_, nullptr, &error);
+    }
+    return session_;
+}
+
+void ClientLease::appendSession(bson_t *opts)
+{
+    auto s = session();
+    if(s!=nullptr) {
+        bson_error_t error;
+        if(!mongoc_client_session_append(s, opts, &error)) {
+            throw MongoException("append_session", error);
+        }
+    }
+}
@@ -18,11 +18,14 @@ using namespace knowrob::mongo;
 Cursor::Cursor(const std::shared_ptr<Collection> &collection)
 : cursor_(nullptr),
   collection_(collection),
-  isAggregateQuery_(false)
+  isAggregateQuery_(false),
+  isExhausted_(false),
+  hasFirstBatch_(false),
+  batchSize_(0),
+  firstBatchSize_(0)
 {
 	query_ = bson_new();
 	opts_ = bson_new();
-	collection_->appendSession(opts_);
 	// use pointer as id
 	std::stringstream ss;
 	ss << static_cast<const void*>(this);  
@@ -30,12 +33,20 @@ Cursor::Cursor(const std::shared_ptr<Collection> &collection)
 }
 
 Cursor::~Cursor()
+{
+	release();
+	bson_destroy(query_);
+	bson_destroy(opts_);
+}
+
+void Cursor::release()
 {
 	if(cursor_!= nullptr) {
 		mongoc_cursor_destroy(cursor_);
+		cursor_ = nullptr;
 	}
-	bson_destroy(query_);
-	bson_destroy(opts_);
+	// the cursor must be destroyed before its client is returned to the pool
+	lease_ = nullptr;
 }
 
 void Cursor::limit(unsigned int limit)
@@ -43,6 +54,12 @@ void Cursor::limit(unsigned int limit)
 	BSON_APPEND_INT64(opts_, "limit", limit);
 }
 
+void Cursor::batchSize(uint32_t size, uint32_t firstBatchSize)
+{
+	batchSize_ = size;
+	firstBatchSize_ = firstBatchSize;
+}
+
 void Cursor::ascending(const char *key)
 {
 	static bson_t *doc = BCON_NEW("sort", "{", key, BCON_INT32(1), "}");
@@ -68,18 +85,31 @@ void Cursor::aggregate(const bson_t *query_doc)
 
 bool Cursor::next(const bson_t **doc, bool ignore_empty)
 {
+	if(isExhausted_) {
+		return ignore_empty;
+	}
 	if(cursor_== nullptr) {
+		lease_ = collection_->lease();
+		// the session id is only valid for the leased client
+		bson_t opts;
+		bson_copy_to(opts_, &opts);
+		lease_->appendSession(&opts);
+		if(firstBatchSize()>0) {
+			BSON_APPEND_INT32(&opts, "batchSize", firstBatchSize());
+		}
 		if(isAggregateQuery_) {
 			cursor_ = mongoc_collection_aggregate(
-                    collection_->coll(), MONGOC_QUERY_NONE, query_, opts_, nullptr /* read_prefs */ );
+                    lease_->coll(), MONGOC_QUERY_NONE, query_, &opts, nullptr /* read_prefs */ );
 		}
 		else {
 			cursor_ = mongoc_collection_find_with_opts(
-                    collection_->coll(), query_, opts_, nullptr /* read_prefs */ );
+                    lease_->coll(), query_, &opts, nullptr /* read_prefs */ );
 		}
+		bson_destroy(&opts);
 		// make sure cursor has no error after creation
 		bson_error_t err1;
 		if(mongoc_cursor_error(cursor_, &err1)) {
+			release();
 			throw MongoException("cursor_error", err1);
 		}
 	}
@@ -87,12 +117,23 @@ bool Cursor::next(const bson_t **doc, bool ignore_empty)
 	if(!mongoc_cursor_next(cursor_,doc)) {
 		// make sure cursor has no error after next has been called
 		bson_error_t err2;
-		if(mongoc_cursor_error(cursor_, &err2)) {
+		bool hasError = mongoc_cursor_error(cursor_, &err2);
+		// no more results, the client can be used by other operations
+		release();
+		isExhausted_ = true;
+		if(hasError) {
 			throw MongoException("cursor_error", err2);
 		}
 		return ignore_empty;
 	}
 	else {
+		if(!hasFirstBatch_) {
+			// the first batch has been received, use the regular batch size for getMore commands
+			hasFirstBatch_ = true;
+			if(batchSize_>0 && batchSize_!=firstBatchSize()) {
+				mongoc_cursor_set_batch_size(cursor_, batchSize_);
+			}
+		}
 		return true;
 	}
 }
@@ -100,8 +141,16 @@ bool Cursor::next(const bson_t **doc, bool ignore_empty)
 bool Cursor::erase()
 {
 	bson_error_t err;
-	bool success = mongoc_collection_delete_many(
-            collection_->coll(), query_, opts_, nullptr /* reply */, &err);
+	bool success;
+	if(lease_) {
+		success = mongoc_collection_delete_many(
+				lease_->coll(), query_, opts_, nullptr /* reply */, &err);
+	}
+	else {
+		ClientLease l(collection_->pool(), collection_->dbName(), collection_->name());
+		success = mongoc_collection_delete_many(
+				l.coll(), query_, opts_, nullptr /* reply */, &err);
+	}
 	if(!success) {
 		throw MongoException("erase_error", err);
 	}
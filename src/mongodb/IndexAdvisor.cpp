@@ -0,0 +1,534 @@
+//
+// Created by daniel on 18.10.26.
+//
+
+#include <gtest/gtest.h>
+#include <set>
+#include <cstring>
+#include <sstream>
+#include <algorithm>
+#include "knowrob/mongodb/IndexAdvisor.h"
+#include "knowrob/mongodb/Cursor.h"
+#include "knowrob/mongodb/MongoException.h"
+#include "knowrob/Logger.h"
+#include "knowrob/Metrics.h"
+
+using namespace knowrob::mongo;
+
+// fields of triple documents in the order they should appear in an index.
+// more selective fields come first.
+static const std::vector<std::string> fieldOrder = {
+    "s", "p", "p*", "o", "o*", "graph", "agent",
+    "uncertain", "occasional", "confidence",
+    "scope.time.since", "scope.time.until"
+};
+// fields that are undefined in some of the triple documents
+static const std::set<std::string> optionalFields = {
+    "agent", "confidence", "uncertain", "occasional",
+    "scope.time.since", "scope.time.until"
+};
+
+static inline size_t fieldRank(const std::string &field)
+{
+    auto it = std::find(fieldOrder.begin(), fieldOrder.end(), field);
+    return it - fieldOrder.begin();
+}
+
+static void sortFields(std::vector<std::string> &fields)
+{
+    std::sort(fields.begin(), fields.end(),
+              [](const std::string &a, const std::string &b) {
+        auto ra = fieldRank(a), rb = fieldRank(b);
+        return ra != rb ? ra < rb : a < b;
+    });
+}
+
+static std::string joinFields(const std::vector<std::string> &fields, const char *separator)
+{
+    std::stringstream ss;
+    for(auto i=0u; i<fields.size(); ++i) {
+        if(i>0) ss << separator;
+        ss << fields[i];
+    }
+    return ss.str();
+}
+
+namespace knowrob::mongo {
+    struct ShapeFields {
+        std::set<std::string> equality;
+        std::set<std::string> range;
+        std::set<std::string> required;
+    };
+}
+
+static void readOperatorShape(bson_iter_t *iter, const std::string &field,
+                              ShapeFields &fields, bool isDisjunctive)
+{
+    bson_iter_t opIter;
+    bool isRange = false, isRequired = !isDisjunctive;
+    if(bson_iter_recurse(iter, &opIter)) {
+        while(bson_iter_next(&opIter)) {
+            std::string_view op(bson_iter_key(&opIter));
+            if(op=="$lt" || op=="$lte" || op=="$gt" || op=="$gte" || op=="$ne" || op=="$nin") {
+                isRange = true;
+            }
+            else if(op=="$exists") {
+                // { $exists: false } matches the null key in the index
+                if(bson_iter_as_bool(&opIter)) isRange = true;
+                else isRequired = false;
+            }
+        }
+    }
+    if(isRange) fields.range.insert(field);
+    else fields.equality.insert(field);
+    if(isRequired) fields.required.insert(field);
+}
+
+static void readShapeFields(bson_iter_t *iter, ShapeFields &fields, bool isDisjunctive) //NOLINT
+{
+    while(bson_iter_next(iter)) {
+        std::string key(bson_iter_key(iter));
+        bson_iter_t childIter, branchIter;
+
+        if(key=="$or" || key=="$and") {
+            if(!bson_iter_recurse(iter, &childIter)) continue;
+            while(bson_iter_next(&childIter)) {
+                if(bson_iter_recurse(&childIter, &branchIter)) {
+                    readShapeFields(&branchIter, fields, isDisjunctive || key=="$or");
+                }
+            }
+        }
+        else if(key[0]=='$') {
+            // e.g. $expr with values of variables that are only known at runtime
+            continue;
+        }
+        else if(BSON_ITER_HOLDS_DOCUMENT(iter)) {
+            readOperatorShape(iter, key, fields, isDisjunctive);
+        }
+        else if(BSON_ITER_HOLDS_NULL(iter)) {
+            // e.g. { $or: [ { b: null }, { b: {$gt: 10.0} } ] }
+            fields.equality.insert(key);
+        }
+        else {
+            fields.equality.insert(key);
+            if(!isDisjunctive) fields.required.insert(key);
+        }
+    }
+}
+
+std::string SelectorShape::key() const
+{
+    std::stringstream ss;
+    ss << joinFields(equalityFields, ",") << '|'
+       << joinFields(rangeFields, ",") << '|'
+       << joinFields(requiredFields, ",");
+    return ss.str();
+}
+
+std::string IndexRecommendation::name() const
+{
+    // same as the default name generated by mongo
+    std::stringstream ss;
+    for(auto i=0u; i<keys.size(); ++i) {
+        if(i>0) ss << '_';
+        ss << keys[i] << "_1";
+    }
+    if(!partialFields.empty()) ss << "_partial";
+    return ss.str();
+}
+
+std::string IndexAdvice::createScript(const std::string &collectionName) const
+{
+    std::stringstream ss;
+    for(auto &index : create) {
+        ss << "db." << collectionName << ".createIndex({";
+        for(auto i=0u; i<index.keys.size(); ++i) {
+            if(i>0) ss << ", ";
+            ss << '"' << index.keys[i] << "\": 1";
+        }
+        ss << "}, {name: \"" << index.name() << '"';
+        if(!index.partialFields.empty()) {
+            ss << ", partialFilterExpression: {";
+            for(auto i=0u; i<index.partialFields.size(); ++i) {
+                if(i>0) ss << ", ";
+                ss << '"' << index.partialFields[i] << "\": {$exists: true}";
+            }
+            ss << '}';
+        }
+        ss << "});\n";
+    }
+    return ss.str();
+}
+
+std::string IndexAdvice::dropScript(const std::string &collectionName) const
+{
+    std::stringstream ss;
+    for(auto &index : drop) {
+        ss << "db." << collectionName << ".dropIndex(\"" << index.name << "\");\n";
+    }
+    return ss.str();
+}
+
+IndexAdvisor::IndexAdvisor(const std::shared_ptr<Collection> &collection)
+: collection_(collection),
+  minDropWindow_(DEFAULT_MIN_DROP_WINDOW),
+  minDropSelectors_(DEFAULT_MIN_DROP_SELECTORS),
+  numSelectors_(0)
+{
+}
+
+void IndexAdvisor::addRequiredIndex(const std::vector<std::string> &keys)
+{
+    IndexRecommendation index;
+    index.keys = keys;
+    std::lock_guard<std::mutex> lock(mutex_);
+    requiredIndexes_.insert(index.name());
+}
+
+void IndexAdvisor::setDropThresholds(std::chrono::seconds minWindow, uint64_t minSelectors)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    minDropWindow_ = minWindow;
+    minDropSelectors_ = minSelectors;
+}
+
+bool IndexAdvisor::isDropCandidate(const IndexUsage &usage, std::chrono::system_clock::time_point now)
+{
+    if(usage.numOps > 0 || usage.name == "_id_") return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(requiredIndexes_.count(usage.name) > 0) return false;
+    // too few selectors were recorded to conclude that the index is not needed
+    if(numSelectors_ < minDropSelectors_) return false;
+    // the statistics are reset when the server restarts, and when the index is (re)created
+    if(now - usage.since < minDropWindow_) return false;
+    auto it = recommendedIndexes_.find(usage.name);
+    return it == recommendedIndexes_.end() || now - it->second >= minDropWindow_;
+}
+
+SelectorShape IndexAdvisor::readShape(const bson_t *selectorDoc)
+{
+    ShapeFields fields;
+    bson_iter_t iter;
+    if(bson_iter_init(&iter, selectorDoc)) {
+        readShapeFields(&iter, fields, false);
+    }
+    SelectorShape shape;
+    for(auto &field : fields.range) {
+        // fields with range constraints are range fields even if they have
+        // an equality constraint in another branch.
+        fields.equality.erase(field);
+        shape.rangeFields.push_back(field);
+    }
+    shape.equalityFields.insert(shape.equalityFields.end(), fields.equality.begin(), fields.equality.end());
+    shape.requiredFields.insert(shape.requiredFields.end(), fields.required.begin(), fields.required.end());
+    sortFields(shape.equalityFields);
+    sortFields(shape.rangeFields);
+    sortFields(shape.requiredFields);
+    return shape;
+}
+
+IndexRecommendation IndexAdvisor::recommendIndex(const SelectorShape &shape)
+{
+    IndexRecommendation index;
+    // equality fields before range fields such that the index
+    // can be scanned for one interval of the range fields.
+    index.keys = shape.equalityFields;
+    index.keys.insert(index.keys.end(), shape.rangeFields.begin(), shape.rangeFields.end());
+    // optional fields that must exist can be used to skip documents
+    // without the field in the index.
+    for(auto &field : shape.requiredFields) {
+        if(optionalFields.count(field)>0) index.partialFields.push_back(field);
+    }
+    return index;
+}
+
+bool IndexAdvisor::supportsShape(const SelectorShape &shape, const std::vector<std::string> &keys)
+{
+    // count the leading keys of the index that are constrained by the selector
+    std::set<std::string> leadingFields;
+    for(auto &key : keys) {
+        if(std::find(shape.equalityFields.begin(), shape.equalityFields.end(), key) == shape.equalityFields.end() &&
+           std::find(shape.rangeFields.begin(), shape.rangeFields.end(), key) == shape.rangeFields.end()) {
+            break;
+        }
+        leadingFields.insert(key);
+    }
+    return std::all_of(shape.equalityFields.begin(), shape.equalityFields.end(),
+                       [&leadingFields](const std::string &field) { return leadingFields.count(field)>0; });
+}
+
+void IndexAdvisor::recordSelector(const bson_t *selectorDoc)
+{
+    static auto &numRecorded = knowrob::Metrics::get().counter(
+            "knowrob_mongo_index_advisor_selectors_total", "Number of selectors recorded by the index advisor.");
+    auto shape = readShape(selectorDoc);
+    if(shape.equalityFields.empty() && shape.rangeFields.empty()) return;
+    auto shapeKey = shape.key();
+    numRecorded.increment();
+    numSelectors_ += 1;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = shapes_.find(shapeKey);
+    if(it == shapes_.end()) {
+        // keep the first selector of each shape to explain its query plan later
+        std::shared_ptr<bson_t> sample(bson_copy(selectorDoc), bson_destroy);
+        shapes_.emplace(shapeKey, ShapeRecord{shape, sample, 1});
+    }
+    else {
+        it->second.count += 1;
+    }
+}
+
+static std::vector<std::string> readKeyPattern(bson_iter_t *iter)
+{
+    std::vector<std::string> keys;
+    bson_iter_t keyIter;
+    if(bson_iter_recurse(iter, &keyIter)) {
+        while(bson_iter_next(&keyIter)) {
+            keys.emplace_back(bson_iter_key(&keyIter));
+        }
+    }
+    return keys;
+}
+
+static void readIndexScans(bson_iter_t *iter, std::vector<std::vector<std::string>> &scans) //NOLINT
+{
+    bson_iter_t childIter;
+    while(bson_iter_next(iter)) {
+        if(strcmp(bson_iter_key(iter), "keyPattern")==0 && BSON_ITER_HOLDS_DOCUMENT(iter)) {
+            scans.push_back(readKeyPattern(iter));
+        }
+        else if((BSON_ITER_HOLDS_DOCUMENT(iter) || BSON_ITER_HOLDS_ARRAY(iter)) &&
+                bson_iter_recurse(iter, &childIter)) {
+            // e.g. "inputStage" or "inputStages"
+            readIndexScans(&childIter, scans);
+        }
+    }
+}
+
+std::vector<std::vector<std::string>> IndexAdvisor::explainIndexKeys(const bson_t *selectorDoc)
+{
+    std::vector<std::vector<std::string>> scans;
+    bson_t reply;
+    bson_error_t err;
+    auto lease = collection_->lease();
+    bson_t *cmd = BCON_NEW(
+            "explain", "{",
+                "find", BCON_UTF8(collection_->name().c_str()),
+                "filter", BCON_DOCUMENT(selectorDoc),
+            "}",
+            "verbosity", BCON_UTF8("queryPlanner"));
+    bool success = mongoc_database_command_simple(lease->db(), cmd, nullptr, &reply, &err);
+    bson_destroy(cmd);
+    if(!success) {
+        bson_destroy(&reply);
+        throw MongoException("explain_failed", err);
+    }
+
+    bson_iter_t iter, planIter;
+    if(bson_iter_init(&iter, &reply) &&
+       bson_iter_find_descendant(&iter, "queryPlanner.winningPlan", &planIter) &&
+       bson_iter_recurse(&planIter, &iter)) {
+        readIndexScans(&iter, scans);
+    }
+    bson_destroy(&reply);
+    return scans;
+}
+
+std::vector<IndexUsage> IndexAdvisor::readIndexStats()
+{
+    std::vector<IndexUsage> stats;
+    bson_t *pipeline = BCON_NEW("pipeline", "[", "{", "$indexStats", "{", "}", "}", "]");
+    Cursor cursor(collection_);
+    cursor.aggregate(pipeline);
+    bson_destroy(pipeline);
+
+    const bson_t *doc;
+    while(cursor.next(&doc)) {
+        bson_iter_t iter;
+        IndexUsage usage;
+        if(bson_iter_init_find(&iter, doc, "name") && BSON_ITER_HOLDS_UTF8(&iter)) {
+            usage.name = bson_iter_utf8(&iter, nullptr);
+        }
+        if(bson_iter_init_find(&iter, doc, "key")) {
+            usage.keys = readKeyPattern(&iter);
+        }
+        bson_iter_t opsIter;
+        if(bson_iter_init(&iter, doc) && bson_iter_find_descendant(&iter, "accesses.ops", &opsIter)) {
+            usage.numOps = bson_iter_as_int64(&opsIter);
+        }
+        if(bson_iter_init(&iter, doc) && bson_iter_find_descendant(&iter, "accesses.since", &opsIter) &&
+           BSON_ITER_HOLDS_DATE_TIME(&opsIter)) {
+            usage.since = std::chrono::system_clock::time_point(
+                    std::chrono::milliseconds(bson_iter_date_time(&opsIter)));
+        }
+        else {
+            // unknown begin of the statistics, assume they were just reset
+            usage.since = std::chrono::system_clock::now();
+        }
+        stats.push_back(usage);
+    }
+    return stats;
+}
+
+IndexAdvice IndexAdvisor::advise(uint64_t minSelectors)
+{
+    IndexAdvice advice;
+    std::map<std::string, IndexRecommendation> recommendations;
+
+    // copy the records such that selectors can be recorded while
+    // query plans are explained.
+    std::vector<ShapeRecord> records;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for(auto &pair : shapes_) {
+            if(pair.second.count >= minSelectors) records.push_back(pair.second);
+        }
+    }
+
+    for(auto &record : records) {
+        // skip shapes for which the planner already selects a suitable index
+        auto scans = explainIndexKeys(record.sample.get());
+        if(std::any_of(scans.begin(), scans.end(),
+                       [&record](auto &keys) { return supportsShape(record.shape, keys); })) {
+            continue;
+        }
+        auto index = recommendIndex(record.shape);
+        auto &existing = recommendations[index.name()];
+        if(existing.keys.empty()) {
+            existing = index;
+        }
+        existing.numSelectors += record.count;
+    }
+
+    for(auto &pair : recommendations) {
+        auto &index = pair.second;
+        // drop indexes that are a prefix of another recommended index
+        bool isRedundant = std::any_of(recommendations.begin(), recommendations.end(),
+            [&index](auto &other) {
+                return other.second.keys.size() > index.keys.size() &&
+                       other.second.partialFields == index.partialFields &&
+                       std::equal(index.keys.begin(), index.keys.end(), other.second.keys.begin());
+            });
+        if(!isRedundant) advice.create.push_back(index);
+    }
+    std::sort(advice.create.begin(), advice.create.end(),
+              [](auto &a, auto &b) { return a.numSelectors > b.numSelectors; });
+
+    auto now = std::chrono::system_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for(auto &index : advice.create) recommendedIndexes_[index.name()] = now;
+    }
+    for(auto &usage : readIndexStats()) {
+        if(isDropCandidate(usage, now)) advice.drop.push_back(usage);
+    }
+
+    return advice;
+}
+
+void IndexAdvisor::apply(const IndexAdvice &advice)
+{
+    for(auto &index : advice.create) {
+        std::vector<const char*> keys;
+        for(auto &key : index.keys) keys.push_back(key.c_str());
+
+        if(index.partialFields.empty()) {
+            collection_->createAscendingIndex(keys);
+        }
+        else {
+            bson_t partialFilter, existsDoc;
+            bson_init(&partialFilter);
+            for(auto &field : index.partialFields) {
+                BSON_APPEND_DOCUMENT_BEGIN(&partialFilter, field.c_str(), &existsDoc);
+                BSON_APPEND_BOOL(&existsDoc, "$exists", true);
+                bson_append_document_end(&partialFilter, &existsDoc);
+            }
+            collection_->createAscendingIndex(keys, &partialFilter);
+            bson_destroy(&partialFilter);
+        }
+        KB_INFO("created index \"{}\" used by {} recorded selectors.", index.name(), index.numSelectors);
+        std::lock_guard<std::mutex> lock(mutex_);
+        recommendedIndexes_[index.name()] = std::chrono::system_clock::now();
+    }
+}
+
+// fixture class for testing
+class IndexAdvisorTest : public ::testing::Test {
+protected:
+    static void recordSelectors(IndexAdvisor &advisor, uint64_t count)
+    {
+        bson_t *selector = BCON_NEW("s", BCON_UTF8("a"));
+        for(uint64_t i=0; i<count; ++i) advisor.recordSelector(selector);
+        bson_destroy(selector);
+    }
+};
+
+TEST_F(IndexAdvisorTest, TimeSelectorShape)
+{
+    // { s: "a", "p*": "b", $or: [ { occasional: null }, { occasional: 0 } ],
+    //   $or: [ { "scope.time.since": null }, { "scope.time.since": { $lte: 10.0 } } ] }
+    bson_t *selector = BCON_NEW(
+        "s", BCON_UTF8("a"),
+        "p*", BCON_UTF8("b"),
+        "$or", "[", "{", "occasional", BCON_NULL, "}", "{", "occasional", BCON_INT32(0), "}", "]",
+        "$or", "[", "{", "scope.time.since", BCON_NULL, "}",
+                    "{", "scope.time.since", "{", "$lte", BCON_DOUBLE(10.0), "}", "}", "]");
+    auto shape = IndexAdvisor::readShape(selector);
+    bson_destroy(selector);
+
+    EXPECT_EQ(shape.equalityFields, std::vector<std::string>({"s", "p*", "occasional"}));
+    EXPECT_EQ(shape.rangeFields, std::vector<std::string>({"scope.time.since"}));
+    EXPECT_EQ(shape.requiredFields, std::vector<std::string>({"s", "p*"}));
+
+    auto index = IndexAdvisor::recommendIndex(shape);
+    EXPECT_EQ(index.keys, std::vector<std::string>({"s", "p*", "occasional", "scope.time.since"}));
+    EXPECT_TRUE(index.partialFields.empty());
+    EXPECT_TRUE(IndexAdvisor::supportsShape(shape, index.keys));
+    EXPECT_TRUE(IndexAdvisor::supportsShape(shape, {"s", "p*", "occasional"}));
+    EXPECT_FALSE(IndexAdvisor::supportsShape(shape, {"s", "o"}));
+}
+
+TEST_F(IndexAdvisorTest, AgentSelectorIsPartial)
+{
+    bson_t *selector = BCON_NEW(
+        "o", BCON_UTF8("c"),
+        "agent", BCON_UTF8("fred"));
+    auto shape = IndexAdvisor::readShape(selector);
+    bson_destroy(selector);
+
+    IndexAdvice advice;
+    advice.create.push_back(IndexAdvisor::recommendIndex(shape));
+    EXPECT_EQ(advice.create[0].name(), "o_1_agent_1_partial");
+    EXPECT_EQ(advice.createScript("triples"),
+              "db.triples.createIndex({\"o\": 1, \"agent\": 1}, {name: \"o_1_agent_1_partial\", "
+              "partialFilterExpression: {\"agent\": {$exists: true}}});\n");
+}
+
+TEST_F(IndexAdvisorTest, DropOnlyObservedUnusedIndexes)
+{
+    // the collection is only used to advise, deciding about dropping does not need it
+    IndexAdvisor advisor(nullptr);
+    advisor.setDropThresholds(std::chrono::hours(1), 10);
+    advisor.addRequiredIndex({"s", "p"});
+    auto now = std::chrono::system_clock::now();
+
+    IndexUsage unused;
+    unused.name = "o_1_agent_1";
+    unused.since = now - std::chrono::hours(2);
+    IndexUsage required = unused;
+    required.name = "s_1_p_1";
+    IndexUsage recent = unused;
+    recent.since = now - std::chrono::minutes(10);
+    IndexUsage used = unused;
+    used.numOps = 1;
+
+    // too few selectors were observed
+    recordSelectors(advisor, 9);
+    EXPECT_FALSE(advisor.isDropCandidate(unused, now));
+    recordSelectors(advisor, 1);
+    EXPECT_TRUE(advisor.isDropCandidate(unused, now));
+    EXPECT_FALSE(advisor.isDropCandidate(required, now));
+    EXPECT_FALSE(advisor.isDropCandidate(recent, now));
+    EXPECT_FALSE(advisor.isDropCandidate(used, now));
+}
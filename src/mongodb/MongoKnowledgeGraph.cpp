@@ -3,9 +3,13 @@
 //
 
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <filesystem>
+#include <sstream>
+#include <limits>
 #include <boost/foreach.hpp>
 #include "knowrob/Logger.h"
+#include "knowrob/Metrics.h"
 #include "knowrob/URI.h"
 #include "knowrob/mongodb/MongoKnowledgeGraph.h"
 #include "knowrob/mongodb/Document.h"
@@ -33,11 +37,31 @@
 #define MONGO_KG_SETTING_COLLECTION "collection"
 #define MONGO_KG_SETTING_READ_ONLY "read-only"
 #define MONGO_KG_SETTING_DROP_GRAPHS "drop_graphs"
+#define MONGO_KG_SETTING_MATERIALIZE "materialize"
+#define MONGO_KG_SETTING_POOL_SIZE "pool-size"
+#define MONGO_KG_SETTING_COMPRESSORS "compressors"
+#define MONGO_KG_SETTING_ZLIB_COMPRESSION_LEVEL "zlib-compression-level"
+#define MONGO_KG_SETTING_READ_PREFERENCE "read-preference"
+#define MONGO_KG_SETTING_CONNECT_TIMEOUT "connect-timeout"
+#define MONGO_KG_SETTING_SOCKET_TIMEOUT "socket-timeout"
+#define MONGO_KG_SETTING_SERVER_SELECTION_TIMEOUT "server-selection-timeout"
+#define MONGO_KG_SETTING_BATCH_SIZE "batch-size"
+#define MONGO_KG_SETTING_FIRST_BATCH_SIZE "first-batch-size"
+#define MONGO_KG_SETTING_PREFETCH "prefetch"
+#define MONGO_KG_SETTING_INDEX_ADVISOR "index-advisor"
+#define MONGO_KG_SETTING_INDEX_ADVISOR_APPLY "index-advisor-apply"
+#define MONGO_KG_SETTING_INDEX_ADVISOR_INTERVAL "index-advisor-interval"
+#define MONGO_KG_SETTING_WRITE_CONCERN "write-concern"
+#define MONGO_KG_SETTING_WRITE_CONCERN_JOURNAL "write-concern-journal"
+#define MONGO_KG_SETTING_WRITE_CONCERN_TIMEOUT "write-concern-timeout"
 
 #define MONGO_KG_DEFAULT_HOST "localhost"
 #define MONGO_KG_DEFAULT_PORT "27017"
 #define MONGO_KG_DEFAULT_DB "knowrob"
 #define MONGO_KG_DEFAULT_COLLECTION "triples"
+#define MONGO_KG_DEFAULT_BATCH_SIZE 1000
+#define MONGO_KG_DEFAULT_FIRST_BATCH_SIZE 16
+#define MONGO_KG_DEFAULT_INDEX_ADVISOR_INTERVAL 1000
 
 using namespace knowrob;
 using namespace knowrob::mongo;
@@ -45,35 +69,114 @@ using namespace knowrob::semweb;
 
 KNOWROB_BUILTIN_BACKEND("MongoDB", MongoKnowledgeGraph)
 
+namespace knowrob {
+    class IndexAdvisorRunner : public ThreadPool::Runner {
+    public:
+        explicit IndexAdvisorRunner(std::function<void()> fn)
+        : fn_(std::move(fn)), ThreadPool::Runner()
+        {}
+
+        void run() override { fn_(); }
+    protected:
+        std::function<void()> fn_;
+    };
+}
+
 // AGGREGATION PIPELINES
 bson_t* newPipelineImportHierarchy(const char *collection);
 
 MongoKnowledgeGraph::MongoKnowledgeGraph()
 : KnowledgeGraph(),
-  isReadOnly_(false)
+  isReadOnly_(false),
+  isPrefetching_(true),
+  batchSize_(MONGO_KG_DEFAULT_BATCH_SIZE),
+  firstBatchSize_(MONGO_KG_DEFAULT_FIRST_BATCH_SIZE),
+  isAutoIndexing_(false),
+  indexAdvisorInterval_(MONGO_KG_DEFAULT_INDEX_ADVISOR_INTERVAL),
+  isAdvisingIndices_(false)
 {
 }
 
 MongoKnowledgeGraph::MongoKnowledgeGraph(const char* db_uri, const char* db_name, const char* collectionName)
 : KnowledgeGraph(),
   tripleCollection_(MongoInterface::get().connect(db_uri, db_name, collectionName)),
-  isReadOnly_(false)
+  isReadOnly_(false),
+  isPrefetching_(true),
+  batchSize_(MONGO_KG_DEFAULT_BATCH_SIZE),
+  firstBatchSize_(MONGO_KG_DEFAULT_FIRST_BATCH_SIZE),
+  isAutoIndexing_(false),
+  indexAdvisorInterval_(MONGO_KG_DEFAULT_INDEX_ADVISOR_INTERVAL),
+  isAdvisingIndices_(false)
 {
     initialize();
     dropGraph("user");
 }
 
+static std::shared_ptr<mongoc_write_concern_t> readWriteConcern(const boost::property_tree::ptree &config)
+{
+    auto o_w = config.get_optional<std::string>(MONGO_KG_SETTING_WRITE_CONCERN);
+    auto o_journal = config.get_optional<bool>(MONGO_KG_SETTING_WRITE_CONCERN_JOURNAL);
+    if(!o_w && !o_journal) return {};
+
+    std::shared_ptr<mongoc_write_concern_t> writeConcern(
+            mongoc_write_concern_new(), mongoc_write_concern_destroy);
+    // the timeout in milliseconds is only used if acknowledgement of more than one node is requested
+    auto timeout = config.get<int32_t>(MONGO_KG_SETTING_WRITE_CONCERN_TIMEOUT, 0);
+    if(o_w) {
+        // either "majority", or the number of nodes that need to acknowledge a write
+        if(o_w.value() == "majority") {
+            mongoc_write_concern_set_wmajority(writeConcern.get(), timeout);
+        }
+        else {
+            mongoc_write_concern_set_w(writeConcern.get(), std::stoi(o_w.value()));
+            mongoc_write_concern_set_wtimeout_int64(writeConcern.get(), timeout);
+        }
+    }
+    if(o_journal) {
+        // wait until writes are written to the on-disk journal
+        mongoc_write_concern_set_journal(writeConcern.get(), o_journal.value());
+    }
+    if(!mongoc_write_concern_is_valid(writeConcern.get())) {
+        KB_WARN("Ignoring invalid write concern in configuration of MongoDB backend.");
+        return {};
+    }
+    return writeConcern;
+}
+
 bool MongoKnowledgeGraph::loadConfiguration(const boost::property_tree::ptree &config)
 {
     tripleCollection_ = connect(config);
     initialize();
 
+    // optionally wait for acknowledgement of writes by replica set members, or the journal
+    auto writeConcern = readWriteConcern(config);
+    if(writeConcern) {
+        tripleCollection_->setWriteConcern(writeConcern);
+        oneCollection_->setWriteConcern(writeConcern);
+    }
+
     // set isReadOnly_ flag
     auto o_readOnly = config.get_optional<bool>(MONGO_KG_SETTING_READ_ONLY);
     if(o_readOnly.has_value()) {
         isReadOnly_ = o_readOnly.value();
     }
 
+    // a small first batch lets first answers arrive early, larger batches save round trips afterwards
+    batchSize_ = config.get<uint32_t>(MONGO_KG_SETTING_BATCH_SIZE, MONGO_KG_DEFAULT_BATCH_SIZE);
+    firstBatchSize_ = config.get<uint32_t>(MONGO_KG_SETTING_FIRST_BATCH_SIZE, MONGO_KG_DEFAULT_FIRST_BATCH_SIZE);
+    // receive the next batch while answers of the previous batch are decoded
+    isPrefetching_ = config.get<bool>(MONGO_KG_SETTING_PREFETCH, true);
+
+    // optionally record selectors to recommend search indices
+    if(config.get<bool>(MONGO_KG_SETTING_INDEX_ADVISOR, false)) {
+        indexAdvisor_ = std::make_shared<IndexAdvisor>(tripleCollection_);
+        // the search indices are never recommended to be dropped
+        for(auto &keys : searchIndexKeys()) indexAdvisor_->addRequiredIndex(keys);
+        isAutoIndexing_ = config.get<bool>(MONGO_KG_SETTING_INDEX_ADVISOR_APPLY, false);
+        indexAdvisorInterval_ = config.get<uint32_t>(MONGO_KG_SETTING_INDEX_ADVISOR_INTERVAL,
+                                                     MONGO_KG_DEFAULT_INDEX_ADVISOR_INTERVAL);
+    }
+
     // auto-drop some named graphs
     auto o_drop_graphs = config.get_child_optional(MONGO_KG_SETTING_DROP_GRAPHS);
     if(o_drop_graphs.has_value()) {
@@ -84,6 +187,12 @@ bool MongoKnowledgeGraph::loadConfiguration(const boost::property_tree::ptree &c
         dropGraph("user");
     }
 
+    // optionally store entailments in the database
+    auto o_materialize = config.get_optional<bool>(MONGO_KG_SETTING_MATERIALIZE);
+    if(o_materialize.has_value() && o_materialize.value()) {
+        enableMaterialization();
+    }
+
     return true;
 }
 
@@ -102,6 +211,16 @@ bool MongoKnowledgeGraph::isReadOnly() const
     return isReadOnly_;
 }
 
+void MongoKnowledgeGraph::enableMaterialization()
+{
+    if(materializer_) return;
+    materializer_ = std::make_shared<MongoMaterializer>(tripleCollection_, oneCollection_, vocabulary_);
+    // derived triples of previous sessions may be outdated, so all are derived again.
+    materializer_->materializeAll();
+    KB_INFO("materialized {} triples in \"{}\" graph.",
+            materializer_->numDerived(), MongoMaterializer::DERIVED_GRAPH);
+}
+
 std::shared_ptr<Collection> MongoKnowledgeGraph::connect(const boost::property_tree::ptree &config)
 {
     return MongoInterface::get().connect(
@@ -130,7 +249,7 @@ std::string MongoKnowledgeGraph::getURI(const boost::property_tree::ptree &confi
     auto o_port = config.get_optional<std::string>(MONGO_KG_SETTING_PORT);
     auto o_user = config.get_optional<std::string>(MONGO_KG_SETTING_USER);
     auto o_password = config.get_optional<std::string>(MONGO_KG_SETTING_PASSWORD);
-    // format URI of the form "mongodb://USER:PW@HOST:PORT"
+    // format URI of the form "mongodb://USER:PW@HOST:PORT/?OPTION=VALUE&..."
     std::stringstream uriStream;
     uriStream << "mongodb://";
     if(o_user) {
@@ -142,6 +261,46 @@ std::string MongoKnowledgeGraph::getURI(const boost::property_tree::ptree &confi
         << (o_host ? o_host.value() : MONGO_KG_DEFAULT_HOST)
         << ':'
         << (o_port ? o_port.value() : MONGO_KG_DEFAULT_PORT);
+
+    // connection options are passed to the client pool via the URI
+    std::vector<std::pair<const char*, std::string>> options;
+    // limits the number of clients that can be leased at the same time
+    auto o_poolSize = config.get_optional<uint32_t>(MONGO_KG_SETTING_POOL_SIZE);
+    if(o_poolSize) {
+        options.emplace_back(MONGOC_URI_MAXPOOLSIZE, std::to_string(o_poolSize.value()));
+    }
+    // wire compression, either a comma separated string or a list, e.g. ["zstd","snappy"].
+    // the first compressor that is also supported by the server is used.
+    auto o_compressors = config.get_child_optional(MONGO_KG_SETTING_COMPRESSORS);
+    if(o_compressors) {
+        std::string compressors = o_compressors.value().data();
+        for(auto &pair : o_compressors.value()) {
+            if(!compressors.empty()) compressors += ',';
+            compressors += pair.second.data();
+        }
+        if(!compressors.empty()) options.emplace_back(MONGOC_URI_COMPRESSORS, compressors);
+    }
+    auto o_zlibLevel = config.get_optional<int32_t>(MONGO_KG_SETTING_ZLIB_COMPRESSION_LEVEL);
+    if(o_zlibLevel) {
+        options.emplace_back(MONGOC_URI_ZLIBCOMPRESSIONLEVEL, std::to_string(o_zlibLevel.value()));
+    }
+    // e.g. "nearest" to read from the closest member of a replica set
+    auto o_readPreference = config.get_optional<std::string>(MONGO_KG_SETTING_READ_PREFERENCE);
+    if(o_readPreference) {
+        options.emplace_back(MONGOC_URI_READPREFERENCE, o_readPreference.value());
+    }
+    // timeouts in milliseconds
+    for(auto &timeout : {
+            std::make_pair(MONGO_KG_SETTING_CONNECT_TIMEOUT, MONGOC_URI_CONNECTTIMEOUTMS),
+            std::make_pair(MONGO_KG_SETTING_SOCKET_TIMEOUT, MONGOC_URI_SOCKETTIMEOUTMS),
+            std::make_pair(MONGO_KG_SETTING_SERVER_SELECTION_TIMEOUT, MONGOC_URI_SERVERSELECTIONTIMEOUTMS) }) {
+        auto o_timeout = config.get_optional<int32_t>(timeout.first);
+        if(o_timeout) options.emplace_back(timeout.second, std::to_string(o_timeout.value()));
+    }
+
+    for(uint32_t i=0; i<options.size(); ++i) {
+        uriStream << (i==0 ? "/?" : "&") << options[i].first << '=' << options[i].second;
+    }
     return uriStream.str();
 }
 
@@ -204,6 +363,22 @@ void MongoKnowledgeGraph::initialize()
         while(cursor.nextTriple(tripleData))
             vocabulary_->setInverseOf(tripleData.subject, tripleData.object);
     }
+    {
+        // iterate over all rdfs::domain assertions
+        TripleCursor cursor(tripleCollection_);
+        cursor.filter(Document(BCON_NEW(
+            "p", BCON_UTF8(rdfs::domain.data()))).bson());
+        while(cursor.nextTriple(tripleData))
+            vocabulary_->addPropertyDomain(tripleData.subject, tripleData.object);
+    }
+    {
+        // iterate over all rdfs::range assertions
+        TripleCursor cursor(tripleCollection_);
+        cursor.filter(Document(BCON_NEW(
+            "p", BCON_UTF8(rdfs::range.data()))).bson());
+        while(cursor.nextTriple(tripleData))
+            vocabulary_->addPropertyRange(tripleData.subject, tripleData.object);
+    }
 
     // initialize the import hierarchy
     {
@@ -223,25 +398,81 @@ void MongoKnowledgeGraph::initialize()
     }
 }
 
+const std::vector<std::vector<std::string>>& MongoKnowledgeGraph::searchIndexKeys()
+{
+    // note: selectors also constrain the fields "graph", "agent", "scope.time.since", "scope.time.until",
+    //  "confidence", "uncertain" and "occasional". compound indices including these fields can be
+    //  recommended by the index advisor based on the selectors that are actually used.
+    static const std::vector<std::vector<std::string>> keys = {
+        {"s"},
+        {"p"},
+        {"o"},
+        {"p*"},
+        {"o*"},
+        {"s", "p"},
+        {"s", "p*"},
+        {"s", "o"},
+        {"s", "o*"},
+        {"o", "p"},
+        {"o", "p*"},
+        {"p", "o*"},
+        {"s", "o", "p"},
+        {"s", "o", "p*"},
+        {"s", "o*", "p"}
+    };
+    return keys;
+}
+
 void MongoKnowledgeGraph::createSearchIndices()
 {
-    // TODO: shouldn't fields "graph", "agent", "scope.time.since", "scope.time.until", "confidence",
-    //  "uncertain", "occasional" be included in each index?
-    tripleCollection_->createAscendingIndex({"s"});
-    tripleCollection_->createAscendingIndex({"p"});
-    tripleCollection_->createAscendingIndex({"o"});
-    tripleCollection_->createAscendingIndex({"p*"});
-    tripleCollection_->createAscendingIndex({"o*"});
-    tripleCollection_->createAscendingIndex({"s", "p"});
-    tripleCollection_->createAscendingIndex({"s", "p*"});
-    tripleCollection_->createAscendingIndex({"s", "o"});
-    tripleCollection_->createAscendingIndex({"s", "o*"});
-    tripleCollection_->createAscendingIndex({"o", "p"});
-    tripleCollection_->createAscendingIndex({"o", "p*"});
-    tripleCollection_->createAscendingIndex({"p", "o*"});
-    tripleCollection_->createAscendingIndex({"s", "o", "p"});
-    tripleCollection_->createAscendingIndex({"s", "o", "p*"});
-    tripleCollection_->createAscendingIndex({"s", "o*", "p"});
+    for(auto &keys : searchIndexKeys()) {
+        std::vector<const char*> keyNames;
+        for(auto &key : keys) keyNames.push_back(key.c_str());
+        tripleCollection_->createAscendingIndex(keyNames);
+    }
+}
+
+void MongoKnowledgeGraph::recordSelector(const bson_t *selectorDoc)
+{
+    if(!indexAdvisor_) return;
+    indexAdvisor_->recordSelector(selectorDoc);
+    if(!isAutoIndexing_ || indexAdvisor_->numSelectors() % indexAdvisorInterval_ != 0) return;
+    // only one advice at a time
+    if(isAdvisingIndices_.exchange(true)) return;
+
+    auto applyAdvice = [this]() {
+        auto advice = indexAdvisor_->advise();
+        indexAdvisor_->apply(advice);
+        isAdvisingIndices_ = false;
+    };
+    if(threadPool_) {
+        // explaining query plans and building indices takes a while, so it is done
+        // without blocking the operation that recorded the selector.
+        threadPool_->pushWork(std::make_shared<IndexAdvisorRunner>(applyAdvice),
+            [this](const std::exception &exc) {
+                KB_WARN("failed to apply index advice: {}", exc.what());
+                isAdvisingIndices_ = false;
+            });
+    }
+    else {
+        applyAdvice();
+    }
+}
+
+mongo::IndexAdvice MongoKnowledgeGraph::adviseIndices()
+{
+    if(!indexAdvisor_) {
+        KB_WARN("index advisor is not enabled, set \"{}\" in the settings.", MONGO_KG_SETTING_INDEX_ADVISOR);
+        return {};
+    }
+    auto advice = indexAdvisor_->advise();
+    if(!advice.create.empty()) {
+        KB_INFO("recommended search indices:\n{}", advice.createScript(tripleCollection_->name()));
+    }
+    if(!advice.drop.empty()) {
+        KB_INFO("unused search indices:\n{}", advice.dropScript(tripleCollection_->name()));
+    }
+    return advice;
 }
 
 void MongoKnowledgeGraph::drop()
@@ -249,13 +480,24 @@ void MongoKnowledgeGraph::drop()
     tripleCollection_->drop();
     vocabulary_ = std::make_shared<semweb::Vocabulary>();
     importHierarchy_->clear();
+    if(materializer_) {
+        materializer_ = std::make_shared<MongoMaterializer>(tripleCollection_, oneCollection_, vocabulary_);
+    }
 }
 
 void MongoKnowledgeGraph::dropGraph(const std::string_view &graphName)
 {
     KB_INFO("dropping graph with name \"{}\".", graphName);
+    // remember triples of the graph to maintain derived triples afterwards
+    std::vector<Triple> removedTriples;
+    if(materializer_ && graphName != MongoMaterializer::DERIVED_GRAPH) {
+        materializer_->matchGraph(std::string(graphName), removedTriples);
+    }
     tripleCollection_->removeAll(Document(
             BCON_NEW("graph", BCON_UTF8(graphName.data()))));
+    if(!removedTriples.empty()) {
+        materializer_->remove(removedTriples);
+    }
     // TODO: improve handling of default graph names.
     //       here it is avoided that import relations are forgotten.
     if(graphName != "user" && graphName != "common" && graphName != "test")
@@ -301,8 +543,33 @@ bson_t* MongoKnowledgeGraph::getSelector(
     return doc;
 }
 
+std::vector<std::pair<std::string, std::vector<const StatementData*>>>
+MongoKnowledgeGraph::groupByGraph(const std::vector<StatementData> &statements)
+{
+    // graphs are kept in the order of their first statement
+    std::vector<std::pair<std::string, std::vector<const StatementData*>>> groups;
+    for(auto &data : statements) {
+        std::string_view graph = data.graph ? data.graph : importHierarchy_->defaultGraph();
+        auto it = std::find_if(groups.begin(), groups.end(),
+                               [&graph](auto &group) { return group.first == graph; });
+        if(it == groups.end()) {
+            groups.emplace_back(std::string(graph), std::vector<const StatementData*>());
+            it = std::prev(groups.end());
+        }
+        it->second.push_back(&data);
+    }
+    return groups;
+}
+
 bool MongoKnowledgeGraph::insert(const StatementData &tripleData)
 {
+    static auto &numInserted = Metrics::get().counter(
+            "knowrob_mongo_inserted_statements_total", "Number of statements inserted into MongoDB.");
+    static auto &insertLatency = Metrics::get().histogram(
+            "knowrob_mongo_insert_seconds", "Time needed to insert statements into MongoDB.");
+    MetricsTimer timer(insertLatency);
+    numInserted.increment();
+
     auto &graph = tripleData.graph ? tripleData.graph : importHierarchy_->defaultGraph();
     TripleLoader loader(graph,
                         tripleCollection_,
@@ -311,42 +578,185 @@ bool MongoKnowledgeGraph::insert(const StatementData &tripleData)
     loader.loadTriple(tripleData);
     loader.flush();
     updateHierarchy(loader);
-    updateTimeInterval(tripleData);
+    updateTimeIntervals({ tripleData });
+
+    if(materializer_ && Materializer::isMaterializable(tripleData)) {
+        Triple triple{ tripleData.subject, tripleData.predicate, tripleData.object };
+        if(materializer_->isRelevant(triple)) materializer_->insert({ triple });
+    }
     return true;
 }
 
 bool MongoKnowledgeGraph::insert(const std::vector<StatementData> &statements)
 {
-    auto &graph = importHierarchy_->defaultGraph();
-    TripleLoader loader(graph,
-                        tripleCollection_,
-                        oneCollection_,
-                        vocabulary_);
-    auto loaderPtr = &loader;
-    std::for_each(statements.begin(), statements.end(),
-        [loaderPtr](auto &data) {
-            loaderPtr->loadTriple(data);
-        });
-    loader.flush();
-    updateHierarchy(loader);
+    static auto &numInserted = Metrics::get().counter(
+            "knowrob_mongo_inserted_statements_total", "Number of statements inserted into MongoDB.");
+    static auto &insertLatency = Metrics::get().histogram(
+            "knowrob_mongo_insert_seconds", "Time needed to insert statements into MongoDB.");
+    MetricsTimer timer(insertLatency);
+    numInserted.increment(statements.size());
+
+    // each loader writes into one graph
+    for(auto &pair : groupByGraph(statements)) {
+        TripleLoader loader(pair.first,
+                            tripleCollection_,
+                            oneCollection_,
+                            vocabulary_);
+        for(auto data : pair.second) {
+            loader.loadTriple(*data);
+        }
+        loader.flush();
+        updateHierarchy(loader);
+    }
+
+    updateTimeIntervals(statements);
 
-    for(auto &data : statements) updateTimeInterval(data);
+    if(materializer_) {
+        std::vector<Triple> triples;
+        for(auto &data : statements) {
+            if(!Materializer::isMaterializable(data)) continue;
+            Triple triple{ data.subject, data.predicate, data.object };
+            if(materializer_->isRelevant(triple)) triples.push_back(std::move(triple));
+        }
+        materializer_->insert(triples);
+    }
 
     return true;
 }
 
 void MongoKnowledgeGraph::removeAll(const RDFLiteral &tripleExpression)
 {
+    if(materializer_) {
+        removeMaterialized(tripleExpression, true);
+        return;
+    }
     bool b_isTaxonomicProperty = isTaxonomicProperty(tripleExpression.propertyTerm());
-    tripleCollection_->removeAll(
-        Document(getSelector(tripleExpression, b_isTaxonomicProperty)));
+    Document selector(getSelector(tripleExpression, b_isTaxonomicProperty));
+    recordSelector(selector.bson());
+    tripleCollection_->removeAll(selector);
 }
 
 void MongoKnowledgeGraph::removeOne(const RDFLiteral &tripleExpression)
 {
+    if(materializer_) {
+        removeMaterialized(tripleExpression, false);
+        return;
+    }
     bool b_isTaxonomicProperty = isTaxonomicProperty(tripleExpression.propertyTerm());
-    tripleCollection_->removeOne(
-        Document(getSelector(tripleExpression, b_isTaxonomicProperty)));
+    Document selector(getSelector(tripleExpression, b_isTaxonomicProperty));
+    recordSelector(selector.bson());
+    tripleCollection_->removeOne(selector);
+}
+
+void MongoKnowledgeGraph::remove(const std::vector<RDFLiteralPtr> &tripleExpressions)
+{
+    static auto &numRemoved = Metrics::get().counter(
+            "knowrob_mongo_removed_expressions_total", "Number of expressions used to remove statements from MongoDB.");
+    if(tripleExpressions.empty()) return;
+    numRemoved.increment(tripleExpressions.size());
+    if(materializer_) {
+        for(auto &tripleExpression : tripleExpressions) {
+            removeMaterialized(*tripleExpression, true);
+        }
+        return;
+    }
+    // remove statements of all expressions in one round trip
+    auto bulk = tripleCollection_->createBulkOperation();
+    for(auto &tripleExpression : tripleExpressions) {
+        bool b_isTaxonomicProperty = isTaxonomicProperty(tripleExpression->propertyTerm());
+        Document selector(getSelector(*tripleExpression, b_isTaxonomicProperty));
+        recordSelector(selector.bson());
+        bulk->pushRemoveAll(selector.bson());
+    }
+    bulk->execute();
+}
+
+bool MongoKnowledgeGraph::replace(const std::vector<RDFLiteralPtr> &tripleExpressions,
+                                  const std::vector<StatementData> &statements)
+{
+    if(materializer_) {
+        // derived triples of removed statements need to be maintained
+        return KnowledgeGraph::replace(tripleExpressions, statements);
+    }
+    static auto &numRemoved = Metrics::get().counter(
+            "knowrob_mongo_removed_expressions_total", "Number of expressions used to remove statements from MongoDB.");
+    static auto &numInserted = Metrics::get().counter(
+            "knowrob_mongo_inserted_statements_total", "Number of statements inserted into MongoDB.");
+    numRemoved.increment(tripleExpressions.size());
+    numInserted.increment(statements.size());
+
+    // deletions and insertions into the first graph are added to the same ordered bulk write
+    // such that statements are removed before new ones are inserted.
+    // statements of other graphs are written afterwards, each graph in its own bulk write.
+    auto graphStatements = groupByGraph(statements);
+    if(graphStatements.empty()) {
+        graphStatements.emplace_back(importHierarchy_->defaultGraph(), std::vector<const StatementData*>());
+    }
+    bool isFirstGraph = true;
+    for(auto &pair : graphStatements) {
+        TripleLoader loader(pair.first,
+                            tripleCollection_,
+                            oneCollection_,
+                            vocabulary_);
+        for(auto &tripleExpression : tripleExpressions) {
+            if(!isFirstGraph) break;
+            bool b_isTaxonomicProperty = isTaxonomicProperty(tripleExpression->propertyTerm());
+            Document selector(getSelector(*tripleExpression, b_isTaxonomicProperty));
+            recordSelector(selector.bson());
+            loader.removeAll(selector.bson());
+        }
+        for(auto data : pair.second) {
+            loader.loadTriple(*data);
+        }
+        loader.flush();
+        updateHierarchy(loader);
+        isFirstGraph = false;
+    }
+    updateTimeIntervals(statements);
+    return true;
+}
+
+void MongoKnowledgeGraph::removeMaterialized(const RDFLiteral &tripleExpression, bool removeAll)
+{
+    // derived triples cannot be removed directly, they are skipped here
+    // and maintained by the materializer instead.
+    bool b_isTaxonomicProperty = isTaxonomicProperty(tripleExpression.propertyTerm());
+    std::list<bson_oid_t> documentIDs;
+    std::vector<Triple> removedTriples;
+    {
+        TripleCursor cursor(tripleCollection_);
+        Document selector(getSelector(tripleExpression, b_isTaxonomicProperty));
+        cursor.filter(selector.bson());
+        for(StatementData data; cursor.nextTriple(data); data = StatementData()) {
+            if(data.graph && MongoMaterializer::DERIVED_GRAPH == data.graph) continue;
+            bson_oid_copy((bson_oid_t*)data.documentID, &documentIDs.emplace_back());
+            if(data.objectType == RDF_STRING_LITERAL) {
+                data.objectType = RDF_RESOURCE;
+                if(Materializer::isMaterializable(data)) {
+                    removedTriples.push_back({ data.subject, data.predicate, data.object });
+                }
+            }
+            if(!removeAll) break;
+        }
+    }
+    if(!documentIDs.empty()) {
+        // remove all matching documents in one round trip
+        auto selectorDoc = bson_new();
+        bson_t idDoc, idArray;
+        char arrIndexStr[16];
+        const char *arrIndexKey;
+        uint32_t arrIndex = 0;
+        BSON_APPEND_DOCUMENT_BEGIN(selectorDoc, "_id", &idDoc);
+        BSON_APPEND_ARRAY_BEGIN(&idDoc, "$in", &idArray);
+        for(auto &oid : documentIDs) {
+            bson_uint32_to_string(arrIndex++, &arrIndexKey, arrIndexStr, sizeof arrIndexStr);
+            BSON_APPEND_OID(&idArray, arrIndexKey, &oid);
+        }
+        bson_append_array_end(&idDoc, &idArray);
+        bson_append_document_end(selectorDoc, &idDoc);
+        tripleCollection_->removeAll(Document(selectorDoc));
+    }
+    if(!removedTriples.empty()) materializer_->remove(removedTriples);
 }
 
 AnswerCursorPtr MongoKnowledgeGraph::lookup(const RDFLiteral &tripleExpression)
@@ -361,6 +771,7 @@ AnswerCursorPtr MongoKnowledgeGraph::lookup(const RDFLiteral &tripleExpression)
         // indicate that no variables in tripleExpression may have been instantiated
         // by a previous step to allow for some optimizations.
         lookupData.mayHasMoreGroundings = false;
+        lookupData.isMaterialized = isMaterialized();
         aggregation::lookupTriple(pipeline, tripleCollection_->name(), vocabulary_, lookupData);
     }
     bson_append_array_end(&pipelineDoc, &pipelineArray);
@@ -375,39 +786,132 @@ mongo::AnswerCursorPtr MongoKnowledgeGraph::lookup(const StatementData &tripleDa
     return lookup(RDFLiteral(tripleData));
 }
 
-mongo::AnswerCursorPtr MongoKnowledgeGraph::lookup(const std::vector<RDFLiteralPtr> &tripleExpressions)
+void MongoKnowledgeGraph::appendLookupPipeline(bson_t *pipelineDoc,
+                                               const std::vector<RDFLiteralPtr> &tripleExpressions)
 {
-    bson_t pipelineDoc = BSON_INITIALIZER;
     bson_t pipelineArray;
-    BSON_APPEND_ARRAY_BEGIN(&pipelineDoc, "pipeline", &pipelineArray);
+    BSON_APPEND_ARRAY_BEGIN(pipelineDoc, "pipeline", &pipelineArray);
     aggregation::Pipeline pipeline(&pipelineArray);
     aggregation::lookupTriplePaths(pipeline,
                                   tripleCollection_->name(),
                                   vocabulary_,
-                                  tripleExpressions);
-    bson_append_array_end(&pipelineDoc, &pipelineArray);
+                                  tripleExpressions,
+                                  isMaterialized());
+    bson_append_array_end(pipelineDoc, &pipelineArray);
+}
+
+void MongoKnowledgeGraph::appendLookupPipeline(bson_t *pipelineDoc, const GraphQuery &query)
+{
+    bson_t pipelineArray;
+    BSON_APPEND_ARRAY_BEGIN(pipelineDoc, "pipeline", &pipelineArray);
+    aggregation::Pipeline pipeline(&pipelineArray);
+    aggregation::lookupTriplePaths(pipeline,
+                                  tripleCollection_->name(),
+                                  vocabulary_,
+                                  query.literals(),
+                                  isMaterialized());
+    // let the server aggregate answers, only the aggregated values are sent
+    if(query.aggregate()) {
+        aggregation::aggregateTriplePaths(pipeline, *query.aggregate());
+    }
+    // pages are taken from answers in a deterministic order, unless any order is allowed.
+    // answers are ordered by their variable bindings, and then by their scope.
+    if(query.isPaged() && !(query.flags() & QUERY_FLAG_UNORDERED_SOLUTIONS)) {
+        pipeline.sortAscending({ "v_VARS", "v_scope" });
+    }
+    // let the server skip answers instead of sending them
+    if(query.offset()>0) {
+        pipeline.skip(query.offset());
+    }
+    if(query.limit().has_value()) {
+        pipeline.limit(query.limit().value());
+    }
+    bson_append_array_end(pipelineDoc, &pipelineArray);
+}
+
+mongo::AnswerCursorPtr MongoKnowledgeGraph::lookup(const std::vector<RDFLiteralPtr> &tripleExpressions)
+{
+    bson_t pipelineDoc = BSON_INITIALIZER;
+    appendLookupPipeline(&pipelineDoc, tripleExpressions);
 
     auto cursor = std::make_shared<AnswerCursor>(oneCollection_);
     cursor->aggregate(&pipelineDoc);
+    bson_destroy(&pipelineDoc);
     return cursor;
 }
 
+mongo::AnswerCursorPtr MongoKnowledgeGraph::lookup(const GraphQuery &query)
+{
+    bson_t pipelineDoc = BSON_INITIALIZER;
+    appendLookupPipeline(&pipelineDoc, query);
+
+    auto cursor = std::make_shared<AnswerCursor>(oneCollection_);
+    cursor->aggregate(&pipelineDoc);
+    bson_destroy(&pipelineDoc);
+    return cursor;
+}
+
+std::string MongoKnowledgeGraph::explainQuery(const GraphQueryPtr &query)
+{
+    bson_t pipelineDoc = BSON_INITIALIZER;
+    appendLookupPipeline(&pipelineDoc, *query);
+
+    char *json = bson_as_relaxed_extended_json(&pipelineDoc, nullptr);
+    std::string pipelineString(json);
+    bson_free(json);
+    bson_destroy(&pipelineDoc);
+    return pipelineString;
+}
+
 void MongoKnowledgeGraph::evaluateQuery(const GraphQueryPtr &query, AnswerBufferPtr &resultStream)
 {
+    static auto &numQueries = Metrics::get().counter(
+            "knowrob_mongo_queries_total", "Number of graph queries evaluated by MongoDB.");
+    static auto &numAnswers = Metrics::get().counter(
+            "knowrob_mongo_answers_total", "Number of answers generated by MongoDB.");
+    static auto &queryLatency = Metrics::get().histogram(
+            "knowrob_mongo_query_seconds", "Time needed to evaluate a graph query in MongoDB.");
+    MetricsTimer timer(queryLatency);
+    numQueries.increment();
+
     auto channel = AnswerStream::Channel::create(resultStream);
-    auto cursor = lookup(query->literals());
+    if(query->limit().has_value() && query->limit().value()==0) {
+        // no answer is requested
+        channel->push(AnswerStream::eos());
+        return;
+    }
+    auto cursor = lookup(*query);
+    if(indexAdvisor_) {
+        for(auto &literal : query->literals()) {
+            Document selector(getSelector(*literal, isTaxonomicProperty(literal->propertyTerm())));
+            recordSelector(selector.bson());
+        }
+    }
 
     // limit to one solution if requested
     if(query->flags() & QUERY_FLAG_ONE_SOLUTION) {
         cursor->limit(1);
     }
+    else {
+        cursor->batchSize(batchSize_, firstBatchSize_);
+        if(isPrefetching_) cursor->setPrefetching(threadPool_);
+    }
 
+    bool hasAnswer = false;
     while(true) {
         std::shared_ptr<Answer> next = std::make_shared<Answer>();
         if(cursor->nextAnswer(next)) {
+            numAnswers.increment();
+            hasAnswer = true;
             channel->push(next);
         }
         else {
+            // $group does not generate a document if there is no input document,
+            // but e.g. a count still has the answer zero in this case.
+            // the answer is the first one, so it is skipped if the query has an offset.
+            if(!hasAnswer && query->offset()==0 && query->aggregate() && query->aggregate()->hasEmptyAnswer()) {
+                channel->push(query->aggregate()->emptyAnswer());
+            }
             channel->push(AnswerStream::eos());
             break;
         }
@@ -464,67 +968,171 @@ bool MongoKnowledgeGraph::loadFile( //NOLINT
     setCurrentGraphVersion(graphName, resolved, newVersion);
     // update o* and p* fields
     updateHierarchy(loader);
+    // derive entailments of the loaded triples
+    if(materializer_) {
+        std::vector<Triple> loadedTriples;
+        materializer_->matchGraph(graphName, loadedTriples);
+        materializer_->insert(loadedTriples);
+    }
     // load imported ontologies
     for(auto &imported : loader.imports()) loadFile(imported, format, label);
 
     return true;
 }
 
-void MongoKnowledgeGraph::updateTimeInterval(const StatementData &tripleData)
+namespace knowrob::mongo {
+    // a document with time scope that may be merged with others
+    struct TimeScopedDocument {
+        bson_oid_t oid;
+        std::optional<double> begin;
+        std::optional<double> end;
+        bool isUpdated = false;
+        bool isRemoved = false;
+    };
+}
+
+static std::string getTimeMergeKey(const StatementData &data, const std::string &defaultGraph)
 {
-    if(!tripleData.begin.has_value() && !tripleData.end.has_value()) return;
-    bool b_isTaxonomicProperty = vocabulary_->isTaxonomicProperty(tripleData.predicate);
+    // documents are only merged if they agree on (s,p,o,graph,agent)
+    std::stringstream ss;
+    ss.precision(std::numeric_limits<double>::max_digits10);
+    ss << data.subject << '\n' << data.predicate << '\n';
+    switch(data.objectType) {
+        case RDF_INT64_LITERAL:
+        case RDF_BOOLEAN_LITERAL:
+            ss << data.objectInteger;
+            break;
+        case RDF_DOUBLE_LITERAL:
+            ss << data.objectDouble;
+            break;
+        default:
+            if(data.object) ss << data.object;
+            break;
+    }
+    ss << '\n' << (data.graph ? data.graph : defaultGraph.c_str());
+    ss << '\n' << (data.agent ? data.agent : "");
+    return ss.str();
+}
 
-    // filter overlapping triples
-    TripleCursor cursor(tripleCollection_);
-    bson_t selectorDoc = BSON_INITIALIZER;
+static inline bool isOverlapping(const std::optional<double> &begin1, const std::optional<double> &end1,
+                                 const std::optional<double> &begin2, const std::optional<double> &end2)
+{
+    // undefined bounds are unbounded
+    if(begin1.has_value() && end2.has_value() && begin1.value() > end2.value()) return false;
+    if(begin2.has_value() && end1.has_value() && begin2.value() > end1.value()) return false;
+    return true;
+}
+
+void MongoKnowledgeGraph::updateTimeIntervals(const std::vector<StatementData> &statements)
+{
+    static auto &numMerged = Metrics::get().counter(
+            "knowrob_mongo_merged_intervals_total", "Number of documents merged into overlapping time intervals.");
+    std::vector<const StatementData*> scopedStatements;
+    for(auto &data : statements) {
+        if(data.begin.has_value() || data.end.has_value()) scopedStatements.push_back(&data);
+    }
+    if(scopedStatements.empty()) return;
+    auto &defaultGraph = importHierarchy_->defaultGraph();
 
-    StatementData tripleDataCopy(tripleData);
-    tripleDataCopy.temporalOperator = TemporalOperator::SOMETIMES;
-    RDFLiteral overlappingExpr(tripleDataCopy);
-    aggregation::appendTripleSelector(&selectorDoc, overlappingExpr, b_isTaxonomicProperty);
-    cursor.filter(&selectorDoc);
+    // filter triples overlapping with any of the statements:
+    // { $or: [ selector_1, ..., selector_n ] }
+    bson_t selectorDoc = BSON_INITIALIZER;
+    bson_t orArray, branchDoc;
+    char arrIndexStr[16];
+    const char *arrIndexKey;
+    uint32_t arrIndex = 0;
+    BSON_APPEND_ARRAY_BEGIN(&selectorDoc, "$or", &orArray);
+    for(auto data : scopedStatements) {
+        StatementData tripleDataCopy(*data);
+        tripleDataCopy.temporalOperator = TemporalOperator::SOMETIMES;
+        RDFLiteral overlappingExpr(tripleDataCopy);
+        bool b_isTaxonomicProperty = vocabulary_->isTaxonomicProperty(data->predicate);
+
+        bson_uint32_to_string(arrIndex++, &arrIndexKey, arrIndexStr, sizeof arrIndexStr);
+        BSON_APPEND_DOCUMENT_BEGIN(&orArray, arrIndexKey, &branchDoc);
+        aggregation::appendTripleSelector(&branchDoc, overlappingExpr, b_isTaxonomicProperty);
+        bson_append_document_end(&orArray, &branchDoc);
+    }
+    bson_append_array_end(&selectorDoc, &orArray);
 
-    // iterate overlapping triples, remember document ids and compute
-    // union of time intervals
-    StatementData overlappingTriple;
-    std::list<bson_oid_t> documentIDs;
-    std::optional<double> begin = tripleData.begin;
-    std::optional<double> end = tripleData.end;
-    while(cursor.nextTriple(overlappingTriple)) {
-        // remember the ID of overlapping documents
-        auto &oid = documentIDs.emplace_back();
-        bson_oid_init(&oid, nullptr);
-        bson_oid_copy((bson_oid_t*)overlappingTriple.documentID, &oid);
-        // compute intersection of time interval
-        if(overlappingTriple.begin.has_value()) {
-            if(begin.has_value()) begin = std::min(begin.value(), overlappingTriple.begin.value());
-            else                  begin = overlappingTriple.begin.value();
+    // group overlapping triples by (s,p,o,graph,agent) keeping the order of the cursor
+    std::map<std::string, std::list<TimeScopedDocument>> groups;
+    {
+        TripleCursor cursor(tripleCollection_);
+        cursor.filter(&selectorDoc);
+        for(StatementData data; cursor.nextTriple(data); data = StatementData()) {
+            auto &doc = groups[getTimeMergeKey(data, defaultGraph)].emplace_back();
+            bson_oid_copy((bson_oid_t*)data.documentID, &doc.oid);
+            doc.begin = data.begin;
+            doc.end = data.end;
         }
-        if(overlappingTriple.end.has_value()) {
-            if(end.has_value()) end = std::max(end.value(), overlappingTriple.end.value());
-            else                end = overlappingTriple.end.value();
+    }
+    bson_destroy(&selectorDoc);
+
+    // compute union of time intervals client-side.
+    // statements are processed in order such that later statements see the
+    // intervals merged for earlier ones.
+    for(auto data : scopedStatements) {
+        auto groupIt = groups.find(getTimeMergeKey(*data, defaultGraph));
+        if(groupIt == groups.end()) continue;
+
+        TimeScopedDocument *firstDoc = nullptr;
+        std::optional<double> begin = data->begin;
+        std::optional<double> end = data->end;
+        for(auto &doc : groupIt->second) {
+            if(doc.isRemoved || !isOverlapping(doc.begin, doc.end, data->begin, data->end)) continue;
+            if(doc.begin.has_value()) {
+                if(begin.has_value()) begin = std::min(begin.value(), doc.begin.value());
+                else                  begin = doc.begin.value();
+            }
+            if(doc.end.has_value()) {
+                if(end.has_value()) end = std::max(end.value(), doc.end.value());
+                else                end = doc.end.value();
+            }
+            // keep the first document, and remove all others
+            if(firstDoc) doc.isRemoved = true;
+            else         firstDoc = &doc;
+        }
+        if(firstDoc && (firstDoc->begin != begin || firstDoc->end != end)) {
+            firstDoc->begin = begin;
+            firstDoc->end = end;
+            firstDoc->isUpdated = true;
         }
     }
 
-    if(documentIDs.size()>1) {
-        auto &firstOID = documentIDs.front();
-        // update time interval of first document ID
-        Document updateDoc(bson_new());
-        bson_t setDoc, scopeDoc, timeDoc;
-        BSON_APPEND_DOCUMENT_BEGIN(updateDoc.bson(), "$set", &setDoc); {
-            BSON_APPEND_DOCUMENT_BEGIN(&setDoc, "scope", &scopeDoc);
-            BSON_APPEND_DOCUMENT_BEGIN(&scopeDoc, "time", &timeDoc);
-            if(begin.has_value()) BSON_APPEND_DOUBLE(&timeDoc, "since", begin.value());
-            if(end.has_value())   BSON_APPEND_DOUBLE(&timeDoc, "until", end.value());
-            bson_append_document_end(&scopeDoc, &timeDoc);
-            bson_append_document_end(&setDoc, &scopeDoc);
+    // apply updates and deletions in one ordered bulk write
+    auto bulk = tripleCollection_->createBulkOperation(true);
+    uint32_t numOperations = 0;
+    for(auto &pair : groups) {
+        for(auto &doc : pair.second) {
+            bson_t queryDoc = BSON_INITIALIZER;
+            BSON_APPEND_OID(&queryDoc, "_id", &doc.oid);
+            if(doc.isRemoved) {
+                bulk->pushRemoveOne(&queryDoc);
+                numMerged.increment();
+                numOperations += 1;
+            }
+            else if(doc.isUpdated) {
+                bson_t updateDoc = BSON_INITIALIZER;
+                bson_t setDoc, scopeDoc, timeDoc;
+                BSON_APPEND_DOCUMENT_BEGIN(&updateDoc, "$set", &setDoc); {
+                    BSON_APPEND_DOCUMENT_BEGIN(&setDoc, "scope", &scopeDoc);
+                    BSON_APPEND_DOCUMENT_BEGIN(&scopeDoc, "time", &timeDoc);
+                    if(doc.begin.has_value()) BSON_APPEND_DOUBLE(&timeDoc, "since", doc.begin.value());
+                    if(doc.end.has_value())   BSON_APPEND_DOUBLE(&timeDoc, "until", doc.end.value());
+                    bson_append_document_end(&scopeDoc, &timeDoc);
+                    bson_append_document_end(&setDoc, &scopeDoc);
+                }
+                bson_append_document_end(&updateDoc, &setDoc);
+                bulk->pushUpdate(&queryDoc, &updateDoc);
+                bson_destroy(&updateDoc);
+                numOperations += 1;
+            }
+            bson_destroy(&queryDoc);
         }
-        bson_append_document_end(updateDoc.bson(), &setDoc);
-        tripleCollection_->update(Document(BCON_NEW("_id", BCON_OID(&firstOID))), updateDoc);
-        // remove all other documents
-        auto it = documentIDs.begin();
-        for(it++; it!=documentIDs.end(); it++) tripleCollection_->removeOne(*it);
+    }
+    if(numOperations>0) {
+        bulk->execute();
     }
 }
 
@@ -876,3 +1484,63 @@ TEST_F(MongoKnowledgeGraphTest, ExtendsTimeInterval)
     statement.temporalOperator = TemporalOperator::SOMETIMES;
     EXPECT_EQ(lookup(statement).size(), 1);
 }
+
+TEST_F(MongoKnowledgeGraphTest, MergesTimeIntervalsOfBatch)
+{
+    // assert overlapping statements [30,40], [35,50] and [45,60] in one batch,
+    // and a disjoint statement [70,80]
+    std::vector<StatementData> statements;
+    for(auto &interval : { std::make_pair(30.0,40.0), std::make_pair(35.0,50.0),
+                           std::make_pair(45.0,60.0), std::make_pair(70.0,80.0) }) {
+        auto &statement = statements.emplace_back(swrl_test_"Lea", swrl_test_"hasName", "Lea");
+        statement.begin = interval.first;
+        statement.end = interval.second;
+    }
+    EXPECT_NO_THROW(kg_->insert(statements));
+
+    StatementData statement(swrl_test_"Lea", swrl_test_"hasName", "Lea");
+    statement.temporalOperator = TemporalOperator::SOMETIMES;
+    statement.begin = 0.0;
+    statement.end = 100.0;
+    // intervals were merged into [30,60] and [70,80]
+    EXPECT_EQ(lookup(statement).size(), 2);
+    statement.temporalOperator = TemporalOperator::ALWAYS;
+    statement.begin = 30.0;
+    statement.end = 60.0;
+    EXPECT_EQ(lookup(statement).size(), 1);
+}
+
+TEST_F(MongoKnowledgeGraphTest, ReplaceStatements)
+{
+    StatementData oldName(swrl_test_"Fred", swrl_test_"hasName", "Fred");
+    StatementData oldNick(swrl_test_"Fred", swrl_test_"hasName", "Freddy");
+    StatementData newName(swrl_test_"Fred", swrl_test_"hasName", "Frederick");
+    EXPECT_NO_THROW(kg_->insert(std::vector<StatementData>{ oldName, oldNick }));
+    EXPECT_EQ(lookup(oldName).size(), 1);
+    EXPECT_EQ(lookup(oldNick).size(), 1);
+    // the statements are removed before the new statement is inserted
+    std::vector<RDFLiteralPtr> retracted = {
+        std::make_shared<RDFLiteral>(oldName),
+        std::make_shared<RDFLiteral>(oldNick) };
+    EXPECT_TRUE(kg_->replace(retracted, { newName }));
+    EXPECT_EQ(lookup(oldName).size(), 0);
+    EXPECT_EQ(lookup(oldNick).size(), 0);
+    EXPECT_EQ(lookup(newName).size(), 1);
+    // remove the new statement again
+    EXPECT_NO_THROW(kg_->remove({ std::make_shared<RDFLiteral>(newName) }));
+    EXPECT_EQ(lookup(newName).size(), 0);
+}
+
+TEST_F(MongoKnowledgeGraphTest, InsertsBatchIntoGraphs)
+{
+    StatementData inUser(swrl_test_"Ernest", swrl_test_"hasName", "Ernest", "user");
+    StatementData inOther(swrl_test_"Ernest", swrl_test_"hasName", "Ernie", "test_graph");
+    EXPECT_NO_THROW(kg_->insert(std::vector<StatementData>{ inUser, inOther }));
+    // each statement is stored in its own graph
+    StatementData lookupOther(swrl_test_"Ernest", swrl_test_"hasName", "Ernest", "test_graph");
+    EXPECT_EQ(lookup(lookupOther).size(), 0);
+    EXPECT_EQ(lookup(inOther).size(), 1);
+    EXPECT_EQ(lookup(inUser).size(), 1);
+    kg_->dropGraph("test_graph");
+    EXPECT_EQ(lookup(inOther).size(), 0);
+}
@@ -0,0 +1,124 @@
+//
+// Created by daniel on 18.10.23.
+//
+
+#include "knowrob/Logger.h"
+#include "knowrob/mongodb/MongoMaterializer.h"
+#include "knowrob/mongodb/BulkOperation.h"
+#include "knowrob/mongodb/Document.h"
+#include "knowrob/mongodb/TripleCursor.h"
+#include "knowrob/mongodb/TripleLoader.h"
+
+using namespace knowrob;
+using namespace knowrob::mongo;
+using namespace knowrob::semweb;
+
+const std::string MongoMaterializer::DERIVED_GRAPH = "derived";
+
+MongoMaterializer::MongoMaterializer(const std::shared_ptr<Collection> &tripleCollection,
+                                     const std::shared_ptr<Collection> &oneCollection,
+                                     const VocabularyPtr &vocabulary)
+: Materializer(vocabulary),
+  tripleCollection_(tripleCollection),
+  oneCollection_(oneCollection)
+{
+}
+
+void MongoMaterializer::appendUnscopedSelector(bson_t *selectorDoc)
+{
+    // only statements without temporal or epistemic scope are materialized:
+    // { agent: {$exists: false}, scope: {$exists: false}, uncertain: {$ne: true}, occasional: {$ne: true} }
+    bson_t agentDoc, scopeDoc, uncertainDoc, occasionalDoc;
+    BSON_APPEND_DOCUMENT_BEGIN(selectorDoc, "agent", &agentDoc);
+    BSON_APPEND_BOOL(&agentDoc, "$exists", false);
+    bson_append_document_end(selectorDoc, &agentDoc);
+    BSON_APPEND_DOCUMENT_BEGIN(selectorDoc, "scope", &scopeDoc);
+    BSON_APPEND_BOOL(&scopeDoc, "$exists", false);
+    bson_append_document_end(selectorDoc, &scopeDoc);
+    BSON_APPEND_DOCUMENT_BEGIN(selectorDoc, "uncertain", &uncertainDoc);
+    BSON_APPEND_BOOL(&uncertainDoc, "$ne", true);
+    bson_append_document_end(selectorDoc, &uncertainDoc);
+    BSON_APPEND_DOCUMENT_BEGIN(selectorDoc, "occasional", &occasionalDoc);
+    BSON_APPEND_BOOL(&occasionalDoc, "$ne", true);
+    bson_append_document_end(selectorDoc, &occasionalDoc);
+}
+
+void MongoMaterializer::match(const std::string *subject,
+                              const std::string &predicate,
+                              const std::string *object,
+                              const TripleVisitor &visitor)
+{
+    // note: "p*" and "o*" fields are used such that sub-properties and sub-classes are matched
+    Document selector(bson_new());
+    if(subject) BSON_APPEND_UTF8(selector.bson(), "s", subject->c_str());
+    if(Vocabulary::isTaxonomicProperty(predicate)) {
+        BSON_APPEND_UTF8(selector.bson(), "p", predicate.c_str());
+        if(object) BSON_APPEND_UTF8(selector.bson(), "o*", object->c_str());
+    }
+    else {
+        BSON_APPEND_UTF8(selector.bson(), "p*", predicate.c_str());
+        if(object) BSON_APPEND_UTF8(selector.bson(), "o", object->c_str());
+    }
+    appendUnscopedSelector(selector.bson());
+
+    TripleCursor cursor(tripleCollection_);
+    cursor.filter(selector.bson());
+    StatementData tripleData;
+    Triple triple;
+    while(cursor.nextTriple(tripleData)) {
+        if(!tripleData.object || tripleData.objectType != RDF_STRING_LITERAL) continue;
+        triple.subject = tripleData.subject;
+        triple.predicate = tripleData.predicate;
+        triple.object = tripleData.object;
+        visitor(triple, tripleData.graph && DERIVED_GRAPH == tripleData.graph);
+    }
+}
+
+void MongoMaterializer::matchGraph(const std::string &graphName, std::vector<Triple> &triples)
+{
+    Document selector(bson_new());
+    BSON_APPEND_UTF8(selector.bson(), "graph", graphName.c_str());
+    appendUnscopedSelector(selector.bson());
+
+    TripleCursor cursor(tripleCollection_);
+    cursor.filter(selector.bson());
+    StatementData tripleData;
+    while(cursor.nextTriple(tripleData)) {
+        if(!tripleData.object || tripleData.objectType != RDF_STRING_LITERAL) continue;
+        Triple triple{tripleData.subject, tripleData.predicate, tripleData.object};
+        if(isRelevant(triple)) triples.push_back(std::move(triple));
+    }
+}
+
+void MongoMaterializer::insertDerived(const std::vector<Triple> &triples)
+{
+    TripleLoader loader(DERIVED_GRAPH, tripleCollection_, oneCollection_, vocabulary_);
+    for(auto &triple : triples) {
+        loader.loadTriple(StatementData(
+                triple.subject.c_str(),
+                triple.predicate.c_str(),
+                triple.object.c_str(),
+                DERIVED_GRAPH.c_str()));
+    }
+    loader.flush();
+}
+
+void MongoMaterializer::removeDerived(const std::vector<Triple> &triples)
+{
+    auto bulkOperation = tripleCollection_->createBulkOperation();
+    for(auto &triple : triples) {
+        Document document(BCON_NEW(
+                "s", BCON_UTF8(triple.subject.c_str()),
+                "p", BCON_UTF8(triple.predicate.c_str()),
+                "o", BCON_UTF8(triple.object.c_str()),
+                "graph", BCON_UTF8(DERIVED_GRAPH.c_str())));
+        bulkOperation->pushRemoveOne(document.bson());
+    }
+    bulkOperation->execute();
+}
+
+void MongoMaterializer::removeAllDerived()
+{
+    tripleCollection_->removeAll(Document(
+            BCON_NEW("graph", BCON_UTF8(DERIVED_GRAPH.c_str()))));
+}
@@ -49,11 +49,25 @@ void Pipeline::appendStageEnd(bson_t *stage)
 
 void Pipeline::limit(uint32_t maxDocuments)
 {
+    if(maxDocuments==0) {
+        // { $match: { $expr: false } }
+        auto matchStage = appendStageBegin("$match");
+        BSON_APPEND_BOOL(matchStage, "$expr", false);
+        appendStageEnd(matchStage);
+        return;
+    }
     auto unwindStage = appendStageBegin();
     BSON_APPEND_INT32(unwindStage, "$limit", maxDocuments);
     appendStageEnd(unwindStage);
 }
 
+void Pipeline::skip(uint32_t numDocuments)
+{
+    auto skipStage = appendStageBegin();
+    BSON_APPEND_INT32(skipStage, "$skip", numDocuments);
+    appendStageEnd(skipStage);
+}
+
 void Pipeline::unwind(const std::string_view &field)
 {
     auto unwindStage = appendStageBegin();
@@ -82,6 +96,15 @@ void Pipeline::sortAscending(const std::string_view &field)
     appendStageEnd(sortStage);
 }
 
+void Pipeline::sortAscending(const std::vector<std::string_view> &fields)
+{
+    auto sortStage = appendStageBegin("$sort");
+    for(auto &field : fields) {
+        BSON_APPEND_INT32(sortStage, field.data(), 1);
+    }
+    appendStageEnd(sortStage);
+}
+
 void Pipeline::sortDescending(const std::string_view &field)
 {
     auto sortStage = appendStageBegin("$sort");
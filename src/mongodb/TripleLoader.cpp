@@ -4,6 +4,7 @@
 
 #include "utility"
 #include "knowrob/Logger.h"
+#include "knowrob/Metrics.h"
 #include "knowrob/semweb/rdf.h"
 #include "knowrob/semweb/rdfs.h"
 #include "knowrob/semweb/owl.h"
@@ -23,22 +24,111 @@ TripleLoader::TripleLoader(std::string graphName,
           oneCollection_(oneCollection),
           batchSize_(batchSize),
           vocabulary_(vocabulary),
-          operationCounter_(0)
+          operationCounter_(0),
+          isOrderedBatch_(false)
 {
+    bson_init(&tripleDoc_);
 }
 
 TripleLoader::~TripleLoader()
-= default;
+{
+    bson_destroy(&tripleDoc_);
+}
 
-bson_t* TripleLoader::createTripleDocument(const StatementData &tripleData,
-                                           const std::string &graphName,
-                                           bool isTaxonomic)
+void TripleLoader::appendParents(bson_t *tripleDoc, const char *key, const std::vector<std::string> &parents)
 {
     bson_t parentsArray;
-    uint32_t arrIndex=0;
-    auto counterPtr=&arrIndex;
+    char arrIndexStr[16];
+    const char *arrIndexKey;
+    uint32_t arrIndex = 0;
 
-    bson_t *tripleDoc = bson_new();
+    BSON_APPEND_ARRAY_BEGIN(tripleDoc, key, &parentsArray);
+    for(auto &parent : parents) {
+        // note: keys of small indices are precomputed by libbson
+        bson_uint32_to_string(arrIndex++, &arrIndexKey, arrIndexStr, sizeof arrIndexStr);
+        bson_append_utf8(&parentsArray, arrIndexKey, -1, parent.c_str(), static_cast<int>(parent.size()));
+    }
+    bson_append_array_end(tripleDoc, &parentsArray);
+}
+
+void TripleLoader::cacheParents(ParentsCache &cache, DescendantsIndex &descendants, std::unique_ptr<ParentsEntry> entry)
+{
+    // note: parents include the resource itself
+    for(auto &parent : entry->parents) {
+        descendants[parent].insert(entry->iri);
+    }
+    std::string_view key = entry->iri;
+    cache.emplace(key, std::move(entry));
+}
+
+void TripleLoader::invalidateParents(ParentsCache &cache, DescendantsIndex &descendants, const char *iri)
+{
+    auto it = descendants.find(iri);
+    if(it == descendants.end()) return;
+    auto invalidated = std::move(it->second);
+    descendants.erase(it);
+
+    for(auto &descendant : invalidated) {
+        auto entryIt = cache.find(descendant);
+        if(entryIt == cache.end()) continue;
+        // remove the entry from the index of its other parents
+        for(auto &parent : entryIt->second->parents) {
+            auto parentIt = descendants.find(parent);
+            if(parentIt == descendants.end()) continue;
+            parentIt->second.erase(descendant);
+            if(parentIt->second.empty()) descendants.erase(parentIt);
+        }
+        cache.erase(entryIt);
+    }
+}
+
+const TripleLoader::ParentsEntry& TripleLoader::getPropertyParents(const char *propertyIRI)
+{
+    auto it = propertyParents_.find(propertyIRI);
+    if(it != propertyParents_.end()) {
+        return *it->second;
+    }
+    auto entry = std::make_unique<ParentsEntry>();
+    entry->iri = propertyIRI;
+    auto entryPtr = entry.get();
+    vocabulary_->defineProperty(propertyIRI)->forallParents(
+        [entryPtr](const auto &parent){ entryPtr->parents.push_back(parent.iri()); });
+    cacheParents(propertyParents_, propertyDescendants_, std::move(entry));
+    return *entryPtr;
+}
+
+const TripleLoader::ParentsEntry* TripleLoader::getObjectParents(const char *objectIRI)
+{
+    auto it = objectParents_.find(objectIRI);
+    if(it != objectParents_.end()) {
+        return it->second.get();
+    }
+    auto entry = std::make_unique<ParentsEntry>();
+    auto entryPtr = entry.get();
+    if(vocabulary_->isDefinedProperty(objectIRI)) {
+        vocabulary_->getDefinedProperty(objectIRI)->forallParents(
+            [entryPtr](const auto &parent){ entryPtr->parents.push_back(parent.iri()); });
+    }
+    else if(vocabulary_->isDefinedClass(objectIRI)) {
+        vocabulary_->getDefinedClass(objectIRI)->forallParents(
+            [entryPtr](const auto &parent){ entryPtr->parents.push_back(parent.iri()); });
+    }
+    else {
+        // undefined resources are not cached as they may be defined later
+        return nullptr;
+    }
+    entry->iri = objectIRI;
+    cacheParents(objectParents_, objectDescendants_, std::move(entry));
+    return entryPtr;
+}
+
+const bson_t* TripleLoader::encodeTriple(const StatementData &tripleData,
+                                         const std::string &graphName,
+                                         bool isTaxonomic)
+{
+    // re-use the memory allocated for previous triples
+    bson_t *tripleDoc = &tripleDoc_;
+    bson_reinit(tripleDoc);
     BSON_APPEND_UTF8(tripleDoc, "s", tripleData.subject);
     BSON_APPEND_UTF8(tripleDoc, "p", tripleData.predicate);
 
@@ -47,28 +137,16 @@ bson_t* TripleLoader::createTripleDocument(const StatementData &tripleData,
             case RDF_STRING_LITERAL:
             case RDF_RESOURCE: {
                 BSON_APPEND_UTF8(tripleDoc, "o", tripleData.object);
-
-                BSON_APPEND_ARRAY_BEGIN(tripleDoc, "o*", &parentsArray);
-                auto parentsPtr = &parentsArray;
-                if(vocabulary_->isDefinedProperty(tripleData.object)) {
-                    vocabulary_->getDefinedProperty(tripleData.object)->forallParents(
-                        [parentsPtr,counterPtr](const auto &parent){
-                            auto counterKey = std::to_string((*counterPtr)++);
-                            BSON_APPEND_UTF8(parentsPtr, counterKey.c_str(), parent.iri().c_str());
-                        });
-                }
-                else if(vocabulary_->isDefinedClass(tripleData.object)) {
-                    // read parents array
-                    vocabulary_->getDefinedClass(tripleData.object)->forallParents(
-                        [parentsPtr,counterPtr](const auto &parent){
-                            auto counterKey = std::to_string((*counterPtr)++);
-                            BSON_APPEND_UTF8(parentsPtr, counterKey.c_str(), parent.iri().c_str());
-                        });
+                auto objectParents = getObjectParents(tripleData.object);
+                if(objectParents) {
+                    appendParents(tripleDoc, "o*", objectParents->parents);
                 }
                 else {
+                    bson_t parentsArray;
+                    BSON_APPEND_ARRAY_BEGIN(tripleDoc, "o*", &parentsArray);
                     BSON_APPEND_UTF8(&parentsArray, "0", tripleData.object);
+                    bson_append_array_end(tripleDoc, &parentsArray);
                 }
-                bson_append_array_end(tripleDoc, &parentsArray);
                 break;
             }
             case RDF_DOUBLE_LITERAL:
@@ -99,14 +177,7 @@ bson_t* TripleLoader::createTripleDocument(const StatementData &tripleData,
                 break;
         }
         // read parents array
-        BSON_APPEND_ARRAY_BEGIN(tripleDoc, "p*", &parentsArray);
-        auto parentsPtr = &parentsArray;
-        vocabulary_->defineProperty(tripleData.predicate)->forallParents(
-            [parentsPtr,counterPtr](const auto &parent){
-                auto counterKey = std::to_string((*counterPtr)++);
-                BSON_APPEND_UTF8(parentsPtr, counterKey.c_str(), parent.iri().c_str());
-            });
-        bson_append_array_end(tripleDoc, &parentsArray);
+        appendParents(tripleDoc, "p*", getPropertyParents(tripleData.predicate).parents);
     }
 
     BSON_APPEND_UTF8(tripleDoc, "graph", graphName.c_str());
@@ -146,12 +217,25 @@ bson_t* TripleLoader::createTripleDocument(const StatementData &tripleData,
 
 void TripleLoader::loadTriple(const StatementData &tripleData)
 {
-    bool isTaxonomic=false;
-
     // skip annotations. they may contain spacial characters and cannot be indexed.
     // TODO: optionally allow inserting annotation properties into separate collection
     if(vocabulary_->isAnnotationProperty(tripleData.predicate)) return;
 
+    bool isTaxonomic = updateVocabulary(tripleData);
+    auto document = encodeTriple(tripleData, graphName_, isTaxonomic);
+    if(!bulkOperation_) {
+        bulkOperation_ = tripleCollection_->createBulkOperation();
+    }
+    // note: the bulk operation copies the document
+    bulkOperation_->pushInsert(document);
+
+    if(operationCounter_++ > batchSize_) flush();
+}
+
+bool TripleLoader::updateVocabulary(const StatementData &tripleData)
+{
+    bool isTaxonomic=false;
+
     // keep track of imports, subclasses, and subproperties
     if(semweb::isSubClassOfIRI(tripleData.predicate)) {
         auto sub = vocabulary_->defineClass(tripleData.subject);
@@ -159,6 +243,8 @@ void TripleLoader::loadTriple(const StatementData &tripleData)
         sub->addDirectParent(sup);
         subClassAssertions_.emplace_back(sub, sup);
         isTaxonomic = true;
+        // parents of the subclass and its descendants have changed
+        invalidateParents(objectParents_, objectDescendants_, tripleData.subject);
     }
     else if(semweb::isSubPropertyOfIRI(tripleData.predicate)) {
         auto sub = vocabulary_->defineProperty(tripleData.subject);
@@ -166,6 +252,9 @@ void TripleLoader::loadTriple(const StatementData &tripleData)
         sub->addDirectParent(sup);
         subPropertyAssertions_.emplace_back(sub, sup);
         isTaxonomic = true;
+        // parents of the subproperty and its descendants have changed
+        invalidateParents(propertyParents_, propertyDescendants_, tripleData.subject);
+        invalidateParents(objectParents_, objectDescendants_, tripleData.subject);
     }
     else if(semweb::isTypeIRI(tripleData.predicate)) {
         isTaxonomic = true;
@@ -177,26 +266,44 @@ void TripleLoader::loadTriple(const StatementData &tripleData)
         p->setInverse(q);
         q->setInverse(p);
     }
+    else if(semweb::isDomainIRI(tripleData.predicate)) {
+        vocabulary_->addPropertyDomain(tripleData.subject, tripleData.object);
+    }
+    else if(semweb::isRangeIRI(tripleData.predicate)) {
+        vocabulary_->addPropertyRange(tripleData.subject, tripleData.object);
+    }
     else if(owl::imports == tripleData.predicate) {
         // TODO: maybe better for less hierarchy updates to load right away?
         imports_.emplace_back(tripleData.object);
     }
+    return isTaxonomic;
+}
 
-    auto document = createTripleDocument(tripleData, graphName_, isTaxonomic);
+void TripleLoader::removeAll(const bson_t *selectorDoc)
+{
+    // operations of unordered batches may be executed in any order
+    if(bulkOperation_ && !isOrderedBatch_) flush();
     if(!bulkOperation_) {
-        bulkOperation_ = tripleCollection_->createBulkOperation();
+        bulkOperation_ = tripleCollection_->createBulkOperation(true);
+        isOrderedBatch_ = true;
     }
-    bulkOperation_->pushInsert(document);
-    bson_free(document);
+    bulkOperation_->pushRemoveAll(selectorDoc);
 
     if(operationCounter_++ > batchSize_) flush();
 }
 
 void TripleLoader::flush()
 {
+    static auto &numFlushed = knowrob::Metrics::get().counter(
+            "knowrob_loader_flushed_statements_total", "Number of statements written by triple loaders.");
+    static auto &flushLatency = knowrob::Metrics::get().histogram(
+            "knowrob_loader_flush_seconds", "Time needed to write a batch of statements.");
     if(bulkOperation_) {
+        knowrob::MetricsTimer timer(flushLatency);
+        numFlushed.increment(operationCounter_);
         bulkOperation_->execute();
         bulkOperation_.reset();
     }
     operationCounter_ = 0;
+    isOrderedBatch_ = false;
 }
@@ -678,6 +678,13 @@ void aggregation::lookupTriple(
 
     bool b_isTransitiveProperty = (definedProperty && definedProperty->hasFlag(
             semweb::PropertyFlag::TRANSITIVE_PROPERTY));
+    // the transitive closure is stored if entailments are materialized, but only
+    // for statements without temporal or epistemic scope.
+    if(b_isTransitiveProperty && lookupData.isMaterialized) {
+        auto &expr = *lookupData.expr;
+        bool b_isScoped = expr.beginTerm() || expr.endTerm() || expr.agentTerm() || expr.confidenceTerm();
+        b_isTransitiveProperty = b_isScoped;
+    }
     if(b_isTransitiveProperty || lookupData.forceTransitiveLookup)
         lookupTriple_transitive_(pipeline, collection, vocabulary, lookupData, definedProperty);
     else
@@ -688,7 +695,8 @@ void aggregation::lookupTriplePaths(
         aggregation::Pipeline &pipeline,
         const std::string_view &collection,
         const std::shared_ptr<semweb::Vocabulary> &vocabulary,
-        const std::vector<RDFLiteralPtr> &tripleExpressions)
+        const std::vector<RDFLiteralPtr> &tripleExpressions,
+        bool isMaterialized)
 {
     std::set<std::string_view> varsSoFar;
 
@@ -700,6 +708,7 @@ void aggregation::lookupTriplePaths(
         // indicate that all previous groundings of variables are known
         lookupData.mayHasMoreGroundings = false;
         lookupData.knownGroundedVariables = varsSoFar;
+        lookupData.isMaterialized = isMaterialized;
         // remember variables in tripleExpression, they have a grounding in next step
         for(auto &exprTerm : {
                 expr->subjectTerm(), expr->propertyTerm(), expr->objectTerm() }) {
@@ -713,3 +722,110 @@ void aggregation::lookupTriplePaths(
                                   lookupData);
     }
 }
+
+void aggregation::aggregateTriplePaths(
+        aggregation::Pipeline &pipeline,
+        const QueryAggregate &aggregate)
+{
+    // one answer is sufficient to decide existence, unless existence is decided per group
+    if(aggregate.function() == AggregateFunction::EXISTS && aggregate.groupBy().empty()) {
+        pipeline.limit(1);
+    }
+
+    // { $group: { _id: { G: "$v_VARS.G.val", ... }, agg: { $op: ... } } }
+    bson_t groupIdDoc, accumulatorDoc;
+    auto groupStage = pipeline.appendStageBegin("$group");
+    if(aggregate.groupBy().empty()) {
+        BSON_APPEND_NULL(groupStage, "_id");
+    }
+    else {
+        BSON_APPEND_DOCUMENT_BEGIN(groupStage, "_id", &groupIdDoc);
+        for(auto &groupVar : aggregate.groupBy()) {
+            auto groupValue = std::string("$")+getVariableKey(groupVar->name())+".val";
+            BSON_APPEND_UTF8(&groupIdDoc, groupVar->name().c_str(), groupValue.c_str());
+        }
+        bson_append_document_end(groupStage, &groupIdDoc);
+    }
+    BSON_APPEND_DOCUMENT_BEGIN(groupStage, "agg", &accumulatorDoc);
+    switch(aggregate.function()) {
+        case AggregateFunction::COUNT:
+            BSON_APPEND_INT64(&accumulatorDoc, "$sum", 1);
+            break;
+        case AggregateFunction::EXISTS:
+            // each group has at least one answer
+            BSON_APPEND_INT64(&accumulatorDoc, "$max", 1);
+            break;
+        case AggregateFunction::SUM:
+            // $sum ignores non-numeric values
+            BSON_APPEND_UTF8(&accumulatorDoc, "$sum",
+                             (std::string("$")+getVariableKey(aggregate.value()->name())+".val").c_str());
+            break;
+        case AggregateFunction::MIN:
+        case AggregateFunction::MAX: {
+            // $min and $max compare values of different types, e.g. strings are larger than numbers.
+            // non-numeric values are removed to select only among numbers.
+            // { $min: { $cond: [ { $in: [ { $type: "$v_VARS.X.val" }, [ "double", ... ] ] }, "$v_VARS.X.val", "$$REMOVE" ] } }
+            auto operatorName = std::string("$")+QueryAggregate::functionName(aggregate.function());
+            auto value = std::string("$")+getVariableKey(aggregate.value()->name())+".val";
+            bson_t condDoc, condArray, inArray, typeDoc, typesArray;
+            BSON_APPEND_DOCUMENT_BEGIN(&accumulatorDoc, operatorName.c_str(), &condDoc);
+            BSON_APPEND_ARRAY_BEGIN(&condDoc, "$cond", &condArray);
+            {
+                bson_t inDoc;
+                BSON_APPEND_DOCUMENT_BEGIN(&condArray, "0", &inDoc);
+                BSON_APPEND_ARRAY_BEGIN(&inDoc, "$in", &inArray);
+                BSON_APPEND_DOCUMENT_BEGIN(&inArray, "0", &typeDoc);
+                BSON_APPEND_UTF8(&typeDoc, "$type", value.c_str());
+                bson_append_document_end(&inArray, &typeDoc);
+                BSON_APPEND_ARRAY_BEGIN(&inArray, "1", &typesArray);
+                BSON_APPEND_UTF8(&typesArray, "0", "double");
+                BSON_APPEND_UTF8(&typesArray, "1", "int");
+                BSON_APPEND_UTF8(&typesArray, "2", "long");
+                BSON_APPEND_UTF8(&typesArray, "3", "decimal");
+                bson_append_array_end(&inArray, &typesArray);
+                bson_append_array_end(&inDoc, &inArray);
+                bson_append_document_end(&condArray, &inDoc);
+            }
+            BSON_APPEND_UTF8(&condArray, "1", value.c_str());
+            BSON_APPEND_UTF8(&condArray, "2", "$$REMOVE");
+            bson_append_array_end(&condDoc, &condArray);
+            bson_append_document_end(&accumulatorDoc, &condDoc);
+            break;
+        }
+    }
+    bson_append_document_end(groupStage, &accumulatorDoc);
+    pipeline.appendStageEnd(groupStage);
+
+    // groups without a numeric value have no minimum or maximum
+    // { $match: { agg: { $ne: null } } }
+    if(aggregate.function() == AggregateFunction::MIN || aggregate.function() == AggregateFunction::MAX) {
+        bson_t neDoc;
+        auto matchStage = pipeline.appendStageBegin("$match");
+        BSON_APPEND_DOCUMENT_BEGIN(matchStage, "agg", &neDoc);
+        BSON_APPEND_NULL(&neDoc, "$ne");
+        bson_append_document_end(matchStage, &neDoc);
+        pipeline.appendStageEnd(matchStage);
+    }
+
+    // map groups back to answer documents:
+    // { $project: { _id: 0, "v_VARS.R.val": "$agg", "v_VARS.G.val": "$_id.G", ... } }
+    auto projectStage = pipeline.appendStageBegin("$project");
+    BSON_APPEND_INT32(projectStage, "_id", 0);
+    auto resultKey = getVariableKey(aggregate.result()->name())+".val";
+    if(aggregate.function() == AggregateFunction::SUM) {
+        // the sum is a double, also if all values are integers
+        bson_t toDoubleDoc;
+        BSON_APPEND_DOCUMENT_BEGIN(projectStage, resultKey.c_str(), &toDoubleDoc);
+        BSON_APPEND_UTF8(&toDoubleDoc, "$toDouble", "$agg");
+        bson_append_document_end(projectStage, &toDoubleDoc);
+    }
+    else {
+        BSON_APPEND_UTF8(projectStage, resultKey.c_str(), "$agg");
+    }
+    for(auto &groupVar : aggregate.groupBy()) {
+        auto groupKey = getVariableKey(groupVar->name())+".val";
+        auto groupValue = std::string("$_id.")+groupVar->name();
+        BSON_APPEND_UTF8(projectStage, groupKey.c_str(), groupValue.c_str());
+    }
+    pipeline.appendStageEnd(projectStage);
+}
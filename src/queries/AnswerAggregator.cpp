@@ -0,0 +1,199 @@
+//
+// Created by daniel on 18.10.26.
+//
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include "knowrob/queries/AnswerAggregator.h"
+#include "knowrob/queries/AnswerQueue.h"
+#include "knowrob/terms/Constant.h"
+
+using namespace knowrob;
+
+AnswerAggregator::AnswerAggregator(QueryAggregatePtr aggregate)
+: AnswerBroadcaster(),
+  aggregate_(std::move(aggregate)),
+  isEOSSent_(false)
+{
+}
+
+static std::optional<double> numericValue(const TermPtr &term)
+{
+    if(!term) return std::nullopt;
+    switch(term->type()) {
+        case TermType::DOUBLE:
+            return std::static_pointer_cast<DoubleTerm>(term)->value();
+        case TermType::LONG:
+            return static_cast<double>(std::static_pointer_cast<LongTerm>(term)->value());
+        case TermType::INT32:
+            return static_cast<double>(std::static_pointer_cast<Integer32Term>(term)->value());
+        default:
+            return std::nullopt;
+    }
+}
+
+void AnswerAggregator::push(const AnswerPtr &msg)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(isEOSSent_) return;
+
+    if(AnswerStream::isEOS(msg)) {
+        if(groups_.empty() && aggregate_->hasEmptyAnswer()) {
+            AnswerBroadcaster::push(aggregate_->emptyAnswer());
+        }
+        for(auto &pair : groups_) {
+            pushGroup(pair.second);
+        }
+        groups_.clear();
+        AnswerBroadcaster::push(msg);
+        isEOSSent_ = true;
+        return;
+    }
+
+    // find the group of the answer
+    auto &substitution = *msg->substitution();
+    std::stringstream keyStream;
+    std::vector<TermPtr> key(aggregate_->groupBy().size());
+    for(std::size_t i=0; i<key.size(); ++i) {
+        auto &groupVar = *aggregate_->groupBy()[i];
+        if(substitution.contains(groupVar)) {
+            key[i] = substitution.get(groupVar);
+            keyStream << *key[i];
+        }
+        keyStream << '\t';
+    }
+    auto &group = groups_[keyStream.str()];
+    if(group.count==0) group.key = key;
+    group.count += 1;
+
+    switch(aggregate_->function()) {
+        case AggregateFunction::COUNT:
+            break;
+        case AggregateFunction::EXISTS:
+            if(aggregate_->groupBy().empty()) {
+                // no need to wait for more answers
+                pushGroup(group);
+                groups_.clear();
+                AnswerBroadcaster::push(AnswerStream::eos());
+                isEOSSent_ = true;
+            }
+            break;
+        case AggregateFunction::SUM: {
+            auto value = numericValue(substitution.get(*aggregate_->value()));
+            if(value.has_value()) group.sum += value.value();
+            break;
+        }
+        case AggregateFunction::MIN:
+        case AggregateFunction::MAX: {
+            auto &term = substitution.get(*aggregate_->value());
+            auto value = numericValue(term);
+            if(!value.has_value()) break;
+            bool isMin = (aggregate_->function() == AggregateFunction::MIN);
+            if(!group.selected ||
+               ( isMin && value.value() < group.selectedValue) ||
+               (!isMin && value.value() > group.selectedValue)) {
+                group.selected = term;
+                group.selectedValue = value.value();
+            }
+            break;
+        }
+    }
+}
+
+void AnswerAggregator::pushGroup(const Group &group)
+{
+    TermPtr result;
+    switch(aggregate_->function()) {
+        case AggregateFunction::COUNT:
+            result = std::make_shared<LongTerm>(group.count);
+            break;
+        case AggregateFunction::EXISTS:
+            result = std::make_shared<LongTerm>(group.count>0 ? 1 : 0);
+            break;
+        case AggregateFunction::SUM:
+            result = std::make_shared<DoubleTerm>(group.sum);
+            break;
+        case AggregateFunction::MIN:
+        case AggregateFunction::MAX:
+            // no numeric value in the group
+            if(!group.selected) return;
+            result = group.selected;
+            break;
+    }
+    auto answer = std::make_shared<Answer>();
+    for(std::size_t i=0; i<group.key.size(); ++i) {
+        if(group.key[i]) answer->substitute(*aggregate_->groupBy()[i], group.key[i]);
+    }
+    answer->substitute(*aggregate_->result(), result);
+    AnswerBroadcaster::push(answer);
+}
+
+// fixture class for testing
+class AnswerAggregatorTest : public ::testing::Test {
+protected:
+    static AnswerPtr answer(const std::vector<std::pair<std::string,TermPtr>> &bindings) {
+        auto a = std::make_shared<Answer>();
+        for(auto &pair : bindings) a->substitute(Variable(pair.first), pair.second);
+        return a;
+    }
+    static std::vector<AnswerPtr> aggregate(const QueryAggregatePtr &aggregate,
+                                            const std::vector<AnswerPtr> &answers) {
+        auto aggregator = std::make_shared<AnswerAggregator>(aggregate);
+        auto output = std::make_shared<AnswerQueue>();
+        aggregator->addSubscriber(AnswerStream::Channel::create(output));
+        auto input = AnswerStream::Channel::create(aggregator);
+        for(auto &a : answers) input->push(a);
+        input->push(AnswerStream::eos());
+        std::vector<AnswerPtr> out;
+        while(output->size()>0) {
+            auto next = output->pop_front();
+            if(!AnswerStream::isEOS(next)) out.push_back(next);
+        }
+        return out;
+    }
+};
+
+TEST_F(AnswerAggregatorTest, Count)
+{
+    auto n = std::make_shared<Variable>("N");
+    auto result = aggregate(std::make_shared<QueryAggregate>(AggregateFunction::COUNT, n), {
+        answer({{"X", std::make_shared<DoubleTerm>(1.0)}}),
+        answer({{"X", std::make_shared<DoubleTerm>(2.0)}})
+    });
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_EQ(*result[0]->substitution()->get(*n), LongTerm(2));
+    // counting no answers yields zero
+    result = aggregate(std::make_shared<QueryAggregate>(AggregateFunction::COUNT, n), {});
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_EQ(*result[0]->substitution()->get(*n), LongTerm(0));
+}
+
+TEST_F(AnswerAggregatorTest, MaxGroupBy)
+{
+    auto x = std::make_shared<Variable>("X");
+    auto g = std::make_shared<Variable>("G");
+    auto m = std::make_shared<Variable>("M");
+    auto result = aggregate(std::make_shared<QueryAggregate>(AggregateFunction::MAX, m, x,
+            std::vector<std::shared_ptr<Variable>>{g}), {
+        answer({{"X", std::make_shared<DoubleTerm>(1.0)}, {"G", std::make_shared<StringTerm>("a")}}),
+        answer({{"X", std::make_shared<DoubleTerm>(4.0)}, {"G", std::make_shared<StringTerm>("b")}}),
+        answer({{"X", std::make_shared<DoubleTerm>(3.0)}, {"G", std::make_shared<StringTerm>("a")}})
+    });
+    ASSERT_EQ(result.size(), 2);
+    // groups are ordered by their key
+    EXPECT_EQ(*result[0]->substitution()->get(*g), StringTerm("a"));
+    EXPECT_EQ(*result[0]->substitution()->get(*m), DoubleTerm(3.0));
+    EXPECT_EQ(*result[1]->substitution()->get(*g), StringTerm("b"));
+    EXPECT_EQ(*result[1]->substitution()->get(*m), DoubleTerm(4.0));
+}
+
+TEST_F(AnswerAggregatorTest, Exists)
+{
+    auto b = std::make_shared<Variable>("B");
+    auto result = aggregate(std::make_shared<QueryAggregate>(AggregateFunction::EXISTS, b), {
+        answer({{"X", std::make_shared<DoubleTerm>(1.0)}}),
+        answer({{"X", std::make_shared<DoubleTerm>(2.0)}})
+    });
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_EQ(*result[0]->substitution()->get(*b), LongTerm(1));
+}
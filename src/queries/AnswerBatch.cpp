@@ -0,0 +1,352 @@
+/*
+ * Copyright (c) 2023, Daniel Beßler
+ * All rights reserved.
+ *
+ * This file is part of KnowRob, please consult
+ * https://github.com/knowrob/knowrob for license details.
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "knowrob/queries/AnswerBatch.h"
+#include "knowrob/queries/QueryError.h"
+#include "knowrob/formulas/Predicate.h"
+
+using namespace knowrob;
+
+static const double numericNaN = std::numeric_limits<double>::quiet_NaN();
+static const double numericInf = std::numeric_limits<double>::infinity();
+
+// The kernels below are kept free of branches inside of the loops such that
+// the compiler can vectorize them.
+
+template <typename Op>
+static inline void compareKernel(const double *lhs, const double *rhs, std::size_t n, uint8_t *mask, Op op)
+{
+	for(std::size_t i=0; i<n; ++i) mask[i] = static_cast<uint8_t>(op(lhs[i], rhs[i]));
+}
+
+template <typename Op>
+static inline void compareKernel(const double *lhs, double rhs, std::size_t n, uint8_t *mask, Op op)
+{
+	for(std::size_t i=0; i<n; ++i) mask[i] = static_cast<uint8_t>(op(lhs[i], rhs));
+}
+
+template <typename Op>
+static inline void computeKernel(const double *lhs, const double *rhs, std::size_t n, double *out, Op op)
+{
+	for(std::size_t i=0; i<n; ++i) out[i] = op(lhs[i], rhs[i]);
+}
+
+template <typename Op>
+static inline void computeKernel(const double *lhs, double rhs, std::size_t n, double *out, Op op)
+{
+	for(std::size_t i=0; i<n; ++i) out[i] = op(lhs[i], rhs);
+}
+
+// note: `a != b` holds for NaN, `a < b || a > b` does not.
+#define KNOWROB_BATCH_COMPARE(lhs, rhs, n, op, mask) switch(op) { \
+	case BatchComparison::LT:  compareKernel(lhs, rhs, n, mask, [](double a, double b) { return a < b; }); break; \
+	case BatchComparison::LEQ: compareKernel(lhs, rhs, n, mask, [](double a, double b) { return a <= b; }); break; \
+	case BatchComparison::GT:  compareKernel(lhs, rhs, n, mask, [](double a, double b) { return a > b; }); break; \
+	case BatchComparison::GEQ: compareKernel(lhs, rhs, n, mask, [](double a, double b) { return a >= b; }); break; \
+	case BatchComparison::EQ:  compareKernel(lhs, rhs, n, mask, [](double a, double b) { return a == b; }); break; \
+	case BatchComparison::NEQ: compareKernel(lhs, rhs, n, mask, [](double a, double b) { return (a < b) | (a > b); }); break; \
+}
+
+// note: min and max propagate NaN such that unbound operands yield unbound results.
+#define KNOWROB_BATCH_COMPUTE(lhs, rhs, n, op, out) switch(op) { \
+	case BatchArithmetic::ADD: computeKernel(lhs, rhs, n, out, [](double a, double b) { return a + b; }); break; \
+	case BatchArithmetic::SUB: computeKernel(lhs, rhs, n, out, [](double a, double b) { return a - b; }); break; \
+	case BatchArithmetic::MUL: computeKernel(lhs, rhs, n, out, [](double a, double b) { return a * b; }); break; \
+	case BatchArithmetic::DIV: computeKernel(lhs, rhs, n, out, [](double a, double b) { return a / b; }); break; \
+	case BatchArithmetic::MIN: computeKernel(lhs, rhs, n, out, [](double a, double b) { return (a == a && b == b) ? (b < a ? b : a) : numericNaN; }); break; \
+	case BatchArithmetic::MAX: computeKernel(lhs, rhs, n, out, [](double a, double b) { return (a == a && b == b) ? (b > a ? b : a) : numericNaN; }); break; \
+}
+
+void batch::compare(const double *lhs, const double *rhs, std::size_t n, BatchComparison op, uint8_t *mask)
+{
+	KNOWROB_BATCH_COMPARE(lhs, rhs, n, op, mask)
+}
+
+void batch::compare(const double *lhs, double rhs, std::size_t n, BatchComparison op, uint8_t *mask)
+{
+	KNOWROB_BATCH_COMPARE(lhs, rhs, n, op, mask)
+}
+
+void batch::compute(const double *lhs, const double *rhs, std::size_t n, BatchArithmetic op, double *out)
+{
+	KNOWROB_BATCH_COMPUTE(lhs, rhs, n, op, out)
+}
+
+void batch::compute(const double *lhs, double rhs, std::size_t n, BatchArithmetic op, double *out)
+{
+	KNOWROB_BATCH_COMPUTE(lhs, rhs, n, op, out)
+}
+
+static double numericValue(const TermPtr &term)
+{
+	if(!term) return numericNaN;
+	switch(term->type()) {
+		case TermType::DOUBLE:
+			return std::static_pointer_cast<DoubleTerm>(term)->value();
+		case TermType::LONG:
+			return static_cast<double>(std::static_pointer_cast<LongTerm>(term)->value());
+		case TermType::INT32:
+			return static_cast<double>(std::static_pointer_cast<Integer32Term>(term)->value());
+		default:
+			return numericNaN;
+	}
+}
+
+AnswerBatch::AnswerBatch(std::vector<AnswerPtr> answers)
+: answers_(std::move(answers))
+{
+}
+
+void AnswerBatch::push_back(const AnswerPtr &answer)
+{
+	answers_.push_back(answer);
+	for(std::size_t i=0; i<columns_.size(); ++i) {
+		columns_[i].push_back(extractors_[i] ? extractors_[i](*answer) : numericNaN);
+	}
+}
+
+AnswerBatch::Column AnswerBatch::addColumn(const std::function<double(const Answer&)> &extractor)
+{
+	std::vector<double> values(answers_.size());
+	for(std::size_t i=0; i<answers_.size(); ++i) values[i] = extractor(*answers_[i]);
+	columns_.push_back(std::move(values));
+	extractors_.push_back(extractor);
+	return columns_.size()-1;
+}
+
+AnswerBatch::Column AnswerBatch::addComputedColumn()
+{
+	columns_.emplace_back(answers_.size());
+	extractors_.emplace_back();
+	return columns_.size()-1;
+}
+
+AnswerBatch::Column AnswerBatch::column(const Variable &var)
+{
+	auto it = variableColumns_.find(var.name());
+	if(it != variableColumns_.end()) return it->second;
+	auto column = addColumn([var](const Answer &answer) {
+		return numericValue(answer.substitution()->get(var));
+	});
+	variableColumns_.emplace(var.name(), column);
+	return column;
+}
+
+AnswerBatch::Column AnswerBatch::sinceColumn()
+{
+	if(!sinceColumn_.has_value()) {
+		sinceColumn_ = addColumn([](const Answer &answer) {
+			auto &ti = answer.timeInterval();
+			return ti.has_value() && ti->since().has_value() ? ti->since()->value() : -numericInf;
+		});
+	}
+	return sinceColumn_.value();
+}
+
+AnswerBatch::Column AnswerBatch::untilColumn()
+{
+	if(!untilColumn_.has_value()) {
+		untilColumn_ = addColumn([](const Answer &answer) {
+			auto &ti = answer.timeInterval();
+			return ti.has_value() && ti->until().has_value() ? ti->until()->value() : numericInf;
+		});
+	}
+	return untilColumn_.value();
+}
+
+AnswerBatch::Column AnswerBatch::constant(double value)
+{
+	auto column = addComputedColumn();
+	std::fill(columns_[column].begin(), columns_[column].end(), value);
+	return column;
+}
+
+AnswerBatch::Column AnswerBatch::compute(Column lhs, BatchArithmetic op, Column rhs)
+{
+	auto column = addComputedColumn();
+	batch::compute(columns_[lhs].data(), columns_[rhs].data(), answers_.size(), op, columns_[column].data());
+	return column;
+}
+
+AnswerBatch::Column AnswerBatch::compute(Column lhs, BatchArithmetic op, double rhs)
+{
+	auto column = addComputedColumn();
+	batch::compute(columns_[lhs].data(), rhs, answers_.size(), op, columns_[column].data());
+	return column;
+}
+
+AnswerBatch::Column AnswerBatch::evaluate(const TermPtr &expression)
+{
+	static const std::map<std::string, BatchArithmetic, std::less<>> operators = {
+		{ "+",   BatchArithmetic::ADD },
+		{ "-",   BatchArithmetic::SUB },
+		{ "*",   BatchArithmetic::MUL },
+		{ "/",   BatchArithmetic::DIV },
+		{ "min", BatchArithmetic::MIN },
+		{ "max", BatchArithmetic::MAX }
+	};
+	switch(expression->type()) {
+		case TermType::VARIABLE:
+			return column(*std::static_pointer_cast<Variable>(expression));
+		case TermType::DOUBLE:
+		case TermType::LONG:
+		case TermType::INT32:
+			return constant(numericValue(expression));
+		case TermType::PREDICATE: {
+			auto p = std::static_pointer_cast<Predicate>(expression);
+			auto &args = p->arguments();
+			auto it = operators.find(p->indicator()->functor());
+			if(it == operators.end() || args.size() != 2) break;
+			// avoid a column for constant right operands
+			auto lhs = evaluate(args[0]);
+			auto rhsValue = numericValue(args[1]);
+			if(!std::isnan(rhsValue)) return compute(lhs, it->second, rhsValue);
+			return compute(lhs, it->second, evaluate(args[1]));
+		}
+		default:
+			break;
+	}
+	throw QueryError("unsupported arithmetic expression `{}`", *expression);
+}
+
+std::size_t AnswerBatch::compact()
+{
+	auto n = answers_.size();
+	std::size_t kept = 0;
+	for(std::size_t i=0; i<n; ++i) {
+		if(mask_[i]) answers_[kept++] = std::move(answers_[i]);
+	}
+	answers_.resize(kept);
+	if(kept == n) return kept;
+	for(auto &values : columns_) {
+		std::size_t j = 0;
+		for(std::size_t i=0; i<n; ++i) {
+			values[j] = values[i];
+			j += mask_[i];
+		}
+		values.resize(kept);
+	}
+	return kept;
+}
+
+std::size_t AnswerBatch::filter(Column lhs, BatchComparison op, Column rhs)
+{
+	mask_.resize(answers_.size());
+	batch::compare(columns_[lhs].data(), columns_[rhs].data(), answers_.size(), op, mask_.data());
+	return compact();
+}
+
+std::size_t AnswerBatch::filter(Column lhs, BatchComparison op, double rhs)
+{
+	mask_.resize(answers_.size());
+	batch::compare(columns_[lhs].data(), rhs, answers_.size(), op, mask_.data());
+	return compact();
+}
+
+std::size_t AnswerBatch::filter(const TermPtr &lhs, BatchComparison op, const TermPtr &rhs)
+{
+	auto rhsValue = numericValue(rhs);
+	if(!std::isnan(rhsValue)) return filter(evaluate(lhs), op, rhsValue);
+	return filter(evaluate(lhs), op, evaluate(rhs));
+}
+
+std::size_t AnswerBatch::extend(const Variable &var, Column column)
+{
+	auto &values = columns_[column];
+	mask_.resize(answers_.size());
+	batch::compare(values.data(), values.data(), answers_.size(), BatchComparison::EQ, mask_.data());
+	compact();
+	for(std::size_t i=0; i<answers_.size(); ++i) {
+		auto extended = std::make_shared<Answer>(*answers_[i]);
+		extended->substitute(var, std::make_shared<DoubleTerm>(columns_[column][i]));
+		answers_[i] = extended;
+	}
+	variableColumns_[var.name()] = column;
+	return answers_.size();
+}
+
+// fixture class for testing
+class AnswerBatchTest : public ::testing::Test {
+protected:
+	std::shared_ptr<Variable> x_, y_;
+	AnswerBatch batch_;
+	void SetUp() override {
+		x_ = std::make_shared<Variable>("X");
+		y_ = std::make_shared<Variable>("Y");
+		for(int i=0; i<100; ++i) {
+			auto answer = std::make_shared<Answer>();
+			answer->substitute(*x_, std::make_shared<DoubleTerm>(i));
+			// Y is unbound in every tenth answer
+			if(i%10 != 0) answer->substitute(*y_, std::make_shared<LongTerm>(100-i));
+			answer->setTimeInterval(TimeInterval(TimePoint(i), std::nullopt));
+			batch_.push_back(answer);
+		}
+	}
+	std::vector<double> valuesOf(const Variable &var) {
+		std::vector<double> out;
+		for(auto &answer : batch_.answers()) out.push_back(numericValue(answer->substitution()->get(var)));
+		return out;
+	}
+};
+
+TEST_F(AnswerBatchTest, Kernels) {
+	std::vector<double> a = {1.0, 2.0, numericNaN, 4.0};
+	std::vector<double> b = {2.0, 2.0, 2.0, numericNaN};
+	std::vector<uint8_t> mask(4);
+	batch::compare(a.data(), b.data(), 4, BatchComparison::LEQ, mask.data());
+	EXPECT_EQ(mask, std::vector<uint8_t>({1, 1, 0, 0}));
+	batch::compare(a.data(), 2.0, 4, BatchComparison::NEQ, mask.data());
+	EXPECT_EQ(mask, std::vector<uint8_t>({1, 0, 0, 1}));
+	std::vector<double> out(4);
+	batch::compute(a.data(), b.data(), 4, BatchArithmetic::MAX, out.data());
+	EXPECT_EQ(out[0], 2.0);
+	EXPECT_EQ(out[1], 2.0);
+	EXPECT_TRUE(std::isnan(out[2]));
+	EXPECT_TRUE(std::isnan(out[3]));
+	batch::compute(a.data(), 2.0, 4, BatchArithmetic::MIN, out.data());
+	EXPECT_EQ(out[0], 1.0);
+	EXPECT_EQ(out[3], 2.0);
+}
+
+TEST_F(AnswerBatchTest, FilterByVariable) {
+	EXPECT_EQ(batch_.filter(batch_.column(*x_), BatchComparison::GEQ, 90.0), 10);
+	EXPECT_EQ(valuesOf(*x_).front(), 90.0);
+	// the column was compacted with the answers
+	EXPECT_EQ(batch_.values(batch_.column(*x_)).size(), 10);
+	EXPECT_EQ(batch_.values(batch_.column(*x_)).back(), 99.0);
+	// X=90 has no binding for Y
+	EXPECT_EQ(batch_.filter(batch_.column(*y_), BatchComparison::LT, 10.0), 9);
+}
+
+TEST_F(AnswerBatchTest, FilterByTime) {
+	EXPECT_EQ(batch_.filter(batch_.sinceColumn(), BatchComparison::LT, 50.0), 50);
+	EXPECT_EQ(batch_.filter(batch_.untilColumn(), BatchComparison::GT, 1000.0), 50);
+}
+
+TEST_F(AnswerBatchTest, FilterByExpression) {
+	// X + Y =:= 100 holds whenever Y is bound
+	auto sum = std::make_shared<Predicate>("+", std::vector<TermPtr>({x_, y_}));
+	EXPECT_EQ(batch_.filter(sum, BatchComparison::EQ, std::make_shared<LongTerm>(100)), 90);
+	// X > 100-X for X in 51..99, excluding four answers without Y
+	EXPECT_EQ(batch_.filter(x_, BatchComparison::GT, y_), 45);
+}
+
+TEST_F(AnswerBatchTest, Extend) {
+	auto z = std::make_shared<Variable>("Z");
+	auto expr = std::make_shared<Predicate>("*", std::vector<TermPtr>({
+		y_, std::make_shared<DoubleTerm>(2.0) }));
+	EXPECT_EQ(batch_.extend(*z, batch_.evaluate(expr)), 90);
+	auto zValues = valuesOf(*z);
+	auto yValues = valuesOf(*y_);
+	for(std::size_t i=0; i<zValues.size(); ++i) EXPECT_EQ(zValues[i], 2.0*yValues[i]);
+	EXPECT_THROW(batch_.evaluate(std::make_shared<StringTerm>("a")), QueryError);
+}
@@ -0,0 +1,180 @@
+//
+// Created by daniel on 18.10.26.
+//
+
+#include <gtest/gtest.h>
+#include <limits>
+#include <set>
+#include <sstream>
+#include "knowrob/queries/AnswerSlice.h"
+#include "knowrob/queries/AnswerQueue.h"
+#include "knowrob/terms/Constant.h"
+
+using namespace knowrob;
+
+AnswerSlice::AnswerSlice(std::optional<uint32_t> limit, uint32_t offset, bool isOrdered)
+: AnswerBroadcaster(),
+  limit_(limit),
+  offset_(offset),
+  isOrdered_(isOrdered),
+  numAnswers_(0),
+  isEOSSent_(false)
+{
+}
+
+void AnswerSlice::pushOrderedPage()
+{
+    // the heap yields answers in descending order
+    std::vector<AnswerPtr> page;
+    while(orderedAnswers_.size() > offset_) {
+        page.push_back(orderedAnswers_.top().second);
+        orderedAnswers_.pop();
+    }
+    for(auto it = page.rbegin(); it != page.rend(); ++it) {
+        AnswerBroadcaster::push(*it);
+    }
+    orderedAnswers_ = {};
+}
+
+void AnswerSlice::push(const AnswerPtr &msg)
+{
+    bool isPageComplete = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(isEOSSent_) {
+            return;
+        }
+        if(AnswerStream::isEOS(msg)) {
+            if(isOrdered_) pushOrderedPage();
+            AnswerBroadcaster::push(msg);
+            isEOSSent_ = true;
+        }
+        else if(isOrdered_) {
+            std::ostringstream key;
+            key << *msg;
+            // answers after the page can be dropped
+            bool isFull = limit_.has_value() && orderedAnswers_.size() >= (uint64_t)offset_ + limit_.value();
+            if(!isFull) {
+                orderedAnswers_.emplace(key.str(), msg);
+            }
+            else if(!orderedAnswers_.empty() && key.str() < orderedAnswers_.top().first) {
+                orderedAnswers_.pop();
+                orderedAnswers_.emplace(key.str(), msg);
+            }
+        }
+        else {
+            // answers of the page are broadcast as they arrive
+            uint64_t pageEnd = limit_.has_value() ?
+                    (uint64_t)offset_ + limit_.value() : std::numeric_limits<uint64_t>::max();
+            if(numAnswers_ >= offset_ && numAnswers_ < pageEnd) {
+                AnswerBroadcaster::push(msg);
+            }
+            numAnswers_ += 1;
+            if(numAnswers_ >= pageEnd) {
+                AnswerBroadcaster::push(AnswerStream::eos());
+                isEOSSent_ = true;
+                isPageComplete = true;
+            }
+        }
+    }
+    // stop generating answers that are not needed anymore.
+    // note that this is done without holding the lock as
+    // stopped stages send EOS to this stage.
+    if(isPageComplete && stopHandler_) {
+        stopHandler_();
+    }
+}
+
+
+// fixture class for testing
+class AnswerSliceTest : public ::testing::Test {
+protected:
+    void SetUp() override {}
+    void TearDown() override {}
+};
+
+static AnswerPtr numberAnswer(int value)
+{
+    auto answer = std::make_shared<Answer>();
+    answer->substitute(Variable("X"), std::make_shared<LongTerm>(value));
+    return answer;
+}
+
+static std::vector<AnswerPtr> readPage(const std::vector<int> &values, std::optional<uint32_t> limit, uint32_t offset)
+{
+    auto slice = std::make_shared<AnswerSlice>(limit, offset);
+    auto output = std::make_shared<AnswerQueue>();
+    slice->addSubscriber(AnswerStream::Channel::create(output));
+    auto input = AnswerStream::Channel::create(slice);
+    for(auto value : values) input->push(numberAnswer(value));
+    // the page is only broadcast once the input stream ends
+    EXPECT_EQ(output->size(), 0);
+    input->push(AnswerStream::eos());
+    std::vector<AnswerPtr> page;
+    while(!output->empty()) {
+        auto next = output->pop_front();
+        if(AnswerStream::isEOS(next)) break;
+        page.push_back(next);
+    }
+    EXPECT_TRUE(output->empty());
+    return page;
+}
+
+TEST_F(AnswerSliceTest, LimitAndOffset)
+{
+    auto page = readPage({ 4, 2, 3, 1 }, 2, 1);
+    ASSERT_EQ(page.size(), 2);
+    EXPECT_EQ(*page[0]->substitution()->get(Variable("X")), *std::make_shared<LongTerm>(2));
+    EXPECT_EQ(*page[1]->substitution()->get(Variable("X")), *std::make_shared<LongTerm>(3));
+}
+
+TEST_F(AnswerSliceTest, OffsetOnly)
+{
+    auto page = readPage({ 5, 3, 1, 4, 2 }, std::nullopt, 2);
+    ASSERT_EQ(page.size(), 3);
+    EXPECT_EQ(*page[0]->substitution()->get(Variable("X")), *std::make_shared<LongTerm>(3));
+    EXPECT_EQ(*page[2]->substitution()->get(Variable("X")), *std::make_shared<LongTerm>(5));
+}
+
+TEST_F(AnswerSliceTest, PagesIndependentOfArrivalOrder)
+{
+    // consecutive pages of differently ordered input streams cover all answers once
+    auto first = readPage({ 1, 2, 3, 4, 5 }, 2, 0);
+    auto second = readPage({ 5, 4, 3, 2, 1 }, 2, 2);
+    auto third = readPage({ 3, 1, 5, 2, 4 }, 2, 4);
+    ASSERT_EQ(first.size(), 2);
+    ASSERT_EQ(second.size(), 2);
+    ASSERT_EQ(third.size(), 1);
+    std::set<std::string> values;
+    for(auto &page : { first, second, third }) {
+        for(auto &answer : page) {
+            std::ostringstream os;
+            os << *answer;
+            values.insert(os.str());
+        }
+    }
+    EXPECT_EQ(values.size(), 5);
+}
+
+TEST_F(AnswerSliceTest, UnorderedPageStopsInput)
+{
+    auto slice = std::make_shared<AnswerSlice>(2, 1, false);
+    int numStopRequests = 0;
+    slice->setStopHandler([&numStopRequests]() { numStopRequests += 1; });
+    auto output = std::make_shared<AnswerQueue>();
+    slice->addSubscriber(AnswerStream::Channel::create(output));
+    auto input = AnswerStream::Channel::create(slice);
+    // answers are broadcast as they arrive
+    input->push(numberAnswer(4));
+    input->push(numberAnswer(2));
+    EXPECT_EQ(output->size(), 1);
+    EXPECT_EQ(numStopRequests, 0);
+    // the page is complete without waiting for EOS
+    input->push(numberAnswer(3));
+    EXPECT_EQ(numStopRequests, 1);
+    input->push(numberAnswer(1));
+    ASSERT_EQ(output->size(), 3);
+    EXPECT_EQ(*output->pop_front()->substitution()->get(Variable("X")), *std::make_shared<LongTerm>(2));
+    EXPECT_EQ(*output->pop_front()->substitution()->get(Variable("X")), *std::make_shared<LongTerm>(3));
+    EXPECT_TRUE(AnswerStream::isEOS(output->pop_front()));
+}
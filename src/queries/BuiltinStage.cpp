@@ -0,0 +1,179 @@
+//
+// Created by daniel on 18.10.26.
+//
+
+#include <gtest/gtest.h>
+#include <map>
+#include "knowrob/queries/BuiltinStage.h"
+#include "knowrob/queries/AnswerQueue.h"
+#include "knowrob/queries/QueryError.h"
+#include "knowrob/terms/Constant.h"
+#include "knowrob/formulas/Predicate.h"
+#include "knowrob/Logger.h"
+
+using namespace knowrob;
+
+static const std::string isFunctor = "is";
+
+static const std::map<std::string, BatchComparison, std::less<>>& comparisonFunctors()
+{
+    static const std::map<std::string, BatchComparison, std::less<>> comparisons = {
+        { "<",   BatchComparison::LT },
+        { "=<",  BatchComparison::LEQ },
+        { ">",   BatchComparison::GT },
+        { ">=",  BatchComparison::GEQ },
+        { "=:=", BatchComparison::EQ },
+        { "=\\=", BatchComparison::NEQ }
+    };
+    return comparisons;
+}
+
+static const std::string* functorOf(const RDFLiteral &literal)
+{
+    auto p = literal.propertyTerm();
+    if(!p || p->type() != TermType::STRING) return nullptr;
+    return &std::static_pointer_cast<StringTerm>(p)->value();
+}
+
+BuiltinStage::BuiltinStage(std::vector<RDFLiteralPtr> builtins, std::size_t batchSize)
+: AnswerBroadcaster(),
+  builtins_(std::move(builtins)),
+  batchSize_(batchSize),
+  isEOSSent_(false)
+{
+}
+
+bool BuiltinStage::isBuiltin(const RDFLiteral &literal)
+{
+    auto functor = functorOf(literal);
+    if(!functor || literal.isNegated()) return false;
+    return *functor == isFunctor || comparisonFunctors().count(*functor) > 0;
+}
+
+void BuiltinStage::evaluate(const RDFLiteral &builtin, AnswerBatch &batch)
+{
+    auto &functor = *functorOf(builtin);
+    auto lhs = builtin.subjectTerm();
+    auto rhs = builtin.objectTerm();
+    auto it = comparisonFunctors().find(functor);
+    if(it != comparisonFunctors().end()) {
+        batch.filter(lhs, it->second, rhs);
+    }
+    else if(lhs->type() == TermType::VARIABLE) {
+        batch.extend(*std::static_pointer_cast<Variable>(lhs), batch.evaluate(rhs));
+    }
+    else {
+        // a bound first argument of is/2 is compared with the value
+        batch.filter(batch.evaluate(lhs), BatchComparison::EQ, batch.evaluate(rhs));
+    }
+}
+
+void BuiltinStage::flush()
+{
+    AnswerBatch batch;
+    std::swap(batch, batch_);
+    if(batch.size() == 0) return;
+
+    int64_t cpuBegin = profile_ ? StageProfile::threadCPUTime() : 0;
+    try {
+        for(auto &builtin : builtins_) {
+            if(batch.size() == 0) break;
+            evaluate(*builtin, batch);
+        }
+    }
+    catch(const QueryError &e) {
+        KB_WARN("failed to evaluate builtins: {}", e.what());
+        return;
+    }
+    if(profile_) {
+        profile_->cpuTimeNs += StageProfile::threadCPUTime() - cpuBegin;
+        profile_->numAnswersOut += batch.size();
+    }
+    for(auto &answer : batch.answers()) {
+        AnswerBroadcaster::push(answer);
+    }
+}
+
+void BuiltinStage::push(const AnswerPtr &msg)
+{
+    // note: answers are broadcast while holding the lock such that EOS is sent last
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(isEOSSent_) {
+        return;
+    }
+    if(AnswerStream::isEOS(msg)) {
+        flush();
+        if(profile_) profile_->end();
+        AnswerBroadcaster::push(msg);
+        isEOSSent_ = true;
+    }
+    else {
+        if(profile_) {
+            profile_->begin();
+            profile_->numAnswersIn += 1;
+        }
+        batch_.push_back(msg);
+        if(batch_.size() >= batchSize_) flush();
+    }
+}
+
+
+// fixture class for testing
+class BuiltinStageTest : public ::testing::Test {
+protected:
+    static RDFLiteralPtr builtin(const TermPtr &lhs, const std::string &functor, const TermPtr &rhs)
+    {
+        return std::make_shared<RDFLiteral>(lhs, std::make_shared<StringTerm>(functor), rhs, false);
+    }
+
+    static std::vector<AnswerPtr> evaluate(const std::vector<RDFLiteralPtr> &builtins, int numAnswers)
+    {
+        auto stage = std::make_shared<BuiltinStage>(builtins, 8);
+        auto output = std::make_shared<AnswerQueue>();
+        stage->addSubscriber(AnswerStream::Channel::create(output));
+        auto input = AnswerStream::Channel::create(stage);
+        for(int i=0; i<numAnswers; ++i) {
+            auto answer = std::make_shared<Answer>();
+            answer->substitute(Variable("X"), std::make_shared<LongTerm>(i));
+            input->push(answer);
+        }
+        input->push(AnswerStream::eos());
+        std::vector<AnswerPtr> answers;
+        while(!output->empty()) {
+            auto next = output->pop_front();
+            if(AnswerStream::isEOS(next)) break;
+            answers.push_back(next);
+        }
+        return answers;
+    }
+};
+
+TEST_F(BuiltinStageTest, IsBuiltin) {
+    auto x = std::make_shared<Variable>("X");
+    auto one = std::make_shared<LongTerm>(1);
+    EXPECT_TRUE(BuiltinStage::isBuiltin(*builtin(x, "<", one)));
+    EXPECT_TRUE(BuiltinStage::isBuiltin(*builtin(x, "is", one)));
+    EXPECT_FALSE(BuiltinStage::isBuiltin(*builtin(x, "p", one)));
+    EXPECT_FALSE(BuiltinStage::isBuiltin(RDFLiteral(x, std::make_shared<StringTerm>("<"), one, true)));
+}
+
+TEST_F(BuiltinStageTest, FilterAcrossBatches) {
+    auto x = std::make_shared<Variable>("X");
+    // the answers are evaluated in three batches of at most eight answers
+    auto answers = evaluate({ builtin(x, ">=", std::make_shared<LongTerm>(5)),
+                              builtin(x, "=\\=", std::make_shared<LongTerm>(7)) }, 20);
+    EXPECT_EQ(answers.size(), 14);
+}
+
+TEST_F(BuiltinStageTest, BindResult) {
+    auto x = std::make_shared<Variable>("X");
+    auto y = std::make_shared<Variable>("Y");
+    auto doubled = std::make_shared<Predicate>("*", std::vector<TermPtr>({ x, std::make_shared<LongTerm>(2) }));
+    auto answers = evaluate({ builtin(y, "is", doubled), builtin(y, "<", std::make_shared<LongTerm>(10)) }, 20);
+    ASSERT_EQ(answers.size(), 5);
+    for(auto &answer : answers) {
+        auto xValue = std::static_pointer_cast<LongTerm>(answer->substitution()->get(*x))->value();
+        auto yValue = std::static_pointer_cast<DoubleTerm>(answer->substitution()->get(*y))->value();
+        EXPECT_EQ(yValue, 2.0 * xValue);
+    }
+}
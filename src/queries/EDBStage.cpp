@@ -12,5 +12,5 @@ EDBStage::EDBStage(KnowledgeGraphPtr edb, const RDFLiteralPtr &literal, int quer
 
 AnswerBufferPtr EDBStage::submitQuery(const RDFLiteralPtr &literal)
 {
-    return edb_->submitQuery(std::make_shared<GraphQuery>(literal, queryFlags_));
+    return edb_->submitQuery(std::make_shared<GraphQuery>(literal, queryFlags_), profile_);
 }
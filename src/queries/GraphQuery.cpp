@@ -12,14 +12,16 @@ using namespace knowrob;
 
 GraphQuery::GraphQuery(const std::vector<RDFLiteralPtr> &literals, int flags)
 : Query(flags),
-  literals_(literals)
+  literals_(literals),
+  offset_(0)
 {
     init();
 }
 
 GraphQuery::GraphQuery(const RDFLiteralPtr &literal, int flags)
 : Query(flags),
-  literals_({literal})
+  literals_({literal}),
+  offset_(0)
 {
     init();
 }
@@ -54,6 +56,9 @@ const FormulaPtr& GraphQuery::formula() const
 std::ostream& GraphQuery::print(std::ostream &os) const
 {
     // TODO: also print ModalFrame
+    if(aggregate_) os << *aggregate_ << ": ";
     os << *formula();
+    if(offset_>0) os << " offset " << offset_;
+    if(limit_.has_value()) os << " limit " << limit_.value();
     return os;
 }
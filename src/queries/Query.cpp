@@ -2,11 +2,18 @@
 // Created by daniel on 28.07.23.
 //
 
+#include <atomic>
 #include "knowrob/queries/Query.h"
 #include "knowrob/KnowledgeBase.h"
 
 using namespace knowrob;
 
+uint64_t Query::nextQueryID()
+{
+	static std::atomic<uint64_t> counter(1);
+	return counter.fetch_add(1, std::memory_order_relaxed);
+}
+
 int Query::defaultFlags()
 { return (int)QueryFlag::QUERY_FLAG_ALL_SOLUTIONS; }
 
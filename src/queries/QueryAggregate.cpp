@@ -0,0 +1,83 @@
+//
+// Created by daniel on 18.10.26.
+//
+
+#include "knowrob/queries/QueryAggregate.h"
+#include "knowrob/queries/QueryError.h"
+#include "knowrob/terms/Constant.h"
+
+using namespace knowrob;
+
+QueryAggregate::QueryAggregate(AggregateFunction function,
+                               std::shared_ptr<Variable> result,
+                               std::shared_ptr<Variable> value,
+                               std::vector<std::shared_ptr<Variable>> groupBy)
+: function_(function),
+  result_(std::move(result)),
+  value_(std::move(value)),
+  groupBy_(std::move(groupBy))
+{
+    if(!value_ && function_ != AggregateFunction::COUNT && function_ != AggregateFunction::EXISTS) {
+        throw QueryError("aggregate function {} requires a variable.", functionName(function_));
+    }
+}
+
+bool QueryAggregate::hasEmptyAnswer() const
+{
+    // without groups, counting no answers still yields an answer
+    return groupBy_.empty() && (
+        function_ == AggregateFunction::COUNT ||
+        function_ == AggregateFunction::EXISTS ||
+        function_ == AggregateFunction::SUM);
+}
+
+AnswerPtr QueryAggregate::emptyAnswer() const
+{
+    auto answer = std::make_shared<Answer>();
+    if(function_ == AggregateFunction::SUM) {
+        answer->substitute(*result_, std::make_shared<DoubleTerm>(0.0));
+    }
+    else {
+        answer->substitute(*result_, std::make_shared<LongTerm>(0));
+    }
+    return answer;
+}
+
+std::optional<AggregateFunction> QueryAggregate::functionFromName(const std::string_view &name)
+{
+    if(name == "count")       return AggregateFunction::COUNT;
+    else if(name == "exists") return AggregateFunction::EXISTS;
+    else if(name == "min")    return AggregateFunction::MIN;
+    else if(name == "max")    return AggregateFunction::MAX;
+    else if(name == "sum")    return AggregateFunction::SUM;
+    else return std::nullopt;
+}
+
+const char* QueryAggregate::functionName(AggregateFunction function)
+{
+    switch(function) {
+        case AggregateFunction::COUNT:  return "count";
+        case AggregateFunction::EXISTS: return "exists";
+        case AggregateFunction::MIN:    return "min";
+        case AggregateFunction::MAX:    return "max";
+        case AggregateFunction::SUM:    return "sum";
+    }
+    return "";
+}
+
+namespace std {
+    std::ostream& operator<<(std::ostream& os, const knowrob::QueryAggregate& aggregate) //NOLINT
+    {
+        os << QueryAggregate::functionName(aggregate.function());
+        if(aggregate.value()) os << '(' << *aggregate.value() << ')';
+        if(!aggregate.groupBy().empty()) {
+            os << " by ";
+            for(std::size_t i=0; i<aggregate.groupBy().size(); ++i) {
+                if(i>0) os << ',';
+                os << *aggregate.groupBy()[i];
+            }
+        }
+        os << " as " << *aggregate.result();
+        return os;
+    }
+}
@@ -39,6 +39,7 @@ using TermRule = qi::rule<Iterator, std::shared_ptr<Term>()>;
 using PredicateRule = qi::rule<Iterator, std::shared_ptr<Predicate>(), ascii::space_type>;
 using FormulaRule = qi::rule<Iterator, std::shared_ptr<Formula>(), ascii::space_type>;
 using StringRule = qi::rule<Iterator, std::string()>;
+using AggregateRule = qi::rule<Iterator, std::pair<FormulaPtr, QueryAggregatePtr>(), ascii::space_type>;
 
 namespace knowrob {
     struct ParserRules {
@@ -76,6 +77,10 @@ namespace knowrob {
         TermRule keyvalue;
         TermRule options;
         TermRule nil;
+        TermRule variableList;
+
+        // a rule that matches aggregate queries
+        AggregateRule aggregate;
 
         StringRule singleQuotes;
         StringRule doubleQuotes;
@@ -297,6 +302,40 @@ static ModalOperatorPtr createH(const TermPtr &optionsTerm) {
     return PastModality::H();
 }
 
+static std::pair<FormulaPtr, QueryAggregatePtr> createAggregate(const TermPtr &spec,
+                                                                const TermPtr &groupBy,
+                                                                const FormulaPtr &goal,
+                                                                const TermPtr &result)
+{
+    // read the aggregate function and the aggregated variable
+    std::optional<AggregateFunction> function;
+    std::shared_ptr<Variable> value;
+    if(spec->type() == TermType::STRING) {
+        function = QueryAggregate::functionFromName(((StringTerm*)spec.get())->value());
+    }
+    else if(spec->type() == TermType::PREDICATE) {
+        auto predicate = (Predicate*)spec.get();
+        if(predicate->indicator()->arity()==1 && predicate->arguments()[0]->type()==TermType::VARIABLE) {
+            function = QueryAggregate::functionFromName(predicate->indicator()->functor());
+            value = std::static_pointer_cast<Variable>(predicate->arguments()[0]);
+        }
+    }
+    if(!function.has_value()) {
+        throw QueryError("Unrecognized aggregate ({}).", *spec);
+    }
+    // read variables used for grouping
+    std::vector<std::shared_ptr<Variable>> groupVars;
+    if(groupBy && groupBy.get() != ListTerm::nil().get()) {
+        for(auto &groupVar : *((ListTerm*)groupBy.get())) {
+            groupVars.push_back(std::static_pointer_cast<Variable>(groupVar));
+        }
+    }
+    return { goal, std::make_shared<QueryAggregate>(function.value(),
+                                                    std::static_pointer_cast<Variable>(result),
+                                                    value,
+                                                    groupVars) };
+}
+
 static std::vector<TermPtr> createTermVector2(const TermPtr &a, const TermPtr &b) { return {a, b}; }
 
 QueryParser::QueryParser() {
@@ -339,6 +378,8 @@ QueryParser::QueryParser() {
             qi::char_('(') >> (bnf_->argument % ',') >> ')')
             [qi::_val = ptr_<Predicate>()(qi::_1, qi::_3)]);
     bnf_->argument %= bnf_->compound | bnf_->variable | bnf_->constant | bnf_->constantList;
+    bnf_->variableList = ((qi::char_('[') >> (bnf_->variable % ',') >> qi::char_(']'))
+            [qi::_val = ptr_<ListTerm>()(qi::_2)]);
 
     ///////////////////////////
     // predicates
@@ -393,6 +434,15 @@ QueryParser::QueryParser() {
                          | bnf_->disjunction[qi::_val = qi::_1]);
 
     bnf_->formula %= bnf_->implication | bnf_->brackets;
+
+    ///////////////////////////
+    // aggregate queries
+    bnf_->aggregate = ((qi::lit("aggregate_all") >> '(' >> bnf_->argument >> ',' >> bnf_->variableList >> ','
+                        >> bnf_->formula >> ',' >> bnf_->variable >> ')')
+                         [qi::_val = boost::phoenix::bind(&createAggregate, qi::_1, qi::_2, qi::_3, qi::_4)]
+                       | (qi::lit("aggregate_all") >> '(' >> bnf_->argument >> ','
+                        >> bnf_->formula >> ',' >> bnf_->variable >> ')')
+                         [qi::_val = boost::phoenix::bind(&createAggregate, qi::_1, ListTerm::nil(), qi::_2, qi::_3)]);
     //BOOST_SPIRIT_DEBUG_NODES((bnf_->conjunction)(bnf_->formula))
 }
 
@@ -432,6 +482,10 @@ TermPtr QueryParser::parseConstant(const std::string &queryString) {
     return parse_<TermPtr, TermRule>(queryString, get()->constant);
 }
 
+std::pair<FormulaPtr, QueryAggregatePtr> QueryParser::parseAggregate(const std::string &queryString) {
+    return parse_<std::pair<FormulaPtr, QueryAggregatePtr>, AggregateRule>(queryString, get()->aggregate);
+}
+
 // fixture class for testing
 class QueryParserTest : public ::testing::Test {
 protected:
@@ -683,3 +737,22 @@ TEST_F(QueryParserTest, Precedence) {
                                QueryParser::parse("Bp->~p"),
                                2, {FormulaType::MODAL, FormulaType::NEGATION}))
 }
+
+TEST_F(QueryParserTest, Aggregates) {
+    std::pair<FormulaPtr, QueryAggregatePtr> aggregate;
+    TEST_NO_THROW(aggregate = QueryParser::parseAggregate("aggregate_all(count, p(X,Y), N)"))
+    EXPECT_EQ(aggregate.first->type(), FormulaType::PREDICATE);
+    EXPECT_EQ(aggregate.second->function(), AggregateFunction::COUNT);
+    EXPECT_EQ(aggregate.second->result()->name(), "N");
+    EXPECT_EQ(aggregate.second->value(), nullptr);
+
+    TEST_NO_THROW(aggregate = QueryParser::parseAggregate("aggregate_all(max(T), [E], (p(E,T), q(E)), M)"))
+    EXPECT_EQ(aggregate.first->type(), FormulaType::CONJUNCTION);
+    EXPECT_EQ(aggregate.second->function(), AggregateFunction::MAX);
+    EXPECT_EQ(aggregate.second->value()->name(), "T");
+    ASSERT_EQ(aggregate.second->groupBy().size(), 1);
+    EXPECT_EQ(aggregate.second->groupBy()[0]->name(), "E");
+
+    EXPECT_THROW(QueryParser::parseAggregate("aggregate_all(median(T), p(T), M)"), QueryError);
+    EXPECT_THROW(QueryParser::parseAggregate("aggregate_all(max, p(T), M)"), QueryError);
+}
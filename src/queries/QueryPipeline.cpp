@@ -5,13 +5,23 @@ using namespace knowrob;
 
 QueryPipeline::~QueryPipeline()
 {
-    for(auto &stage : stages_) {
+    close();
+}
+
+void QueryPipeline::close()
+{
+    std::vector<std::shared_ptr<AnswerStream>> stages;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stages.swap(stages_);
+    }
+    for(auto &stage : stages) {
         stage->close();
     }
-    stages_.clear();
 }
 
 void QueryPipeline::addStage(const std::shared_ptr<AnswerStream> &stage)
 {
+    std::lock_guard<std::mutex> lock(mutex_);
     stages_.push_back(stage);
 }
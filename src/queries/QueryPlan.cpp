@@ -0,0 +1,52 @@
+//
+// Created by daniel on 18.10.23.
+//
+
+#include "knowrob/queries/QueryPlan.h"
+
+using namespace knowrob;
+
+std::ostream& QueryPlan::print(std::ostream &os) const
+{
+    uint32_t pathIndex = 0;
+    for(auto &path : paths_) {
+        os << "path " << pathIndex++ << ":\n";
+
+        os << "  edb literals:";
+        if(path.edbLiterals.empty()) os << " none";
+        os << '\n';
+        for(auto &lit : path.edbLiterals) {
+            os << "    " << *lit << '\n';
+        }
+        if(!path.edbQuery.empty()) {
+            os << "  edb query: " << path.edbQuery << '\n';
+        }
+
+        uint32_t groupIndex = 0;
+        for(auto &group : path.dependencyGroups) {
+            os << "  dependency group " << groupIndex++ << ":\n";
+            for(auto &step : group) {
+                os << "    " << *step.literal << " [edb";
+                for(auto &reasonerName : step.reasonerNames) {
+                    os << ", " << reasonerName;
+                }
+                os << "]\n";
+            }
+        }
+
+        for(auto &lit : path.builtinLiterals) {
+            os << "  builtin literal: " << *lit << '\n';
+        }
+        for(auto &lit : path.negativeLiterals) {
+            os << "  negative literal: " << *lit << '\n';
+        }
+    }
+    return os;
+}
+
+namespace std {
+    std::ostream& operator<<(std::ostream& os, const knowrob::QueryPlan& plan) //NOLINT
+    {
+        return plan.print(os);
+    }
+}
@@ -0,0 +1,138 @@
+//
+// Created by daniel on 18.10.23.
+//
+
+#include <ctime>
+#include <chrono>
+#include <iomanip>
+#include <gtest/gtest.h>
+#include "knowrob/queries/QueryProfile.h"
+
+using namespace knowrob;
+
+StageProfile::StageProfile(std::string name)
+: numSubQueries(0),
+  numAnswersIn(0),
+  numAnswersOut(0),
+  cpuTimeNs(0),
+  blockedTimeNs(0),
+  name_(std::move(name)),
+  beginTimeNs_(0),
+  endTimeNs_(0)
+{
+}
+
+int64_t StageProfile::threadCPUTime()
+{
+    struct timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+int64_t StageProfile::steadyTime()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void StageProfile::begin()
+{
+    int64_t expected = 0;
+    beginTimeNs_.compare_exchange_strong(expected, steadyTime());
+}
+
+void StageProfile::end()
+{
+    endTimeNs_ = steadyTime();
+}
+
+double StageProfile::wallTime() const
+{
+    int64_t beginTime = beginTimeNs_;
+    if(beginTime == 0) return 0.0;
+    int64_t endTime = endTimeNs_;
+    // the stage is still active if it has not sent EOS yet
+    if(endTime == 0) endTime = steadyTime();
+    return static_cast<double>(endTime - beginTime) / 1e9;
+}
+
+QueryProfile::QueryProfile()
+: creationTimeNs_(StageProfile::steadyTime())
+{
+}
+
+StageProfilePtr QueryProfile::addStage(const std::string &name)
+{
+    auto stage = std::make_shared<StageProfile>(name);
+    std::lock_guard<std::mutex> lock(mutex_);
+    stages_.push_back(stage);
+    return stage;
+}
+
+std::vector<StageProfilePtr> QueryProfile::stages() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stages_;
+}
+
+double QueryProfile::totalWallTime() const
+{
+    return static_cast<double>(StageProfile::steadyTime() - creationTimeNs_) / 1e9;
+}
+
+std::ostream& QueryProfile::print(std::ostream &os) const
+{
+    auto precision = os.precision();
+    os << std::fixed << std::setprecision(6);
+    os << "total wall time: " << totalWallTime() << "s\n";
+    for(auto &stage : stages()) {
+        os << stage->name() << '\n'
+           << "  subqueries: " << stage->numSubQueries
+           << ", answers in: " << stage->numAnswersIn
+           << ", answers out: " << stage->numAnswersOut << '\n'
+           << "  wall: " << stage->wallTime() << "s"
+           << ", cpu: " << stage->cpuTime() << "s"
+           << ", blocked: " << stage->blockedTime() << "s\n";
+    }
+    os.unsetf(std::ios_base::floatfield);
+    os.precision(precision);
+    return os;
+}
+
+namespace std {
+    std::ostream& operator<<(std::ostream& os, const knowrob::QueryProfile& profile) //NOLINT
+    {
+        return profile.print(os);
+    }
+}
+
+// fixture class for testing
+class QueryProfileTest : public ::testing::Test {
+protected:
+    void SetUp() override {}
+    void TearDown() override {}
+};
+
+TEST_F(QueryProfileTest, StagesInOrderOfCreation)
+{
+    QueryProfile profile;
+    auto first = profile.addStage("first");
+    auto second = profile.addStage("second");
+    auto stages = profile.stages();
+    ASSERT_EQ(stages.size(), 2);
+    EXPECT_EQ(stages[0], first);
+    EXPECT_EQ(stages[1], second);
+}
+
+TEST_F(QueryProfileTest, WallTimeOfStage)
+{
+    StageProfile stage("stage");
+    // no wall time before first input
+    EXPECT_EQ(stage.wallTime(), 0.0);
+    stage.begin();
+    stage.end();
+    auto wallTime = stage.wallTime();
+    EXPECT_GE(wallTime, 0.0);
+    // wall time does not change after the stage has ended
+    EXPECT_EQ(stage.wallTime(), wallTime);
+}
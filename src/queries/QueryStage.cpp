@@ -3,8 +3,10 @@
 //
 
 #include <utility>
+#include <sstream>
 
 #include "knowrob/Logger.h"
+#include "knowrob/Tracing.h"
 #include "knowrob/KnowledgeBase.h"
 #include "knowrob/queries/QueryStage.h"
 #include "knowrob/queries/AnswerTransformer.h"
@@ -18,7 +20,10 @@ namespace knowrob {
 		                      const AnswerPtr &partialResult)
 		: AnswerStream(),
 		  queryStage_(queryStage),
-		  partialResult_(partialResult)
+		  partialResult_(partialResult),
+		  profile_(queryStage->profile()),
+		  queryID_(queryStage->queryID_),
+		  traceBeginNs_(0)
 		{}
 
 		void close() override {
@@ -45,15 +50,38 @@ namespace knowrob {
 		std::shared_ptr<QueryStage> queryStage_;
 		std::list<QueryStage::ActiveQuery>::iterator graphQueryIterator_;
 		const AnswerPtr partialResult_;
+		const StageProfilePtr profile_;
+		const uint64_t queryID_;
+		// begin time and literal instance of the subquery, only set if tracing is enabled
+		int64_t traceBeginNs_;
+		std::string traceDetail_;
 		std::mutex pushLock_;
 
 		// Override AnswerStream
 		void push(const AnswerPtr &msg) override {
-			std::lock_guard<std::mutex> lock(pushLock_);
+			std::unique_lock<std::mutex> lock(pushLock_, std::defer_lock);
+			if(profile_) {
+				// measure how long the stage is blocked by concurrent pushes
+				auto waitBegin = StageProfile::steadyTime();
+				lock.lock();
+				profile_->blockedTimeNs += StageProfile::steadyTime() - waitBegin;
+			}
+			else {
+				lock.lock();
+			}
 			if(queryStage_) {
 				if(AnswerStream::isEOS(msg)) {
+					if(traceBeginNs_) {
+						Tracer::record("subquery", queryID_, traceBeginNs_, Tracer::now(), traceDetail_);
+					}
 					queryStage_->pushTransformed(msg, graphQueryIterator_);
 				}
+				else if(profile_) {
+					auto cpuBegin = StageProfile::threadCPUTime();
+					auto transformed = transformAnswer(msg, partialResult_);
+					profile_->cpuTimeNs += StageProfile::threadCPUTime() - cpuBegin;
+					queryStage_->pushTransformed(transformed, graphQueryIterator_);
+				}
 				else {
 					auto transformed = transformAnswer(msg, partialResult_);
 					queryStage_->pushTransformed(transformed, graphQueryIterator_);
@@ -71,7 +99,8 @@ QueryStage::QueryStage(RDFLiteralPtr literal, int queryFlags)
   queryFlags_(queryFlags),
   isQueryOpened_(true),
   isAwaitingInput_(true),
-  hasStopRequest_(false)
+  hasStopRequest_(false),
+  queryID_(0)
 {
 }
 
@@ -112,10 +141,12 @@ void QueryStage::pushTransformed(const AnswerPtr &transformedAnswer,
 		// if the stream has received EOS as input already.
 		if(graphQueries_.empty() && !isAwaitingInput_) {
 			isQueryOpened_ = false;
+			if(profile_) profile_->end();
 			pushToBroadcast(transformedAnswer);
 		}
 	}
 	else if(isQueryOpened()) {
+		if(profile_) profile_->numAnswersOut += 1;
 		pushToBroadcast(transformedAnswer);
 		// close the stage if only one solution is requested
 		if((queryFlags_ & (int)QueryFlag::QUERY_FLAG_ONE_SOLUTION) == (int)QueryFlag::QUERY_FLAG_ONE_SOLUTION) close();
@@ -131,6 +162,7 @@ void QueryStage::push(const AnswerPtr &partialResult)
         // only broadcast EOS if no graph query is still active.
         if(graphQueries_.empty() && !hasStopRequest_) {
             isQueryOpened_ = false;
+            if(profile_) profile_->end();
             pushToBroadcast(partialResult);
         }
     }
@@ -141,6 +173,15 @@ void QueryStage::push(const AnswerPtr &partialResult)
         // create a reference on self from a weak reference
         auto selfRef = selfWeakRef_.lock();
         if(!selfRef) return;
+        TraceSpan span("QueryStage::push", queryID_);
+
+        int64_t cpuBegin = 0;
+        if(profile_) {
+            profile_->begin();
+            profile_->numAnswersIn += 1;
+            profile_->numSubQueries += 1;
+            cpuBegin = StageProfile::threadCPUTime();
+        }
 
         // apply the substitution mapping
         auto literalInstance =
@@ -150,6 +191,12 @@ void QueryStage::push(const AnswerPtr &partialResult)
         auto graphQueryStream = submitQuery(literalInstance);
         // combine query result with partial answer
         auto transformer = std::make_shared<QueryStageTransformer>(selfRef, partialResult);
+        if(Tracer::isEnabled()) {
+            std::stringstream ss;
+            ss << *literalInstance;
+            transformer->traceDetail_ = ss.str();
+            transformer->traceBeginNs_ = Tracer::now();
+        }
 
         // keep a reference on the stream
         auto pair = graphQueries_.emplace_front(graphQueryStream, transformer);
@@ -159,6 +206,10 @@ void QueryStage::push(const AnswerPtr &partialResult)
         // combine graph query answer with partialResult and push it to the broadcast
         graphQueryStream >> transformer;
 
+        if(profile_) {
+            profile_->cpuTimeNs += StageProfile::threadCPUTime() - cpuBegin;
+        }
+
         // start sending messages into AnswerTransformer.
         // the messages are buffered before to avoid them being lost before the transformer
         // is connected.
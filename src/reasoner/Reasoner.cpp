@@ -8,6 +8,7 @@
 
 #include "knowrob/Logger.h"
 #include "knowrob/reasoner/Reasoner.h"
+#include "knowrob/reasoner/ReasonerManager.h"
 
 using namespace knowrob;
 
@@ -49,11 +50,24 @@ void Reasoner::addDataSourceHandler(const std::string &format, const DataSourceL
 
 bool Reasoner::loadDataSource(const DataSourcePtr &dataSource)
 {
+	bool isLoaded;
 	if(dataSource->dataFormat().empty()) {
-		return loadDataSourceWithUnknownFormat(dataSource);
+		isLoaded = loadDataSourceWithUnknownFormat(dataSource);
 	}
 	else {
 		auto it = dataSourceHandler_.find(dataSource->dataFormat());
-		return (it != dataSourceHandler_.end()) && it->second(dataSource);
+		isLoaded = (it != dataSourceHandler_.end()) && it->second(dataSource);
 	}
+	if(isLoaded) {
+		// the data source may define new predicates
+		auto reasonerManager = ReasonerManager::getReasonerManager(reasonerManagerID_);
+		if(reasonerManager) reasonerManager->invalidateDispatchIndex();
+	}
+	return isLoaded;
+}
+
+void Reasoner::notifyPredicatesDefined()
+{
+	auto reasonerManager = ReasonerManager::getReasonerManager(reasonerManagerID_);
+	if(reasonerManager) reasonerManager->invalidateUndefinedPredicates();
 }
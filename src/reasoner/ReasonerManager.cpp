@@ -6,10 +6,13 @@
  * https://github.com/knowrob/knowrob for license details.
  */
 
+#include <gtest/gtest.h>
 #include <filesystem>
+#include <set>
 #include <utility>
 
 #include "knowrob/Logger.h"
+#include "knowrob/Metrics.h"
 #include "knowrob/reasoner/ReasonerManager.h"
 #include "knowrob/reasoner/ReasonerError.h"
 
@@ -23,7 +26,8 @@ ReasonerManager::ReasonerManager(const std::shared_ptr<ThreadPool> &threadPool,
                                  const std::shared_ptr<KnowledgeGraphManager> &backendManager)
 : threadPool_(threadPool),
   backendManager_(backendManager),
-  reasonerIndex_(0)
+  reasonerIndex_(0),
+  dispatchGeneration_(0)
 {
     std::lock_guard<std::mutex> scoped_lock(staticMutex_);
     managerID_ = (managerIDCounter_++);
@@ -47,6 +51,11 @@ ReasonerManager* ReasonerManager::getReasonerManager(uint32_t managerID)
 }
 
 void ReasonerManager::loadReasoner(const boost::property_tree::ptree &config)
+{
+	configureReasoner(createReasoner(config), config);
+}
+
+std::shared_ptr<DefinedReasoner> ReasonerManager::createReasoner(const boost::property_tree::ptree &config)
 {
 	auto lib = config.get_optional<std::string>("lib");
 	auto type = config.get_optional<std::string>("type");
@@ -103,7 +112,17 @@ void ReasonerManager::loadReasoner(const boost::property_tree::ptree &config)
 	else {
         throw ReasonerError("Reasoner `{}` has no 'data-backend' configured.", reasonerID);
 	}
-    addReasoner(reasonerID, reasoner);
+	auto definedReasoner = addReasoner(reasonerID, reasoner);
+	// increase reasonerIndex_
+	reasonerIndex_ += 1;
+	return definedReasoner;
+}
+
+void ReasonerManager::configureReasoner(const std::shared_ptr<DefinedReasoner> &definedReasoner,
+                                       const boost::property_tree::ptree &config)
+{
+	auto &reasoner = definedReasoner->reasoner();
+	auto &reasonerID = definedReasoner->name();
 
 	ReasonerConfiguration reasonerConfig;
 	reasonerConfig.loadPropertyTree(&config);
@@ -117,8 +136,8 @@ void ReasonerManager::loadReasoner(const boost::property_tree::ptree &config)
             }
         }
 	}
-	// increase reasonerIndex_
-	reasonerIndex_ += 1;
+	// the reasoner may define predicates that were looked up before
+	invalidateDispatchIndex();
 }
 
 std::shared_ptr<ReasonerPlugin> ReasonerManager::loadReasonerPlugin(const std::string &path)
@@ -158,6 +177,7 @@ std::shared_ptr<DefinedReasoner> ReasonerManager::addReasoner(
 	auto managedReasoner = std::make_shared<DefinedReasoner>(reasonerID, reasoner);
 	reasonerPool_[reasonerID] = managedReasoner;
     reasoner->setReasonerManager(managerID_);
+    invalidateDispatchIndex();
 
 	return managedReasoner;
 }
@@ -165,6 +185,7 @@ std::shared_ptr<DefinedReasoner> ReasonerManager::addReasoner(
 void ReasonerManager::removeReasoner(const std::shared_ptr<DefinedReasoner> &reasoner)
 {
 	reasonerPool_.erase(reasoner->name());
+	invalidateDispatchIndex();
 }
 
 std::shared_ptr<DefinedReasoner> ReasonerManager::getReasonerWithID(const std::string &reasonerID)
@@ -182,11 +203,145 @@ std::shared_ptr<DefinedPredicate> ReasonerManager::getPredicateDefinition(
 		const std::shared_ptr<PredicateIndicator> &indicator)
 {
 	auto description = std::make_shared<DefinedPredicate>(indicator);
-	for(auto &x : reasonerPool_) {
-		auto description_n = x.second->reasoner()->getPredicateDescription(indicator);
-		if(description_n && !description->addReasoner(x.second, description_n)) {
+	auto dispatch = getPredicateDispatch(indicator->functor(), indicator->arity());
+	for(uint32_t i=0; i<dispatch->reasoners.size(); ++i) {
+		if(!description->addReasoner(dispatch->reasoners[i], dispatch->descriptions[i])) {
 			KB_WARN("ignoring inconsistent reasoner descriptions provided.");
 		}
 	}
 	return description;
 }
+
+std::vector<std::shared_ptr<DefinedReasoner>> ReasonerManager::getReasonersForPredicate(
+		const std::string &functor, uint32_t arity)
+{
+	return getPredicateDispatch(functor, arity)->reasoners;
+}
+
+ReasonerManager::PredicateDispatchPtr ReasonerManager::getPredicateDispatch(
+		const std::string &functor, uint32_t arity)
+{
+	static auto &numMisses = Metrics::get().counter(
+			"knowrob_reasoner_dispatch_misses_total", "Number of predicates looked up in all reasoners.");
+	uint64_t generation;
+	{
+		std::shared_lock<std::shared_mutex> lock(dispatchMutex_);
+		auto it = dispatchIndex_.find(functor);
+		if(it != dispatchIndex_.end()) {
+			auto jt = it->second.find(arity);
+			if(jt != it->second.end()) return jt->second;
+		}
+		generation = dispatchGeneration_;
+	}
+	numMisses.increment();
+
+	// ask each reasoner for a description of the predicate.
+	// note: this is done without holding the lock as reasoners may need to evaluate queries.
+	auto dispatch = std::make_shared<PredicateDispatch>();
+	auto indicator = std::make_shared<PredicateIndicator>(functor, arity);
+	for(auto &x : reasonerPool_) {
+		auto description_n = x.second->reasoner()->getPredicateDescription(indicator);
+		if(description_n) {
+			dispatch->reasoners.push_back(x.second);
+			dispatch->descriptions.push_back(description_n);
+		}
+	}
+
+	std::unique_lock<std::shared_mutex> lock(dispatchMutex_);
+	// the result is only stored if the index was not invalidated in the meantime
+	if(generation == dispatchGeneration_) {
+		dispatchIndex_[functor][arity] = dispatch;
+	}
+	return dispatch;
+}
+
+void ReasonerManager::invalidateDispatchIndex()
+{
+	std::unique_lock<std::shared_mutex> lock(dispatchMutex_);
+	dispatchIndex_.clear();
+	dispatchGeneration_ += 1;
+}
+
+void ReasonerManager::invalidateUndefinedPredicates()
+{
+	std::unique_lock<std::shared_mutex> lock(dispatchMutex_);
+	for(auto it=dispatchIndex_.begin(); it!=dispatchIndex_.end();) {
+		auto &arityMap = it->second;
+		for(auto jt=arityMap.begin(); jt!=arityMap.end();) {
+			if(jt->second->reasoners.empty()) jt = arityMap.erase(jt);
+			else ++jt;
+		}
+		if(arityMap.empty()) it = dispatchIndex_.erase(it);
+		else ++it;
+	}
+	// lookups in flight may have missed the new definition
+	dispatchGeneration_ += 1;
+}
+
+// a reasoner that defines predicates by name, and counts lookups of predicate descriptions
+class DispatchTestReasoner : public Reasoner {
+public:
+	std::set<std::string> definedNames;
+	uint32_t numLookups = 0;
+
+	void define(const std::string &name)
+	{
+		definedNames.insert(name);
+		notifyPredicatesDefined();
+	}
+
+	void setDataBackend(const KnowledgeGraphPtr&) override {}
+
+	bool loadConfiguration(const ReasonerConfiguration&) override { return true; }
+
+	unsigned long getCapabilities() const override { return CAPABILITY_TOP_DOWN_EVALUATION; }
+
+	AnswerBufferPtr submitQuery(const RDFLiteralPtr&, int) override { return {}; }
+
+	std::shared_ptr<PredicateDescription> getPredicateDescription(
+			const std::shared_ptr<PredicateIndicator> &indicator) override
+	{
+		numLookups += 1;
+		if(definedNames.count(indicator->functor()) == 0) return {};
+		return std::make_shared<PredicateDescription>(indicator, PredicateType::RELATION);
+	}
+};
+
+// fixture class for testing
+class ReasonerManagerTest : public ::testing::Test {
+protected:
+	ReasonerManager manager_;
+	std::shared_ptr<DispatchTestReasoner> reasoner_;
+
+	ReasonerManagerTest() : manager_(nullptr, nullptr) {}
+
+	void SetUp() override
+	{
+		reasoner_ = std::make_shared<DispatchTestReasoner>();
+		reasoner_->definedNames.insert("p");
+		manager_.addReasoner("dispatch", reasoner_);
+	}
+};
+
+TEST_F(ReasonerManagerTest, DispatchIndex)
+{
+	EXPECT_EQ(manager_.getReasonersForPredicate("p", 2).size(), 1);
+	EXPECT_EQ(manager_.getReasonersForPredicate("p", 2).size(), 1);
+	EXPECT_TRUE(manager_.getReasonersForPredicate("q", 2).empty());
+	EXPECT_TRUE(manager_.getReasonersForPredicate("q", 2).empty());
+	EXPECT_EQ(manager_.getPredicateDefinition(
+		std::make_shared<PredicateIndicator>("p", 2))->reasonerEnsemble().size(), 1);
+	// reasoners are only asked once for each predicate
+	EXPECT_EQ(reasoner_->numLookups, 2);
+}
+
+TEST_F(ReasonerManagerTest, DefineInvalidatesUndefinedPredicates)
+{
+	EXPECT_TRUE(manager_.getReasonersForPredicate("q", 2).empty());
+	EXPECT_EQ(manager_.getReasonersForPredicate("p", 2).size(), 1);
+	reasoner_->define("q");
+	EXPECT_EQ(manager_.getReasonersForPredicate("q", 2).size(), 1);
+	EXPECT_EQ(manager_.getReasonersForPredicate("p", 2).size(), 1);
+	// only the entry of the undefined predicate was dropped
+	EXPECT_EQ(reasoner_->numLookups, 3);
+}
@@ -0,0 +1,440 @@
+/*
+ * Copyright (c) 2023, Daniel Beßler
+ * All rights reserved.
+ *
+ * This file is part of KnowRob, please consult
+ * https://github.com/knowrob/knowrob for license details.
+ */
+
+#include "knowrob/Logger.h"
+#include "knowrob/KnowledgeBase.h"
+#include "knowrob/reasoner/allen/AllenReasoner.h"
+#include "knowrob/reasoner/ReasonerManager.h"
+#include "knowrob/terms/ListTerm.h"
+
+using namespace knowrob;
+using namespace knowrob::allen;
+
+// make reasoner type accessible
+KNOWROB_BUILTIN_REASONER("Allen", AllenReasoner)
+
+AllenReasoner::AllenReasoner(std::string reasonerID)
+: Reasoner(),
+  reasonerID_(std::move(reasonerID))
+{
+}
+
+const std::map<std::string, AllenRelation, std::less<>>& AllenReasoner::relationProperties()
+{
+	static const std::string soma = "http://www.ease-crc.org/ont/SOMA.owl#";
+	static const std::map<std::string, AllenRelation, std::less<>> properties = {
+		{ soma + "simultaneous",  AllenRelation::EQUALS },
+		{ soma + "before",        AllenRelation::BEFORE },
+		{ soma + "after",         AllenRelation::AFTER },
+		{ soma + "meets",         AllenRelation::MEETS },
+		{ soma + "metBy",         AllenRelation::MET_BY },
+		{ soma + "overlappedOn",  AllenRelation::OVERLAPS },
+		{ soma + "overlappedBy",  AllenRelation::OVERLAPPED_BY },
+		{ soma + "starts",        AllenRelation::STARTS },
+		{ soma + "startedBy",     AllenRelation::STARTED_BY },
+		{ soma + "finishes",      AllenRelation::FINISHES },
+		{ soma + "finishedBy",    AllenRelation::FINISHED_BY },
+		{ soma + "during",        AllenRelation::DURING }
+	};
+	return properties;
+}
+
+void AllenReasoner::setDataBackend(const KnowledgeGraphPtr &knowledgeGraph)
+{
+	knowledgeGraph_ = knowledgeGraph;
+}
+
+bool AllenReasoner::loadConfiguration(const ReasonerConfiguration &cfg)
+{
+	if(knowledgeGraph_) loadIntervals();
+	return true;
+}
+
+unsigned long AllenReasoner::getCapabilities() const
+{
+	return CAPABILITY_TOP_DOWN_EVALUATION;
+}
+
+std::shared_ptr<PredicateDescription> AllenReasoner::getPredicateDescription(
+		const std::shared_ptr<PredicateIndicator> &indicator)
+{
+	if(indicator->arity() == 2 &&
+	   (indicator->functor() == allen::interval ||
+	    relationProperties().count(indicator->functor()) > 0))
+	{
+		return std::make_shared<PredicateDescription>(indicator, PredicateType::BUILT_IN);
+	}
+	return {};
+}
+
+static std::optional<double> readTime(const TermPtr &term)
+{
+	if(!term) return std::nullopt;
+	switch(term->type()) {
+		case TermType::DOUBLE:
+			return std::static_pointer_cast<DoubleTerm>(term)->value();
+		case TermType::LONG:
+			return static_cast<double>(std::static_pointer_cast<LongTerm>(term)->value());
+		case TermType::INT32:
+			return static_cast<double>(std::static_pointer_cast<Integer32Term>(term)->value());
+		case TermType::STRING:
+			try {
+				return std::stod(std::static_pointer_cast<StringTerm>(term)->value());
+			}
+			catch(const std::exception&) {
+				return std::nullopt;
+			}
+		default:
+			return std::nullopt;
+	}
+}
+
+static std::optional<double> readTime(const StatementData &statement)
+{
+	switch(statement.objectType) {
+		case RDF_DOUBLE_LITERAL:
+			return statement.objectDouble;
+		case RDF_INT64_LITERAL:
+			return static_cast<double>(statement.objectInteger);
+		case RDF_STRING_LITERAL:
+			if(statement.object) {
+				return readTime(std::make_shared<StringTerm>(statement.object));
+			}
+			return std::nullopt;
+		default:
+			return std::nullopt;
+	}
+}
+
+void AllenReasoner::loadIntervals()
+{
+	static const auto s_var = std::make_shared<Variable>("S");
+	static const auto o_var = std::make_shared<Variable>("O");
+
+	auto forEachTriple = [this](std::string_view property,
+			const std::function<void(const TermPtr&, const TermPtr&)> &visitor) {
+		auto literal = std::make_shared<RDFLiteral>(
+				s_var, std::make_shared<StringTerm>(std::string(property)), o_var, false);
+		auto answerQueue = knowledgeGraph_->submitQuery(
+				std::make_shared<GraphQuery>(literal, QUERY_FLAG_ALL_SOLUTIONS))->createQueue();
+		while(true) {
+			auto answer = answerQueue->pop_front();
+			if(AnswerStream::isEOS(answer)) break;
+			auto &substitution = *answer->substitution();
+			visitor(substitution.get(*s_var), substitution.get(*o_var));
+		}
+	};
+	auto forEachEndpoint = [&](std::string_view property, bool isBegin) {
+		forEachTriple(property, [this,isBegin](const TermPtr &s, const TermPtr &o) {
+			auto time = readTime(o);
+			if(!s || s->type() != TermType::STRING || !time.has_value()) return;
+			auto &resource = std::static_pointer_cast<StringTerm>(s)->value();
+			if(isBegin) setInterval(resource, time, std::nullopt);
+			else        setInterval(resource, std::nullopt, time);
+		});
+	};
+
+	forEachEndpoint(allen::hasIntervalBegin, true);
+	forEachEndpoint(allen::hasIntervalEnd, false);
+	forEachTriple(allen::hasTimeInterval, [this](const TermPtr &s, const TermPtr &o) {
+		if(!s || !o || s->type() != TermType::STRING || o->type() != TermType::STRING) return;
+		setTimeInterval(std::static_pointer_cast<StringTerm>(s)->value(),
+		                std::static_pointer_cast<StringTerm>(o)->value());
+	});
+	KB_INFO("Allen reasoner `{}` indexed {} intervals.", reasonerID_, index_.size());
+}
+
+void AllenReasoner::onInsert(const std::vector<StatementData> &statements)
+{
+	for(auto &statement : statements) {
+		if(!statement.subject || !statement.predicate) continue;
+		std::string_view property(statement.predicate);
+		if(property == allen::hasIntervalBegin) {
+			setInterval(statement.subject, readTime(statement), std::nullopt);
+		}
+		else if(property == allen::hasIntervalEnd) {
+			setInterval(statement.subject, std::nullopt, readTime(statement));
+		}
+		else if(property == allen::hasTimeInterval && statement.object) {
+			setTimeInterval(statement.subject, statement.object);
+		}
+	}
+}
+
+void AllenReasoner::onRemove(const std::vector<RDFLiteralPtr> &tripleExpressions)
+{
+	std::unique_lock<std::shared_mutex> lock(mutex_);
+	for(auto &literal : tripleExpressions) {
+		auto propertyTerm = literal->propertyTerm();
+		if(!propertyTerm) continue;
+		if(propertyTerm->type() == TermType::VARIABLE) {
+			// statements of any property were removed
+			removeEndpoints(*literal, true);
+			removeEndpoints(*literal, false);
+			removeTimeIntervals(*literal);
+			continue;
+		}
+		if(propertyTerm->type() != TermType::STRING) continue;
+		auto &property = std::static_pointer_cast<StringTerm>(propertyTerm)->value();
+		if(property == allen::hasIntervalBegin) {
+			removeEndpoints(*literal, true);
+		}
+		else if(property == allen::hasIntervalEnd) {
+			removeEndpoints(*literal, false);
+		}
+		else if(property == allen::hasTimeInterval) {
+			removeTimeIntervals(*literal);
+		}
+	}
+}
+
+static const std::string* readResource(const TermPtr &term)
+{
+	// a null pointer matches any resource
+	if(term && term->type() == TermType::STRING) {
+		return &std::static_pointer_cast<StringTerm>(term)->value();
+	}
+	return nullptr;
+}
+
+void AllenReasoner::removeEndpoints(const RDFLiteral &literal, bool isBegin)
+{
+	auto resource = readResource(literal.subjectTerm());
+	auto objectTerm = literal.objectTerm();
+	bool isAnyTime = (!objectTerm || objectTerm->type() == TermType::VARIABLE);
+	auto time = (isAnyTime ? std::nullopt : readTime(objectTerm));
+	if(!isAnyTime && !time.has_value()) return;
+
+	auto removeEndpoint = [&](const std::string &intervalResource, std::optional<double> &endpoint) {
+		if(!endpoint.has_value() || (!isAnyTime && endpoint.value() != time.value())) return;
+		endpoint = std::nullopt;
+		// the interval is incomplete now, and so are the intervals of its events
+		index_.remove(intervalResource);
+		auto jt = eventsOfInterval_.find(intervalResource);
+		if(jt != eventsOfInterval_.end()) {
+			for(auto &event : jt->second) reindexEvent(event);
+		}
+	};
+	if(resource) {
+		auto it = endpoints_.find(*resource);
+		if(it == endpoints_.end()) return;
+		removeEndpoint(it->first, isBegin ? it->second.first : it->second.second);
+	}
+	else {
+		for(auto &pair : endpoints_) {
+			removeEndpoint(pair.first, isBegin ? pair.second.first : pair.second.second);
+		}
+	}
+}
+
+void AllenReasoner::removeTimeIntervals(const RDFLiteral &literal)
+{
+	auto event = readResource(literal.subjectTerm());
+	auto objectTerm = literal.objectTerm();
+	auto timeInterval = readResource(objectTerm);
+	if(!timeInterval && objectTerm && objectTerm->type() != TermType::VARIABLE) return;
+
+	std::set<std::string> unlinkedEvents;
+	for(auto it = eventsOfInterval_.begin(); it != eventsOfInterval_.end();) {
+		if(timeInterval && it->first != *timeInterval) {
+			++it;
+			continue;
+		}
+		auto &events = it->second;
+		if(event) {
+			if(events.erase(*event) > 0) unlinkedEvents.insert(*event);
+		}
+		else {
+			unlinkedEvents.insert(events.begin(), events.end());
+			events.clear();
+		}
+		if(events.empty()) it = eventsOfInterval_.erase(it);
+		else ++it;
+	}
+	for(auto &unlinkedEvent : unlinkedEvents) reindexEvent(unlinkedEvent);
+}
+
+void AllenReasoner::reindexEvent(const std::string &event)
+{
+	// the event may still have an interval of its own, or another time interval
+	index_.remove(event);
+	updateIndex(event);
+	for(auto &pair : eventsOfInterval_) {
+		if(pair.second.count(event) > 0) updateIndex(pair.first);
+	}
+}
+
+void AllenReasoner::setInterval(const std::string &resource, std::optional<double> begin, std::optional<double> end)
+{
+	if(!begin.has_value() && !end.has_value()) return;
+	std::unique_lock<std::shared_mutex> lock(mutex_);
+	auto &endpoints = endpoints_[resource];
+	if(begin.has_value()) endpoints.first = begin;
+	if(end.has_value()) endpoints.second = end;
+	updateIndex(resource);
+}
+
+void AllenReasoner::setTimeInterval(const std::string &event, const std::string &timeInterval)
+{
+	std::unique_lock<std::shared_mutex> lock(mutex_);
+	eventsOfInterval_[timeInterval].insert(event);
+	updateIndex(timeInterval);
+}
+
+void AllenReasoner::updateIndex(const std::string &resource)
+{
+	auto it = endpoints_.find(resource);
+	if(it == endpoints_.end() || !it->second.first.has_value() || !it->second.second.has_value()) {
+		// the interval is not complete yet
+		return;
+	}
+	EventInterval interval = { it->second.first.value(), it->second.second.value() };
+	// note: as in the Prolog implementation, a resource with interval data is
+	//       also considered to be the time interval of itself.
+	index_.set(resource, interval);
+	auto jt = eventsOfInterval_.find(resource);
+	if(jt != eventsOfInterval_.end()) {
+		for(auto &event : jt->second) index_.set(event, interval);
+	}
+}
+
+AnswerBufferPtr AllenReasoner::submitQuery(const RDFLiteralPtr &literal, int queryFlags)
+{
+	auto answerBuffer = std::make_shared<AnswerBuffer>();
+	auto channel = AnswerStream::Channel::create(answerBuffer);
+
+	auto propertyTerm = literal->propertyTerm();
+	if(propertyTerm->type() == TermType::STRING) {
+		auto &property = std::static_pointer_cast<StringTerm>(propertyTerm)->value();
+		auto it = relationProperties().find(property);
+		std::shared_lock<std::shared_mutex> lock(mutex_);
+		if(it != relationProperties().end()) {
+			answerRelation(it->second, *literal, queryFlags, channel);
+		}
+		else if(property == allen::interval) {
+			answerInterval(*literal, queryFlags, channel);
+		}
+	}
+	channel->push(AnswerStream::eos());
+
+	return answerBuffer;
+}
+
+void AllenReasoner::answerRelation(AllenRelation relation, const RDFLiteral &literal,
+                                   int queryFlags, const std::shared_ptr<AnswerStream::Channel> &channel)
+{
+	auto s = literal.subjectTerm();
+	auto o = literal.objectTerm();
+	bool oneSolution = (queryFlags & QUERY_FLAG_ONE_SOLUTION);
+
+	if(s->type() == TermType::STRING && o->type() == TermType::STRING) {
+		if(index_.holds(std::static_pointer_cast<StringTerm>(s)->value(), relation,
+		                std::static_pointer_cast<StringTerm>(o)->value())) {
+			channel->push(std::make_shared<Answer>());
+		}
+	}
+	else if(s->type() == TermType::STRING && o->type() == TermType::VARIABLE) {
+		auto interval = index_.get(std::static_pointer_cast<StringTerm>(s)->value());
+		if(!interval.has_value()) return;
+		auto &var = *std::static_pointer_cast<Variable>(o);
+		index_.forEachRelated(interval.value(), relation,
+			[&](const std::string &event, const EventInterval&) {
+				auto answer = std::make_shared<Answer>();
+				answer->substitute(var, std::make_shared<StringTerm>(event));
+				channel->push(answer);
+				return !oneSolution;
+			});
+	}
+	else if(s->type() == TermType::VARIABLE && o->type() == TermType::STRING) {
+		auto interval = index_.get(std::static_pointer_cast<StringTerm>(o)->value());
+		if(!interval.has_value()) return;
+		auto &var = *std::static_pointer_cast<Variable>(s);
+		index_.forEachRelated(interval.value(), inverseOf(relation),
+			[&](const std::string &event, const EventInterval&) {
+				auto answer = std::make_shared<Answer>();
+				answer->substitute(var, std::make_shared<StringTerm>(event));
+				channel->push(answer);
+				return !oneSolution;
+			});
+	}
+	else if(s->type() == TermType::VARIABLE && o->type() == TermType::VARIABLE) {
+		auto &sVar = *std::static_pointer_cast<Variable>(s);
+		auto &oVar = *std::static_pointer_cast<Variable>(o);
+		bool isSameVariable = (sVar.name() == oVar.name());
+		index_.forEach([&](const std::string &a, const EventInterval &aInterval) {
+			auto aTerm = std::make_shared<StringTerm>(a);
+			return index_.forEachRelated(aInterval, relation,
+				[&](const std::string &b, const EventInterval&) {
+					if(isSameVariable && a != b) return true;
+					auto answer = std::make_shared<Answer>();
+					answer->substitute(sVar, aTerm);
+					if(!isSameVariable) answer->substitute(oVar, std::make_shared<StringTerm>(b));
+					channel->push(answer);
+					return !oneSolution;
+				});
+		});
+	}
+}
+
+void AllenReasoner::answerInterval(const RDFLiteral &literal,
+                                   int queryFlags, const std::shared_ptr<AnswerStream::Channel> &channel)
+{
+	auto s = literal.subjectTerm();
+	auto o = literal.objectTerm();
+	bool oneSolution = (queryFlags & QUERY_FLAG_ONE_SOLUTION);
+
+	auto toListTerm = [](const EventInterval &interval) {
+		return std::make_shared<ListTerm>(std::vector<TermPtr>({
+			std::make_shared<DoubleTerm>(interval.begin),
+			std::make_shared<DoubleTerm>(interval.end) }));
+	};
+	// read [Begin,End] if the object is a ground list
+	std::optional<EventInterval> objectInterval;
+	if(o->type() == TermType::LIST) {
+		auto &elements = std::static_pointer_cast<ListTerm>(o)->elements();
+		if(elements.size() != 2) return;
+		auto begin = readTime(elements[0]);
+		auto end = readTime(elements[1]);
+		if(!begin.has_value() || !end.has_value()) return;
+		objectInterval = EventInterval{ begin.value(), end.value() };
+	}
+	else if(o->type() != TermType::VARIABLE) {
+		return;
+	}
+
+	if(s->type() == TermType::STRING) {
+		auto interval = index_.get(std::static_pointer_cast<StringTerm>(s)->value());
+		if(!interval.has_value()) return;
+		auto answer = std::make_shared<Answer>();
+		if(objectInterval.has_value()) {
+			if(!holds(interval.value(), AllenRelation::EQUALS, objectInterval.value())) return;
+		}
+		else {
+			answer->substitute(*std::static_pointer_cast<Variable>(o), toListTerm(interval.value()));
+		}
+		channel->push(answer);
+	}
+	else if(s->type() == TermType::VARIABLE) {
+		auto &var = *std::static_pointer_cast<Variable>(s);
+		auto visitor = [&](const std::string &event, const EventInterval &interval) {
+			auto answer = std::make_shared<Answer>();
+			answer->substitute(var, std::make_shared<StringTerm>(event));
+			if(!objectInterval.has_value()) {
+				answer->substitute(*std::static_pointer_cast<Variable>(o), toListTerm(interval));
+			}
+			channel->push(answer);
+			return !oneSolution;
+		};
+		if(objectInterval.has_value()) {
+			index_.forEachWithInterval(objectInterval.value(), visitor);
+		}
+		else {
+			index_.forEach(visitor);
+		}
+	}
+}
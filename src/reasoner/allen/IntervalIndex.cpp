@@ -0,0 +1,369 @@
+/*
+ * Copyright (c) 2023, Daniel Beßler
+ * All rights reserved.
+ *
+ * This file is part of KnowRob, please consult
+ * https://github.com/knowrob/knowrob for license details.
+ */
+
+#include <gtest/gtest.h>
+#include <limits>
+#include "knowrob/reasoner/allen/IntervalIndex.h"
+
+using namespace knowrob::allen;
+
+AllenRelation knowrob::allen::inverseOf(AllenRelation r)
+{
+	switch(r) {
+		case AllenRelation::EQUALS:        return AllenRelation::EQUALS;
+		case AllenRelation::BEFORE:        return AllenRelation::AFTER;
+		case AllenRelation::AFTER:         return AllenRelation::BEFORE;
+		case AllenRelation::MEETS:         return AllenRelation::MET_BY;
+		case AllenRelation::MET_BY:        return AllenRelation::MEETS;
+		case AllenRelation::OVERLAPS:      return AllenRelation::OVERLAPPED_BY;
+		case AllenRelation::OVERLAPPED_BY: return AllenRelation::OVERLAPS;
+		case AllenRelation::STARTS:        return AllenRelation::STARTED_BY;
+		case AllenRelation::STARTED_BY:    return AllenRelation::STARTS;
+		case AllenRelation::FINISHES:      return AllenRelation::FINISHED_BY;
+		case AllenRelation::FINISHED_BY:   return AllenRelation::FINISHES;
+		case AllenRelation::DURING:        return AllenRelation::CONTAINS;
+		case AllenRelation::CONTAINS:      return AllenRelation::DURING;
+	}
+	return r;
+}
+
+bool knowrob::allen::holds(const EventInterval &a, AllenRelation r, const EventInterval &b)
+{
+	switch(r) {
+		case AllenRelation::EQUALS:        return a.begin == b.begin && a.end == b.end;
+		case AllenRelation::BEFORE:        return a.end < b.begin;
+		case AllenRelation::AFTER:         return b.end < a.begin;
+		case AllenRelation::MEETS:         return a.end == b.begin;
+		case AllenRelation::MET_BY:        return b.end == a.begin;
+		case AllenRelation::OVERLAPS:      return a.begin < b.begin && b.begin < a.end && a.end < b.end;
+		case AllenRelation::OVERLAPPED_BY: return b.begin < a.begin && a.begin < b.end && b.end < a.end;
+		case AllenRelation::STARTS:        return a.begin == b.begin && a.end < b.end;
+		case AllenRelation::STARTED_BY:    return a.begin == b.begin && b.end < a.end;
+		case AllenRelation::FINISHES:      return a.end == b.end && b.begin < a.begin;
+		case AllenRelation::FINISHED_BY:   return a.end == b.end && a.begin < b.begin;
+		case AllenRelation::DURING:        return b.begin < a.begin && a.end < b.end;
+		case AllenRelation::CONTAINS:      return a.begin < b.begin && b.end < a.end;
+	}
+	return false;
+}
+
+bool EndpointTree::isLess(const Node &n, double key, const std::string *event)
+{
+	return n.key < key || (n.key == key && std::less<>()(n.event, event));
+}
+
+void EndpointTree::update(Node &n)
+{
+	n.minOther = n.other;
+	n.maxOther = n.other;
+	for(auto child : { n.left.get(), n.right.get() }) {
+		if(!child) continue;
+		n.minOther = std::min(n.minOther, child->minOther);
+		n.maxOther = std::max(n.maxOther, child->maxOther);
+	}
+}
+
+void EndpointTree::split(NodePtr n, double key, const std::string *event, bool inclusive,
+                         NodePtr &lower, NodePtr &upper)
+{
+	if(!n) {
+		lower = nullptr;
+		upper = nullptr;
+		return;
+	}
+	bool isLower = isLess(*n, key, event) || (inclusive && n->key == key && n->event == event);
+	if(isLower) {
+		split(std::move(n->right), key, event, inclusive, n->right, upper);
+		update(*n);
+		lower = std::move(n);
+	}
+	else {
+		split(std::move(n->left), key, event, inclusive, lower, n->left);
+		update(*n);
+		upper = std::move(n);
+	}
+}
+
+EndpointTree::NodePtr EndpointTree::merge(NodePtr lower, NodePtr upper)
+{
+	if(!lower) return upper;
+	if(!upper) return lower;
+	if(lower->priority > upper->priority) {
+		lower->right = merge(std::move(lower->right), std::move(upper));
+		update(*lower);
+		return lower;
+	}
+	else {
+		upper->left = merge(std::move(lower), std::move(upper->left));
+		update(*upper);
+		return upper;
+	}
+}
+
+void EndpointTree::insert(double key, double other, const std::string *event)
+{
+	NodePtr lower, upper;
+	split(std::move(root_), key, event, false, lower, upper);
+	auto node = std::make_unique<Node>(key, other, event, priorityGenerator_());
+	root_ = merge(merge(std::move(lower), std::move(node)), std::move(upper));
+}
+
+void EndpointTree::remove(double key, const std::string *event)
+{
+	NodePtr lower, middle, upper;
+	split(std::move(root_), key, event, false, lower, upper);
+	split(std::move(upper), key, event, true, middle, upper);
+	root_ = merge(std::move(lower), std::move(upper));
+}
+
+bool EndpointTree::visit(double keyMin, double keyMax, double otherMin, double otherMax,
+                         const Visitor &visitor) const
+{
+	return visit(root_.get(), keyMin, keyMax, otherMin, otherMax, visitor);
+}
+
+bool EndpointTree::visit(const Node *n, double keyMin, double keyMax,
+                         double otherMin, double otherMax, const Visitor &visitor)
+{
+	// skip subtrees without an event whose other endpoint is in range
+	if(!n || n->maxOther < otherMin || n->minOther > otherMax) return true;
+	if(keyMin <= n->key && !visit(n->left.get(), keyMin, keyMax, otherMin, otherMax, visitor)) {
+		return false;
+	}
+	if(keyMin <= n->key && n->key <= keyMax &&
+	   otherMin <= n->other && n->other <= otherMax &&
+	   !visitor(n->event)) {
+		return false;
+	}
+	if(n->key <= keyMax) {
+		return visit(n->right.get(), keyMin, keyMax, otherMin, otherMax, visitor);
+	}
+	return true;
+}
+
+void IntervalIndex::set(std::string_view event, const EventInterval &interval)
+{
+	auto it = intervals_.find(event);
+	if(it == intervals_.end()) {
+		it = intervals_.emplace(std::string(event), interval).first;
+	}
+	else {
+		begins_.remove(it->second.begin, &it->first);
+		ends_.remove(it->second.end, &it->first);
+		it->second = interval;
+	}
+	begins_.insert(interval.begin, interval.end, &it->first);
+	ends_.insert(interval.end, interval.begin, &it->first);
+}
+
+bool IntervalIndex::remove(std::string_view event)
+{
+	auto it = intervals_.find(event);
+	if(it == intervals_.end()) return false;
+	begins_.remove(it->second.begin, &it->first);
+	ends_.remove(it->second.end, &it->first);
+	intervals_.erase(it);
+	return true;
+}
+
+std::optional<EventInterval> IntervalIndex::get(std::string_view event) const
+{
+	auto it = intervals_.find(event);
+	if(it == intervals_.end()) return std::nullopt;
+	return it->second;
+}
+
+bool IntervalIndex::holds(std::string_view a, AllenRelation r, std::string_view b) const
+{
+	auto it = intervals_.find(a);
+	auto jt = intervals_.find(b);
+	return it != intervals_.end() && jt != intervals_.end() &&
+	       knowrob::allen::holds(it->second, r, jt->second);
+}
+
+bool IntervalIndex::visitRange(const EndpointTree &tree, double keyMin, double keyMax,
+                               double otherMin, double otherMax,
+                               const EventInterval &a, AllenRelation r, const EventVisitor &visitor) const
+{
+	// note: the ranges are closed, strict inequalities of the relation are checked here
+	return tree.visit(keyMin, keyMax, otherMin, otherMax, [&](const std::string *event) {
+		auto &b = intervals_.find(*event)->second;
+		return !knowrob::allen::holds(a, r, b) || visitor(*event, b);
+	});
+}
+
+bool IntervalIndex::forEachRelated(const EventInterval &a, AllenRelation r, const EventVisitor &visitor) const
+{
+	static const double inf = std::numeric_limits<double>::infinity();
+	switch(r) {
+		case AllenRelation::BEFORE:
+			// b.begin > a.end
+			return visitRange(begins_, a.end, inf, -inf, inf, a, r, visitor);
+		case AllenRelation::AFTER:
+			// b.end < a.begin
+			return visitRange(ends_, -inf, a.begin, -inf, inf, a, r, visitor);
+		case AllenRelation::MEETS:
+			// b.begin = a.end
+			return visitRange(begins_, a.end, a.end, -inf, inf, a, r, visitor);
+		case AllenRelation::MET_BY:
+			// b.end = a.begin
+			return visitRange(ends_, a.begin, a.begin, -inf, inf, a, r, visitor);
+		case AllenRelation::EQUALS:
+			// b.begin = a.begin, b.end = a.end
+			return visitRange(begins_, a.begin, a.begin, a.end, a.end, a, r, visitor);
+		case AllenRelation::STARTS:
+			// b.begin = a.begin, b.end > a.end
+			return visitRange(begins_, a.begin, a.begin, a.end, inf, a, r, visitor);
+		case AllenRelation::STARTED_BY:
+			// b.begin = a.begin, b.end < a.end
+			return visitRange(begins_, a.begin, a.begin, -inf, a.end, a, r, visitor);
+		case AllenRelation::FINISHES:
+			// b.end = a.end, b.begin < a.begin
+			return visitRange(ends_, a.end, a.end, -inf, a.begin, a, r, visitor);
+		case AllenRelation::FINISHED_BY:
+			// b.end = a.end, b.begin > a.begin
+			return visitRange(ends_, a.end, a.end, a.begin, inf, a, r, visitor);
+		case AllenRelation::OVERLAPS:
+			// a.begin < b.begin < a.end, b.end > a.end
+			return visitRange(begins_, a.begin, a.end, a.end, inf, a, r, visitor);
+		case AllenRelation::CONTAINS:
+			// a.begin < b.begin < a.end, b.end < a.end
+			return visitRange(begins_, a.begin, a.end, -inf, a.end, a, r, visitor);
+		case AllenRelation::OVERLAPPED_BY:
+			// a.begin < b.end < a.end, b.begin < a.begin
+			return visitRange(ends_, a.begin, a.end, -inf, a.begin, a, r, visitor);
+		case AllenRelation::DURING:
+			// b.begin < a.begin, b.end > a.end
+			return visitRange(begins_, -inf, a.begin, a.end, inf, a, r, visitor);
+	}
+	return true;
+}
+
+bool IntervalIndex::forEachWithInterval(const EventInterval &interval, const EventVisitor &visitor) const
+{
+	return forEachRelated(interval, AllenRelation::EQUALS, visitor);
+}
+
+bool IntervalIndex::forEach(const EventVisitor &visitor) const
+{
+	for(auto &pair : intervals_) {
+		if(!visitor(pair.first, pair.second)) return false;
+	}
+	return true;
+}
+
+// fixture class for testing
+class IntervalIndexTest : public ::testing::Test {
+protected:
+	IntervalIndex index_;
+	void SetUp() override {
+		index_.set("A", {0.0, 10.0});
+		index_.set("B", {2.0, 5.0});
+		index_.set("C", {5.0, 12.0});
+		index_.set("D", {10.0, 15.0});
+		index_.set("E", {20.0, 25.0});
+		index_.set("F", {0.0, 10.0});
+	}
+	std::set<std::string> related(const std::string &a, AllenRelation r) {
+		std::set<std::string> out;
+		index_.forEachRelated(index_.get(a).value(), r,
+			[&out](const std::string &event, const EventInterval&) { out.insert(event); return true; });
+		return out;
+	}
+};
+
+TEST_F(IntervalIndexTest, InverseRelations) {
+	std::vector<AllenRelation> relations = {
+		AllenRelation::EQUALS, AllenRelation::BEFORE, AllenRelation::AFTER,
+		AllenRelation::MEETS, AllenRelation::MET_BY, AllenRelation::OVERLAPS,
+		AllenRelation::OVERLAPPED_BY, AllenRelation::STARTS, AllenRelation::STARTED_BY,
+		AllenRelation::FINISHES, AllenRelation::FINISHED_BY, AllenRelation::DURING,
+		AllenRelation::CONTAINS };
+	for(auto r : relations) {
+		EXPECT_EQ(inverseOf(inverseOf(r)), r);
+		for(auto a : {"A","B","C","D","E"}) {
+			for(auto b : {"A","B","C","D","E"}) {
+				EXPECT_EQ(index_.holds(a, r, b), index_.holds(b, inverseOf(r), a));
+			}
+		}
+	}
+}
+
+TEST_F(IntervalIndexTest, RelatedEventsMatchPairwiseCheck) {
+	std::vector<AllenRelation> relations = {
+		AllenRelation::EQUALS, AllenRelation::BEFORE, AllenRelation::AFTER,
+		AllenRelation::MEETS, AllenRelation::MET_BY, AllenRelation::OVERLAPS,
+		AllenRelation::OVERLAPPED_BY, AllenRelation::STARTS, AllenRelation::STARTED_BY,
+		AllenRelation::FINISHES, AllenRelation::FINISHED_BY, AllenRelation::DURING,
+		AllenRelation::CONTAINS };
+	for(auto r : relations) {
+		for(auto a : {"A","B","C","D","E","F"}) {
+			std::set<std::string> expected;
+			for(auto b : {"A","B","C","D","E","F"}) {
+				if(index_.holds(a, r, b)) expected.insert(b);
+			}
+			EXPECT_EQ(related(a, r), expected);
+		}
+	}
+}
+
+TEST_F(IntervalIndexTest, Relations) {
+	EXPECT_EQ(related("A", AllenRelation::BEFORE), std::set<std::string>({"E"}));
+	EXPECT_EQ(related("A", AllenRelation::MEETS), std::set<std::string>({"D"}));
+	EXPECT_EQ(related("A", AllenRelation::EQUALS), std::set<std::string>({"A", "F"}));
+	EXPECT_EQ(related("A", AllenRelation::OVERLAPS), std::set<std::string>({"C"}));
+	EXPECT_EQ(related("A", AllenRelation::CONTAINS), std::set<std::string>({"B"}));
+	EXPECT_EQ(related("B", AllenRelation::DURING), std::set<std::string>({"A", "F"}));
+	EXPECT_EQ(related("B", AllenRelation::MEETS), std::set<std::string>({"C"}));
+}
+
+TEST_F(IntervalIndexTest, Update) {
+	index_.set("B", {21.0, 22.0});
+	EXPECT_EQ(index_.size(), 6);
+	EXPECT_EQ(related("E", AllenRelation::CONTAINS), std::set<std::string>({"B"}));
+	EXPECT_TRUE(related("A", AllenRelation::CONTAINS).empty());
+	EXPECT_TRUE(index_.remove("B"));
+	EXPECT_FALSE(index_.remove("B"));
+	EXPECT_FALSE(index_.get("B").has_value());
+	EXPECT_TRUE(related("E", AllenRelation::CONTAINS).empty());
+}
+
+TEST_F(IntervalIndexTest, RandomIntervalsMatchPairwiseCheck) {
+	std::vector<AllenRelation> relations = {
+		AllenRelation::EQUALS, AllenRelation::BEFORE, AllenRelation::AFTER,
+		AllenRelation::MEETS, AllenRelation::MET_BY, AllenRelation::OVERLAPS,
+		AllenRelation::OVERLAPPED_BY, AllenRelation::STARTS, AllenRelation::STARTED_BY,
+		AllenRelation::FINISHES, AllenRelation::FINISHED_BY, AllenRelation::DURING,
+		AllenRelation::CONTAINS };
+	// integer endpoints such that endpoints of different events coincide
+	std::minstd_rand rng(42);
+	std::uniform_int_distribution<int> endpoint(0, 40);
+	std::vector<std::string> events;
+	for(int i=0; i<200; ++i) {
+		auto begin = endpoint(rng);
+		events.push_back("E" + std::to_string(i));
+		index_.set(events.back(), {double(begin), double(begin + 1 + endpoint(rng) % 10)});
+	}
+	// update and remove some events
+	for(int i=0; i<50; ++i) {
+		auto begin = endpoint(rng);
+		index_.set(events[i], {double(begin), double(begin + 1 + endpoint(rng) % 10)});
+		index_.remove(events[50+i]);
+	}
+	for(auto r : relations) {
+		for(int i=0; i<20; ++i) {
+			auto a = index_.get(events[i]).value();
+			std::set<std::string> expected;
+			index_.forEach([&](const std::string &event, const EventInterval &b) {
+				if(knowrob::allen::holds(a, r, b)) expected.insert(event);
+				return true;
+			});
+			EXPECT_EQ(related(events[i], r), expected);
+		}
+	}
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2023, Daniel Beßler
+ * All rights reserved.
+ *
+ * This file is part of KnowRob, please consult
+ * https://github.com/knowrob/knowrob for license details.
+ */
+
+#include "knowrob/reasoner/prolog/PrologList.h"
+#include "knowrob/reasoner/prolog/PrologQuery.h"
+#include "knowrob/reasoner/prolog/PrologThreadPool.h"
+#include "knowrob/formulas/Predicate.h"
+#include "knowrob/formulas/Bottom.h"
+#include "knowrob/formulas/Top.h"
+
+using namespace knowrob;
+
+PrologList::PrologList(size_t numElements)
+: ListTerm(numElements, true),
+  numElements_(numElements)
+{
+	cells_.reserve(numElements);
+}
+
+std::shared_ptr<PrologList> PrologList::read(term_t t)
+{
+	size_t length;
+	if(PL_skip_list(t, 0, &length) != PL_LIST || length==0 || !PL_is_ground(t)) {
+		return {};
+	}
+	auto list = std::shared_ptr<PrologList>(new PrologList(length));
+
+	auto head = PL_new_term_ref();
+	auto tail = PL_copy_term_ref(t);
+	while(PL_get_list(tail, head, tail)) {
+		if(!list->readCell(head)) return {};
+	}
+	return list;
+}
+
+bool PrologList::readCell(term_t t) //NOLINT
+{
+	auto &cell = cells_.emplace_back();
+	switch(PL_term_type(t)) {
+		case PL_ATOM: {
+			atom_t atom;
+			if(!PL_get_atom(t, &atom)) return false;
+			cell.type = Cell::CONSTANT;
+			if(atom == PrologQuery::ATOM_fail() || atom == PrologQuery::ATOM_false()) {
+				cell.constant = Bottom::get();
+			}
+			else if(atom == PrologQuery::ATOM_true()) {
+				cell.constant = Top::get();
+			}
+			else {
+				cell.constant = PrologEngineCache::get().stringTerm(atom);
+			}
+			return true;
+		}
+		case PL_INTEGER:
+			cell.type = Cell::LONG;
+			return PL_get_long(t, &cell.longValue);
+		case PL_FLOAT:
+			cell.type = Cell::DOUBLE;
+			return PL_get_float(t, &cell.doubleValue);
+		case PL_STRING: {
+			char *s;
+			if(!PL_get_chars(t, &s, CVT_ALL)) return false;
+			cell.type = Cell::CONSTANT;
+			cell.constant = std::make_shared<StringTerm>(std::string(s));
+			return true;
+		}
+		case PL_NIL:
+			cell.type = Cell::LIST;
+			return true;
+		case PL_LIST_PAIR: {
+			size_t length;
+			if(PL_skip_list(t, 0, &length) != PL_LIST) return false;
+			cell.type = Cell::LIST;
+			cell.arity = length;
+			// note: `cell` must not be used below as the vector may grow
+			auto head = PL_new_term_ref();
+			auto tail = PL_copy_term_ref(t);
+			while(PL_get_list(tail, head, tail)) {
+				if(!readCell(head)) return false;
+			}
+			return true;
+		}
+		case PL_TERM: {
+			size_t arity;
+			atom_t name;
+			if(!PL_get_name_arity(t, &name, &arity)) return false;
+			cell.type = Cell::PREDICATE;
+			cell.arity = arity;
+			cell.constant = PrologEngineCache::get().stringTerm(name);
+			auto arg = PL_new_term_ref();
+			for(int n=1; n<=arity; n++) {
+				if(!PL_get_arg(n, t, arg) || !readCell(arg)) return false;
+			}
+			return true;
+		}
+		default:
+			return false;
+	}
+}
+
+TermPtr PrologList::construct(size_t &cellIndex) const //NOLINT
+{
+	auto &cell = cells_[cellIndex++];
+	switch(cell.type) {
+		case Cell::CONSTANT:
+			return cell.constant;
+		case Cell::LONG:
+			return std::make_shared<LongTerm>(cell.longValue);
+		case Cell::DOUBLE:
+			return std::make_shared<DoubleTerm>(cell.doubleValue);
+		case Cell::PREDICATE: {
+			std::vector<TermPtr> arguments(cell.arity);
+			for(auto &arg : arguments) arg = construct(cellIndex);
+			auto &functor = ((StringTerm*)cell.constant.get())->value();
+			return std::make_shared<Predicate>(functor, arguments);
+		}
+		case Cell::LIST: {
+			if(cell.arity == 0) return ListTerm::nil();
+			std::vector<TermPtr> elements(cell.arity);
+			for(auto &elem : elements) elem = construct(cellIndex);
+			return std::make_shared<ListTerm>(elements);
+		}
+	}
+	return Bottom::get();
+}
+
+void PrologList::materialize(std::vector<TermPtr> &elements) const
+{
+	elements.resize(numElements_);
+	size_t cellIndex = 0;
+	for(auto &elem : elements) elem = construct(cellIndex);
+}
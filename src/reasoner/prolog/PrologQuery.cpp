@@ -9,6 +9,8 @@
 #include <list>
 #include "knowrob/Logger.h"
 #include "knowrob/reasoner/prolog/PrologQuery.h"
+#include "knowrob/reasoner/prolog/PrologThreadPool.h"
+#include "knowrob/reasoner/prolog/PrologList.h"
 #include "knowrob/terms/Term.h"
 #include "knowrob/terms/Constant.h"
 #include "knowrob/terms/ListTerm.h"
@@ -83,18 +85,17 @@ bool PrologQuery::putTerm( //NOLINT
 				}
 				pl_arg += 1;
 			}
-			// construct output term
-			// TODO: caching result of PL_new_functor() could be a good idea
+			// construct output term, the functor is interned once per thread
 			return PL_cons_functor_v(pl_term,
-				PL_new_functor(
-					PL_new_atom(qa_pred->indicator()->functor().c_str()),
+				PrologEngineCache::get().functor(
+					qa_pred->indicator()->functor(),
 					qa_pred->indicator()->arity()),
 				pl_arg0);
 		}
 		else {
 			// 0-ary predicates are atoms
-			return PL_put_atom_chars(pl_term,
-				qa_pred->indicator()->functor().c_str());
+			return PL_put_atom(pl_term,
+				PrologEngineCache::get().atom(qa_pred->indicator()->functor()));
 		}
 	}
 	case TermType::VARIABLE: {
@@ -221,7 +222,8 @@ TermPtr PrologQuery::constructTerm(const term_t &t, std::map<std::string,term_t>
 			return Top::get();
 		}
 		else {
-			return std::make_shared<StringTerm>(std::string(PL_atom_chars(atom)));
+			// atoms are mapped to string terms shared by all answers of this thread
+			return PrologEngineCache::get().stringTerm(atom);
 		}
 	}
 	case PL_INTEGER: {
@@ -242,13 +244,20 @@ TermPtr PrologQuery::constructTerm(const term_t &t, std::map<std::string,term_t>
 	case PL_NIL:
 		return ListTerm::nil();
 	case PL_LIST_PAIR: {
+		// ground lists are copied into a compact buffer, and their
+		// elements are only constructed when accessed.
+		auto lazyList = PrologList::read(t);
+		if(lazyList) return lazyList;
+
+		size_t length = 0;
+		std::vector<TermPtr> elements;
+		if(PL_skip_list(t, 0, &length) == PL_LIST) elements.reserve(length);
 		term_t head = PL_new_term_ref();
-		std::list<TermPtr> elements;
-		while(PL_get_list(t, head, t)) {
+		term_t tail = PL_copy_term_ref(t);
+		while(PL_get_list(tail, head, tail)) {
 			elements.push_back(PrologQuery::constructTerm(head, vars));
 		}
-		return std::make_shared<ListTerm>(
-			std::vector<TermPtr>(elements.begin(), elements.end()));
+		return std::make_shared<ListTerm>(elements);
 	}
 	default:
 		KB_WARN("Unknown Prolog term type {}.", PL_term_type(t));
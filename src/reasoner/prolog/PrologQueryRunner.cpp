@@ -7,6 +7,8 @@
  */
 
 #include "knowrob/Logger.h"
+#include "knowrob/Metrics.h"
+#include "knowrob/Tracing.h"
 #include "knowrob/queries/QueryError.h"
 #include "knowrob/reasoner/prolog/PrologReasoner.h"
 #include "knowrob/reasoner/prolog/PrologQueryRunner.h"
@@ -29,11 +31,23 @@ PrologQueryRunner::PrologQueryRunner(PrologReasoner *reasoner,
 void PrologQueryRunner::run()
 {
 	static const int flags = PL_Q_CATCH_EXCEPTION|PL_Q_NODEBUG;
+	static auto &numQueries = Metrics::get().counter(
+			"knowrob_prolog_queries_total", "Number of queries evaluated by Prolog reasoners.");
+	static auto &numAnswers = Metrics::get().counter(
+			"knowrob_prolog_answers_total", "Number of answers generated by Prolog reasoners.");
+	static auto &queryLatency = Metrics::get().histogram(
+			"knowrob_prolog_query_seconds", "Time needed to evaluate a query in a Prolog reasoner.");
+	MetricsTimer timer(queryLatency);
+	TraceSpan span("PrologQueryRunner", request_.goal->queryID());
+	numQueries.increment();
 
 	KB_DEBUG("PrologReasoner has new query {}:({}).",
 			 request_.queryModule->value(), *request_.goal);
+	// term references created below are released when the scope ends
+	PrologEngineCache::FrameScope frameScope;
+	auto &engineCache = PrologEngineCache::get();
 	// use the reasoner module as context module for query evaluation
-	module_t ctx_module = PL_new_module(PL_new_atom(request_.queryModule->value().c_str()));
+	module_t ctx_module = engineCache.module(request_.queryModule->value());
 	// the exception risen by the Prolog engine, if any
 	auto pl_exception = (term_t)0;
 
@@ -84,6 +98,7 @@ void PrologQueryRunner::run()
 		// set the solution scope, if reasoner specified it
         PrologQuery::putScope(solution, solution_scope);
 		// push the solution into the output stream
+		numAnswers.increment();
 		outputChannel_->push(solution);
 
 		if(request_.goal->flags() & QUERY_FLAG_ONE_SOLUTION) break;
@@ -224,7 +239,7 @@ term_t PrologQueryRunner::createQueryArgumentTerms(
     // construct b_setval/2 arguments
     auto setval_args1 = PL_new_term_refs(2);
     if(!PL_put_atom(setval_args1, reasoner_module_a) ||
-       !PL_put_atom_chars(setval_args1+1, request_.queryModule->value().c_str()))
+       !PL_put_atom(setval_args1+1, PrologEngineCache::get().atom(request_.queryModule->value())))
     {
         return (term_t)0;
     }
@@ -6,6 +6,7 @@
  * https://github.com/knowrob/knowrob for license details.
  */
 
+#include <algorithm>
 #include <memory>
 #include <filesystem>
 #include <utility>
@@ -14,6 +15,7 @@
 
 #include "knowrob/knowrob.h"
 #include "knowrob/Logger.h"
+#include "knowrob/Metrics.h"
 #include "knowrob/reasoner/ReasonerManager.h"
 #include "knowrob/reasoner/prolog/PrologReasoner.h"
 #include "knowrob/reasoner/prolog/logging.h"
@@ -151,7 +153,7 @@ bool PrologReasoner::loadConfiguration(const ReasonerConfiguration &cfg)
         // in particular the ones specified in settings are globally registered with PrefixRegistry.
         static const auto register_prefix_i =
                 std::make_shared<PredicateIndicator>("rdf_register_prefix", 3);
-        for(auto &pair : semweb::PrefixRegistry::get()) {
+        for(auto &pair : semweb::PrefixRegistry::get().uriToAliasMap()) {
             const auto &uri = pair.first;
             const auto &alias = pair.second;
             eval(std::make_shared<Predicate>(Predicate(register_prefix_i, {
@@ -168,10 +170,207 @@ bool PrologReasoner::loadConfiguration(const ReasonerConfiguration &cfg)
 	}
 	// load reasoner default packages. this is usually the code that implements the reasoner.
 	initializeDefaultPackages();
+	// declare tabled predicates
+	if(cfg.ptree && !loadTableConfiguration(*cfg.ptree)) {
+		return false;
+	}
 
 	return true;
 }
 
+static std::shared_ptr<PredicateIndicator> readPredicateIndicator(const std::string &str)
+{
+	auto separator = str.rfind('/');
+	if(separator == std::string::npos || separator == 0 || separator+1 == str.size()) return {};
+	try {
+		return std::make_shared<PredicateIndicator>(str.substr(0, separator), std::stoul(str.substr(separator+1)));
+	}
+	catch(const std::logic_error&) {
+		return {};
+	}
+}
+
+bool PrologReasoner::loadTableConfiguration(const boost::property_tree::ptree &config)
+{
+	// tabled predicates are either given as "Name/Arity" string,
+	// or as object with keys "predicate", "depends" and "dynamic".
+	auto tabledList = config.get_child_optional("tabled");
+	if(!tabledList) return true;
+
+	bool status = true;
+	for(auto &pair : tabledList.value()) {
+		auto &tabledConfig = pair.second;
+		auto indicator = readPredicateIndicator(tabledConfig.empty() ?
+				tabledConfig.data() : tabledConfig.get<std::string>("predicate", ""));
+		if(!indicator) {
+			KB_WARN("[{}] invalid tabled predicate in reasoner configuration.", reasonerID_);
+			status = false;
+			continue;
+		}
+		std::set<std::string, std::less<>> dependencies;
+		std::vector<std::shared_ptr<PredicateIndicator>> dynamicPredicates;
+		auto dependsList = tabledConfig.get_child_optional("depends");
+		if(dependsList) {
+			for(auto &x : dependsList.value()) {
+				auto iri = x.second.data();
+				// expand IRIs written with a namespace alias, e.g. "dul:hasPart"
+				auto separator = iri.find(':');
+				if(separator != std::string::npos && iri.find("://") == std::string::npos) {
+					auto expanded = semweb::PrefixRegistry::get().createIRI(
+							iri.substr(0, separator), iri.substr(separator+1));
+					if(expanded.has_value()) iri = expanded.value();
+				}
+				dependencies.insert(iri);
+			}
+		}
+		if(dependencies.empty()) {
+			KB_WARN("[{}] tabled predicate {}/{} has no \"depends\" properties, "
+					"its tables are invalidated by every assertion.",
+					reasonerID_, indicator->functor(), indicator->arity());
+		}
+		auto dynamicList = tabledConfig.get_child_optional("dynamic");
+		if(dynamicList) {
+			for(auto &x : dynamicList.value()) {
+				auto dynamicIndicator = readPredicateIndicator(x.second.data());
+				if(dynamicIndicator) dynamicPredicates.push_back(dynamicIndicator);
+				else KB_WARN("[{}] invalid dynamic predicate `{}` of tabled predicate.", reasonerID_, x.second.data());
+			}
+		}
+		status = tablePredicate(indicator, dependencies, dynamicPredicates) && status;
+	}
+	return status;
+}
+
+bool PrologReasoner::tablePredicate(const std::shared_ptr<PredicateIndicator> &indicator,
+									const std::set<std::string, std::less<>> &dependencies,
+									const std::vector<std::shared_ptr<PredicateIndicator>> &dynamicPredicates)
+{
+	auto tabled = std::make_shared<TabledPredicate>();
+	tabled->indicator = indicator;
+	tabled->dependencies = dependencies;
+	tabled->dynamicPredicates = dynamicPredicates;
+	if(!declareTable(*tabled)) {
+		KB_WARN("[{}] failed to declare predicate {}/{} as tabled.",
+				reasonerID_, indicator->functor(), indicator->arity());
+		return false;
+	}
+	std::lock_guard<std::mutex> lock(tableMutex_);
+	tabledPredicates_.push_back(tabled);
+	KB_DEBUG("[{}] predicate {}/{} is tabled.", reasonerID_, indicator->functor(), indicator->arity());
+	return true;
+}
+
+bool PrologReasoner::declareTable(const TabledPredicate &tabled)
+{
+	static auto table_f = std::make_shared<PredicateIndicator>("reasoner_table", 3);
+	std::vector<TermPtr> dynamicTerms;
+	for(auto &x : tabled.dynamicPredicates) dynamicTerms.push_back(x->toTerm());
+	auto options = std::make_shared<ListTerm>(std::vector<TermPtr>({
+		std::make_shared<Predicate>(Predicate("dynamic", { std::make_shared<ListTerm>(dynamicTerms) }))
+	}));
+	return eval(std::make_shared<Predicate>(Predicate(table_f, {
+			reasonerIDTerm_, tabled.indicator->toTerm(), options })), nullptr, false);
+}
+
+bool PrologReasoner::loadDataSourceWithUnknownFormat(const DataSourcePtr &dataFile)
+{
+	if(!consult(dataFile->uri())) return false;
+	// the file may (re-)define tabled predicates
+	std::lock_guard<std::mutex> lock(tableMutex_);
+	for(auto &tabled : tabledPredicates_) declareTable(*tabled);
+	return true;
+}
+
+static uint64_t readCount(const TermPtr &term)
+{
+	if(!term) return 0;
+	switch(term->type()) {
+		case TermType::INT32:
+			return ((Integer32Term*)term.get())->value();
+		case TermType::LONG:
+			return ((LongTerm*)term.get())->value();
+		default:
+			return 0;
+	}
+}
+
+std::vector<PrologTableStatistics> PrologReasoner::tableStatistics()
+{
+	static auto statistics_f = std::make_shared<PredicateIndicator>("reasoner_table_statistics", 6);
+	static auto numTables_v = std::make_shared<Variable>("NumTables");
+	static auto numAnswers_v = std::make_shared<Variable>("NumAnswers");
+	static auto numCalls_v = std::make_shared<Variable>("NumCalls");
+	static auto numHits_v = std::make_shared<Variable>("NumHits");
+
+	std::vector<std::shared_ptr<TabledPredicate>> tabledPredicates;
+	{
+		std::lock_guard<std::mutex> lock(tableMutex_);
+		tabledPredicates = tabledPredicates_;
+	}
+	std::vector<PrologTableStatistics> result;
+	for(auto &tabled : tabledPredicates) {
+		auto &statistics = result.emplace_back();
+		statistics.indicator = tabled->indicator;
+		statistics.numInvalidations = tabled->numInvalidations;
+		auto solution = oneSolution(std::make_shared<Predicate>(Predicate(statistics_f, {
+				reasonerIDTerm_, tabled->indicator->toTerm(),
+				numTables_v, numAnswers_v, numCalls_v, numHits_v })), nullptr, false);
+		if(AnswerStream::isEOS(solution)) {
+			statistics.numTables = statistics.numAnswers = statistics.numCalls = statistics.numHits = 0;
+			continue;
+		}
+		auto &substitution = *solution->substitution();
+		statistics.numTables = readCount(substitution.get(*numTables_v));
+		statistics.numAnswers = readCount(substitution.get(*numAnswers_v));
+		statistics.numCalls = readCount(substitution.get(*numCalls_v));
+		statistics.numHits = readCount(substitution.get(*numHits_v));
+	}
+	return result;
+}
+
+void PrologReasoner::onInsert(const std::vector<StatementData> &statements)
+{
+	invalidateTables([&statements](const auto &dependencies) {
+		return std::any_of(statements.begin(), statements.end(), [&dependencies](const StatementData &x) {
+			return x.predicate && dependencies.count(std::string_view(x.predicate)) > 0;
+		});
+	});
+}
+
+void PrologReasoner::onRemove(const std::vector<RDFLiteralPtr> &tripleExpressions)
+{
+	invalidateTables([&tripleExpressions](const auto &dependencies) {
+		return std::any_of(tripleExpressions.begin(), tripleExpressions.end(), [&dependencies](const RDFLiteralPtr &x) {
+			auto property = x->propertyTerm();
+			// statements of any property may have been removed
+			if(!property || property->type() != TermType::STRING) return true;
+			return dependencies.count(std::static_pointer_cast<StringTerm>(property)->value()) > 0;
+		});
+	});
+}
+
+void PrologReasoner::invalidateTables(
+		const std::function<bool(const std::set<std::string, std::less<>>&)> &isDependency)
+{
+	static auto abolish_f = std::make_shared<PredicateIndicator>("reasoner_abolish_table", 2);
+	static auto &numInvalidations = Metrics::get().counter(
+			"knowrob_prolog_table_invalidations_total",
+			"Number of times tables of tabled Prolog predicates were invalidated.");
+
+	std::lock_guard<std::mutex> lock(tableMutex_);
+	for(auto &tabled : tabledPredicates_) {
+		// tables without dependencies are invalidated by any change
+		bool isAffected = tabled->dependencies.empty() || isDependency(tabled->dependencies);
+		if(!isAffected) continue;
+
+		if(eval(std::make_shared<Predicate>(Predicate(abolish_f, {
+				reasonerIDTerm_, tabled->indicator->toTerm() })), nullptr, false)) {
+			tabled->numInvalidations += 1;
+			numInvalidations.increment();
+		}
+	}
+}
+
 void PrologReasoner::setDataBackend(const KnowledgeGraphPtr &knowledgeGraph)
 {
     // TODO: think about how data backend of Prolog would be configured
@@ -210,7 +409,11 @@ bool PrologReasoner::consult(const std::filesystem::path &prologFile,
 	static auto consult_f = std::make_shared<PredicateIndicator>("consult", 1);
 	auto path = getPrologPath(prologFile);
 	auto arg = std::make_shared<StringTerm>(path.native());
-	return eval(std::make_shared<Predicate>(Predicate(consult_f, { arg })), contextModule, doTransformQuery);
+	if(eval(std::make_shared<Predicate>(Predicate(consult_f, { arg })), contextModule, doTransformQuery)) {
+		notifyPredicatesDefined();
+		return true;
+	}
+	return false;
 }
 
 bool PrologReasoner::load_rdf_xml(const std::filesystem::path &rdfFile)
@@ -224,7 +427,11 @@ bool PrologReasoner::load_rdf_xml(const std::filesystem::path &rdfFile)
 bool PrologReasoner::assertFact(const std::shared_ptr<Predicate> &fact)
 {
 	static auto assert_f = std::make_shared<PredicateIndicator>("assertz", 1);
-	return eval(std::make_shared<Predicate>(Predicate(assert_f, { fact })));
+	if(eval(std::make_shared<Predicate>(Predicate(assert_f, { fact })))) {
+		notifyPredicatesDefined();
+		return true;
+	}
+	return false;
 }
 
 std::shared_ptr<PredicateDescription> PrologReasoner::getPredicateDescription(
@@ -245,10 +452,9 @@ std::shared_ptr<PredicateDescription> PrologReasoner::getPredicateDescription(
 				current_predicate_f, { indicator->toTerm(), type_v })));
 
 		if(AnswerStream::isEOS(solution)) {
-			// FIXME: this is not safe if files are consulted at runtime
-			static std::shared_ptr<PredicateDescription> nullDescr;
-			predicateDescriptions_[*indicator] = nullDescr;
-			return nullDescr;
+			// note: undefined predicates are not cached as they may be defined later,
+			//       the reasoner manager caches them until a predicate is defined.
+			return {};
 		}
 		else {
 			// read type of predicate
@@ -77,3 +77,4 @@ protected:
 };
 
 TEST_F(PrologReasonerTests, semweb)	{ runTests(getPath("semweb.pl")); }
+TEST_F(PrologReasonerTests, tables)	{ runTests(getPath("reasoner_tables.pl")); }
@@ -28,13 +28,117 @@ bool PrologThreadPool::initializeWorker()
 	else {
 		// if PL_thread_attach_engine()>0, then the Prolog ID for the thread was returned
 		KB_DEBUG("Attached Prolog engine to current thread.");
+		// keep a frame open that is rewound after each query
+		PrologEngineCache::get().openFrame();
 		return true;
 	}
 }
 
 void PrologThreadPool::finalizeWorker()
 {
+	PrologEngineCache::get().closeFrame();
 	// destroy the engine previously bound to this thread
 	PL_thread_destroy_engine();
 	KB_ERROR("destroyed Prolog engine");
 }
+
+PrologEngineCache& PrologEngineCache::get()
+{
+	static thread_local PrologEngineCache cache;
+	return cache;
+}
+
+atom_t PrologEngineCache::atom(std::string_view name)
+{
+	auto it = atoms_.find(name);
+	if(it != atoms_.end()) return it->second;
+	auto a = PL_new_atom_nchars(name.size(), name.data());
+	atoms_.emplace(std::string(name), a);
+	return a;
+}
+
+functor_t PrologEngineCache::functor(std::string_view name, uint32_t arity)
+{
+	auto &byName = functors_[arity];
+	auto it = byName.find(name);
+	if(it != byName.end()) return it->second;
+	auto f = PL_new_functor(atom(name), arity);
+	byName.emplace(std::string(name), f);
+	return f;
+}
+
+module_t PrologEngineCache::module(std::string_view name)
+{
+	auto it = modules_.find(name);
+	if(it != modules_.end()) return it->second;
+	auto m = PL_new_module(atom(name));
+	modules_.emplace(std::string(name), m);
+	return m;
+}
+
+const std::shared_ptr<StringTerm>& PrologEngineCache::stringTerm(atom_t atom)
+{
+	// the cache is cleared when it grows too large to keep memory bounded
+	static const uint32_t maxStringTerms = 100000;
+
+	auto it = stringTerms_.find(atom);
+	if(it != stringTerms_.end()) return it->second;
+	if(stringTerms_.size() >= maxStringTerms) clearStringTerms();
+
+	size_t len;
+	const char *chars = PL_atom_nchars(atom, &len);
+	// make sure the atom handle is not reused for another atom while cached
+	PL_register_atom(atom);
+	auto inserted = stringTerms_.emplace(atom,
+		std::make_shared<StringTerm>(chars ? std::string(chars, len) : std::string()));
+	return inserted.first->second;
+}
+
+void PrologEngineCache::clearStringTerms()
+{
+	for(auto &pair : stringTerms_) {
+		PL_unregister_atom(pair.first);
+	}
+	stringTerms_.clear();
+}
+
+void PrologEngineCache::openFrame()
+{
+	if(frame_ == (fid_t)0) {
+		frame_ = PL_open_foreign_frame();
+	}
+}
+
+void PrologEngineCache::closeFrame()
+{
+	if(frame_ != (fid_t)0) {
+		PL_discard_foreign_frame(frame_);
+		frame_ = (fid_t)0;
+	}
+	clearStringTerms();
+}
+
+PrologEngineCache::FrameScope::FrameScope()
+{
+	auto &cache = PrologEngineCache::get();
+	isWarm_ = (cache.frame_ != (fid_t)0 && !cache.isFrameInUse_);
+	if(isWarm_) {
+		frame_ = cache.frame_;
+		cache.isFrameInUse_ = true;
+	}
+	else {
+		frame_ = PL_open_foreign_frame();
+	}
+}
+
+PrologEngineCache::FrameScope::~FrameScope()
+{
+	if(isWarm_) {
+		// drop all term references and bindings created since the frame was opened
+		PL_rewind_foreign_frame(frame_);
+		PrologEngineCache::get().isFrameInUse_ = false;
+	}
+	else {
+		PL_discard_foreign_frame(frame_);
+	}
+}
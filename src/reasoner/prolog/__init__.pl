@@ -62,3 +62,5 @@
 
 % predicates that interact with the QA system in some way
 :- use_module(library('blackboard')).
+% tabling of predicates declared in reasoner configurations
+:- use_module(library('reasoner_tables')).
@@ -0,0 +1,163 @@
+:- module(reasoner_tables,
+    [ reasoner_table/3,             % +ReasonerModule, +PredicateIndicator, +Options
+      reasoner_abolish_table/2,     % +ReasonerModule, +PredicateIndicator
+      reasoner_table_statistics/6   % +ReasonerModule, +PredicateIndicator, -NumTables, -NumAnswers, -NumCalls, -NumHits
+    ]).
+/** <module> Tabling of predicates defined by reasoner modules.
+
+Tables are shared between threads such that answers computed by one worker
+thread of the reasoner can be reused by the others.
+
+@author Daniel Beßler
+@license BSD
+*/
+
+%% reasoner_table(+ReasonerModule, +PredicateIndicator, +Options) is det.
+%
+% Declare a predicate of a reasoner module as tabled.
+% Calls of the predicate are counted, and a call is counted as a hit
+% if a table for a variant of the call exists already.
+% Options are:
+%
+%   - dynamic(List): dynamic predicates the tabled predicate depends on.
+%     They are declared as incremental such that changes of them
+%     automatically invalidate the table.
+%
+% Declaring the same predicate again is allowed, e.g. after its
+% clauses have been reloaded.
+%
+% @param ReasonerModule the reasoner module.
+% @param PredicateIndicator the predicate indicator Name/Arity.
+% @param Options list of options.
+%
+reasoner_table(ReasonerModule, Name/Arity, Options) :-
+    functor(Head, Name, Arity),
+    option(dynamic(Dynamic), Options, []),
+    forall(
+        member(DynName/DynArity, Dynamic),
+        ReasonerModule:dynamic([DynName/DynArity], [incremental(true)])
+    ),
+    (   Dynamic == []
+    ->  Spec = (Name/Arity as shared)
+    ;   Spec = (Name/Arity as (incremental,shared))
+    ),
+    (   predicate_property(ReasonerModule:Head, tabled)
+    ->  true
+    ;   ReasonerModule:table(Spec)
+    ),
+    table_flag_key(calls, ReasonerModule, Name/Arity, CallsKey),
+    table_flag_key(hits, ReasonerModule, Name/Arity, HitsKey),
+    wrap_predicate(ReasonerModule:Head, reasoner_table_statistics, Wrapped,
+        table_call(ReasonerModule:Head, CallsKey, HitsKey, Wrapped)).
+
+%%
+table_call(Goal, CallsKey, HitsKey, Wrapped) :-
+    flag(CallsKey, NumCalls, NumCalls+1),
+    (   has_variant_table(Goal)
+    ->  flag(HitsKey, NumHits, NumHits+1)
+    ;   true
+    ),
+    Wrapped.
+
+%%
+has_variant_table(Module:Goal) :-
+    copy_term(Goal, Variant),
+    current_table(Module:Variant, _),
+    Variant =@= Goal,
+    !.
+
+%% reasoner_abolish_table(+ReasonerModule, +PredicateIndicator) is det.
+%
+% Remove all tables of a tabled predicate.
+%
+% @param ReasonerModule the reasoner module.
+% @param PredicateIndicator the predicate indicator Name/Arity.
+%
+reasoner_abolish_table(ReasonerModule, Name/Arity) :-
+    functor(Head, Name, Arity),
+    abolish_table_subgoals(ReasonerModule:Head).
+
+%% reasoner_table_statistics(+ReasonerModule, +PredicateIndicator, -NumTables, -NumAnswers, -NumCalls, -NumHits) is det.
+%
+% Read statistics about the tables of a tabled predicate.
+%
+% @param ReasonerModule the reasoner module.
+% @param PredicateIndicator the predicate indicator Name/Arity.
+% @param NumTables number of call variants with a table.
+% @param NumAnswers number of answers in all tables.
+% @param NumCalls number of calls since the predicate was declared as tabled.
+% @param NumHits number of calls for which a table existed already.
+%
+reasoner_table_statistics(ReasonerModule, Name/Arity, NumTables, NumAnswers, NumCalls, NumHits) :-
+    functor(Head, Name, Arity),
+    aggregate_all(count,
+        current_table(ReasonerModule:Head, _),
+        NumTables),
+    aggregate_all(count,
+        ( current_table(ReasonerModule:Head, Trie), trie_gen(Trie, _) ),
+        NumAnswers),
+    table_flag_key(calls, ReasonerModule, Name/Arity, CallsKey),
+    table_flag_key(hits, ReasonerModule, Name/Arity, HitsKey),
+    flag(CallsKey, NumCalls, NumCalls),
+    flag(HitsKey, NumHits, NumHits).
+
+% flag/3 only uses name and arity of compound keys, hence atomic keys are used.
+table_flag_key(Type, ReasonerModule, Name/Arity, Key) :-
+    atomic_list_concat([table, Type, ReasonerModule, Name, Arity], ':', Key).
+
+		 /*******************************
+		 *	    UNIT TESTS	     		*
+		 *******************************/
+
+:- begin_tests('reasoner_tables').
+
+% a left-recursive predicate that only terminates when it is tabled
+reasoner_tables_test:path(X,Y) :-
+    reasoner_tables_test:edge(X,Y).
+reasoner_tables_test:path(X,Y) :-
+    reasoner_tables_test:path(X,Z),
+    reasoner_tables_test:edge(Z,Y).
+
+tables_setup :-
+    reasoner_table(reasoner_tables_test, path/2, [dynamic([edge/2])]),
+    retractall(reasoner_tables_test:edge(_,_)),
+    assertz(reasoner_tables_test:edge(a,b)),
+    assertz(reasoner_tables_test:edge(b,c)),
+    assertz(reasoner_tables_test:edge(c,a)).
+
+tables_cleanup :-
+    retractall(reasoner_tables_test:edge(_,_)),
+    reasoner_abolish_table(reasoner_tables_test, path/2).
+
+path_targets(X, Ys) :-
+    findall(Y, reasoner_tables_test:path(X,Y), Ys0),
+    sort(Ys0, Ys).
+
+test('tabled recursive predicate',
+        [ setup(tables_setup), cleanup(tables_cleanup), true(Ys == [a,b,c]) ]) :-
+    path_targets(a, Ys).
+
+test('tables are reused by variant calls',
+        [ setup(tables_setup), cleanup(tables_cleanup) ]) :-
+    reasoner_table_statistics(reasoner_tables_test, path/2, _, _, Calls0, Hits0),
+    path_targets(a, _),
+    path_targets(a, _),
+    reasoner_table_statistics(reasoner_tables_test, path/2, NumTables, NumAnswers, Calls1, Hits1),
+    assertion(NumTables >= 1),
+    assertion(NumAnswers >= 3),
+    assertion(Calls1 > Calls0),
+    assertion(Hits1 > Hits0).
+
+test('changes of dynamic predicates invalidate tables',
+        [ setup(tables_setup), cleanup(tables_cleanup), true(Ys == [a,b,c,d]) ]) :-
+    path_targets(a, _),
+    assertz(reasoner_tables_test:edge(c,d)),
+    path_targets(a, Ys).
+
+test('abolish tables',
+        [ setup(tables_setup), cleanup(tables_cleanup), true(NumTables == 0) ]) :-
+    path_targets(a, _),
+    reasoner_abolish_table(reasoner_tables_test, path/2),
+    reasoner_table_statistics(reasoner_tables_test, path/2, NumTables, _, _, _).
+
+:- end_tests('reasoner_tables').
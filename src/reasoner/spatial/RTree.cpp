@@ -0,0 +1,495 @@
+/*
+ * Copyright (c) 2023, Daniel Beßler
+ * All rights reserved.
+ *
+ * This file is part of KnowRob, please consult
+ * https://github.com/knowrob/knowrob for license details.
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <queue>
+#include <set>
+#include "knowrob/reasoner/spatial/RTree.h"
+
+using namespace knowrob::spatial;
+
+namespace knowrob::spatial {
+	// volume and edge length sum of a box, the latter is used to break ties
+	// between flat boxes without volume.
+	using BoxMeasure = std::pair<double,double>;
+
+	static BoxMeasure measure(const BoundingBox &box)
+	{
+		double edges = 0.0;
+		for(int i=0; i<3; ++i) edges += box.max[i] - box.min[i];
+		return { box.volume(), edges };
+	}
+
+	static BoxMeasure enlargement(const BoundingBox &box, const BoundingBox &added)
+	{
+		auto before = measure(box);
+		auto after = measure(box.merge(added));
+		return { after.first - before.first, after.second - before.second };
+	}
+}
+
+BoundingBox BoundingBox::fromCenter(const std::array<double,3> &center, const std::array<double,3> &extents)
+{
+	BoundingBox box{};
+	for(int i=0; i<3; ++i) {
+		box.min[i] = center[i] - 0.5*extents[i];
+		box.max[i] = center[i] + 0.5*extents[i];
+	}
+	return box;
+}
+
+BoundingBox BoundingBox::expand(double margin) const
+{
+	BoundingBox box{};
+	for(int i=0; i<3; ++i) {
+		box.min[i] = min[i] - margin;
+		box.max[i] = max[i] + margin;
+	}
+	return box;
+}
+
+BoundingBox BoundingBox::merge(const BoundingBox &other) const
+{
+	BoundingBox box{};
+	for(int i=0; i<3; ++i) {
+		box.min[i] = std::min(min[i], other.min[i]);
+		box.max[i] = std::max(max[i], other.max[i]);
+	}
+	return box;
+}
+
+bool BoundingBox::intersects(const BoundingBox &other) const
+{
+	for(int i=0; i<3; ++i) {
+		if(other.max[i] < min[i] || max[i] < other.min[i]) return false;
+	}
+	return true;
+}
+
+bool BoundingBox::contains(const BoundingBox &other) const
+{
+	for(int i=0; i<3; ++i) {
+		if(other.min[i] < min[i] || max[i] < other.max[i]) return false;
+	}
+	return true;
+}
+
+double BoundingBox::volume() const
+{
+	return (max[0]-min[0]) * (max[1]-min[1]) * (max[2]-min[2]);
+}
+
+std::array<double,3> BoundingBox::center() const
+{
+	return { 0.5*(min[0]+max[0]), 0.5*(min[1]+max[1]), 0.5*(min[2]+max[2]) };
+}
+
+double BoundingBox::squaredDistance(const std::array<double,3> &point) const
+{
+	double d = 0.0;
+	for(int i=0; i<3; ++i) {
+		double delta = 0.0;
+		if(point[i] < min[i])      delta = min[i] - point[i];
+		else if(point[i] > max[i]) delta = point[i] - max[i];
+		d += delta*delta;
+	}
+	return d;
+}
+
+BoundingBox RTree::Node::bounds() const
+{
+	auto box = entries.front().box;
+	for(auto &entry : entries) box = box.merge(entry.box);
+	return box;
+}
+
+RTree::RTree(uint32_t maxEntries)
+: maxEntries_(std::max(maxEntries, 4u)),
+  root_(std::make_unique<Node>())
+{
+}
+
+RTree::~RTree() = default;
+
+void RTree::set(std::string_view object, const BoundingBox &box)
+{
+	remove(object);
+	auto it = objects_.emplace(std::string(object), ObjectData{box, nullptr}).first;
+	Entry entry;
+	entry.box = box;
+	entry.object = &it->first;
+	insert(chooseLeaf(box), std::move(entry));
+}
+
+bool RTree::remove(std::string_view object)
+{
+	auto it = objects_.find(object);
+	if(it == objects_.end()) return false;
+
+	Node *node = it->second.leaf;
+	auto &entries = node->entries;
+	entries.erase(std::find_if(entries.begin(), entries.end(),
+		[&it](const Entry &entry) { return entry.object == &it->first; }));
+	objects_.erase(it);
+
+	// prune empty nodes, and shrink the boxes of remaining ancestors
+	while(node->parent && node->entries.empty()) {
+		Node *parent = node->parent;
+		parent->entries.erase(std::find_if(parent->entries.begin(), parent->entries.end(),
+			[node](const Entry &entry) { return entry.child.get() == node; }));
+		node = parent;
+	}
+	if(!node->entries.empty()) adjustBounds(node);
+
+	// shorten the tree if the root has a single child
+	while(!root_->isLeaf && root_->entries.size() <= 1) {
+		if(root_->entries.empty()) {
+			root_ = std::make_unique<Node>();
+		}
+		else {
+			auto child = std::move(root_->entries.front().child);
+			child->parent = nullptr;
+			root_ = std::move(child);
+		}
+	}
+	return true;
+}
+
+std::optional<BoundingBox> RTree::get(std::string_view object) const
+{
+	auto it = objects_.find(object);
+	if(it == objects_.end()) return std::nullopt;
+	return it->second.box;
+}
+
+RTree::Node* RTree::chooseLeaf(const BoundingBox &box) const
+{
+	Node *node = root_.get();
+	while(!node->isLeaf) {
+		Entry *best = nullptr;
+		BoxMeasure bestEnlargement, bestMeasure;
+		for(auto &entry : node->entries) {
+			auto e = enlargement(entry.box, box);
+			auto m = measure(entry.box);
+			if(!best || e < bestEnlargement || (e == bestEnlargement && m < bestMeasure)) {
+				best = &entry;
+				bestEnlargement = e;
+				bestMeasure = m;
+			}
+		}
+		node = best->child.get();
+	}
+	return node;
+}
+
+void RTree::setParent(Node *node, Entry &entry)
+{
+	if(entry.child) {
+		entry.child->parent = node;
+	}
+	else {
+		objects_.find(*entry.object)->second.leaf = node;
+	}
+}
+
+void RTree::insert(Node *node, Entry entry)
+{
+	setParent(node, entry);
+	node->entries.push_back(std::move(entry));
+	if(node->entries.size() > maxEntries_) {
+		split(node);
+	}
+	else {
+		adjustBounds(node);
+	}
+}
+
+void RTree::adjustBounds(Node *node)
+{
+	while(node->parent) {
+		Node *parent = node->parent;
+		for(auto &entry : parent->entries) {
+			if(entry.child.get() == node) {
+				entry.box = node->bounds();
+				break;
+			}
+		}
+		node = parent;
+	}
+}
+
+void RTree::split(Node *node)
+{
+	std::vector<Entry> remaining = std::move(node->entries);
+	node->entries.clear();
+	auto sibling = std::make_unique<Node>();
+	sibling->isLeaf = node->isLeaf;
+	const auto minEntries = std::max<std::size_t>(1, (maxEntries_*2)/5);
+
+	// pick the two entries that would waste most space when grouped together
+	std::size_t seed1=0, seed2=1;
+	BoxMeasure worstWaste;
+	bool hasWaste = false;
+	for(std::size_t i=0; i<remaining.size(); ++i) {
+		for(std::size_t j=i+1; j<remaining.size(); ++j) {
+			auto merged = measure(remaining[i].box.merge(remaining[j].box));
+			auto a = measure(remaining[i].box);
+			auto b = measure(remaining[j].box);
+			BoxMeasure waste = { merged.first - a.first - b.first, merged.second - a.second - b.second };
+			if(!hasWaste || waste > worstWaste) {
+				seed1 = i; seed2 = j;
+				worstWaste = waste;
+				hasWaste = true;
+			}
+		}
+	}
+	std::array<Node*,2> groups = { node, sibling.get() };
+	std::array<BoundingBox,2> groupBoxes = { remaining[seed1].box, remaining[seed2].box };
+	auto assign = [&](std::size_t group, std::size_t index) {
+		groupBoxes[group] = groups[group]->entries.empty() ?
+			remaining[index].box : groupBoxes[group].merge(remaining[index].box);
+		setParent(groups[group], remaining[index]);
+		groups[group]->entries.push_back(std::move(remaining[index]));
+		remaining.erase(remaining.begin() + static_cast<long>(index));
+	};
+	// erase the seed with the larger index first such that the other index stays valid
+	assign(1, seed2);
+	assign(0, seed1);
+
+	while(!remaining.empty()) {
+		// make sure each group receives the minimum number of entries
+		for(std::size_t g=0; g<2; ++g) {
+			if(groups[g]->entries.size() + remaining.size() <= minEntries) {
+				while(!remaining.empty()) assign(g, remaining.size()-1);
+			}
+		}
+		if(remaining.empty()) break;
+
+		// pick the entry with the strongest preference for one of the groups
+		std::size_t next = 0;
+		double maxPreference = -1.0;
+		for(std::size_t i=0; i<remaining.size(); ++i) {
+			auto d0 = enlargement(groupBoxes[0], remaining[i].box);
+			auto d1 = enlargement(groupBoxes[1], remaining[i].box);
+			double preference = std::abs(d0.first - d1.first) + std::abs(d0.second - d1.second);
+			if(preference > maxPreference) {
+				maxPreference = preference;
+				next = i;
+			}
+		}
+		auto d0 = enlargement(groupBoxes[0], remaining[next].box);
+		auto d1 = enlargement(groupBoxes[1], remaining[next].box);
+		std::size_t group;
+		if(d0 != d1) {
+			group = (d0 < d1 ? 0 : 1);
+		}
+		else {
+			auto m0 = measure(groupBoxes[0]);
+			auto m1 = measure(groupBoxes[1]);
+			if(m0 != m1) group = (m0 < m1 ? 0 : 1);
+			else group = (groups[0]->entries.size() <= groups[1]->entries.size() ? 0 : 1);
+		}
+		assign(group, next);
+	}
+
+	if(!node->parent) {
+		// grow the tree by one level
+		auto newRoot = std::make_unique<Node>();
+		newRoot->isLeaf = false;
+		Entry left, right;
+		left.box = node->bounds();
+		left.child = std::move(root_);
+		right.box = sibling->bounds();
+		right.child = std::move(sibling);
+		left.child->parent = newRoot.get();
+		right.child->parent = newRoot.get();
+		newRoot->entries.push_back(std::move(left));
+		newRoot->entries.push_back(std::move(right));
+		root_ = std::move(newRoot);
+	}
+	else {
+		adjustBounds(node);
+		Entry entry;
+		entry.box = sibling->bounds();
+		entry.child = std::move(sibling);
+		insert(node->parent, std::move(entry));
+	}
+}
+
+bool RTree::search(const Node *node,
+                   const std::function<bool(const BoundingBox&)> &visitNode,
+                   const std::function<bool(const BoundingBox&)> &matchBox,
+                   const BoxVisitor &visitor) const
+{
+	for(auto &entry : node->entries) {
+		if(node->isLeaf) {
+			if(matchBox(entry.box) && !visitor(*entry.object, entry.box)) return false;
+		}
+		else if(visitNode(entry.box)) {
+			if(!search(entry.child.get(), visitNode, matchBox, visitor)) return false;
+		}
+	}
+	return true;
+}
+
+bool RTree::intersecting(const BoundingBox &box, const BoxVisitor &visitor) const
+{
+	auto intersects = [&box](const BoundingBox &other) { return box.intersects(other); };
+	return search(root_.get(), intersects, intersects, visitor);
+}
+
+bool RTree::containedIn(const BoundingBox &box, const BoxVisitor &visitor) const
+{
+	return search(root_.get(),
+		[&box](const BoundingBox &other) { return box.intersects(other); },
+		[&box](const BoundingBox &other) { return box.contains(other); },
+		visitor);
+}
+
+bool RTree::containing(const BoundingBox &box, const BoxVisitor &visitor) const
+{
+	// a node can only have a child containing the box if the node itself contains it
+	auto contains = [&box](const BoundingBox &other) { return other.contains(box); };
+	return search(root_.get(), contains, contains, visitor);
+}
+
+bool RTree::forEach(const BoxVisitor &visitor) const
+{
+	for(auto &pair : objects_) {
+		if(!visitor(pair.first, pair.second.box)) return false;
+	}
+	return true;
+}
+
+std::vector<std::string> RTree::nearest(const std::array<double,3> &point, uint32_t k) const
+{
+	std::vector<std::string> result;
+	if(k == 0) return result;
+	nearest(point, [&result,k](const std::string &object, double) {
+		result.push_back(object);
+		return result.size() < k;
+	});
+	return result;
+}
+
+bool RTree::nearest(const std::array<double,3> &point, const DistanceVisitor &visitor) const
+{
+	// best-first search over nodes and objects ordered by their distance to the point
+	using QueueItem = std::pair<double, const Entry*>;
+	std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<>> queue;
+	for(auto &entry : root_->entries) {
+		queue.emplace(entry.box.squaredDistance(point), &entry);
+	}
+	while(!queue.empty()) {
+		auto [distance, entry] = queue.top();
+		queue.pop();
+		if(entry->object) {
+			if(!visitor(*entry->object, distance)) return false;
+		}
+		else {
+			for(auto &childEntry : entry->child->entries) {
+				queue.emplace(childEntry.box.squaredDistance(point), &childEntry);
+			}
+		}
+	}
+	return true;
+}
+
+bool RTree::forEachPair(double margin, const PairVisitor &visitor) const
+{
+	for(auto &pair : objects_) {
+		auto &a = pair.first;
+		auto &boxA = pair.second.box;
+		bool proceed = intersecting(boxA.expand(margin),
+			[&](const std::string &b, const BoundingBox &boxB) {
+				return &a == &b || visitor(a, boxA, b, boxB);
+			});
+		if(!proceed) return false;
+	}
+	return true;
+}
+
+// fixture class for testing
+class RTreeTest : public ::testing::Test {
+protected:
+	RTree tree_;
+	std::map<std::string, BoundingBox> boxes_;
+	void SetUp() override {
+		// a 10x10 grid of small boxes, and a large box covering part of it
+		for(int x=0; x<10; ++x) {
+			for(int y=0; y<10; ++y) {
+				auto name = std::to_string(x) + "_" + std::to_string(y);
+				setBox(name, BoundingBox::fromCenter({double(x), double(y), 0.0}, {0.5, 0.5, 0.5}));
+			}
+		}
+		setBox("table", BoundingBox{{-0.5, -0.5, -0.5}, {2.5, 2.5, 0.5}});
+	}
+	void setBox(const std::string &name, const BoundingBox &box) {
+		tree_.set(name, box);
+		boxes_[name] = box;
+	}
+	void removeBox(const std::string &name) {
+		tree_.remove(name);
+		boxes_.erase(name);
+	}
+	static std::set<std::string> collect(const std::function<bool(const BoxVisitor&)> &query) {
+		std::set<std::string> out;
+		query([&out](const std::string &object, const BoundingBox&) { out.insert(object); return true; });
+		return out;
+	}
+	std::set<std::string> expected(const std::function<bool(const BoundingBox&)> &filter) {
+		std::set<std::string> out;
+		for(auto &pair : boxes_) if(filter(pair.second)) out.insert(pair.first);
+		return out;
+	}
+};
+
+TEST_F(RTreeTest, QueriesMatchLinearScan) {
+	BoundingBox query{{0.6, 0.6, -1.0}, {3.2, 2.4, 1.0}};
+	EXPECT_EQ(collect([&](auto &v) { return tree_.intersecting(query, v); }),
+	          expected([&](auto &box) { return query.intersects(box); }));
+	EXPECT_EQ(collect([&](auto &v) { return tree_.containedIn(query, v); }),
+	          expected([&](auto &box) { return query.contains(box); }));
+	auto point = BoundingBox::fromCenter({1.0, 1.0, 0.0}, {0.1, 0.1, 0.1});
+	EXPECT_EQ(collect([&](auto &v) { return tree_.containing(point, v); }),
+	          std::set<std::string>({"1_1", "table"}));
+}
+
+TEST_F(RTreeTest, Nearest) {
+	EXPECT_EQ(tree_.nearest({5.1, 7.0, 0.0}, 2), std::vector<std::string>({"5_7", "6_7"}));
+	EXPECT_EQ(tree_.nearest({1.2, 1.4, 0.0}, 2), std::vector<std::string>({"table", "1_1"}));
+	EXPECT_EQ(tree_.nearest({0.0, 0.0, 0.0}, 1000).size(), tree_.size());
+}
+
+TEST_F(RTreeTest, Pairs) {
+	std::set<std::pair<std::string,std::string>> pairs;
+	tree_.forEachPair(0.6, [&pairs](const std::string &a, const BoundingBox&, const std::string &b, const BoundingBox&) {
+		pairs.emplace(a, b);
+		return true;
+	});
+	EXPECT_TRUE(pairs.count({"3_3", "3_4"}));
+	EXPECT_TRUE(pairs.count({"3_4", "3_3"}));
+	EXPECT_TRUE(pairs.count({"table", "2_2"}));
+	EXPECT_FALSE(pairs.count({"3_3", "3_3"}));
+	EXPECT_FALSE(pairs.count({"3_3", "5_5"}));
+}
+
+TEST_F(RTreeTest, UpdateAndRemove) {
+	setBox("table", BoundingBox{{6.5, 6.5, -0.5}, {9.5, 9.5, 0.5}});
+	for(int x=0; x<10; x+=2) removeBox(std::to_string(x) + "_" + std::to_string(x));
+	EXPECT_EQ(tree_.size(), boxes_.size());
+	EXPECT_FALSE(tree_.remove("0_0"));
+	EXPECT_FALSE(tree_.get("0_0").has_value());
+	BoundingBox query{{-1.0, -1.0, -1.0}, {7.0, 7.0, 1.0}};
+	EXPECT_EQ(collect([&](auto &v) { return tree_.intersecting(query, v); }),
+	          expected([&](auto &box) { return query.intersects(box); }));
+	for(auto &pair : std::map<std::string, BoundingBox>(boxes_)) removeBox(pair.first);
+	EXPECT_EQ(tree_.size(), 0);
+	EXPECT_TRUE(tree_.nearest({0.0, 0.0, 0.0}, 1).empty());
+}
@@ -0,0 +1,728 @@
+/*
+ * Copyright (c) 2023, Daniel Beßler
+ * All rights reserved.
+ *
+ * This file is part of KnowRob, please consult
+ * https://github.com/knowrob/knowrob for license details.
+ */
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include "knowrob/Logger.h"
+#include "knowrob/KnowledgeBase.h"
+#include "knowrob/reasoner/spatial/SpatialReasoner.h"
+#include "knowrob/reasoner/ReasonerManager.h"
+
+using namespace knowrob;
+using namespace knowrob::spatial;
+
+// make reasoner type accessible
+KNOWROB_BUILTIN_REASONER("Spatial", SpatialReasoner)
+
+namespace knowrob::spatial {
+	// tolerance of the inside and on-top-of relations as used by the Prolog implementation
+	constexpr double contactTolerance = 0.05;
+	// maximum distance of centers along each axis for the in-center-of relation
+	constexpr double centerTolerance = 0.2;
+
+	// the reasoners receiving poses from setObjectPose
+	static std::set<SpatialReasoner*> &reasonerInstances()
+	{
+		static std::set<SpatialReasoner*> instances;
+		return instances;
+	}
+	static std::mutex reasonerInstancesMutex;
+
+	// the tf frame of an object is the local name of its IRI
+	static std::string_view frameOfObject(std::string_view iri)
+	{
+		auto pos = iri.find_last_of("#/");
+		return pos == std::string_view::npos ? iri : iri.substr(pos+1);
+	}
+
+	/**
+	 * @param r a spatial relation.
+	 * @param a the box of the subject.
+	 * @param b the box of the object.
+	 * @return true if r(a,b) holds.
+	 */
+	static bool holds(SpatialRelation r, const BoundingBox &a, const BoundingBox &b)
+	{
+		auto ac = a.center();
+		auto bc = b.center();
+		switch(r) {
+			case SpatialRelation::INSIDE_OF:
+				return b.expand(contactTolerance).contains(a);
+			case SpatialRelation::ONTOP_OF: {
+				auto d = ac[2] - bc[2];
+				return d >= 0.0 && d <= contactTolerance;
+			}
+			case SpatialRelation::ABOVE_OF:
+				return bc[2] < ac[2];
+			case SpatialRelation::BELOW_OF:
+				return ac[2] < bc[2];
+			case SpatialRelation::IN_CENTER_OF:
+				for(int i=0; i<3; ++i) {
+					if(std::abs(ac[i] - bc[i]) > centerTolerance) return false;
+				}
+				return true;
+		}
+		return false;
+	}
+
+	/**
+	 * Compute a box that intersects the box of each object related to a given one.
+	 * @param r a spatial relation.
+	 * @param box the box of the known argument.
+	 * @param isSubject true if the known argument is the subject of the relation.
+	 * @return the query window.
+	 */
+	static BoundingBox window(SpatialRelation r, const BoundingBox &box, bool isSubject)
+	{
+		static const double inf = std::numeric_limits<double>::infinity();
+		// relations over centers use windows that are unbounded in x and y.
+		// the box of an object intersects a window if its center is inside.
+		auto c = box.center();
+		BoundingBox w{{-inf, -inf, -inf}, {inf, inf, inf}};
+		switch(r) {
+			case SpatialRelation::INSIDE_OF:
+				// the container is at most tolerance away from the inner object,
+				// and the inner object is inside of the enlarged container
+				return box.expand(contactTolerance);
+			case SpatialRelation::ONTOP_OF:
+				if(isSubject) { w.min[2] = c[2] - contactTolerance; w.max[2] = c[2]; }
+				else          { w.min[2] = c[2]; w.max[2] = c[2] + contactTolerance; }
+				return w;
+			case SpatialRelation::ABOVE_OF:
+				if(isSubject) w.max[2] = c[2];
+				else          w.min[2] = c[2];
+				return w;
+			case SpatialRelation::BELOW_OF:
+				if(isSubject) w.min[2] = c[2];
+				else          w.max[2] = c[2];
+				return w;
+			case SpatialRelation::IN_CENTER_OF:
+				return BoundingBox::fromCenter(c, {
+					2.0*centerTolerance,
+					2.0*centerTolerance,
+					2.0*centerTolerance });
+		}
+		return w;
+	}
+}
+
+SpatialReasoner::SpatialReasoner(std::string reasonerID)
+: Reasoner(),
+  reasonerID_(std::move(reasonerID)),
+  referenceFrame_("map")
+{
+	std::lock_guard<std::mutex> lock(reasonerInstancesMutex);
+	reasonerInstances().insert(this);
+}
+
+SpatialReasoner::~SpatialReasoner()
+{
+	std::lock_guard<std::mutex> lock(reasonerInstancesMutex);
+	reasonerInstances().erase(this);
+}
+
+const std::map<std::string, SpatialRelation, std::less<>>& SpatialReasoner::relationProperties()
+{
+	static const std::map<std::string, SpatialRelation, std::less<>> properties = {
+		{ std::string(spatial::isInsideOf),   SpatialRelation::INSIDE_OF },
+		{ std::string(spatial::isOntopOf),    SpatialRelation::ONTOP_OF },
+		{ std::string(spatial::isAboveOf),    SpatialRelation::ABOVE_OF },
+		{ std::string(spatial::isBelowOf),    SpatialRelation::BELOW_OF },
+		{ std::string(spatial::isInCenterOf), SpatialRelation::IN_CENTER_OF }
+	};
+	return properties;
+}
+
+void SpatialReasoner::setObjectPose(const std::string &frame, const std::string &parentFrame,
+                                    const std::array<double,3> &position)
+{
+	std::lock_guard<std::mutex> lock(reasonerInstancesMutex);
+	for(auto reasoner : reasonerInstances()) {
+		// note: only poses relative to the reference frame are used,
+		//       poses relative to other objects are not resolved.
+		if(reasoner->referenceFrame_ == parentFrame) {
+			reasoner->setPosition(frame, position);
+		}
+	}
+}
+
+void SpatialReasoner::setDataBackend(const KnowledgeGraphPtr &knowledgeGraph)
+{
+	knowledgeGraph_ = knowledgeGraph;
+}
+
+bool SpatialReasoner::loadConfiguration(const ReasonerConfiguration &cfg)
+{
+	if(cfg.ptree) {
+		referenceFrame_ = cfg.ptree->get<std::string>("frame", referenceFrame_);
+	}
+	if(knowledgeGraph_) loadObjects();
+	return true;
+}
+
+unsigned long SpatialReasoner::getCapabilities() const
+{
+	return CAPABILITY_TOP_DOWN_EVALUATION;
+}
+
+std::shared_ptr<PredicateDescription> SpatialReasoner::getPredicateDescription(
+		const std::shared_ptr<PredicateIndicator> &indicator)
+{
+	if(indicator->arity() == 2 &&
+	   (indicator->functor() == spatial::nearest ||
+	    relationProperties().count(indicator->functor()) > 0))
+	{
+		return std::make_shared<PredicateDescription>(indicator, PredicateType::BUILT_IN);
+	}
+	return {};
+}
+
+static std::optional<double> readExtent(const TermPtr &term)
+{
+	if(!term) return std::nullopt;
+	switch(term->type()) {
+		case TermType::DOUBLE:
+			return std::static_pointer_cast<DoubleTerm>(term)->value();
+		case TermType::LONG:
+			return static_cast<double>(std::static_pointer_cast<LongTerm>(term)->value());
+		case TermType::INT32:
+			return static_cast<double>(std::static_pointer_cast<Integer32Term>(term)->value());
+		case TermType::STRING:
+			try {
+				return std::stod(std::static_pointer_cast<StringTerm>(term)->value());
+			}
+			catch(const std::exception&) {
+				return std::nullopt;
+			}
+		default:
+			return std::nullopt;
+	}
+}
+
+static std::optional<double> readExtent(const StatementData &statement)
+{
+	switch(statement.objectType) {
+		case RDF_DOUBLE_LITERAL:
+			return statement.objectDouble;
+		case RDF_INT64_LITERAL:
+			return static_cast<double>(statement.objectInteger);
+		case RDF_STRING_LITERAL:
+			if(statement.object) {
+				return readExtent(std::make_shared<StringTerm>(statement.object));
+			}
+			return std::nullopt;
+		default:
+			return std::nullopt;
+	}
+}
+
+// translations are written as "x y z"
+static std::optional<std::array<double,3>> readTranslation(const char *data)
+{
+	std::array<double,3> position{};
+	std::istringstream stream(data);
+	for(auto &value : position) {
+		if(!(stream >> value)) return std::nullopt;
+	}
+	return position;
+}
+
+static int axisOfProperty(std::string_view property)
+{
+	if(property == spatial::hasDepth)  return 0;
+	if(property == spatial::hasWidth)  return 1;
+	if(property == spatial::hasHeight) return 2;
+	return -1;
+}
+
+void SpatialReasoner::loadObjects()
+{
+	static const auto s_var = std::make_shared<Variable>("S");
+	static const auto o_var = std::make_shared<Variable>("O");
+
+	auto forEachTriple = [this](std::string_view property,
+			const std::function<void(const TermPtr&, const TermPtr&)> &visitor) {
+		auto literal = std::make_shared<RDFLiteral>(
+				s_var, std::make_shared<StringTerm>(std::string(property)), o_var, false);
+		auto answerQueue = knowledgeGraph_->submitQuery(
+				std::make_shared<GraphQuery>(literal, QUERY_FLAG_ALL_SOLUTIONS))->createQueue();
+		while(true) {
+			auto answer = answerQueue->pop_front();
+			if(AnswerStream::isEOS(answer)) break;
+			auto &substitution = *answer->substitution();
+			visitor(substitution.get(*s_var), substitution.get(*o_var));
+		}
+	};
+	auto forEachLink = [&](std::string_view property,
+			const std::function<void(const std::string&, const std::string&)> &visitor) {
+		forEachTriple(property, [&visitor](const TermPtr &s, const TermPtr &o) {
+			if(!s || !o || s->type() != TermType::STRING || o->type() != TermType::STRING) return;
+			visitor(std::static_pointer_cast<StringTerm>(s)->value(),
+			        std::static_pointer_cast<StringTerm>(o)->value());
+		});
+	};
+
+	for(auto property : { spatial::hasDepth, spatial::hasWidth, spatial::hasHeight }) {
+		auto axis = axisOfProperty(property);
+		forEachTriple(property, [this,axis](const TermPtr &s, const TermPtr &o) {
+			auto extent = readExtent(o);
+			if(!s || s->type() != TermType::STRING || !extent.has_value()) return;
+			setExtent(std::static_pointer_cast<StringTerm>(s)->value(), axis, extent.value());
+		});
+	}
+	forEachLink(spatial::hasRegion, [this](const std::string &shape, const std::string &region) {
+		setRegion(shape, region);
+	});
+	forEachLink(spatial::hasShape, [this](const std::string &object, const std::string &shape) {
+		setShape(object, shape);
+	});
+	forEachTriple(spatial::translation, [this](const TermPtr &s, const TermPtr &o) {
+		if(!s || !o || s->type() != TermType::STRING || o->type() != TermType::STRING) return;
+		auto position = readTranslation(std::static_pointer_cast<StringTerm>(o)->value().c_str());
+		if(position.has_value()) setTranslation(std::static_pointer_cast<StringTerm>(s)->value(), position.value());
+	});
+	forEachLink(spatial::pose, [this](const std::string &object, const std::string &pose) {
+		setPose(object, pose);
+	});
+	KB_INFO("Spatial reasoner `{}` knows the shapes of {} objects, and the poses of {} objects.",
+	        reasonerID_, shapeOfObject_.size(), poseOfObject_.size());
+}
+
+void SpatialReasoner::onInsert(const std::vector<StatementData> &statements)
+{
+	for(auto &statement : statements) {
+		if(!statement.subject || !statement.predicate) continue;
+		std::string_view property(statement.predicate);
+		auto axis = axisOfProperty(property);
+		if(axis >= 0) {
+			auto extent = readExtent(statement);
+			if(extent.has_value()) setExtent(statement.subject, axis, extent.value());
+		}
+		else if(property == spatial::hasRegion && statement.object) {
+			setRegion(statement.subject, statement.object);
+		}
+		else if(property == spatial::hasShape && statement.object) {
+			setShape(statement.subject, statement.object);
+		}
+		else if(property == spatial::pose && statement.object) {
+			setPose(statement.subject, statement.object);
+		}
+		else if(property == spatial::translation && statement.object) {
+			auto position = readTranslation(statement.object);
+			if(position.has_value()) setTranslation(statement.subject, position.value());
+		}
+	}
+}
+
+void SpatialReasoner::setPosition(const std::string &frame, const std::array<double,3> &position)
+{
+	std::unique_lock<std::shared_mutex> lock(mutex_);
+	positions_[frame] = position;
+	updateIndex(frame);
+}
+
+void SpatialReasoner::setShape(const std::string &object, const std::string &shape)
+{
+	std::unique_lock<std::shared_mutex> lock(mutex_);
+	std::string frame(frameOfObject(object));
+	objectOfFrame_[frame] = object;
+	shapeOfObject_[object] = shape;
+	updateIndex(frame);
+}
+
+void SpatialReasoner::setRegion(const std::string &shape, const std::string &region)
+{
+	std::unique_lock<std::shared_mutex> lock(mutex_);
+	regionOfShape_[shape] = region;
+	for(auto &pair : shapeOfObject_) {
+		if(pair.second == shape) updateIndex(std::string(frameOfObject(pair.first)));
+	}
+}
+
+void SpatialReasoner::setExtent(const std::string &region, int axis, double value)
+{
+	std::unique_lock<std::shared_mutex> lock(mutex_);
+	auto it = regionExtents_.find(region);
+	if(it == regionExtents_.end()) {
+		it = regionExtents_.emplace(region, std::array<double,3>{0.0, 0.0, 0.0}).first;
+	}
+	it->second[axis] = value;
+	for(auto &pair : shapeOfObject_) {
+		auto jt = regionOfShape_.find(pair.second);
+		if(jt != regionOfShape_.end() && jt->second == region) {
+			updateIndex(std::string(frameOfObject(pair.first)));
+		}
+	}
+}
+
+void SpatialReasoner::setPose(const std::string &object, const std::string &pose)
+{
+	std::unique_lock<std::shared_mutex> lock(mutex_);
+	std::string frame(frameOfObject(object));
+	objectOfFrame_[frame] = object;
+	poseOfObject_[object] = pose;
+	auto it = poseTranslations_.find(pose);
+	if(it != poseTranslations_.end()) {
+		positions_[frame] = it->second;
+		updateIndex(frame);
+	}
+}
+
+void SpatialReasoner::setTranslation(const std::string &pose, const std::array<double,3> &position)
+{
+	std::unique_lock<std::shared_mutex> lock(mutex_);
+	poseTranslations_[pose] = position;
+	for(auto &pair : poseOfObject_) {
+		if(pair.second != pose) continue;
+		std::string frame(frameOfObject(pair.first));
+		positions_[frame] = position;
+		updateIndex(frame);
+	}
+}
+
+std::array<double,3> SpatialReasoner::extentsOf(const std::string &frame) const
+{
+	// objects with unknown shape are represented by their position only
+	static const std::array<double,3> noExtents = {0.0, 0.0, 0.0};
+	auto it = objectOfFrame_.find(frame);
+	if(it == objectOfFrame_.end()) return noExtents;
+	auto jt = shapeOfObject_.find(it->second);
+	if(jt == shapeOfObject_.end()) return noExtents;
+	auto kt = regionOfShape_.find(jt->second);
+	if(kt == regionOfShape_.end()) return noExtents;
+	auto lt = regionExtents_.find(kt->second);
+	if(lt == regionExtents_.end()) return noExtents;
+	return lt->second;
+}
+
+void SpatialReasoner::updateIndex(const std::string &frame)
+{
+	auto it = positions_.find(frame);
+	if(it == positions_.end()) return;
+	index_.set(frame, BoundingBox::fromCenter(it->second, extentsOf(frame)));
+}
+
+std::string SpatialReasoner::objectOfFrame(const std::string &frame) const
+{
+	auto it = objectOfFrame_.find(frame);
+	return it == objectOfFrame_.end() ? frame : it->second;
+}
+
+AnswerBufferPtr SpatialReasoner::submitQuery(const RDFLiteralPtr &literal, int queryFlags)
+{
+	auto answerBuffer = std::make_shared<AnswerBuffer>();
+	auto channel = AnswerStream::Channel::create(answerBuffer);
+
+	auto propertyTerm = literal->propertyTerm();
+	if(propertyTerm->type() == TermType::STRING) {
+		auto &property = std::static_pointer_cast<StringTerm>(propertyTerm)->value();
+		auto it = relationProperties().find(property);
+		std::shared_lock<std::shared_mutex> lock(mutex_);
+		if(it != relationProperties().end()) {
+			answerRelation(it->second, *literal, queryFlags, channel);
+		}
+		else if(property == spatial::nearest) {
+			answerNearest(*literal, queryFlags, channel);
+		}
+	}
+	channel->push(AnswerStream::eos());
+
+	return answerBuffer;
+}
+
+void SpatialReasoner::answerRelation(SpatialRelation relation, const RDFLiteral &literal,
+                                     int queryFlags, const std::shared_ptr<AnswerStream::Channel> &channel)
+{
+	auto s = literal.subjectTerm();
+	auto o = literal.objectTerm();
+	bool oneSolution = (queryFlags & QUERY_FLAG_ONE_SOLUTION);
+
+	auto boxOf = [this](const TermPtr &term) {
+		return index_.get(frameOfObject(std::static_pointer_cast<StringTerm>(term)->value()));
+	};
+	// enumerate objects related to a known one, candidates are found by a window
+	// query on the index and filtered by the exact relation
+	auto forEachRelated = [&](const std::string &known, const BoundingBox &knownBox,
+	                          bool isSubject, const std::function<void(const std::string&)> &visitor) {
+		return index_.intersecting(window(relation, knownBox, isSubject),
+			[&](const std::string &frame, const BoundingBox &box) {
+				if(frame == known) return true;
+				if(isSubject ? holds(relation, knownBox, box) : holds(relation, box, knownBox)) {
+					visitor(frame);
+					return !oneSolution;
+				}
+				return true;
+			});
+	};
+
+	if(s->type() == TermType::STRING && o->type() == TermType::STRING) {
+		auto a = boxOf(s);
+		auto b = boxOf(o);
+		if(a.has_value() && b.has_value() &&
+		   frameOfObject(std::static_pointer_cast<StringTerm>(s)->value()) !=
+		   frameOfObject(std::static_pointer_cast<StringTerm>(o)->value()) &&
+		   holds(relation, a.value(), b.value())) {
+			channel->push(std::make_shared<Answer>());
+		}
+	}
+	else if(s->type() == TermType::STRING && o->type() == TermType::VARIABLE) {
+		auto box = boxOf(s);
+		if(!box.has_value()) return;
+		auto &var = *std::static_pointer_cast<Variable>(o);
+		std::string known(frameOfObject(std::static_pointer_cast<StringTerm>(s)->value()));
+		forEachRelated(known, box.value(), true, [&](const std::string &frame) {
+			auto answer = std::make_shared<Answer>();
+			answer->substitute(var, std::make_shared<StringTerm>(objectOfFrame(frame)));
+			channel->push(answer);
+		});
+	}
+	else if(s->type() == TermType::VARIABLE && o->type() == TermType::STRING) {
+		auto box = boxOf(o);
+		if(!box.has_value()) return;
+		auto &var = *std::static_pointer_cast<Variable>(s);
+		std::string known(frameOfObject(std::static_pointer_cast<StringTerm>(o)->value()));
+		forEachRelated(known, box.value(), false, [&](const std::string &frame) {
+			auto answer = std::make_shared<Answer>();
+			answer->substitute(var, std::make_shared<StringTerm>(objectOfFrame(frame)));
+			channel->push(answer);
+		});
+	}
+	else if(s->type() == TermType::VARIABLE && o->type() == TermType::VARIABLE) {
+		auto &sVar = *std::static_pointer_cast<Variable>(s);
+		auto &oVar = *std::static_pointer_cast<Variable>(o);
+		// the relations are irreflexive
+		if(sVar.name() == oVar.name()) return;
+		index_.forEach([&](const std::string &a, const BoundingBox &aBox) {
+			auto aTerm = std::make_shared<StringTerm>(objectOfFrame(a));
+			return forEachRelated(a, aBox, true, [&](const std::string &b) {
+				auto answer = std::make_shared<Answer>();
+				answer->substitute(sVar, aTerm);
+				answer->substitute(oVar, std::make_shared<StringTerm>(objectOfFrame(b)));
+				channel->push(answer);
+			});
+		});
+	}
+}
+
+void SpatialReasoner::answerNearest(const RDFLiteral &literal,
+                                    int queryFlags, const std::shared_ptr<AnswerStream::Channel> &channel)
+{
+	auto s = literal.subjectTerm();
+	auto o = literal.objectTerm();
+	if(s->type() != TermType::STRING) return;
+
+	std::string frame(frameOfObject(std::static_pointer_cast<StringTerm>(s)->value()));
+	auto box = index_.get(frame);
+	if(!box.has_value()) return;
+
+	// the nearest objects are all other objects at the smallest distance from the center of the object.
+	// note: the object itself is usually the first result.
+	std::optional<double> nearestDistance;
+	index_.nearest(box->center(), [&](const std::string &other, double distance) {
+		if(other == frame) return true;
+		if(nearestDistance.has_value() && distance > nearestDistance.value()) return false;
+		nearestDistance = distance;
+		if(o->type() == TermType::VARIABLE) {
+			auto answer = std::make_shared<Answer>();
+			answer->substitute(*std::static_pointer_cast<Variable>(o),
+			                   std::make_shared<StringTerm>(objectOfFrame(other)));
+			channel->push(answer);
+			return !(queryFlags & QUERY_FLAG_ONE_SOLUTION);
+		}
+		else if(o->type() == TermType::STRING) {
+			// nearest(A,B) holds if B is one of the closest objects to A
+			if(frameOfObject(std::static_pointer_cast<StringTerm>(o)->value()) == other) {
+				channel->push(std::make_shared<Answer>());
+				return false;
+			}
+			return true;
+		}
+		return false;
+	});
+}
+
+// fixture class for testing
+class SpatialReasonerTest : public ::testing::Test {
+protected:
+	SpatialReasoner reasoner_{"spatial"};
+
+	static std::string iri(const std::string &name)
+	{ return "http://knowrob.org/kb/test_spatial.owl#" + name; }
+
+	void place(const std::string &name, const char *translation)
+	{
+		auto object = iri(name);
+		auto pose = iri("Pose_" + name);
+		StatementData poseLink(object.c_str(), spatial::pose.data(), pose.c_str());
+		StatementData poseData(pose.c_str(), spatial::translation.data(), translation);
+		poseData.objectType = RDF_STRING_LITERAL;
+		reasoner_.onInsert({ poseLink, poseData });
+	}
+
+	void shape(const std::string &name, const char *depth, const char *width, const char *height)
+	{
+		auto object = iri(name);
+		auto shape = iri("Shape_" + name);
+		auto region = iri("Region_" + name);
+		std::vector<StatementData> statements = {
+			StatementData(object.c_str(), spatial::hasShape.data(), shape.c_str()),
+			StatementData(shape.c_str(), spatial::hasRegion.data(), region.c_str()),
+			StatementData(region.c_str(), spatial::hasDepth.data(), depth),
+			StatementData(region.c_str(), spatial::hasWidth.data(), width),
+			StatementData(region.c_str(), spatial::hasHeight.data(), height)
+		};
+		for(std::size_t i=2; i<statements.size(); ++i) statements[i].objectType = RDF_STRING_LITERAL;
+		reasoner_.onInsert(statements);
+	}
+
+	// arguments starting with '?' are variables, the answers are the local names
+	// of the objects bound to the variables in order of the arguments.
+	std::set<std::vector<std::string>> related(const std::string &s, std::string_view property, const std::string &o)
+	{
+		auto term = [](const std::string &arg) -> TermPtr {
+			if(arg[0] == '?') return std::make_shared<Variable>(arg.substr(1));
+			return std::make_shared<StringTerm>(iri(arg));
+		};
+		auto literal = std::make_shared<RDFLiteral>(
+				term(s), std::make_shared<StringTerm>(std::string(property)), term(o), false);
+		auto answerQueue = reasoner_.submitQuery(literal, QUERY_FLAG_ALL_SOLUTIONS)->createQueue();
+		std::set<std::vector<std::string>> result;
+		while(true) {
+			auto answer = answerQueue->pop_front();
+			if(AnswerStream::isEOS(answer)) break;
+			std::vector<std::string> values;
+			for(auto &arg : { s, o }) {
+				if(arg[0] != '?') continue;
+				auto value = std::static_pointer_cast<StringTerm>(
+						answer->substitution()->get(Variable(arg.substr(1))))->value();
+				values.emplace_back(frameOfObject(value));
+			}
+			result.insert(values);
+		}
+		return result;
+	}
+
+	// a table with a plate and a cup on it, and a lamp above it
+	void placeTableScene()
+	{
+		place("table", "0.0 0.0 0.0");
+		shape("table", "2.0", "2.0", "0.2");
+		place("plate", "0.5 0.5 0.02");
+		shape("plate", "0.2", "0.2", "0.02");
+		place("cup", "0.05 0.0 0.01");
+		place("lamp", "0.0 0.0 2.0");
+	}
+
+	std::set<std::string> nearest(const std::string &name)
+	{
+		static const Variable other("Other");
+		auto literal = std::make_shared<RDFLiteral>(
+				std::make_shared<StringTerm>(iri(name)),
+				std::make_shared<StringTerm>(std::string(spatial::nearest)),
+				std::make_shared<Variable>(other.name()), false);
+		auto answerQueue = reasoner_.submitQuery(literal, QUERY_FLAG_ALL_SOLUTIONS)->createQueue();
+		std::set<std::string> result;
+		while(true) {
+			auto answer = answerQueue->pop_front();
+			if(AnswerStream::isEOS(answer)) break;
+			result.insert(std::static_pointer_cast<StringTerm>(answer->substitution()->get(other))->value());
+		}
+		return result;
+	}
+};
+
+TEST_F(SpatialReasonerTest, PosesFromStatements)
+{
+	place("cup", "1.0 2.0 0.5");
+	auto box = reasoner_.boxIndex().get("cup");
+	ASSERT_TRUE(box.has_value());
+	EXPECT_EQ(box->center(), (std::array<double,3>{1.0, 2.0, 0.5}));
+	// a new translation of the pose moves the object
+	auto pose = iri("Pose_cup");
+	StatementData poseData(pose.c_str(), spatial::translation.data(), "3.0 2.0 0.5");
+	poseData.objectType = RDF_STRING_LITERAL;
+	reasoner_.onInsert({ poseData });
+	EXPECT_EQ(reasoner_.boxIndex().get("cup")->center(), (std::array<double,3>{3.0, 2.0, 0.5}));
+}
+
+TEST_F(SpatialReasonerTest, NearestObjects)
+{
+	place("cup", "0.0 0.0 0.0");
+	place("plate", "1.0 0.0 0.0");
+	place("bowl", "-1.0 0.0 0.0");
+	place("spoon", "3.0 0.0 0.0");
+	// objects at the same distance are all nearest
+	EXPECT_EQ(nearest("cup"), std::set<std::string>({ iri("plate"), iri("bowl") }));
+	EXPECT_EQ(nearest("spoon"), std::set<std::string>({ iri("plate") }));
+}
+
+using Bindings = std::set<std::vector<std::string>>;
+static const Bindings isTrue = {{}};
+
+TEST_F(SpatialReasonerTest, RelationsOfGroundObjects)
+{
+	placeTableScene();
+	EXPECT_EQ(related("plate", spatial::isInsideOf, "table"), isTrue);
+	EXPECT_TRUE(related("table", spatial::isInsideOf, "plate").empty());
+	EXPECT_EQ(related("plate", spatial::isOntopOf, "table"), isTrue);
+	EXPECT_TRUE(related("lamp", spatial::isOntopOf, "table").empty());
+	EXPECT_EQ(related("lamp", spatial::isAboveOf, "table"), isTrue);
+	EXPECT_TRUE(related("table", spatial::isAboveOf, "lamp").empty());
+	EXPECT_EQ(related("table", spatial::isBelowOf, "lamp"), isTrue);
+	EXPECT_TRUE(related("lamp", spatial::isBelowOf, "table").empty());
+	EXPECT_EQ(related("cup", spatial::isInCenterOf, "table"), isTrue);
+	EXPECT_TRUE(related("plate", spatial::isInCenterOf, "table").empty());
+	// the relations are irreflexive
+	EXPECT_TRUE(related("table", spatial::isInCenterOf, "table").empty());
+}
+
+TEST_F(SpatialReasonerTest, RelationsOfGroundSubject)
+{
+	placeTableScene();
+	EXPECT_EQ(related("cup", spatial::isInsideOf, "?X"), Bindings({{"table"}}));
+	EXPECT_EQ(related("plate", spatial::isOntopOf, "?X"), Bindings({{"table"}, {"cup"}}));
+	EXPECT_EQ(related("lamp", spatial::isAboveOf, "?X"), Bindings({{"table"}, {"plate"}, {"cup"}}));
+	EXPECT_EQ(related("table", spatial::isBelowOf, "?X"), Bindings({{"plate"}, {"cup"}, {"lamp"}}));
+	EXPECT_EQ(related("cup", spatial::isInCenterOf, "?X"), Bindings({{"table"}}));
+}
+
+TEST_F(SpatialReasonerTest, RelationsOfGroundObject)
+{
+	placeTableScene();
+	EXPECT_EQ(related("?X", spatial::isInsideOf, "table"), Bindings({{"plate"}, {"cup"}}));
+	EXPECT_EQ(related("?X", spatial::isOntopOf, "table"), Bindings({{"plate"}, {"cup"}}));
+	EXPECT_EQ(related("?X", spatial::isAboveOf, "table"), Bindings({{"plate"}, {"cup"}, {"lamp"}}));
+	EXPECT_EQ(related("?X", spatial::isBelowOf, "lamp"), Bindings({{"table"}, {"plate"}, {"cup"}}));
+	EXPECT_EQ(related("?X", spatial::isInCenterOf, "table"), Bindings({{"cup"}}));
+}
+
+TEST_F(SpatialReasonerTest, RelationsOfVariables)
+{
+	placeTableScene();
+	EXPECT_EQ(related("?A", spatial::isInsideOf, "?B"),
+			  Bindings({{"plate", "table"}, {"cup", "table"}}));
+	EXPECT_EQ(related("?A", spatial::isInCenterOf, "?B"),
+			  Bindings({{"cup", "table"}, {"table", "cup"}}));
+	EXPECT_EQ(related("?A", spatial::isBelowOf, "?B"), Bindings({
+			  {"table", "cup"}, {"table", "plate"}, {"table", "lamp"},
+			  {"cup", "plate"}, {"cup", "lamp"}, {"plate", "lamp"}}));
+	// the relations are irreflexive
+	EXPECT_TRUE(related("?A", spatial::isInCenterOf, "?A").empty());
+	// each answer of the var/var pattern is an answer of the ground patterns
+	for(auto property : { spatial::isInsideOf, spatial::isOntopOf, spatial::isAboveOf,
+	                      spatial::isBelowOf, spatial::isInCenterOf }) {
+		for(auto &pair : related("?A", property, "?B")) {
+			EXPECT_EQ(related(pair[0], property, pair[1]), isTrue);
+			EXPECT_EQ(related(pair[0], property, "?X").count({pair[1]}), 1);
+			EXPECT_EQ(related("?X", property, pair[1]).count({pair[0]}), 1);
+		}
+	}
+}
@@ -0,0 +1,899 @@
+/*
+ * Copyright (c) 2023, Daniel Beßler
+ * All rights reserved.
+ *
+ * This file is part of KnowRob, please consult
+ * https://github.com/knowrob/knowrob for license details.
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <string_view>
+#include <fmt/core.h>
+#include "knowrob/Logger.h"
+#include "knowrob/KnowledgeBase.h"
+#include "knowrob/reasoner/swrl/SWRLEngine.h"
+#include "knowrob/reasoner/ReasonerError.h"
+#include "knowrob/semweb/rdf.h"
+#include "knowrob/terms/Variable.h"
+
+using namespace knowrob;
+using namespace knowrob::swrl;
+
+static const std::string rdfType(semweb::rdf::type);
+
+// builtins that bind their first argument to the result of an operation on the other arguments
+static bool isBindingBuiltin(const std::string &name)
+{
+	static const std::set<std::string> builtins = {
+		"add", "subtract", "multiply", "divide", "mod", "abs", "stringConcat"
+	};
+	return builtins.count(name) > 0;
+}
+
+static bool isNumeric(RDFType type)
+{
+	return type == RDF_INT64_LITERAL || type == RDF_DOUBLE_LITERAL || type == RDF_BOOLEAN_LITERAL;
+}
+
+static double toNumber(const SWRLTerm &term)
+{
+	if(term.type == RDF_BOOLEAN_LITERAL) return (term.value == "true" || term.value == "1");
+	try {
+		return std::stod(term.value);
+	}
+	catch(const std::logic_error&) {
+		return std::nan("");
+	}
+}
+
+static bool isSameValue(const SWRLTerm &a, const SWRLTerm &b)
+{
+	if(isNumeric(a.type) || isNumeric(b.type)) return toNumber(a) == toNumber(b);
+	return a.value == b.value;
+}
+
+static SWRLTerm numberTerm(double value, bool isInteger)
+{
+	if(isInteger) return SWRLTerm::constant(std::to_string(static_cast<long>(value)), RDF_INT64_LITERAL);
+	return SWRLTerm::constant(fmt::format("{}", value), RDF_DOUBLE_LITERAL);
+}
+
+static const SWRLTerm& instantiate(const SWRLTerm &term, const SWRLBinding &binding)
+{
+	if(term.isVariable) {
+		auto it = binding.find(term.value);
+		if(it != binding.end()) return it->second;
+	}
+	return term;
+}
+
+static bool bindTerm(const SWRLTerm &arg, const SWRLTerm &value, SWRLBinding &binding)
+{
+	if(!arg.isVariable) return isSameValue(arg, value);
+	auto it = binding.find(arg.value);
+	if(it != binding.end()) return isSameValue(it->second, value);
+	binding.emplace(arg.value, value);
+	return true;
+}
+
+static void addVariables(const SWRLAtom &atom, std::set<std::string> &variables)
+{
+	for(auto &arg : atom.args) {
+		if(arg.isVariable) variables.insert(arg.value);
+	}
+}
+
+static bool isBound(const SWRLTerm &arg, const std::set<std::string> &bound)
+{
+	return !arg.isVariable || bound.count(arg.value) > 0;
+}
+
+SWRLEngine::SWRLEngine(semweb::VocabularyPtr vocabulary)
+: vocabulary_(std::move(vocabulary)),
+  numInferred_(0)
+{
+}
+
+static bool fromTerm(const TermPtr &term, RDFType stringType, std::string &value, RDFType &type)
+{
+	if(!term) return false;
+	switch(term->type()) {
+		case TermType::STRING:
+			value = std::static_pointer_cast<StringTerm>(term)->value();
+			type = stringType;
+			return true;
+		case TermType::DOUBLE:
+			value = fmt::format("{}", std::static_pointer_cast<DoubleTerm>(term)->value());
+			type = RDF_DOUBLE_LITERAL;
+			return true;
+		case TermType::LONG:
+			value = std::to_string(std::static_pointer_cast<LongTerm>(term)->value());
+			type = RDF_INT64_LITERAL;
+			return true;
+		case TermType::INT32:
+			value = std::to_string(std::static_pointer_cast<Integer32Term>(term)->value());
+			type = RDF_INT64_LITERAL;
+			return true;
+		default:
+			return false;
+	}
+}
+
+bool SWRLEngine::toFact(const StatementData &statement, SWRLFact &fact)
+{
+	if(statement.agent || statement.begin.has_value() || statement.end.has_value() ||
+	   statement.confidence.has_value()) return false;
+	if(statement.epistemicOperator.has_value() &&
+	   statement.epistemicOperator.value() != EpistemicOperator::KNOWLEDGE) return false;
+	if(statement.temporalOperator.has_value() &&
+	   statement.temporalOperator.value() != TemporalOperator::ALWAYS) return false;
+
+	fact.subject = statement.subject;
+	fact.property = statement.predicate;
+	fact.objectType = statement.objectType;
+	switch(statement.objectType) {
+		case RDF_INT64_LITERAL:
+			fact.object = std::to_string(statement.objectInteger);
+			break;
+		case RDF_DOUBLE_LITERAL:
+			fact.object = fmt::format("{}", statement.objectDouble);
+			break;
+		case RDF_BOOLEAN_LITERAL:
+			fact.object = (statement.objectInteger ? "true" : "false");
+			break;
+		default:
+			fact.object = statement.object;
+			break;
+	}
+	return true;
+}
+
+SWRLPattern SWRLEngine::toPattern(const RDFLiteral &literal)
+{
+	auto toPatternTerm = [](const TermPtr &term, RDFType stringType) {
+		SWRLTerm patternTerm;
+		if(!fromTerm(term, stringType, patternTerm.value, patternTerm.type)) {
+			// variables, and terms that cannot be converted, match any value
+			patternTerm = SWRLTerm::variable("_");
+		}
+		return patternTerm;
+	};
+	return {
+		toPatternTerm(literal.subjectTerm(), RDF_RESOURCE),
+		toPatternTerm(literal.propertyTerm(), RDF_RESOURCE),
+		toPatternTerm(literal.objectTerm(), RDF_RESOURCE) };
+}
+
+void SWRLEngine::addRule(const SWRLRulePtr &rule)
+{
+	// check arity of atoms
+	for(auto &atom : rule->body) {
+		if(atom.type == SWRLAtom::BUILTIN && atom.args.size() < 2) {
+			throw ReasonerError("builtin `{}` in SWRL rule `{}` requires at least two arguments.",
+			                    atom.name, rule->label);
+		}
+	}
+	for(auto &atom : rule->head) {
+		if(atom.type == SWRLAtom::BUILTIN) {
+			throw ReasonerError("builtin `{}` is not allowed in the head of SWRL rule `{}`.",
+			                    atom.name, rule->label);
+		}
+	}
+
+	auto fullPlan = compilePlan(rule, -1);
+	std::lock_guard<std::mutex> lock(mutex_);
+	fullPlans_[rule] = fullPlan;
+	for(uint32_t i=0; i<rule->body.size(); ++i) {
+		auto &atom = rule->body[i];
+		if(atom.type == SWRLAtom::BUILTIN) continue;
+		seedPlans_[atom.name].push_back(compilePlan(rule, static_cast<int>(i)));
+	}
+	rules_.push_back(rule);
+}
+
+const SWRLJoinPlan& SWRLEngine::fullPlan(const SWRLRulePtr &rule) const
+{
+	return fullPlans_.at(rule);
+}
+
+SWRLJoinPlan SWRLEngine::compilePlan(const SWRLRulePtr &rule, int seed) const
+{
+	SWRLJoinPlan plan;
+	plan.rule = rule;
+	plan.seed = seed;
+
+	std::set<std::string> bound;
+	std::vector<uint32_t> remaining;
+	for(uint32_t i=0; i<rule->body.size(); ++i) {
+		if(static_cast<int>(i) == seed) addVariables(rule->body[i], bound);
+		else remaining.push_back(i);
+	}
+
+	while(!remaining.empty()) {
+		int bestScore = -1;
+		auto best = remaining.end();
+		for(auto it=remaining.begin(); it!=remaining.end(); ++it) {
+			auto &atom = rule->body[*it];
+			int score;
+			if(atom.type == SWRLAtom::BUILTIN) {
+				// builtins are filters, and are evaluated as early as possible
+				auto firstInput = (isBindingBuiltin(atom.name) ? atom.args.begin()+1 : atom.args.begin());
+				if(!std::all_of(firstInput, atom.args.end(),
+						[&bound](auto &arg) { return isBound(arg, bound); })) continue;
+				score = 100;
+			}
+			else {
+				// prefer atoms with bound arguments, and property atoms over class atoms
+				score = 10 * static_cast<int>(std::count_if(atom.args.begin(), atom.args.end(),
+						[&bound](auto &arg) { return isBound(arg, bound); }));
+				if(atom.type == SWRLAtom::PROPERTY) score += 1;
+			}
+			if(score > bestScore) {
+				bestScore = score;
+				best = it;
+			}
+		}
+		if(best == remaining.end()) {
+			throw ReasonerError("SWRL rule `{}` has a builtin with arguments that are never bound.", rule->label);
+		}
+		addVariables(rule->body[*best], bound);
+		plan.steps.push_back(*best);
+		remaining.erase(best);
+	}
+
+	for(auto &atom : rule->head) {
+		for(auto &arg : atom.args) {
+			if(!isBound(arg, bound)) {
+				throw ReasonerError("variable `?{}` in the head of SWRL rule `{}` does not appear in its body.",
+				                    arg.value, rule->label);
+			}
+		}
+	}
+	return plan;
+}
+
+void SWRLEngine::forallSeedNames(const SWRLFact &fact, const std::function<void(const std::string&)> &visitor)
+{
+	// facts also match atoms of super-classes and super-properties
+	if(fact.property == rdfType) {
+		auto definedClass = vocabulary_->getDefinedClass(fact.object);
+		if(definedClass) definedClass->forallParents([&visitor](semweb::Class &x) { visitor(x.iri()); });
+		else visitor(fact.object);
+	}
+	else {
+		auto definedProperty = vocabulary_->getDefinedProperty(fact.property);
+		if(definedProperty) definedProperty->forallParents([&visitor](semweb::Property &x) { visitor(x.iri()); });
+		else visitor(fact.property);
+	}
+}
+
+bool SWRLEngine::isRelevant(const SWRLFact &fact)
+{
+	bool isRelevant = false;
+	forallSeedNames(fact, [this,&isRelevant](const std::string &name) {
+		if(seedPlans_.count(name) > 0) isRelevant = true;
+	});
+	return isRelevant;
+}
+
+bool SWRLEngine::unify(const SWRLAtom &atom, const SWRLFact &fact, SWRLBinding &binding)
+{
+	if(!bindTerm(atom.args[0], SWRLTerm::constant(fact.subject), binding)) return false;
+	if(atom.type == SWRLAtom::CLASS) return true;
+	return bindTerm(atom.args[1], SWRLTerm::constant(fact.object, fact.objectType), binding);
+}
+
+bool SWRLEngine::evaluateBuiltin(const SWRLAtom &atom, SWRLBinding &binding)
+{
+	auto &name = atom.name;
+	auto &a = instantiate(atom.args[0], binding);
+	auto &b = instantiate(atom.args[1], binding);
+
+	if(isBindingBuiltin(name)) {
+		if(name == "stringConcat") {
+			std::string result;
+			for(auto it=atom.args.begin()+1; it!=atom.args.end(); ++it) {
+				result += instantiate(*it, binding).value;
+			}
+			return bindTerm(atom.args[0], SWRLTerm::constant(result, RDF_STRING_LITERAL), binding);
+		}
+		bool isInteger = true;
+		std::vector<double> operands;
+		for(auto it=atom.args.begin()+1; it!=atom.args.end(); ++it) {
+			auto &operand = instantiate(*it, binding);
+			operands.push_back(toNumber(operand));
+			if(std::isnan(operands.back())) return false;
+			isInteger = isInteger && (operand.type == RDF_INT64_LITERAL);
+		}
+		double result;
+		if(name == "add") {
+			result = 0.0;
+			for(auto x : operands) result += x;
+		}
+		else if(name == "multiply") {
+			result = 1.0;
+			for(auto x : operands) result *= x;
+		}
+		else if(name == "abs") {
+			result = std::abs(operands[0]);
+		}
+		else if(operands.size() != 2) {
+			return false;
+		}
+		else if(name == "subtract") {
+			result = operands[0] - operands[1];
+		}
+		else if(operands[1] == 0.0) {
+			return false;
+		}
+		else if(name == "divide") {
+			result = operands[0] / operands[1];
+			isInteger = false;
+		}
+		else {
+			result = std::fmod(operands[0], operands[1]);
+		}
+		return bindTerm(atom.args[0], numberTerm(result, isInteger), binding);
+	}
+
+	if(name == "equal") return isSameValue(a, b);
+	if(name == "notEqual") return !isSameValue(a, b);
+	if(name == "startsWith") return a.value.rfind(b.value, 0) == 0;
+	if(name == "endsWith") {
+		return a.value.size() >= b.value.size() &&
+		       a.value.compare(a.value.size() - b.value.size(), b.value.size(), b.value) == 0;
+	}
+	if(name == "contains") return a.value.find(b.value) != std::string::npos;
+	if(name == "stringEqualIgnoreCase") {
+		return a.value.size() == b.value.size() &&
+		       std::equal(a.value.begin(), a.value.end(), b.value.begin(),
+		                  [](char x, char y) { return tolower(x) == tolower(y); });
+	}
+
+	// ordering of numbers, or of strings if one of the arguments is not a number
+	int order;
+	auto x = toNumber(a), y = toNumber(b);
+	if(std::isnan(x) || std::isnan(y)) order = a.value.compare(b.value);
+	else order = (x < y ? -1 : (x > y ? 1 : 0));
+	if(name == "lessThan") return order < 0;
+	if(name == "lessThanOrEqual") return order <= 0;
+	if(name == "greaterThan") return order > 0;
+	if(name == "greaterThanOrEqual") return order >= 0;
+	return false;
+}
+
+void SWRLEngine::join(const SWRLJoinPlan &plan, uint32_t stepIndex,
+                      SWRLBinding &binding, std::vector<SWRLFact> &premises,
+                      std::map<SWRLFact, SWRLDerivation> &derived)
+{
+	auto &rule = *plan.rule;
+
+	if(stepIndex == plan.steps.size()) {
+		// all body atoms are satisfied, instantiate the head
+		for(auto &atom : rule.head) {
+			SWRLFact fact;
+			fact.subject = instantiate(atom.args[0], binding).value;
+			if(atom.type == SWRLAtom::CLASS) {
+				fact.property = rdfType;
+				fact.object = atom.name;
+			}
+			else {
+				auto &object = instantiate(atom.args[1], binding);
+				fact.property = atom.name;
+				fact.object = object.value;
+				fact.objectType = object.type;
+			}
+			derived.emplace(fact, SWRLDerivation{ plan.rule, premises });
+		}
+		return;
+	}
+
+	auto &atom = rule.body[plan.steps[stepIndex]];
+	if(atom.type == SWRLAtom::BUILTIN) {
+		SWRLBinding next(binding);
+		if(evaluateBuiltin(atom, next)) {
+			join(plan, stepIndex+1, next, premises, derived);
+		}
+		return;
+	}
+
+	// matches are collected first such that no query is active while joining with the next atom
+	std::vector<SWRLFact> matches;
+	auto &subject = instantiate(atom.args[0], binding);
+	if(atom.type == SWRLAtom::CLASS) {
+		match(subject, rdfType, SWRLTerm::constant(atom.name),
+		      [&matches](const SWRLFact &fact) { matches.push_back(fact); });
+	}
+	else {
+		match(subject, atom.name, instantiate(atom.args[1], binding),
+		      [&matches](const SWRLFact &fact) { matches.push_back(fact); });
+	}
+
+	for(auto &fact : matches) {
+		SWRLBinding next(binding);
+		if(!unify(atom, fact, next)) continue;
+		premises.push_back(fact);
+		join(plan, stepIndex+1, next, premises, derived);
+		premises.pop_back();
+	}
+}
+
+void SWRLEngine::matchKnown(const std::vector<SWRLFact> &facts, std::vector<bool> &isKnown)
+{
+	for(uint32_t i=0; i<facts.size(); ++i) {
+		auto &fact = facts[i];
+		match(SWRLTerm::constant(fact.subject), fact.property,
+		      SWRLTerm::constant(fact.object, fact.objectType),
+		      [&isKnown, i](const SWRLFact&) { isKnown[i] = true; });
+	}
+}
+
+std::vector<SWRLFact> SWRLEngine::commit(std::map<SWRLFact, SWRLDerivation> &derived)
+{
+	// facts that were not inferred before are looked up in the fact store all at once
+	std::vector<SWRLFact> candidates;
+	for(auto &pair : derived) {
+		if(inferred_.count(pair.first) == 0) candidates.push_back(pair.first);
+	}
+	std::vector<bool> isKnown(candidates.size(), false);
+	if(!candidates.empty()) matchKnown(candidates, isKnown);
+
+	std::vector<SWRLFact> newFacts;
+	for(uint32_t i=0; i<candidates.size(); ++i) {
+		if(isKnown[i]) continue;
+		inferred_.emplace(candidates[i], std::move(derived[candidates[i]]));
+		newFacts.push_back(candidates[i]);
+	}
+	if(!newFacts.empty()) {
+		insertInferred(newFacts);
+		numInferred_ += newFacts.size();
+	}
+	return newFacts;
+}
+
+void SWRLEngine::propagate(std::vector<SWRLFact> delta)
+{
+	// semi-naive evaluation: only joins that involve a fact of the previous round can yield new facts
+	while(!delta.empty()) {
+		std::map<SWRLFact, SWRLDerivation> derived;
+		for(auto &fact : delta) {
+			bool isClassFact = (fact.property == rdfType);
+			forallSeedNames(fact, [&](const std::string &name) {
+				auto it = seedPlans_.find(name);
+				if(it == seedPlans_.end()) return;
+				for(auto &plan : it->second) {
+					auto &seedAtom = plan.rule->body[plan.seed];
+					if((seedAtom.type == SWRLAtom::CLASS) != isClassFact) continue;
+					SWRLBinding binding;
+					if(!unify(seedAtom, fact, binding)) continue;
+					std::vector<SWRLFact> premises = { fact };
+					join(plan, 0, binding, premises, derived);
+				}
+			});
+		}
+		delta = commit(derived);
+	}
+}
+
+void SWRLEngine::evaluate(const std::vector<SWRLRulePtr> &rules)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	evaluateRules(rules);
+}
+
+void SWRLEngine::evaluateRules(const std::vector<SWRLRulePtr> &rules)
+{
+	std::map<SWRLFact, SWRLDerivation> derived;
+	for(auto &rule : rules) {
+		SWRLBinding binding;
+		std::vector<SWRLFact> premises;
+		join(fullPlans_.at(rule), 0, binding, premises, derived);
+	}
+	propagate(commit(derived));
+}
+
+void SWRLEngine::insert(const std::vector<SWRLFact> &facts)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	std::vector<SWRLFact> delta;
+	for(auto &fact : facts) {
+		if(isRelevant(fact)) delta.push_back(fact);
+	}
+	propagate(delta);
+}
+
+bool SWRLEngine::matches(const SWRLPattern &pattern, const SWRLFact &fact)
+{
+	if(!pattern.subject.isVariable && pattern.subject.value != fact.subject) return false;
+	if(!pattern.object.isVariable &&
+	   !isSameValue(pattern.object, SWRLTerm::constant(fact.object, fact.objectType))) return false;
+	if(pattern.property.isVariable || pattern.property.value == fact.property) return true;
+	// a pattern of a property also matches facts of its sub-properties
+	bool isSubProperty = false;
+	auto definedProperty = vocabulary_->getDefinedProperty(fact.property);
+	if(definedProperty) definedProperty->forallParents([&](semweb::Property &x) {
+		if(x.iri() == pattern.property.value) isSubProperty = true;
+	});
+	return isSubProperty;
+}
+
+void SWRLEngine::remove(const std::vector<SWRLPattern> &patterns)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	if(patterns.empty() || inferred_.empty()) return;
+	auto isRemoved = [&](const SWRLFact &fact) {
+		return std::any_of(patterns.begin(), patterns.end(),
+			[&](const SWRLPattern &pattern) { return matches(pattern, fact); });
+	};
+
+	// inferred facts that were removed, or that were derived from a removed fact.
+	// the latter are still in the fact store and must be removed.
+	std::set<SWRLFact> deleted;
+	std::vector<SWRLFact> delta, removedInferred;
+	std::map<SWRLFact, std::vector<const SWRLFact*>> dependents;
+	for(auto &pair : inferred_) {
+		bool isFactRemoved = isRemoved(pair.first);
+		bool isAffected = isFactRemoved;
+		for(auto &premise : pair.second.premises) {
+			dependents[premise].push_back(&pair.first);
+			if(!isAffected) isAffected = isRemoved(premise);
+		}
+		if(!isAffected) continue;
+		deleted.insert(pair.first);
+		delta.push_back(pair.first);
+		if(!isFactRemoved) removedInferred.push_back(pair.first);
+	}
+	// facts derived from deleted facts are deleted as well
+	while(!delta.empty()) {
+		auto it = dependents.find(delta.back());
+		delta.pop_back();
+		if(it == dependents.end()) continue;
+		for(auto dependent : it->second) {
+			if(!deleted.insert(*dependent).second) continue;
+			delta.push_back(*dependent);
+			removedInferred.push_back(*dependent);
+		}
+	}
+	if(deleted.empty()) return;
+
+	if(!removedInferred.empty()) removeInferred(removedInferred);
+	std::set<std::string_view> deletedNames;
+	for(auto &fact : deleted) {
+		deletedNames.insert(fact.property == rdfType ? fact.object : fact.property);
+	}
+	// note: names point into facts of deleted which must outlive deletedNames
+	for(auto &fact : deleted) inferred_.erase(fact);
+
+	// only one derivation is remembered per fact, other derivations of
+	// deleted facts are found by evaluating the rules that infer them.
+	std::vector<SWRLRulePtr> affectedRules;
+	for(auto &rule : rules_) {
+		if(std::any_of(rule->head.begin(), rule->head.end(), [&](const SWRLAtom &atom) {
+			return atom.type != SWRLAtom::BUILTIN && deletedNames.count(atom.name) > 0; })) {
+			affectedRules.push_back(rule);
+		}
+	}
+	KB_DEBUG("SWRL engine retracted {} inferred facts, re-evaluating {} rules.",
+	         deleted.size(), affectedRules.size());
+	evaluateRules(affectedRules);
+}
+
+std::optional<SWRLDerivation> SWRLEngine::provenance(const SWRLFact &fact) const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto it = inferred_.find(fact);
+	if(it == inferred_.end()) return std::nullopt;
+	return it->second;
+}
+
+const std::string KnowledgeGraphSWRLEngine::INFERRED_GRAPH = "swrl";
+
+KnowledgeGraphSWRLEngine::KnowledgeGraphSWRLEngine(const KnowledgeGraphPtr &knowledgeGraph)
+: SWRLEngine(knowledgeGraph->vocabulary()),
+  knowledgeGraph_(knowledgeGraph)
+{
+}
+
+static TermPtr toTerm(const SWRLTerm &term)
+{
+	switch(term.type) {
+		case RDF_INT64_LITERAL:
+			return std::make_shared<LongTerm>(std::stol(term.value));
+		case RDF_DOUBLE_LITERAL:
+			return std::make_shared<DoubleTerm>(std::stod(term.value));
+		case RDF_BOOLEAN_LITERAL:
+			return std::make_shared<LongTerm>(term.value == "true");
+		default:
+			return std::make_shared<StringTerm>(term.value);
+	}
+}
+
+AnswerBufferPtr KnowledgeGraphSWRLEngine::submitMatch(const SWRLTerm &subject, const std::string &property,
+                                                      const SWRLTerm &object)
+{
+	static const auto s_var = std::make_shared<Variable>("S");
+	static const auto o_var = std::make_shared<Variable>("O");
+	auto literal = std::make_shared<RDFLiteral>(
+			subject.isVariable ? s_var : toTerm(subject),
+			std::make_shared<StringTerm>(property),
+			object.isVariable ? o_var : toTerm(object),
+			false);
+	return knowledgeGraph_->submitQuery(
+			std::make_shared<GraphQuery>(literal, QUERY_FLAG_ALL_SOLUTIONS));
+}
+
+void KnowledgeGraphSWRLEngine::readMatches(const AnswerBufferPtr &answerBuffer,
+                                           const SWRLTerm &subject, const std::string &property,
+                                           const SWRLTerm &object, const SWRLFactVisitor &visitor)
+{
+	static const Variable s_var("S");
+	static const Variable o_var("O");
+	// strings are literals if the property is a datatype property
+	auto definedProperty = vocabulary_->getDefinedProperty(property);
+	auto stringType = (definedProperty && definedProperty->hasFlag(semweb::DATATYPE_PROPERTY) ?
+			RDF_STRING_LITERAL : RDF_RESOURCE);
+	auto answerQueue = answerBuffer->createQueue();
+
+	SWRLFact fact;
+	fact.property = property;
+	RDFType subjectType;
+	while(true) {
+		auto answer = answerQueue->pop_front();
+		if(AnswerStream::isEOS(answer)) break;
+		auto &substitution = *answer->substitution();
+		if(subject.isVariable) {
+			if(!fromTerm(substitution.get(s_var), RDF_RESOURCE, fact.subject, subjectType)) continue;
+		}
+		else {
+			fact.subject = subject.value;
+		}
+		if(object.isVariable) {
+			if(!fromTerm(substitution.get(o_var), stringType, fact.object, fact.objectType)) continue;
+		}
+		else {
+			fact.object = object.value;
+			fact.objectType = object.type;
+		}
+		visitor(fact);
+	}
+}
+
+void KnowledgeGraphSWRLEngine::match(const SWRLTerm &subject, const std::string &property,
+                                     const SWRLTerm &object, const SWRLFactVisitor &visitor)
+{
+	readMatches(submitMatch(subject, property, object), subject, property, object, visitor);
+}
+
+void KnowledgeGraphSWRLEngine::matchKnown(const std::vector<SWRLFact> &facts, std::vector<bool> &isKnown)
+{
+	// facts with the same subject and property are looked up with a single query
+	// that leaves the object unbound, and all queries are submitted before
+	// their answers are read such that they are evaluated concurrently.
+	std::map<std::pair<std::string_view, std::string_view>, std::vector<uint32_t>> groups;
+	for(uint32_t i=0; i<facts.size(); ++i) {
+		groups[{ facts[i].subject, facts[i].property }].push_back(i);
+	}
+	std::vector<std::pair<const std::vector<uint32_t>*, AnswerBufferPtr>> lookups;
+	lookups.reserve(groups.size());
+	for(auto &group : groups) {
+		auto &first = facts[group.second[0]];
+		auto object = (group.second.size() == 1 ?
+				SWRLTerm::constant(first.object, first.objectType) : SWRLTerm::variable("O"));
+		lookups.emplace_back(&group.second,
+				submitMatch(SWRLTerm::constant(first.subject), first.property, object));
+	}
+	for(auto &lookup : lookups) {
+		auto &indices = *lookup.first;
+		auto &first = facts[indices[0]];
+		auto object = (indices.size() == 1 ?
+				SWRLTerm::constant(first.object, first.objectType) : SWRLTerm::variable("O"));
+		readMatches(lookup.second, SWRLTerm::constant(first.subject), first.property, object,
+			[&](const SWRLFact &match) {
+				auto matchObject = SWRLTerm::constant(match.object, match.objectType);
+				for(auto i : indices) {
+					if(isSameValue(SWRLTerm::constant(facts[i].object, facts[i].objectType), matchObject)) {
+						isKnown[i] = true;
+					}
+				}
+			});
+	}
+}
+
+StatementData KnowledgeGraphSWRLEngine::toStatement(const SWRLFact &fact)
+{
+	// note: the statement refers to the strings of the fact
+	StatementData data;
+	data.subject = fact.subject.c_str();
+	data.predicate = fact.property.c_str();
+	data.graph = INFERRED_GRAPH.c_str();
+	data.objectType = fact.objectType;
+	switch(fact.objectType) {
+		case RDF_INT64_LITERAL:
+			data.objectInteger = std::stol(fact.object);
+			break;
+		case RDF_DOUBLE_LITERAL:
+			data.objectDouble = std::stod(fact.object);
+			break;
+		case RDF_BOOLEAN_LITERAL:
+			data.objectInteger = (fact.object == "true");
+			break;
+		default:
+			data.object = fact.object.c_str();
+			break;
+	}
+	return data;
+}
+
+void KnowledgeGraphSWRLEngine::insertInferred(const std::vector<SWRLFact> &facts)
+{
+	std::vector<StatementData> statements;
+	statements.reserve(facts.size());
+	for(auto &fact : facts) statements.push_back(toStatement(fact));
+	if(!knowledgeGraph_->insert(statements)) {
+		KB_WARN("failed to insert {} facts inferred by SWRL rules.", facts.size());
+	}
+	else if(insertHandler_) {
+		insertHandler_(statements);
+	}
+}
+
+void KnowledgeGraphSWRLEngine::removeInferred(const std::vector<SWRLFact> &facts)
+{
+	std::vector<RDFLiteralPtr> literals;
+	literals.reserve(facts.size());
+	for(auto &fact : facts) literals.push_back(std::make_shared<RDFLiteral>(toStatement(fact)));
+	knowledgeGraph_->remove(literals);
+	if(removeHandler_) removeHandler_(literals);
+}
+
+// a SWRL engine that stores facts in memory
+class MemorySWRLEngine : public SWRLEngine {
+public:
+	MemorySWRLEngine() : SWRLEngine(std::make_shared<semweb::Vocabulary>()) {}
+	std::set<SWRLFact> facts;
+
+	void assertFact(const SWRLFact &fact)
+	{
+		facts.insert(fact);
+		insert({ fact });
+	}
+
+	void retractFact(const SWRLFact &fact)
+	{
+		facts.erase(fact);
+		remove({{ SWRLTerm::constant(fact.subject), SWRLTerm::constant(fact.property),
+		          SWRLTerm::constant(fact.object, fact.objectType) }});
+	}
+
+protected:
+	void match(const SWRLTerm &subject, const std::string &property,
+	           const SWRLTerm &object, const SWRLFactVisitor &visitor) override
+	{
+		for(auto &fact : facts) {
+			if(fact.property != property) continue;
+			if(!subject.isVariable && fact.subject != subject.value) continue;
+			if(!object.isVariable && !isSameValue(object, SWRLTerm::constant(fact.object, fact.objectType))) continue;
+			visitor(fact);
+		}
+	}
+
+	void insertInferred(const std::vector<SWRLFact> &newFacts) override
+	{ facts.insert(newFacts.begin(), newFacts.end()); }
+
+	void removeInferred(const std::vector<SWRLFact> &oldFacts) override
+	{ for(auto &fact : oldFacts) facts.erase(fact); }
+};
+
+// fixture class for testing
+class SWRLEngineTest : public ::testing::Test {
+protected:
+	MemorySWRLEngine engine_;
+
+	static SWRLFact fact(const std::string &s, const std::string &p, const std::string &o,
+	                     RDFType objectType=RDF_RESOURCE)
+	{ return { s, p, o, objectType }; }
+
+	void addRules(const std::string &text)
+	{
+		for(auto &rule : SWRLParser().parse(text)) engine_.addRule(rule);
+	}
+
+	bool has(const SWRLFact &x) const { return engine_.facts.count(x) > 0; }
+};
+
+TEST_F(SWRLEngineTest, RecursiveRules)
+{
+	addRules("hasParent(?x,?y) -> hasAncestor(?x,?y).\n"
+	         "hasAncestor(?x,?y), hasParent(?y,?z) -> hasAncestor(?x,?z).");
+	engine_.facts.insert(fact("a", "hasParent", "b"));
+	engine_.facts.insert(fact("b", "hasParent", "c"));
+	engine_.evaluateAll();
+	EXPECT_TRUE(has(fact("a", "hasAncestor", "c")));
+	EXPECT_EQ(engine_.numInferred(), 3);
+
+	// new facts are propagated incrementally
+	engine_.assertFact(fact("c", "hasParent", "d"));
+	EXPECT_TRUE(has(fact("a", "hasAncestor", "d")));
+	EXPECT_TRUE(has(fact("b", "hasAncestor", "d")));
+	EXPECT_EQ(engine_.numInferred(), 6);
+}
+
+TEST_F(SWRLEngineTest, RemoveFacts)
+{
+	addRules("hasParent(?x,?y) -> hasAncestor(?x,?y).\n"
+	         "hasAncestor(?x,?y), hasParent(?y,?z) -> hasAncestor(?x,?z).\n"
+	         "hasGodparent(?x,?y) -> hasAncestor(?x,?y).");
+	engine_.assertFact(fact("a", "hasParent", "b"));
+	engine_.assertFact(fact("b", "hasParent", "c"));
+	engine_.assertFact(fact("a", "hasGodparent", "c"));
+	EXPECT_TRUE(has(fact("a", "hasAncestor", "c")));
+
+	// facts derived from the removed fact are removed
+	engine_.retractFact(fact("b", "hasParent", "c"));
+	EXPECT_FALSE(has(fact("b", "hasAncestor", "c")));
+	EXPECT_TRUE(has(fact("a", "hasAncestor", "b")));
+	// unless they have another derivation
+	EXPECT_TRUE(has(fact("a", "hasAncestor", "c")));
+	auto derivation = engine_.provenance(fact("a", "hasAncestor", "c"));
+	ASSERT_TRUE(derivation.has_value());
+	EXPECT_EQ(derivation->premises.size(), 1);
+
+	engine_.retractFact(fact("a", "hasGodparent", "c"));
+	EXPECT_FALSE(has(fact("a", "hasAncestor", "c")));
+	EXPECT_FALSE(engine_.provenance(fact("a", "hasAncestor", "c")).has_value());
+}
+
+TEST_F(SWRLEngineTest, Provenance)
+{
+	addRules(":- { label: 'brother' }, Person(?p), hasSibling(?p,?s), Man(?s) -> hasBrother(?p,?s).");
+	engine_.assertFact(fact("fred", rdfType, "Person"));
+	engine_.assertFact(fact("fred", "hasSibling", "bob"));
+	EXPECT_FALSE(has(fact("fred", "hasBrother", "bob")));
+	engine_.assertFact(fact("bob", rdfType, "Man"));
+	EXPECT_TRUE(has(fact("fred", "hasBrother", "bob")));
+
+	auto derivation = engine_.provenance(fact("fred", "hasBrother", "bob"));
+	ASSERT_TRUE(derivation.has_value());
+	EXPECT_EQ(derivation->rule->label, "brother");
+	EXPECT_EQ(derivation->premises.size(), 3);
+	EXPECT_FALSE(engine_.provenance(fact("fred", "hasSibling", "bob")).has_value());
+}
+
+TEST_F(SWRLEngineTest, Builtins)
+{
+	addRules("Person(?p), hasAge(?p,?age), greaterThan(?age,17) -> Adult(?p).\n"
+	         "Rectangle(?r), hasWidth(?r,?w), hasHeight(?r,?h), multiply(?a,?w,?h) -> hasArea(?r,?a).\n"
+	         "Person(?p), hasNumber(?p,?n), startsWith(?n,\"+\") -> hasInternationalNumber(?p,true).");
+	engine_.assertFact(fact("fred", rdfType, "Person"));
+	engine_.assertFact(fact("fred", "hasAge", "34", RDF_INT64_LITERAL));
+	engine_.assertFact(fact("fred", "hasNumber", "+49421", RDF_STRING_LITERAL));
+	engine_.assertFact(fact("ann", rdfType, "Person"));
+	engine_.assertFact(fact("ann", "hasAge", "12", RDF_INT64_LITERAL));
+	engine_.assertFact(fact("r1", rdfType, "Rectangle"));
+	engine_.assertFact(fact("r1", "hasWidth", "4", RDF_INT64_LITERAL));
+	engine_.assertFact(fact("r1", "hasHeight", "2.5", RDF_DOUBLE_LITERAL));
+	EXPECT_TRUE(has(fact("fred", rdfType, "Adult")));
+	EXPECT_FALSE(has(fact("ann", rdfType, "Adult")));
+	EXPECT_TRUE(has(fact("r1", "hasArea", "10", RDF_DOUBLE_LITERAL)));
+	EXPECT_TRUE(has(fact("fred", "hasInternationalNumber", "true", RDF_BOOLEAN_LITERAL)));
+}
+
+TEST_F(SWRLEngineTest, JoinPlan)
+{
+	addRules("Person(?p), hasAge(?p,?age), greaterThan(?age,17) -> Adult(?p).");
+	auto &plan = engine_.fullPlan(engine_.rules()[0]);
+	ASSERT_EQ(plan.steps.size(), 3);
+	// the property atom is preferred, and the builtin is evaluated as soon as ?age is bound
+	EXPECT_EQ(plan.steps[0], 1);
+	EXPECT_EQ(plan.steps[1], 2);
+	EXPECT_EQ(plan.steps[2], 0);
+}
+
+TEST_F(SWRLEngineTest, UnsafeRules)
+{
+	EXPECT_THROW(addRules("Person(?p) -> hasParent(?p,?q)."), ReasonerError);
+	EXPECT_THROW(addRules("Person(?p), greaterThan(?age,17) -> Adult(?p)."), ReasonerError);
+}
@@ -9,6 +9,7 @@
 #include "knowrob/reasoner/prolog/PrologTests.h"
 #include "knowrob/reasoner/swrl/SWRLReasoner.h"
 #include "knowrob/reasoner/ReasonerManager.h"
+#include "knowrob/Logger.h"
 
 /*
 	- TODO: make swrl configurable for mongolog
@@ -46,10 +47,91 @@ SWRLReasoner::SWRLReasoner(const std::string &reasonerID)
             (const DataSourcePtr &dataFile) { return loadSWRLFile(dataFile); });
 }
 
+bool SWRLReasoner::loadConfiguration(const ReasonerConfiguration &cfg)
+{
+	// note: the engine must exist before data sources are loaded
+	if(cfg.ptree && cfg.ptree->get<bool>("bottom-up", false)) {
+		if(!knowledgeGraph_) {
+			KB_ERROR("SWRL reasoner `{}` requires a data backend for bottom-up evaluation.",
+					 reasonerIDTerm_->value());
+			return false;
+		}
+		engine_ = std::make_shared<swrl::KnowledgeGraphSWRLEngine>(knowledgeGraph_);
+		// inferred facts are written into the knowledge graph directly,
+		// so other reasoners and the Prolog tables of this reasoner are notified about them here.
+		// the engine itself is not notified as it already maintains its inferences.
+		engine_->setInsertHandler([this](const std::vector<StatementData> &statements) {
+			PrologReasoner::onInsert(statements);
+			forOtherReasoners([&statements](Reasoner &reasoner) { reasoner.onInsert(statements); });
+		});
+		engine_->setRemoveHandler([this](const std::vector<RDFLiteralPtr> &tripleExpressions) {
+			PrologReasoner::onRemove(tripleExpressions);
+			forOtherReasoners([&tripleExpressions](Reasoner &reasoner) { reasoner.onRemove(tripleExpressions); });
+		});
+	}
+	return PrologReasoner::loadConfiguration(cfg);
+}
+
+void SWRLReasoner::setDataBackend(const KnowledgeGraphPtr &knowledgeGraph)
+{
+	knowledgeGraph_ = knowledgeGraph;
+	PrologReasoner::setDataBackend(knowledgeGraph);
+}
+
+unsigned long SWRLReasoner::getCapabilities() const
+{
+	auto capabilities = PrologReasoner::getCapabilities();
+	if(engine_) capabilities |= CAPABILITY_BOTTOM_UP_EVALUATION;
+	return capabilities;
+}
+
+void SWRLReasoner::onInsert(const std::vector<StatementData> &statements)
+{
+	PrologReasoner::onInsert(statements);
+	if(!engine_) return;
+	std::vector<swrl::SWRLFact> facts;
+	for(auto &statement : statements) {
+		swrl::SWRLFact fact;
+		if(swrl::SWRLEngine::toFact(statement, fact)) facts.push_back(std::move(fact));
+	}
+	engine_->insert(facts);
+}
+
+void SWRLReasoner::onRemove(const std::vector<RDFLiteralPtr> &tripleExpressions)
+{
+	PrologReasoner::onRemove(tripleExpressions);
+	if(!engine_) return;
+	std::vector<swrl::SWRLPattern> patterns;
+	patterns.reserve(tripleExpressions.size());
+	for(auto &expr : tripleExpressions) {
+		patterns.push_back(swrl::SWRLEngine::toPattern(*expr));
+	}
+	engine_->remove(patterns);
+}
+
+void SWRLReasoner::forOtherReasoners(const std::function<void(Reasoner&)> &visitor)
+{
+	auto manager = ReasonerManager::getReasonerManager(reasonerManagerID());
+	if(!manager) return;
+	for(auto &pair : manager->reasonerPool()) {
+		auto &reasoner = pair.second->reasoner();
+		if(reasoner.get() != this) visitor(*reasoner);
+	}
+}
+
 bool SWRLReasoner::loadSWRLFile(const DataSourcePtr &dataFile)
 {
 	static auto consult_f = std::make_shared<PredicateIndicator>("swrl_file_load", 1);
 	auto path = getResourcePath(dataFile->uri());
+	if(engine_) {
+		auto rules = swrl::SWRLParser().parseFile(path);
+		for(auto &rule : rules) engine_->addRule(rule);
+		auto numInferred = engine_->numInferred();
+		engine_->evaluate(rules);
+		KB_INFO("loaded {} SWRL rules from `{}`, {} facts were inferred.",
+				rules.size(), path.native(), engine_->numInferred() - numInferred);
+		return true;
+	}
 	auto arg0 = std::make_shared<StringTerm>(path.native());
 	return eval(std::make_shared<Predicate>(Predicate(consult_f, { arg0 })));
 }
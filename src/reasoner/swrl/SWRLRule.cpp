@@ -0,0 +1,472 @@
+/*
+ * Copyright (c) 2023, Daniel Beßler
+ * All rights reserved.
+ *
+ * This file is part of KnowRob, please consult
+ * https://github.com/knowrob/knowrob for license details.
+ */
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include "knowrob/reasoner/swrl/SWRLRule.h"
+#include "knowrob/reasoner/ReasonerError.h"
+#include "knowrob/semweb/PrefixRegistry.h"
+
+using namespace knowrob;
+using namespace knowrob::swrl;
+
+#define SWRLB_NAMESPACE "http://www.w3.org/2003/11/swrlb#"
+
+static std::string trim(const std::string &str)
+{
+	auto begin = str.find_first_not_of(" \t\r\n");
+	if(begin == std::string::npos) return {};
+	auto end = str.find_last_not_of(" \t\r\n");
+	return str.substr(begin, end - begin + 1);
+}
+
+// split text at a separator that does not appear within quotes, parentheses or braces
+static std::vector<std::string> splitTopLevel(const std::string &text, const std::string &separator)
+{
+	std::vector<std::string> parts;
+	int depth = 0;
+	char quote = 0;
+	size_t begin = 0;
+	for(size_t i=0; i<text.size(); ++i) {
+		char c = text[i];
+		if(quote) {
+			if(c == quote) quote = 0;
+		}
+		else if(c == '"' || c == '\'') quote = c;
+		else if(c == '(' || c == '{') ++depth;
+		else if(c == ')' || c == '}') --depth;
+		else if(depth == 0 && text.compare(i, separator.size(), separator) == 0) {
+			parts.push_back(trim(text.substr(begin, i - begin)));
+			i += separator.size() - 1;
+			begin = i + 1;
+		}
+	}
+	parts.push_back(trim(text.substr(begin)));
+	return parts;
+}
+
+// @return the index of the parenthesis closing the one at position `open`
+static size_t closingParenthesis(const std::string &text, size_t open)
+{
+	int depth = 0;
+	char quote = 0;
+	for(size_t i=open; i<text.size(); ++i) {
+		char c = text[i];
+		if(quote) {
+			if(c == quote) quote = 0;
+		}
+		else if(c == '"' || c == '\'') quote = c;
+		else if(c == '(') ++depth;
+		else if(c == ')' && --depth == 0) return i;
+	}
+	throw ReasonerError("unbalanced parentheses in SWRL expression `{}`.", text);
+}
+
+static std::string unquote(const std::string &str)
+{
+	if(str.size() > 1 && (str[0] == '\'' || str[0] == '"') && str.back() == str[0]) {
+		return str.substr(1, str.size() - 2);
+	}
+	return str;
+}
+
+bool swrl::isSWRLBuiltin(const std::string &name)
+{
+	static const std::set<std::string> builtins = {
+		"equal", "notEqual", "lessThan", "lessThanOrEqual", "greaterThan", "greaterThanOrEqual",
+		"add", "subtract", "multiply", "divide", "mod", "abs",
+		"stringEqualIgnoreCase", "startsWith", "endsWith", "contains", "stringConcat"
+	};
+	std::string_view localName(name);
+	if(localName.rfind("swrlb:", 0) == 0) localName.remove_prefix(6);
+	else if(localName.rfind(SWRLB_NAMESPACE, 0) == 0) localName.remove_prefix(sizeof(SWRLB_NAMESPACE) - 1);
+	return builtins.count(std::string(localName)) > 0;
+}
+
+/**
+ * A class expression in disjunctive normal form, e.g. `(Driver or (Person and (hasChild value true)))`.
+ * Each disjunct is a list of atoms that all apply to the same term.
+ */
+struct SWRLParser::ClassExpression {
+	std::vector<std::vector<SWRLAtom>> disjuncts;
+
+	ClassExpression(const SWRLParser &parser, const std::string &text, const SWRLTerm &arg)
+	: parser_(parser), arg_(arg), pos_(0)
+	{
+		tokenize(text);
+		disjuncts = parseOr();
+		if(pos_ != tokens_.size()) {
+			throw ReasonerError("unexpected token `{}` in SWRL class expression `{}`.", tokens_[pos_], text);
+		}
+	}
+
+protected:
+	const SWRLParser &parser_;
+	const SWRLTerm &arg_;
+	std::vector<std::string> tokens_;
+	size_t pos_;
+
+	void tokenize(const std::string &text)
+	{
+		size_t i = 0;
+		while(i < text.size()) {
+			char c = text[i];
+			if(isspace(c)) { ++i; continue; }
+			if(c == '(' || c == ')') {
+				tokens_.emplace_back(1, c);
+				++i;
+			}
+			else if(c == '\'' || c == '"') {
+				auto end = text.find(c, i + 1);
+				if(end == std::string::npos) end = text.size() - 1;
+				tokens_.push_back(text.substr(i, end - i + 1));
+				i = end + 1;
+			}
+			else {
+				auto end = i;
+				while(end < text.size() && !isspace(text[end]) && text[end] != '(' && text[end] != ')') ++end;
+				tokens_.push_back(text.substr(i, end - i));
+				i = end;
+			}
+		}
+	}
+
+	const std::string& next()
+	{
+		if(pos_ >= tokens_.size()) throw ReasonerError("unexpected end of SWRL class expression.");
+		return tokens_[pos_++];
+	}
+
+	bool peek(const char *token) const
+	{ return pos_ < tokens_.size() && tokens_[pos_] == token; }
+
+	std::vector<std::vector<SWRLAtom>> parseOr()
+	{
+		auto result = parseAnd();
+		while(peek("or")) {
+			++pos_;
+			auto right = parseAnd();
+			result.insert(result.end(), right.begin(), right.end());
+		}
+		return result;
+	}
+
+	std::vector<std::vector<SWRLAtom>> parseAnd()
+	{
+		auto result = parsePrimary();
+		while(peek("and")) {
+			++pos_;
+			auto right = parsePrimary();
+			// distribute the conjunction over the disjuncts of both sides
+			std::vector<std::vector<SWRLAtom>> product;
+			for(auto &a : result) {
+				for(auto &b : right) {
+					auto &conjunct = product.emplace_back(a);
+					conjunct.insert(conjunct.end(), b.begin(), b.end());
+				}
+			}
+			result = std::move(product);
+		}
+		return result;
+	}
+
+	std::vector<std::vector<SWRLAtom>> parsePrimary()
+	{
+		auto &token = next();
+		if(token == "(") {
+			auto result = parseOr();
+			if(next() != ")") throw ReasonerError("missing `)` in SWRL class expression.");
+			return result;
+		}
+		if(token == "not" || token == "some" || token == "only") {
+			throw ReasonerError("unsupported operator `{}` in SWRL class expression.", token);
+		}
+		if(peek("value")) {
+			++pos_;
+			auto value = parser_.parseTerm(next());
+			return {{ SWRLAtom{ SWRLAtom::PROPERTY, parser_.resolve(token), { arg_, value }} }};
+		}
+		return {{ SWRLAtom{ SWRLAtom::CLASS, parser_.resolve(token), { arg_ }} }};
+	}
+};
+
+std::vector<SWRLRulePtr> SWRLParser::parseFile(const std::string &path)
+{
+	std::ifstream file(path);
+	if(!file.good()) {
+		throw ReasonerError("unable to read SWRL file `{}`.", path);
+	}
+	std::stringstream buffer;
+	buffer << file.rdbuf();
+	return parse(buffer.str());
+}
+
+std::vector<SWRLRulePtr> SWRLParser::parse(const std::string &text)
+{
+	std::vector<SWRLRulePtr> rules;
+	std::string clause;
+	char quote = 0;
+	int depth = 0;
+
+	for(size_t i=0; i<text.size(); ++i) {
+		char c = text[i];
+		if(quote) {
+			if(c == quote) quote = 0;
+		}
+		else if(c == '%') {
+			// skip comment until the end of the line
+			auto end = text.find('\n', i);
+			if(end == std::string::npos) break;
+			i = end;
+			c = '\n';
+		}
+		else if(c == '"' || c == '\'') quote = c;
+		else if(c == '(' || c == '{') ++depth;
+		else if(c == ')' || c == '}') --depth;
+		else if(c == '.' && depth == 0 && (i+1 == text.size() || isspace(text[i+1]))) {
+			parseClause(trim(clause), rules);
+			clause.clear();
+			continue;
+		}
+		clause += c;
+	}
+	if(!trim(clause).empty()) {
+		throw ReasonerError("SWRL clause `{}` is not terminated by a full stop.", trim(clause));
+	}
+	return rules;
+}
+
+void SWRLParser::parseClause(const std::string &clause_, std::vector<SWRLRulePtr> &rules)
+{
+	std::string clause(clause_);
+	if(clause.rfind(":-", 0) == 0) clause = trim(clause.substr(2));
+	if(clause.empty()) return;
+
+	if(clause.rfind("namespace(", 0) == 0) {
+		namespace_ = unquote(trim(clause.substr(10, closingParenthesis(clause, 9) - 10)));
+		return;
+	}
+
+	// read options of the rule, e.g. `{ label: 'Person' },`
+	std::string label;
+	if(clause[0] == '{') {
+		auto end = clause.find('}');
+		if(end == std::string::npos) throw ReasonerError("missing `}` in SWRL clause `{}`.", clause);
+		for(auto &option : splitTopLevel(clause.substr(1, end - 1), ",")) {
+			auto separator = option.find(':');
+			if(separator == std::string::npos) continue;
+			if(trim(option.substr(0, separator)) == "label") {
+				label = unquote(trim(option.substr(separator + 1)));
+			}
+		}
+		clause = trim(clause.substr(end + 1));
+		if(!clause.empty() && clause[0] == ',') clause = trim(clause.substr(1));
+	}
+
+	auto parts = splitTopLevel(clause, "->");
+	if(parts.size() != 2) {
+		throw ReasonerError("SWRL rule `{}` must have exactly one `->`.", clause);
+	}
+	std::vector<std::vector<SWRLAtom>> bodies, heads;
+	parseConjunction(parts[0], bodies);
+	parseConjunction(parts[1], heads);
+	if(heads.size() != 1) {
+		throw ReasonerError("disjunctions are not allowed in the head of SWRL rule `{}`.", clause);
+	}
+
+	for(size_t i=0; i<bodies.size(); ++i) {
+		auto rule = std::make_shared<SWRLRule>();
+		rule->label = (bodies.size() > 1 ? label + "_" + std::to_string(i) : label);
+		rule->body = bodies[i];
+		rule->head = heads[0];
+		rules.push_back(rule);
+	}
+}
+
+void SWRLParser::parseConjunction(const std::string &text, std::vector<std::vector<SWRLAtom>> &alternatives)
+{
+	alternatives = {{}};
+	for(auto &atomText : splitTopLevel(text, ",")) {
+		if(atomText.empty()) throw ReasonerError("empty atom in SWRL expression `{}`.", text);
+		parseAtom(atomText, alternatives);
+	}
+}
+
+void SWRLParser::parseAtom(const std::string &text, std::vector<std::vector<SWRLAtom>> &alternatives)
+{
+	std::vector<std::vector<SWRLAtom>> atomAlternatives;
+
+	if(text[0] == '(') {
+		// a class expression applied to a term, e.g. `(Man or Woman)(?x)`
+		auto end = closingParenthesis(text, 0);
+		auto argText = trim(text.substr(end + 1));
+		if(argText.size() < 2 || argText[0] != '(' || argText.back() != ')') {
+			throw ReasonerError("class expression `{}` must be applied to a single term.", text);
+		}
+		auto arg = parseTerm(trim(argText.substr(1, argText.size() - 2)));
+		atomAlternatives = ClassExpression(*this, text.substr(1, end - 1), arg).disjuncts;
+	}
+	else {
+		auto open = text.find('(');
+		if(open == std::string::npos || text.back() != ')') {
+			throw ReasonerError("invalid SWRL atom `{}`.", text);
+		}
+		auto name = trim(text.substr(0, open));
+		SWRLAtom atom;
+		for(auto &argText : splitTopLevel(text.substr(open + 1, text.size() - open - 2), ",")) {
+			atom.args.push_back(parseTerm(argText));
+		}
+		if(isSWRLBuiltin(name)) {
+			atom.type = SWRLAtom::BUILTIN;
+			atom.name = name.substr(name.find_last_of(":#") == std::string::npos ? 0 : name.find_last_of(":#") + 1);
+		}
+		else if(atom.args.size() == 1) {
+			atom.type = SWRLAtom::CLASS;
+			atom.name = resolve(name);
+		}
+		else if(atom.args.size() == 2) {
+			atom.type = SWRLAtom::PROPERTY;
+			atom.name = resolve(name);
+		}
+		else {
+			throw ReasonerError("SWRL atom `{}` has an unexpected number of arguments.", text);
+		}
+		atomAlternatives = {{ atom }};
+	}
+
+	// extend each alternative with each alternative of the atom
+	std::vector<std::vector<SWRLAtom>> product;
+	for(auto &a : alternatives) {
+		for(auto &b : atomAlternatives) {
+			auto &conjunct = product.emplace_back(a);
+			conjunct.insert(conjunct.end(), b.begin(), b.end());
+		}
+	}
+	alternatives = std::move(product);
+}
+
+SWRLTerm SWRLParser::parseTerm(const std::string &text) const
+{
+	if(text.empty()) throw ReasonerError("empty term in SWRL expression.");
+	if(text[0] == '?') return SWRLTerm::variable(text.substr(1));
+	if(text[0] == '"') return SWRLTerm::constant(unquote(text), RDF_STRING_LITERAL);
+	if(text[0] == '\'') return SWRLTerm::constant(resolve(unquote(text)));
+	if(text == "true" || text == "false") return SWRLTerm::constant(text, RDF_BOOLEAN_LITERAL);
+	if(isdigit(text[0]) || ((text[0] == '-' || text[0] == '+') && text.size() > 1 && isdigit(text[1]))) {
+		if(text.find_first_of(".eE") == std::string::npos) {
+			return SWRLTerm::constant(text, RDF_INT64_LITERAL);
+		}
+		return SWRLTerm::constant(text, RDF_DOUBLE_LITERAL);
+	}
+	return SWRLTerm::constant(resolve(text));
+}
+
+std::string SWRLParser::resolve(const std::string &name) const
+{
+	if(name.find("://") != std::string::npos) return name;
+	auto separator = name.find(':');
+	if(separator != std::string::npos) {
+		auto iri = semweb::PrefixRegistry::get().createIRI(
+				name.substr(0, separator), name.substr(separator + 1));
+		if(iri.has_value()) return iri.value();
+		throw ReasonerError("unknown namespace alias in SWRL name `{}`.", name);
+	}
+	return namespace_ + name;
+}
+
+static void writeTerm(std::ostream &os, const SWRLTerm &term)
+{
+	if(term.isVariable) os << '?' << term.value;
+	else if(term.type == RDF_STRING_LITERAL) os << '"' << term.value << '"';
+	else os << term.value;
+}
+
+namespace knowrob::swrl {
+	std::ostream& operator<<(std::ostream &os, const SWRLAtom &atom)
+	{
+		os << atom.name << '(';
+		for(size_t i=0; i<atom.args.size(); ++i) {
+			if(i > 0) os << ',';
+			writeTerm(os, atom.args[i]);
+		}
+		return os << ')';
+	}
+
+	std::ostream& operator<<(std::ostream &os, const SWRLRule &rule)
+	{
+		for(size_t i=0; i<rule.body.size(); ++i) {
+			if(i > 0) os << ", ";
+			os << rule.body[i];
+		}
+		os << " -> ";
+		for(size_t i=0; i<rule.head.size(); ++i) {
+			if(i > 0) os << ", ";
+			os << rule.head[i];
+		}
+		return os;
+	}
+}
+
+// fixture class for testing
+class SWRLParserTest : public ::testing::Test {
+protected:
+	static std::vector<SWRLRulePtr> parse(const std::string &text)
+	{ return SWRLParser().parse(":- namespace('http://knowrob.org/kb/swrl_test#').\n" + text); }
+};
+
+TEST_F(SWRLParserTest, PropertyAndBuiltinAtoms)
+{
+	auto rules = parse(":- { label: 'Adult' },\n"
+	                   "   Person(?p), hasAge(?p,?age), greaterThan(?age,17) % a comment\n"
+	                   "-> Adult(?p).");
+	ASSERT_EQ(rules.size(), 1);
+	auto &rule = *rules[0];
+	EXPECT_EQ(rule.label, "Adult");
+	ASSERT_EQ(rule.body.size(), 3);
+	ASSERT_EQ(rule.head.size(), 1);
+	EXPECT_EQ(rule.body[0].type, SWRLAtom::CLASS);
+	EXPECT_EQ(rule.body[0].name, "http://knowrob.org/kb/swrl_test#Person");
+	EXPECT_EQ(rule.body[1].type, SWRLAtom::PROPERTY);
+	EXPECT_TRUE(rule.body[1].args[1].isVariable);
+	EXPECT_EQ(rule.body[2].type, SWRLAtom::BUILTIN);
+	EXPECT_EQ(rule.body[2].name, "greaterThan");
+	EXPECT_EQ(rule.body[2].args[1].type, RDF_INT64_LITERAL);
+}
+
+TEST_F(SWRLParserTest, ClassExpressions)
+{
+	auto rules = parse(":- { label: 'Adult2' },\n"
+	                   "   (Driver or (Person and (hasChild value true)))(?x) -> Adult(?x).");
+	ASSERT_EQ(rules.size(), 2);
+	EXPECT_EQ(rules[0]->body.size(), 1);
+	ASSERT_EQ(rules[1]->body.size(), 2);
+	EXPECT_EQ(rules[1]->body[1].type, SWRLAtom::PROPERTY);
+	EXPECT_EQ(rules[1]->body[1].args[1].type, RDF_BOOLEAN_LITERAL);
+}
+
+TEST_F(SWRLParserTest, ConstantsAndErrors)
+{
+	auto rules = parse("Person(Fred), hasNumber(Fred,?n), startsWith(?n,\"+\") -> Driver(Fred).");
+	ASSERT_EQ(rules.size(), 1);
+	EXPECT_FALSE(rules[0]->body[0].args[0].isVariable);
+	EXPECT_EQ(rules[0]->body[0].args[0].value, "http://knowrob.org/kb/swrl_test#Fred");
+	EXPECT_EQ(rules[0]->body[2].args[1].type, RDF_STRING_LITERAL);
+	EXPECT_THROW(parse("Person(?x) Driver(?x)."), ReasonerError);
+	EXPECT_THROW(parse("Person(?x) -> (Man or Woman)(?x)."), ReasonerError);
+}
+
+TEST_F(SWRLParserTest, TestFile)
+{
+	auto path = std::filesystem::path(KNOWROB_SOURCE_DIR) / "tests" / "swrl" / "test.swrl";
+	std::vector<SWRLRulePtr> rules;
+	EXPECT_NO_THROW(rules = SWRLParser().parseFile(path));
+	EXPECT_GE(rules.size(), 10);
+}
@@ -35,14 +35,18 @@ ROSInterface::ROSInterface(const boost::property_tree::ptree& config)
         : askall_action_server_(nh_, "knowrob/askall", boost::bind(&ROSInterface::executeAskAllCB, this, _1), false),
           askone_action_server_(nh_, "knowrob/askone", boost::bind(&ROSInterface::executeAskOneCB, this, _1), false),
           askincremental_action_server_(nh_, "knowrob/askincremental", boost::bind(&ROSInterface::executeAskIncrementalCB, this, _1), false),
+          askpaged_action_server_(nh_, "knowrob/askpaged", boost::bind(&ROSInterface::executeAskPagedCB, this, _1), false),
           tell_action_server_(nh_, "knowrob/tell", boost::bind(&ROSInterface::executeTellCB, this, _1), false),
+          explain_action_server_(nh_, "knowrob/explain", boost::bind(&ROSInterface::executeExplainCB, this, _1), false),
           kb_(config)
 {
     // Start all action servers
     askall_action_server_.start();
     askone_action_server_.start();
     askincremental_action_server_.start();
+    askpaged_action_server_.start();
     tell_action_server_.start();
+    explain_action_server_.start();
 }
 
 ROSInterface::~ROSInterface() = default;
@@ -246,6 +250,50 @@ void ROSInterface::executeAskIncrementalCB(const askincrementalGoalConstPtr& goa
     askincremental_action_server_.setSucceeded(result);
 }
 
+void ROSInterface::executeAskPagedCB(const askpagedGoalConstPtr& goal)
+{
+    FormulaPtr phi(QueryParser::parse(goal->query.queryString));
+
+    FormulaPtr mPhi = applyModality(goal->query, phi);
+
+    // ask for one more answer than requested to find out if there is another page
+    auto resultStream = kb_.submitQuery(mPhi, QUERY_FLAG_ALL_SOLUTIONS, goal->limit + 1, goal->offset);
+    auto resultQueue = resultStream->createQueue();
+
+    uint32_t numSolutions_ = 0;
+    bool isTrue = false;
+    askpagedResult result;
+    result.hasMore = false;
+    while(true) {
+        auto nextResult = resultQueue->pop_front();
+
+        if(AnswerStream::isEOS(nextResult)) {
+            break;
+        }
+        else if(numSolutions_ == goal->limit) {
+            result.hasMore = true;
+            break;
+        }
+        else {
+            isTrue = true;
+            if (nextResult->substitution()->empty()) {
+                break;
+            } else {
+                result.answer.push_back(createGraphAnswer(nextResult));
+                numSolutions_ += 1;
+                // publish feedback
+                askpagedFeedback feedback;
+                feedback.numberOfSolutions = numSolutions_;
+                askpaged_action_server_.publishFeedback(feedback);
+            }
+        }
+    }
+
+    result.status = (isTrue ? askpagedResult::TRUE : askpagedResult::FALSE);
+    result.nextOffset = goal->offset + numSolutions_;
+    askpaged_action_server_.setSucceeded(result);
+}
+
 void ROSInterface::executeAskOneCB(const askoneGoalConstPtr& goal)
 {
     FormulaPtr phi(QueryParser::parse(goal->query.queryString));
@@ -274,10 +322,12 @@ void ROSInterface::executeAskOneCB(const askoneGoalConstPtr& goal)
     askone_action_server_.setSucceeded(result);
 }
 
-void ROSInterface::executeTellCB(const tellGoalConstPtr &goal) {
-    FormulaPtr phi(QueryParser::parse(goal->query.queryString));
+std::vector<RDFLiteralPtr> ROSInterface::readStatements(const GraphQueryMessage &query)
+{
+    std::vector<RDFLiteralPtr> statements;
+    if(query.queryString.empty()) return statements;
 
-    FormulaPtr mPhi = applyModality(goal->query, phi);
+    FormulaPtr phi(QueryParser::parse(query.queryString));
 
     const QueryTree qt(phi);
     if(qt.numPaths()>1) {
@@ -288,19 +338,40 @@ void ROSInterface::executeTellCB(const tellGoalConstPtr &goal) {
         throw QueryError("Invalid assertion: '{}'", *phi);
     }
 
-    std::vector<StatementData> data(qt.begin()->literals().size());
-    std::vector<RDFLiteralPtr> buf(qt.begin()->literals().size());
-    uint32_t dataIndex = 0;
+    statements.reserve(qt.begin()->literals().size());
     for(auto &lit : qt.begin()->literals()) {
-        buf[dataIndex] = RDFLiteral::fromLiteral(lit);
-        data[dataIndex++] = buf[dataIndex]->toStatementData();
+        statements.push_back(RDFLiteral::fromLiteral(lit));
+    }
+    return statements;
+}
+
+void ROSInterface::executeTellCB(const tellGoalConstPtr &goal) {
+    // note: the literals must be kept alive while statement data is used
+    auto asserted = readStatements(goal->query);
+    auto retracted = readStatements(goal->retract);
+
+    std::vector<StatementData> data(asserted.size());
+    for(uint32_t dataIndex=0; dataIndex<asserted.size(); ++dataIndex) {
+        data[dataIndex] = asserted[dataIndex]->toStatementData();
+    }
+
+    bool success;
+    if(retracted.empty()) {
+        success = kb_.insert(data);
+    }
+    else {
+        success = kb_.replace(retracted, data);
     }
 
     tellResult result;
     tellFeedback feedback;
-    if(kb_.insert(data)) {
+    if(success) {
         result.status = tellResult::TRUE;
-        std::cout << "success, " << dataIndex << " statement(s) were asserted." << "\n";
+        std::cout << "success, " << data.size() << " statement(s) were asserted";
+        if(!retracted.empty()) {
+            std::cout << " after removing statements of " << retracted.size() << " expression(s)";
+        }
+        std::cout << "." << "\n";
     }
     else {
         result.status = tellResult::TELL_FAILED;
@@ -311,6 +382,40 @@ void ROSInterface::executeTellCB(const tellGoalConstPtr &goal) {
     tell_action_server_.setSucceeded(result);
 }
 
+void ROSInterface::executeExplainCB(const explainGoalConstPtr &goal)
+{
+    FormulaPtr phi(QueryParser::parse(goal->query.queryString));
+
+    FormulaPtr mPhi = applyModality(goal->query, phi);
+
+    explainResult result;
+    std::stringstream planStream;
+    planStream << *kb_.explainQuery(mPhi, QUERY_FLAG_ALL_SOLUTIONS);
+    result.plan = planStream.str();
+    result.status = explainResult::TRUE;
+
+    if(goal->mode == explainGoal::PROFILE) {
+        auto profile = std::make_shared<QueryProfile>();
+        auto resultStream = kb_.submitQuery(mPhi, QUERY_FLAG_ALL_SOLUTIONS, profile);
+        auto resultQueue = resultStream->createQueue();
+
+        uint32_t numSolutions = 0;
+        while(!AnswerStream::isEOS(resultQueue->pop_front())) {
+            numSolutions += 1;
+        }
+        std::stringstream profileStream;
+        profileStream << *profile;
+        result.profile = profileStream.str();
+        result.numberOfSolutions = numSolutions;
+        result.status = (numSolutions > 0 ? explainResult::TRUE : explainResult::FALSE);
+    }
+
+    explainFeedback feedback;
+    feedback.finished = true;
+    explain_action_server_.publishFeedback(feedback);
+    explain_action_server_.setSucceeded(result);
+}
+
 boost::property_tree::ptree loadSetting() {
     // Check for settings file
     std::string config_path = "default.json";
@@ -2,6 +2,7 @@
 
 #include <knowrob/ros/tf/logger.h>
 #include <knowrob/mongodb/MongoInterface.h>
+#include <knowrob/Metrics.h>
 
 TFLogger::TFLogger(
 		ros::NodeHandle &node,
@@ -36,6 +37,12 @@ void TFLogger::store_document(bson_t *doc)
 
 void TFLogger::store(const geometry_msgs::TransformStamped &ts)
 {
+	static auto &numStored = knowrob::Metrics::get().counter(
+			"knowrob_tf_stored_total", "Number of transforms stored by the TF logger.");
+	static auto &storeLatency = knowrob::Metrics::get().histogram(
+			"knowrob_tf_store_seconds", "Time needed to store a transform.");
+	knowrob::MetricsTimer timer(storeLatency);
+	numStored.increment();
 	bson_t *doc = bson_new();
 	appendTransform(doc, ts);
 	BSON_APPEND_DATE_TIME(doc, "__recorded", time(NULL) * 1000);
@@ -46,6 +53,9 @@ void TFLogger::store(const geometry_msgs::TransformStamped &ts)
 
 void TFLogger::callback(const tf::tfMessage::ConstPtr& msg)
 {
+	static auto &numReceived = knowrob::Metrics::get().counter(
+			"knowrob_tf_received_total", "Number of transforms received by the TF logger.");
+	numReceived.increment(msg->transforms.size());
 	std::vector<geometry_msgs::TransformStamped>::const_iterator it;
 	for (it = msg->transforms.begin(); it != msg->transforms.end(); ++it)
 	{
@@ -1,4 +1,5 @@
 #include <knowrob/ros/tf/memory.h>
+#include <knowrob/reasoner/spatial/SpatialReasoner.h>
 
 static inline double get_stamp(const geometry_msgs::TransformStamped &ts)
 {
@@ -70,16 +71,30 @@ const geometry_msgs::TransformStamped& TFMemory::get_transform(
 
 void TFMemory::set_transform(const geometry_msgs::TransformStamped &ts)
 {
-	std::lock_guard<std::mutex> guard(transforms_lock_);
-	transforms_[buffer_index_][ts.child_frame_id] = ts;
+	{
+		std::lock_guard<std::mutex> guard(transforms_lock_);
+		transforms_[buffer_index_][ts.child_frame_id] = ts;
+	}
+	update_spatial_index(ts);
 }
 
 void TFMemory::set_managed_transform(const geometry_msgs::TransformStamped &ts)
 {
-	std::lock_guard<std::mutex> guard1(transforms_lock_);
-	std::lock_guard<std::mutex> guard2(names_lock_);
-	managed_frames_[buffer_index_].insert(ts.child_frame_id);
-	transforms_[buffer_index_][ts.child_frame_id] = ts;
+	{
+		std::lock_guard<std::mutex> guard1(transforms_lock_);
+		std::lock_guard<std::mutex> guard2(names_lock_);
+		managed_frames_[buffer_index_].insert(ts.child_frame_id);
+		transforms_[buffer_index_][ts.child_frame_id] = ts;
+	}
+	update_spatial_index(ts);
+}
+
+void TFMemory::update_spatial_index(const geometry_msgs::TransformStamped &ts)
+{
+	knowrob::SpatialReasoner::setObjectPose(ts.child_frame_id, ts.header.frame_id, {
+		ts.transform.translation.x,
+		ts.transform.translation.y,
+		ts.transform.translation.z });
 }
 
 bool TFMemory::loadTF(tf::tfMessage &tf_msg, bool clear_memory)
@@ -0,0 +1,184 @@
+//
+// Created by daniel on 18.10.26.
+//
+
+#include <gtest/gtest.h>
+#include "knowrob/Metrics.h"
+#include "knowrob/semweb/GroupCommitWriter.h"
+
+using namespace knowrob;
+using namespace knowrob::semweb;
+
+GroupCommitWriter::GroupCommitWriter(CommitFunction commit,
+                                     std::chrono::microseconds window,
+                                     uint32_t maxBatchSize)
+: commit_(std::move(commit)),
+  window_(window),
+  maxBatchSize_(maxBatchSize),
+  numPendingStatements_(0),
+  numWrites_(0),
+  numCommittedWrites_(0),
+  hasFlushRequest_(false),
+  isTerminated_(false),
+  numCommits_(0),
+  thread_(&GroupCommitWriter::run, this)
+{
+}
+
+GroupCommitWriter::~GroupCommitWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        isTerminated_ = true;
+    }
+    pendingCV_.notify_one();
+    // the commit thread commits pending writes before it exits
+    if(thread_.joinable()) thread_.join();
+}
+
+std::future<bool> GroupCommitWriter::write(const std::vector<StatementData> &statements)
+{
+    std::future<bool> future;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto &pendingWrite = pending_.emplace_back();
+        pendingWrite.statements = statements;
+        future = pendingWrite.promise.get_future();
+        numPendingStatements_ += statements.size();
+        numWrites_ += 1;
+    }
+    pendingCV_.notify_one();
+    return future;
+}
+
+void GroupCommitWriter::flush()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto numWrites = numWrites_;
+    if(numCommittedWrites_ >= numWrites) return;
+    // pending writes are committed without waiting for the window to elapse
+    if(!pending_.empty()) {
+        hasFlushRequest_ = true;
+        pendingCV_.notify_one();
+    }
+    committedCV_.wait(lock, [this, numWrites]{ return numCommittedWrites_ >= numWrites; });
+}
+
+void GroupCommitWriter::run()
+{
+    std::vector<PendingWrite> batch;
+    while(true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            pendingCV_.wait(lock, [this]{ return !pending_.empty() || isTerminated_; });
+            if(pending_.empty()) break;
+            // give concurrent writers a chance to join the batch
+            pendingCV_.wait_for(lock, window_, [this]{
+                return numPendingStatements_ >= maxBatchSize_ || hasFlushRequest_ || isTerminated_;
+            });
+            batch.swap(pending_);
+            numPendingStatements_ = 0;
+            hasFlushRequest_ = false;
+        }
+        commit(batch);
+        batch.clear();
+    }
+}
+
+void GroupCommitWriter::commit(std::vector<PendingWrite> &batch)
+{
+    static auto &numCommits = knowrob::Metrics::get().counter(
+            "knowrob_group_commits_total", "Number of batches committed by group commit writers.");
+    static auto &numWrites = knowrob::Metrics::get().counter(
+            "knowrob_group_commit_writes_total", "Number of writes coalesced into group commits.");
+    numCommits.increment();
+    numWrites.increment(batch.size());
+    numCommits_ += 1;
+
+    std::vector<StatementData> statements;
+    if(batch.size() == 1) {
+        statements.swap(batch[0].statements);
+    }
+    else {
+        size_t numStatements = 0;
+        for(auto &pendingWrite : batch) numStatements += pendingWrite.statements.size();
+        statements.reserve(numStatements);
+        for(auto &pendingWrite : batch) {
+            statements.insert(statements.end(),
+                              pendingWrite.statements.begin(),
+                              pendingWrite.statements.end());
+        }
+    }
+
+    try {
+        bool status = commit_(statements);
+        for(auto &pendingWrite : batch) pendingWrite.promise.set_value(status);
+    }
+    catch(...) {
+        auto error = std::current_exception();
+        for(auto &pendingWrite : batch) pendingWrite.promise.set_exception(error);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        numCommittedWrites_ += batch.size();
+    }
+    committedCV_.notify_all();
+}
+
+// fixture class for testing
+class GroupCommitWriterTest : public ::testing::Test {
+protected:
+    std::mutex mutex_;
+    std::vector<size_t> batchSizes_;
+
+    bool commit(const std::vector<StatementData> &statements) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        batchSizes_.push_back(statements.size());
+        return true;
+    }
+};
+
+TEST_F(GroupCommitWriterTest, CoalescesConcurrentWrites)
+{
+    std::vector<StatementData> statements = {
+        StatementData("a", "p", "b"),
+        StatementData("b", "p", "c") };
+    std::vector<std::future<bool>> futures;
+    {
+        // a long window such that all writes are added to the first batch
+        GroupCommitWriter writer(
+            [this](auto &batch){ return commit(batch); },
+            std::chrono::seconds(10), 6);
+        for(int i=0; i<3; ++i) futures.push_back(writer.write(statements));
+        for(auto &future : futures) EXPECT_TRUE(future.get());
+        EXPECT_EQ(writer.numCommits(), 1);
+    }
+    ASSERT_EQ(batchSizes_.size(), 1);
+    EXPECT_EQ(batchSizes_[0], 6);
+}
+
+TEST_F(GroupCommitWriterTest, FlushCommitsPendingWrites)
+{
+    // a long window that would delay the commit without flushing
+    GroupCommitWriter writer(
+        [this](auto &batch){ return commit(batch); },
+        std::chrono::seconds(10), 100);
+    auto future = writer.write({ StatementData("a", "p", "b") });
+    auto flushBegin = std::chrono::steady_clock::now();
+    writer.flush();
+    EXPECT_LT(std::chrono::steady_clock::now() - flushBegin, std::chrono::seconds(5));
+    EXPECT_EQ(future.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    EXPECT_EQ(writer.numCommits(), 1);
+    // nothing is pending anymore
+    writer.flush();
+    EXPECT_EQ(writer.numCommits(), 1);
+}
+
+TEST_F(GroupCommitWriterTest, PropagatesCommitErrors)
+{
+    GroupCommitWriter writer(
+        [](auto&) -> bool { throw std::runtime_error("write failed"); },
+        std::chrono::microseconds(100), 100);
+    auto future = writer.write({ StatementData("a", "p", "b") });
+    EXPECT_THROW(future.get(), std::runtime_error);
+}
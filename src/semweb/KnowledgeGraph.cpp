@@ -10,6 +10,7 @@
 #include <utility>
 
 #include "knowrob/Logger.h"
+#include "knowrob/Tracing.h"
 #include "knowrob/semweb/KnowledgeGraph.h"
 #include "knowrob/semweb/xsd.h"
 
@@ -25,15 +26,23 @@ namespace knowrob {
         KnowledgeGraph *kg_;
         GraphQueryPtr query_;
         AnswerBufferPtr result_;
+        StageProfilePtr profile_;
 
         GraphQueryRunner(
                 KnowledgeGraph *kg,
                 GraphQueryPtr query,
-                AnswerBufferPtr &result)
-        : kg_(kg), query_(std::move(query)), result_(result), ThreadPool::Runner()
+                AnswerBufferPtr &result,
+                StageProfilePtr profile)
+        : kg_(kg), query_(std::move(query)), result_(result), profile_(std::move(profile)), ThreadPool::Runner()
         {}
 
-        void run() override { kg_->evaluateQuery(query_, result_); }
+        void run() override {
+            TraceSpan span("GraphQueryRunner", query_->queryID());
+            // the query is evaluated in this worker thread, so its CPU time is measured here
+            int64_t cpuBegin = profile_ ? StageProfile::threadCPUTime() : 0;
+            kg_->evaluateQuery(query_, result_);
+            if(profile_) profile_->cpuTimeNs += StageProfile::threadCPUTime() - cpuBegin;
+        }
     };
 }
 
@@ -174,6 +183,20 @@ void KnowledgeGraph::setThreadPool(const std::shared_ptr<ThreadPool> &threadPool
     threadPool_ = threadPool;
 }
 
+void KnowledgeGraph::remove(const std::vector<RDFLiteralPtr> &tripleExpressions)
+{
+    for(auto &tripleExpression : tripleExpressions) {
+        removeAll(*tripleExpression);
+    }
+}
+
+bool KnowledgeGraph::replace(const std::vector<RDFLiteralPtr> &tripleExpressions,
+                             const std::vector<StatementData> &tripleData)
+{
+    remove(tripleExpressions);
+    return tripleData.empty() || insert(tripleData);
+}
+
 bool KnowledgeGraph::isDefinedResource(const std::string_view &iri)
 {
     return isDefinedClass(iri) || isDefinedProperty(iri);
@@ -189,10 +212,10 @@ bool KnowledgeGraph::isDefinedClass(const std::string_view &iri)
     return vocabulary_->isDefinedClass(iri);
 }
 
-AnswerBufferPtr KnowledgeGraph::submitQuery(const GraphQueryPtr &query)
+AnswerBufferPtr KnowledgeGraph::submitQuery(const GraphQueryPtr &query, const StageProfilePtr &profile)
 {
     AnswerBufferPtr result = std::make_shared<AnswerBuffer>();
-    auto runner = std::make_shared<GraphQueryRunner>(this, query, result);
+    auto runner = std::make_shared<GraphQueryRunner>(this, query, result, profile);
     if(!threadPool_) {
         threadPool_ = std::make_shared<ThreadPool>(4);
     }
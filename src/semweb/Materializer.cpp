@@ -0,0 +1,438 @@
+//
+// Created by daniel on 18.10.23.
+//
+
+#include <deque>
+#include <gtest/gtest.h>
+#include "knowrob/Logger.h"
+#include "knowrob/semweb/Materializer.h"
+#include "knowrob/semweb/rdf.h"
+#include "knowrob/semweb/rdfs.h"
+#include "knowrob/semweb/owl.h"
+
+using namespace knowrob::semweb;
+
+Materializer::Materializer(VocabularyPtr vocabulary)
+: vocabulary_(std::move(vocabulary)),
+  numDerived_(0),
+  numDeleted_(0)
+{
+}
+
+bool Materializer::isMaterializable(const StatementData &statement)
+{
+    return statement.subject && statement.predicate && statement.object &&
+           statement.objectType == RDF_RESOURCE &&
+           !statement.agent &&
+           !statement.begin.has_value() &&
+           !statement.end.has_value() &&
+           !statement.confidence.has_value() &&
+           statement.epistemicOperator.value_or(EpistemicOperator::KNOWLEDGE) == EpistemicOperator::KNOWLEDGE &&
+           statement.temporalOperator.value_or(TemporalOperator::ALWAYS) == TemporalOperator::ALWAYS;
+}
+
+bool Materializer::hasRules(const std::string_view &property) const
+{
+    if(Vocabulary::isTaxonomicProperty(property)) return false;
+    auto definedProperty = vocabulary_->getDefinedProperty(property);
+    if(!definedProperty) return false;
+
+    bool hasRule = false;
+    definedProperty->forallParents([&hasRule](Property &p) {
+        hasRule = hasRule ||
+                  p.hasFlag(TRANSITIVE_PROPERTY) ||
+                  p.hasFlag(SYMMETRIC_PROPERTY) ||
+                  p.inverse() ||
+                  !p.domains().empty() ||
+                  !p.ranges().empty();
+    });
+    return hasRule;
+}
+
+bool Materializer::isSchemaAxiom(const Triple &triple)
+{
+    if(isTypeIRI(triple.predicate)) {
+        return isTransitivePropertyIRI(triple.object) || isSymmetricPropertyIRI(triple.object);
+    }
+    else {
+        return isInverseOfIRI(triple.predicate) ||
+               isDomainIRI(triple.predicate) ||
+               isRangeIRI(triple.predicate) ||
+               isSubPropertyOfIRI(triple.predicate);
+    }
+}
+
+bool Materializer::isRelevant(const Triple &triple) const
+{
+    return isSchemaAxiom(triple) || hasRules(triple.predicate);
+}
+
+bool Materializer::TripleIndex::add(const Triple &triple, Vocabulary &vocabulary)
+{
+    if(!triples.insert(triple).second) return false;
+    // index the triple for the property and all its super properties
+    auto property = vocabulary.getDefinedProperty(triple.predicate);
+    if(property) {
+        property->forallParents([this,&triple](Property &p) {
+            bySubject[{p.iri(), triple.subject}].push_back(triple.object);
+            byObject[{p.iri(), triple.object}].push_back(triple.subject);
+        });
+    }
+    else {
+        bySubject[{triple.predicate, triple.subject}].push_back(triple.object);
+        byObject[{triple.predicate, triple.object}].push_back(triple.subject);
+    }
+    return true;
+}
+
+bool Materializer::contains(const Triple &triple, bool *isDerivedOnly)
+{
+    bool isFound = false, isExplicit = false;
+    match(&triple.subject, triple.predicate, &triple.object,
+          [&isFound,&isExplicit](const Triple&, bool isDerived) {
+        isFound = true;
+        isExplicit = isExplicit || !isDerived;
+    });
+    if(isDerivedOnly) *isDerivedOnly = isFound && !isExplicit;
+    return isFound;
+}
+
+void Materializer::matchAll(const std::string_view &property, std::vector<Triple> &out)
+{
+    std::string propertyIRI(property);
+    match(nullptr, propertyIRI, nullptr, [&out](const Triple &triple, bool) {
+        out.push_back(triple);
+    });
+}
+
+void Materializer::consequences(const Triple &triple, const TripleIndex &index, std::vector<Triple> &out)
+{
+    if(Vocabulary::isTaxonomicProperty(triple.predicate)) return;
+    auto property = vocabulary_->getDefinedProperty(triple.predicate);
+    if(!property) return;
+
+    // a triple (x P y) also counts as (x Q y) for all super properties Q of P
+    property->forallParents([this,&triple,&index,&out](Property &q) {
+        const auto &qIRI = q.iri();
+        if(q.hasFlag(TRANSITIVE_PROPERTY)) {
+            // (x Q y), (y Q z) -> (x Q z)
+            match(&triple.object, qIRI, nullptr, [&](const Triple &next, bool) {
+                out.push_back({triple.subject, qIRI, next.object});
+            });
+            auto it = index.bySubject.find({qIRI, triple.object});
+            if(it != index.bySubject.end()) {
+                for(auto &z : it->second) out.push_back({triple.subject, qIRI, z});
+            }
+            // (w Q x), (x Q y) -> (w Q y)
+            match(nullptr, qIRI, &triple.subject, [&](const Triple &previous, bool) {
+                out.push_back({previous.subject, qIRI, triple.object});
+            });
+            it = index.byObject.find({qIRI, triple.subject});
+            if(it != index.byObject.end()) {
+                for(auto &w : it->second) out.push_back({w, qIRI, triple.object});
+            }
+        }
+        if(q.hasFlag(SYMMETRIC_PROPERTY)) {
+            out.push_back({triple.object, qIRI, triple.subject});
+        }
+        if(q.inverse()) {
+            out.push_back({triple.object, q.inverse()->iri(), triple.subject});
+        }
+        for(auto &domain : q.domains()) {
+            out.push_back({triple.subject, std::string(rdf::type), domain->iri()});
+        }
+        for(auto &range : q.ranges()) {
+            out.push_back({triple.object, std::string(rdf::type), range->iri()});
+        }
+    });
+}
+
+bool Materializer::hasDerivation(const Triple &triple)
+{
+    if(isTypeIRI(triple.predicate)) {
+        // (x P y) -> (x rdf:type C) if C is a domain of P,
+        // and (y rdf:type C) if C is a range of P
+        bool hasPremise = false;
+        for(auto &p : vocabulary_->getDefinedPropertiesWithPrefix("")) {
+            for(auto &domain : p->domains()) {
+                if(domain->iri() != triple.object) continue;
+                match(&triple.subject, p->iri(), nullptr, [&hasPremise](const Triple&, bool) { hasPremise = true; });
+                if(hasPremise) return true;
+            }
+            for(auto &range : p->ranges()) {
+                if(range->iri() != triple.object) continue;
+                match(nullptr, p->iri(), &triple.subject, [&hasPremise](const Triple&, bool) { hasPremise = true; });
+                if(hasPremise) return true;
+            }
+        }
+        return false;
+    }
+
+    auto property = vocabulary_->getDefinedProperty(triple.predicate);
+    if(!property) return false;
+    // (y Q x) -> (x Q y)
+    if(property->hasFlag(SYMMETRIC_PROPERTY) &&
+       contains({triple.object, triple.predicate, triple.subject})) return true;
+    // (y R x) -> (x Q y) if R is the inverse of Q
+    if(property->inverse() &&
+       contains({triple.object, property->inverse()->iri(), triple.subject})) return true;
+    // (x Q m), (m Q y) -> (x Q y)
+    if(property->hasFlag(TRANSITIVE_PROPERTY)) {
+        std::set<std::string> successors;
+        match(&triple.subject, triple.predicate, nullptr, [&successors](const Triple &next, bool) {
+            successors.insert(next.object);
+        });
+        bool hasPath = false;
+        if(!successors.empty()) {
+            match(nullptr, triple.predicate, &triple.object, [&](const Triple &previous, bool) {
+                hasPath = hasPath || (successors.count(previous.subject) > 0);
+            });
+        }
+        if(hasPath) return true;
+    }
+    return false;
+}
+
+void Materializer::derive(const std::vector<Triple> &delta)
+{
+    // semi-naive evaluation: only consequences of new triples are computed in each step.
+    // new triples are kept in memory until the fixpoint is reached, and are then stored at once.
+    TripleIndex pending;
+    std::vector<Triple> derived, candidates;
+    std::deque<Triple> queue(delta.begin(), delta.end());
+
+    while(!queue.empty()) {
+        auto next = std::move(queue.front());
+        queue.pop_front();
+
+        candidates.clear();
+        consequences(next, pending, candidates);
+        for(auto &candidate : candidates) {
+            if(pending.triples.count(candidate) > 0 || contains(candidate)) continue;
+            pending.add(candidate, *vocabulary_);
+            derived.push_back(candidate);
+            queue.push_back(candidate);
+        }
+    }
+
+    if(!derived.empty()) {
+        KB_DEBUG("materialized {} triples.", derived.size());
+        insertDerived(derived);
+        numDerived_ += derived.size();
+    }
+}
+
+void Materializer::addSchemaChanges(const std::vector<Triple> &triples, std::vector<Triple> &delta)
+{
+    // axioms that add rules for a property require to derive consequences of
+    // all triples with the property.
+    std::set<std::string> properties;
+    for(auto &triple : triples) {
+        if(!isSchemaAxiom(triple)) continue;
+        properties.insert(triple.subject);
+        if(isInverseOfIRI(triple.predicate)) properties.insert(triple.object);
+    }
+    for(auto &property : properties) {
+        if(hasRules(property)) matchAll(property, delta);
+    }
+}
+
+void Materializer::insert(const std::vector<Triple> &insertedTriples)
+{
+    std::lock_guard<std::mutex> scoped_lock(mutex_);
+    std::vector<Triple> delta;
+    for(auto &triple : insertedTriples) {
+        if(hasRules(triple.predicate)) delta.push_back(triple);
+    }
+    addSchemaChanges(insertedTriples, delta);
+    derive(delta);
+}
+
+void Materializer::remove(const std::vector<Triple> &removedTriples)
+{
+    std::lock_guard<std::mutex> scoped_lock(mutex_);
+    // triples that are not stored anymore, but that must be considered when
+    // computing consequences of removed triples
+    TripleIndex removed;
+    std::vector<Triple> overDeleted;
+    std::deque<Triple> queue;
+
+    for(auto &triple : removedTriples) {
+        if(!hasRules(triple.predicate)) continue;
+        bool isDerivedOnly = false;
+        if(contains(triple, &isDerivedOnly)) {
+            // the triple is still asserted, e.g. in another graph
+            if(!isDerivedOnly) continue;
+            // a derived copy of the triple must be checked for alternative derivations
+            overDeleted.push_back(triple);
+        }
+        if(removed.add(triple, *vocabulary_)) queue.push_back(triple);
+    }
+
+    // (1) overdelete: delete all derived triples that depend on removed triples
+    std::vector<Triple> candidates;
+    while(!queue.empty()) {
+        auto next = std::move(queue.front());
+        queue.pop_front();
+
+        candidates.clear();
+        consequences(next, removed, candidates);
+        for(auto &candidate : candidates) {
+            if(removed.triples.count(candidate) > 0) continue;
+            // explicit triples are never deleted, and do not need to be propagated
+            bool isDerivedOnly = false;
+            if(!contains(candidate, &isDerivedOnly) || !isDerivedOnly) continue;
+            removed.add(candidate, *vocabulary_);
+            overDeleted.push_back(candidate);
+            queue.push_back(candidate);
+        }
+    }
+    if(!overDeleted.empty()) {
+        removeDerived(overDeleted);
+        numDeleted_ += overDeleted.size();
+    }
+
+    // (2) rederive: re-insert triples that have an alternative derivation,
+    //     and derive the consequences of re-inserted triples.
+    std::vector<Triple> rederived;
+    for(auto &triple : removed.triples) {
+        if(hasDerivation(triple) && !contains(triple)) rederived.push_back(triple);
+    }
+    if(!rederived.empty()) {
+        insertDerived(rederived);
+        numDerived_ += rederived.size();
+        derive(rederived);
+    }
+}
+
+void Materializer::materializeAll()
+{
+    std::lock_guard<std::mutex> scoped_lock(mutex_);
+    removeAllDerived();
+    std::vector<Triple> delta;
+    for(auto &property : vocabulary_->getDefinedPropertiesWithPrefix("")) {
+        if(hasRules(property->iri())) matchAll(property->iri(), delta);
+    }
+    derive(delta);
+}
+
+// an in-memory knowledge graph used for testing
+class MemoryMaterializer : public Materializer {
+public:
+    explicit MemoryMaterializer(const VocabularyPtr &vocabulary) : Materializer(vocabulary) {}
+    std::map<Triple,bool> triples_;
+
+    void assertTriple(const std::string &s, const std::string &p, const std::string &o)
+    {
+        triples_[{s,p,o}] = false;
+        insert({{s,p,o}});
+    }
+    void retractTriple(const std::string &s, const std::string &p, const std::string &o)
+    {
+        triples_.erase({s,p,o});
+        remove({{s,p,o}});
+    }
+    bool has(const std::string &s, const std::string &p, const std::string &o)
+    {
+        return triples_.count({s,p,o}) > 0;
+    }
+
+protected:
+    void match(const std::string *s, const std::string &p, const std::string *o,
+               const TripleVisitor &visitor) override
+    {
+        for(auto &pair : triples_) {
+            auto &t = pair.first;
+            if(s && t.subject != *s) continue;
+            if(o && t.object != *o) continue;
+            bool isSubProperty = (t.predicate == p);
+            auto property = vocabulary_->getDefinedProperty(t.predicate);
+            if(!isSubProperty && property) {
+                property->forallParents([&](Property &parent) {
+                    isSubProperty = isSubProperty || parent.iri() == p;
+                });
+            }
+            if(isSubProperty) visitor(t, pair.second);
+        }
+    }
+    void insertDerived(const std::vector<Triple> &triples) override
+    { for(auto &t : triples) triples_[t] = true; }
+    void removeDerived(const std::vector<Triple> &triples) override
+    { for(auto &t : triples) triples_.erase(t); }
+    void removeAllDerived() override
+    { for(auto it=triples_.begin(); it!=triples_.end();) it = (it->second ? triples_.erase(it) : ++it); }
+};
+
+// fixture class for testing
+class MaterializerTest : public ::testing::Test {
+protected:
+    VocabularyPtr vocabulary_;
+    std::shared_ptr<MemoryMaterializer> kg_;
+    void SetUp() override {
+        vocabulary_ = std::make_shared<Vocabulary>();
+        vocabulary_->setPropertyFlag("partOf", TRANSITIVE_PROPERTY);
+        vocabulary_->setPropertyFlag("adjacentTo", SYMMETRIC_PROPERTY);
+        vocabulary_->setInverseOf("hasPart", "partOf");
+        vocabulary_->addPropertyDomain("hasPart", "Whole");
+        kg_ = std::make_shared<MemoryMaterializer>(vocabulary_);
+    }
+};
+
+TEST_F(MaterializerTest, TransitiveClosure)
+{
+    kg_->assertTriple("a", "partOf", "b");
+    kg_->assertTriple("c", "partOf", "d");
+    kg_->assertTriple("b", "partOf", "c");
+    EXPECT_TRUE(kg_->has("a", "partOf", "c"));
+    EXPECT_TRUE(kg_->has("a", "partOf", "d"));
+    EXPECT_TRUE(kg_->has("b", "partOf", "d"));
+    // inverse and domain of the inverse
+    EXPECT_TRUE(kg_->has("d", "hasPart", "a"));
+    EXPECT_TRUE(kg_->has("d", std::string(rdf::type), "Whole"));
+}
+
+TEST_F(MaterializerTest, SymmetricProperty)
+{
+    kg_->assertTriple("a", "adjacentTo", "b");
+    EXPECT_TRUE(kg_->has("b", "adjacentTo", "a"));
+    kg_->retractTriple("a", "adjacentTo", "b");
+    EXPECT_FALSE(kg_->has("b", "adjacentTo", "a"));
+}
+
+TEST_F(MaterializerTest, DeleteRederive)
+{
+    kg_->assertTriple("a", "partOf", "b");
+    kg_->assertTriple("b", "partOf", "c");
+    kg_->assertTriple("a", "partOf", "x");
+    kg_->assertTriple("x", "partOf", "c");
+    // (a partOf c) has two derivations, it must survive removal of one of them
+    kg_->retractTriple("b", "partOf", "c");
+    EXPECT_TRUE(kg_->has("a", "partOf", "c"));
+    EXPECT_FALSE(kg_->has("c", "hasPart", "b"));
+    EXPECT_TRUE(kg_->has("c", "hasPart", "a"));
+    // no derivation is left
+    kg_->retractTriple("x", "partOf", "c");
+    EXPECT_FALSE(kg_->has("a", "partOf", "c"));
+    EXPECT_FALSE(kg_->has("c", std::string(rdf::type), "Whole"));
+    EXPECT_TRUE(kg_->has("b", std::string(rdf::type), "Whole"));
+}
+
+TEST_F(MaterializerTest, SchemaChange)
+{
+    kg_->assertTriple("a", "locatedIn", "b");
+    kg_->assertTriple("b", "locatedIn", "c");
+    EXPECT_FALSE(kg_->has("a", "locatedIn", "c"));
+    vocabulary_->setPropertyFlag("locatedIn", TRANSITIVE_PROPERTY);
+    kg_->assertTriple("locatedIn", std::string(rdf::type), std::string(owl::TransitiveProperty));
+    EXPECT_TRUE(kg_->has("a", "locatedIn", "c"));
+}
+
+TEST_F(MaterializerTest, MaterializeAll)
+{
+    kg_->assertTriple("a", "partOf", "b");
+    kg_->assertTriple("b", "partOf", "c");
+    auto numTriples = kg_->triples_.size();
+    kg_->materializeAll();
+    EXPECT_EQ(kg_->triples_.size(), numTriples);
+    EXPECT_TRUE(kg_->has("a", "partOf", "c"));
+}
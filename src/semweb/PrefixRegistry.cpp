@@ -24,6 +24,7 @@ PrefixRegistry& PrefixRegistry::get()
 
 void PrefixRegistry::registerPrefix(const std::string &prefix, const std::string &uri)
 {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
     if(uri[uri.size()-1]=='#') {
         auto x = uri;
         x.pop_back();
@@ -36,31 +37,33 @@ void PrefixRegistry::registerPrefix(const std::string &prefix, const std::string
     }
 }
 
-OptionalStringRef PrefixRegistry::uriToAlias(const std::string &uri) const
+std::optional<std::string> PrefixRegistry::uriToAlias(const std::string &uri) const
 {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
     if(uri[uri.size()-1]=='#') {
         auto x = uri;
         x.pop_back();
         auto it = uriToAlias_.find(x);
-        return it == uriToAlias_.end() ? std::nullopt : OptionalStringRef(it->second);
+        return it == uriToAlias_.end() ? std::nullopt : std::optional<std::string>(it->second);
     }
     else {
         auto it = uriToAlias_.find(uri);
-        return it == uriToAlias_.end() ? std::nullopt : OptionalStringRef(it->second);
+        return it == uriToAlias_.end() ? std::nullopt : std::optional<std::string>(it->second);
     }
 }
 
-OptionalStringRef PrefixRegistry::aliasToUri(const std::string &alias) const
+std::optional<std::string> PrefixRegistry::aliasToUri(const std::string &alias) const
 {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
     auto it = aliasToURI_.find(alias);
-    return it == aliasToURI_.end() ? std::nullopt : OptionalStringRef(it->second);
+    return it == aliasToURI_.end() ? std::nullopt : std::optional<std::string>(it->second);
 }
 
 std::optional<std::string> PrefixRegistry::createIRI(const std::string &alias, const std::string &entityName) const
 {
     auto uri = aliasToUri(alias);
     if(uri.has_value()) {
-        return uri.value().get() + "#" + entityName;
+        return uri.value() + "#" + entityName;
     }
     else {
         return uri;
@@ -69,6 +72,8 @@ std::optional<std::string> PrefixRegistry::createIRI(const std::string &alias, c
 
 std::vector<std::string_view> PrefixRegistry::getAliasesWithPrefix(const std::string &prefix) const
 {
+    // note: keys are never erased, so the views stay valid after the lock is released
+    std::shared_lock<std::shared_mutex> lock(mutex_);
     auto range_it = aliasToURI_.equal_range(PrefixProbe { prefix });
     std::vector<std::string_view> result;
     for (auto it = range_it.first; it != range_it.second; ++it) {
@@ -76,3 +81,9 @@ std::vector<std::string_view> PrefixRegistry::getAliasesWithPrefix(const std::st
     }
     return result;
 }
+
+std::map<std::string, std::string> PrefixRegistry::uriToAliasMap() const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return uriToAlias_;
+}
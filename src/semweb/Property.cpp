@@ -17,6 +17,12 @@ void Property::addDirectParent(const std::shared_ptr<Property> &directParent)
 void Property::setInverse(const std::shared_ptr<Property> &inverse)
 { inverse_ = inverse; }
 
+void Property::addDomain(const std::shared_ptr<Class> &domain)
+{ domains_.push_back(domain); }
+
+void Property::addRange(const std::shared_ptr<Class> &range)
+{ ranges_.push_back(range); }
+
 bool Property::hasFlag(PropertyFlag flag) const
 { return flags_ & flag; }
 
@@ -145,6 +145,16 @@ void Vocabulary::setInverseOf(const std::string_view &a, const std::string_view
     b1->setInverse(a1);
 }
 
+void Vocabulary::addPropertyDomain(const std::string_view &property, const std::string_view &domain)
+{
+    defineProperty(property)->addDomain(defineClass(domain));
+}
+
+void Vocabulary::addPropertyRange(const std::string_view &property, const std::string_view &range)
+{
+    defineProperty(property)->addRange(defineClass(range));
+}
+
 bool Vocabulary::isAnnotationProperty(const std::string_view &iri)
 {
     auto it = definedProperties_.find(iri);
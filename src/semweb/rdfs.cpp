@@ -11,4 +11,10 @@ namespace knowrob::semweb {
     bool isSubPropertyOfIRI(std::string_view iri)
     { return iri == rdfs::subPropertyOf; }
 
+    bool isDomainIRI(std::string_view iri)
+    { return iri == rdfs::domain; }
+
+    bool isRangeIRI(std::string_view iri)
+    { return iri == rdfs::range; }
+
 } // knowrob::semweb
@@ -12,6 +12,7 @@
 #include <iostream>
 #include <algorithm>
 #include <list>
+#include <limits>
 // BOOST
 #include <boost/program_options/options_description.hpp>
 #include <boost/program_options/variables_map.hpp>
@@ -24,12 +25,14 @@
 // KnowRob
 #include <knowrob/knowrob.h>
 #include <knowrob/Logger.h>
+#include <knowrob/Tracing.h>
 #include <knowrob/KnowledgeBase.h>
 #include "knowrob/formulas/Predicate.h"
 #include "knowrob/queries/QueryParser.h"
 #include "knowrob/semweb/PrefixRegistry.h"
 #include "knowrob/queries/QueryError.h"
 #include "knowrob/queries/QueryTree.h"
+#include "knowrob/formulas/Conjunction.h"
 
 using namespace knowrob;
 namespace po = boost::program_options;
@@ -120,11 +123,14 @@ template<class T> class TerminalCommand {
 public:
     using CommandFunction = std::function<bool(const std::vector<T> &arguments)>;
 
+    // arity of commands that accept any number of arguments
+    static constexpr uint32_t VARIADIC = std::numeric_limits<uint32_t>::max();
+
     TerminalCommand(std::string functor, uint32_t arity, CommandFunction function)
     : functor_(std::move(functor)), arity_(arity), function_(std::move(function)) {}
 
     bool runCommand(const std::vector<T> &arguments) {
-        if(arguments.size() != arity_) {
+        if(arity_ != VARIADIC && arguments.size() != arity_) {
             throw QueryError("Wrong number of arguments for terminal command '{}/{}'. "
                              "Actual number of arguments: {}.", functor_, arity_, arguments.size());
         }
@@ -162,6 +168,12 @@ public:
                         [this](const std::vector<FormulaPtr> &x) { return assertStatements(x); });
         registerCommand("tell", 1,
                         [this](const std::vector<FormulaPtr> &x) { return assertStatements(x); });
+        registerCommand("explain", TerminalCommand<FormulaPtr>::VARIADIC,
+                        [this](const std::vector<FormulaPtr> &x) { return explainQuery(x); });
+        registerCommand("profile", TerminalCommand<FormulaPtr>::VARIADIC,
+                        [this](const std::vector<FormulaPtr> &x) { return profileQuery(x); });
+        registerCommand("trace_dump", 1,
+                        [this](const std::vector<TermPtr> &x) { return dumpTrace(x); });
 	}
 
 	static char getch() {
@@ -256,9 +268,9 @@ public:
         history_.save(historyFile_);
 	}
 
-    void runQuery(const std::shared_ptr<const ModalQuery> &query) {
+    void runQuery(const std::shared_ptr<const ModalQuery> &query, const QueryProfilePtr &profile={}) {
         // evaluate query in hybrid QA system
-        auto resultStream = kb_.submitQuery(query->formula(), QUERY_FLAG_ALL_SOLUTIONS);
+        auto resultStream = kb_.submitQuery(query->formula(), QUERY_FLAG_ALL_SOLUTIONS, profile);
         auto resultQueue = resultStream->createQueue();
 
         numSolutions_ = 0;
@@ -285,6 +297,45 @@ public:
         }
     }
 
+    static FormulaPtr argumentsToFormula(const std::vector<FormulaPtr> &args) {
+        if(args.empty()) {
+            throw QueryError("Missing query argument.");
+        }
+        else if(args.size()==1) {
+            return args[0];
+        }
+        else {
+            return std::make_shared<Conjunction>(args);
+        }
+    }
+
+    bool explainQuery(const std::vector<FormulaPtr> &args) {
+        auto plan = kb_.explainQuery(argumentsToFormula(args), QUERY_FLAG_ALL_SOLUTIONS);
+        std::cout << *plan << std::flush;
+        return true;
+    }
+
+    bool profileQuery(const std::vector<FormulaPtr> &args) {
+        auto profile = std::make_shared<QueryProfile>();
+        runQuery(std::make_shared<ModalQuery>(argumentsToFormula(args), QUERY_FLAG_ALL_SOLUTIONS), profile);
+        std::cout << *profile << std::flush;
+        return true;
+    }
+
+    bool dumpTrace(const std::vector<TermPtr> &args) {
+        if(args[0]->type() != TermType::STRING) {
+            throw QueryError("Invalid argument '{}', expected a file path.", *args[0]);
+        }
+        auto &path = std::static_pointer_cast<StringTerm>(args[0])->value();
+        if(!Tracer::isEnabled()) {
+            std::cout << "tracing is disabled, enable it with the 'tracing' key in the settings file." << std::endl;
+        }
+        if(Tracer::dump(path)) {
+            std::cout << "trace written to " << path << std::endl;
+        }
+        return true;
+    }
+
     bool assertStatements(const std::vector<FormulaPtr> &args) {
         std::vector<StatementData> data(args.size());
         std::vector<RDFLiteralPtr> buf(args.size());
@@ -434,10 +485,10 @@ public:
 	bool autoCompleteLocal(const std::string &word, const std::string &nsAlias) {
 		auto uri = semweb::PrefixRegistry::get().aliasToUri(nsAlias);
 		if(uri.has_value()) {
-			auto partialIRI = uri.value().get() + "#" + word;
+			auto partialIRI = uri.value() + "#" + word;
 			auto propertyOptions = kb_.vocabulary()->getDefinedPropertyNamesWithPrefix(partialIRI);
 			auto classOptions = kb_.vocabulary()->getDefinedClassNamesWithPrefix(partialIRI);
-			size_t namePosition = uri.value().get().length() + 1;
+			size_t namePosition = uri.value().length() + 1;
 
 			// create options array holding only the name of entities.
 			// note that strings are not copied by using string_view
@@ -15,14 +15,34 @@ using namespace knowrob;
 ListTerm::ListTerm(const std::vector<TermPtr> &elements)
 : Term(TermType::LIST),
   elements_(elements),
-  variables_(getVariables1())
+  variables_(getVariables1()),
+  isLazy_(false),
+  numLazyElements_(0)
 {
 }
 
+ListTerm::ListTerm(std::size_t numElements, bool isLazy)
+: Term(TermType::LIST),
+  isLazy_(isLazy),
+  numLazyElements_(numElements)
+{
+}
+
+const std::vector<TermPtr>& ListTerm::elements() const
+{
+	if(isLazy_) {
+		std::call_once(materializeFlag_, [this]{ materialize(elements_); });
+	}
+	return elements_;
+}
+
 bool ListTerm::isEqual(const Term& other) const {
 	const auto &x = static_cast<const ListTerm&>(other); // NOLINT
-    for(int i=0; i<elements_.size(); ++i) {
-        if(!(*(elements_[i]) == *(x.elements_[i]))) return false;
+	const auto &elems = elements();
+	const auto &otherElems = x.elements();
+	if(elems.size() != otherElems.size()) return false;
+    for(std::size_t i=0; i<elems.size(); ++i) {
+        if(!(*(elems[i]) == *(otherElems[i]))) return false;
     }
     return true;
 }
@@ -47,7 +67,7 @@ std::shared_ptr<ListTerm> ListTerm::nil()
 
 bool ListTerm::isNIL() const
 {
-	return elements_.empty();
+	return isLazy_ ? (numLazyElements_==0) : elements_.empty();
 }
 
 size_t ListTerm::computeHash() const
@@ -55,7 +75,7 @@ size_t ListTerm::computeHash() const
     static const auto GOLDEN_RATIO_HASH = static_cast<size_t>(0x9e3779b9);
     auto seed = static_cast<size_t>(0);
 
-    for(const auto &item : elements_) {
+    for(const auto &item : elements()) {
         /* Combine the hashes.
            The function (a ^ (b + GOLDEN_RATIO_HASH + (a << 6) + (a >> 2))) is known to
            give a good distribution of hash values across the range of size_t. */
@@ -67,11 +87,12 @@ size_t ListTerm::computeHash() const
 
 void ListTerm::write(std::ostream& os) const
 {
+	const auto &elems = elements();
 	os << '[';
-	for(uint32_t i=0; i<elements_.size(); i++) {
-		Term *t = elements_[i].get();
+	for(uint32_t i=0; i<elems.size(); i++) {
+		Term *t = elems[i].get();
 		os << (*t);
-		if(i+1 < elements_.size()) {
+		if(i+1 < elems.size()) {
 			os << ',' << ' ';
 		}
 	}
@@ -99,3 +120,27 @@ TEST(list_term, lists) {
     EXPECT_EQ(ListTerm({x,y}).elements()[0], x);
     EXPECT_EQ(ListTerm({x,y}).elements()[1], y);
 }
+
+class CountingListTerm : public ListTerm {
+public:
+	CountingListTerm() : ListTerm(2, true) {}
+	mutable int numMaterialized = 0;
+protected:
+	void materialize(std::vector<TermPtr> &elements) const override {
+		numMaterialized += 1;
+		elements.push_back(std::make_shared<StringTerm>("x"));
+		elements.push_back(std::make_shared<LongTerm>(2));
+	}
+};
+
+TEST(list_term, lazy) {
+    CountingListTerm l;
+    EXPECT_EQ(l.numMaterialized, 0);
+    EXPECT_TRUE(l.isGround());
+    EXPECT_FALSE(l.isNIL());
+    EXPECT_EQ(l.numMaterialized, 0);
+    EXPECT_EQ(l.elements().size(), 2);
+    EXPECT_EQ(l.elements().size(), 2);
+    EXPECT_EQ(l.numMaterialized, 1);
+    EXPECT_TRUE(l == ListTerm({std::make_shared<StringTerm>("x"), std::make_shared<LongTerm>(2)}));
+}
@@ -20,8 +20,10 @@ Term::Term(TermType type)
 
 bool Term::operator==(const Term& other) const
 {
-	// note: isEqual can safely perform static cast as type id's do match
-	return typeid(*this) == typeid(other) && isEqual(other);
+	// note: isEqual can safely perform static cast as type id's do match.
+	//       lists are compared by their elements, no matter how they are represented.
+	return (typeid(*this) == typeid(other) ||
+			(type_ == TermType::LIST && other.type() == TermType::LIST)) && isEqual(other);
 }
 
 bool VariableComparator::operator()(const Variable* const &v0, const Variable* const &v1) const